@@ -3,6 +3,12 @@
 
 #include <thread>
 #include <mutex>
+#include <vector>
+#include <string>
+#include <span>
+#include <cstring>
+#include <cctype>
+#include <cstdio>
 
 using namespace Pinewood::Operators;
 
@@ -24,47 +30,63 @@ uint32_t indices[6]{
 	2, 3, 0
 };
 
+Vertex triangleVertices[3]{
+	{ {  0.0,  0.5 }, {  0.5,  2.0 } },
+	{ {  0.5, -0.5 }, {  2.0, -1.0 } },
+	{ { -0.5, -0.5 }, { -1.0, -1.0 } }
+};
+
+uint32_t triangleIndices[3]{
+	0, 1, 2
+};
+
 Pinewood::HLLayoutElement layoutElements[]{
 	{ 0,					Pinewood::HLLayoutElementType::Vector2F32, /* index */ 0, /* binding */ 0, /* divisor (per-vertex) */ 0 },
-	{ offsetof(Vertex, uv),	Pinewood::HLLayoutElementType::Vector3F32, /* index */ 1, /* binding */ 0, /* divisor (per-vertex) */ 0 }
+	{ offsetof(Vertex, uv),	Pinewood::HLLayoutElementType::Vector3F32, /* index */ 1, /* binding */ 0, /* divisor (per-vertex) */ 0 },
+	{ 0,					Pinewood::HLLayoutElementType::Vector3F32, /* index */ 2, /* binding */ 1, /* divisor (per-instance) */ 1 }
 };
 
 Pinewood::HLLayoutBinding layoutBindings[]{
-	{ 0, sizeof(Vertex) }
+	{ 0, sizeof(Vertex) },
+	{ 0, sizeof(PWMath::Vector3F32) }
 };
 
-const char* vertexShaderSource = R"(
-#version 450
-
-layout(location = 0) in vec4 i_position;
-layout(location = 1) in vec4 i_color;
+// A grid of quads, culled on the GPU. The offset of a quad is an instanced attribute, indexed by the baseInstance of its draw,
+// and its z is the texture of the quad in the texture table. Every other row is triangles, from the same geometry heap
+constexpr uint32_t GridSize = 64;
+constexpr float GridSpacing = 1.25f;
 
-layout(std140, location = 0) uniform transform
+// The #version and the vertex puller are put before it, the attributes are read from storage buffers
+const char* vertexShaderSource = R"(
+layout(std140, binding = 0) uniform transform
 {
 	mat4 u_mvp;
 };
 
 out vec4 v_color;
+flat out uint v_texture;
 
 void main()
 {
-	gl_Position = u_mvp * i_position;
-	v_color = i_color;
+	vec4 position = PWPullAttribute0();
+	vec3 offset = PWPullAttribute2().xyz;
+
+	gl_Position = u_mvp * (position + vec4(offset.xy, 0.0, 0.0));
+	v_color = PWPullAttribute1();
+	v_texture = uint(offset.z);
 }
 )";
 
+// The #version and the texture table are put before it
 const char* pixelShaderSource = R"(
-#version 450
-
 layout(location = 0) out vec4 o_color;
 
-layout(location = 1) uniform sampler2D i_sampler;
-
 in vec4 v_color;
+flat in uint v_texture;
 
 void main()
 {
-	o_color = texture(i_sampler, v_color.rg);//vec4(pow(v_color.rgb, vec3(1/2.2)), v_color.a); 
+	o_color = SampleTextureTable(v_texture, v_color.rg);//vec4(pow(v_color.rgb, vec3(1/2.2)), v_color.a); 
 }
 )";
 
@@ -98,6 +120,27 @@ void main()
 }
 )";
 
+// Darkens the corners of the resolved scene in place
+const char* vignetteComputeSource = R"(
+#version 450
+
+layout(local_size_x = 8, local_size_y = 8) in;
+
+layout(binding = 0, rgba8) uniform image2D u_image;
+
+void main()
+{
+	ivec2 size = imageSize(u_image);
+	ivec2 texel = ivec2(gl_GlobalInvocationID.xy);
+	if (any(greaterThanEqual(texel, size)))
+		return;
+
+	vec2 offset = (vec2(texel) + 0.5) / vec2(size) - 0.5;
+	vec4 color = imageLoad(u_image, texel);
+	imageStore(u_image, texel, vec4(color.rgb * (1.0 - dot(offset, offset)), color.a));
+}
+)";
+
 constexpr uint8_t textureData[] = {
 	0xff, 0x00, 0x00,
 	0xff, 0xff, 0x00,
@@ -110,24 +153,53 @@ constexpr uint8_t textureData[] = {
 	0xff, 0xff, 0xff,
 };
 
+// The same pixels in the other order
+constexpr uint8_t altTextureData[] = {
+	0xff, 0xff, 0xff,
+	0xff, 0x00, 0xff,
+	0x00, 0x00, 0xff,
+	0x00, 0xff, 0xff,
+
+	0x00, 0x00, 0x00,
+	0x00, 0xff, 0x00,
+	0xff, 0xff, 0x00,
+	0xff, 0x00, 0x00,
+};
+
 std::mutex contextMutex;
 Pinewood::Window window;
 Pinewood::HLContext context;
 Pinewood::HLRenderInterface renderInterface;
-Pinewood::HLBuffer vertexBuffer, indexBuffer, uniformBuffer;
+Pinewood::HLResourceLoader resourceLoader;
+Pinewood::HLRenderTargetPool renderTargetPool;
+Pinewood::HLRenderGraph renderGraph;
+constexpr uint32_t FramesInFlight = 2;
+
+Pinewood::HLBuffer offsetBuffer;
+Pinewood::HLBuffer uniformBuffers[FramesInFlight]; // Written every frame, so one per frame in flight
 Pinewood::HLLayout vertexLayout;
-Pinewood::HLVertexBinding vertexBinding;
+Pinewood::HLGeometryHeap geometryHeap; // The quad and the triangle, drawn with one vertex binding
+Pinewood::HLVertexPuller vertexPuller; // Draws the heap without its vertex binding, the shader reads the buffers
 Pinewood::HLShaderModule vertexShader, pixelShader;
 Pinewood::HLShaderProgram shaderProgram;
-Pinewood::HLTexture2D texture;
+Pinewood::HLPipelineState scenePipeline;
+Pinewood::HLTexture2D texture, altTexture;
+Pinewood::HLSampler pointSampler; // Nearest and repeating, for the pixel art textures
+Pinewood::HLTextureTable textureTable; // The textures of the quads, so every quad is drawn by one multi-draw
+bool textureReady = false; // Loaded on the resource loader thread, then put in the texture table
+Pinewood::HLResidencyManager residencyManager; // The binds of the render interface mark the registered resources used
+Pinewood::HLGPUCuller culler;
 
 Pinewood::HLBuffer screenVertexBuffer;
 Pinewood::HLLayout screenVertexLayout;
 Pinewood::HLVertexBinding screenVertexBinding;
 Pinewood::HLShaderModule postVertex, postPixel;
 Pinewood::HLShaderProgram postProgram;
-Pinewood::HLTexture2D colorAttachment;
-Pinewood::HLFramebuffer framebuffer;
+Pinewood::HLPipelineState postPipeline;
+Pinewood::HLSampler linearClampSampler; // Same render target size, but filtered in case it's scaled
+Pinewood::HLShaderModule vignetteCompute;
+Pinewood::HLShaderProgram vignetteProgram;
+uint32_t targetWidth = 1280, targetHeight = 720; // The size of the render graph's targets
 
 Pinewood::KeyboardInput keyboard;
 Pinewood::MouseInput mouse;
@@ -139,39 +211,40 @@ void WindowResizeHandler(const Pinewood::Window&, const Pinewood::WindowEvent& e
 
 	context.MakeCurrent();
 	context.ResizeSwapChain(event.width, event.height);
+	context.MakeObsolete();
 
-	// Recreate framebuffer
-	colorAttachment.Create({
-		.context = context,
-		.width = event.width,
-		.height = event.height,
-		.sampleFilter = Pinewood::HLTextureFilter::Nearest,
-		.format = Pinewood::HLImageFormat::R8G8B8_UNorm,
-		.data = nullptr
-		});
+	// The next frame acquires targets of the new size, the pool destroys the old ones once they're unused
+	targetWidth = std::max<uint32_t>(event.width, 1);
+	targetHeight = std::max<uint32_t>(event.height, 1);
+}
 
+int main(int argc, char** argv)
+{
+	// --headless [frames] renders that many frames without showing a window, then exits
+	// --memory-budget <MiB> replaces the GPU memory budget of the driver (ex: to test eviction with a software renderer)
+	bool headless = false;
+	uint32_t headlessFrames = 300;
+	uint64_t memoryBudget = 0;
+	for (int i = 1; i < argc; i++)
 	{
-		Pinewood::HLTexture2D textures[]{ colorAttachment };
-		Pinewood::HLFramebufferAttachment attachments[]{ Pinewood::HLFramebufferAttachment::Color0 };
-		framebuffer.Create({
-			.context = context,
-			.textures = std::span{ textures },
-			.attachments = std::span{ attachments }
-			});
+		if (std::strcmp(argv[i], "--headless") == 0)
+		{
+			headless = true;
+			if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0])))
+				headlessFrames = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (std::strcmp(argv[i], "--memory-budget") == 0 && i + 1 < argc)
+			memoryBudget = std::strtoull(argv[++i], nullptr, 10) * 1024 * 1024;
 	}
 
-	context.MakeObsolete();
-}
-
-int main()
-{
 	window.Create({
 		.title = "Pinewood Application Window",
 		.x = 100,
 		.y = 100,
 		.width = 1280,
 		.height = 720,
-		.flags = Pinewood::WindowCreateFlags::DefaultStyle | Pinewood::WindowCreateFlags::Show | Pinewood::WindowCreateFlags::Async
+		.flags = Pinewood::WindowCreateFlags::DefaultStyle | Pinewood::WindowCreateFlags::Show | Pinewood::WindowCreateFlags::Async |
+			Pinewood::WindowCreateFlags::EventQueue | (headless ? Pinewood::WindowCreateFlags::Headless : Pinewood::WindowCreateFlags{})
 		});
 
 	window.AddEventHandler({
@@ -184,60 +257,141 @@ int main()
 
 	context.Create({
 		.window = window,
-		.swapInterval = 1
+		.swapInterval = 1,
+		.framesInFlight = FramesInFlight
 		});
 
 	renderInterface.Create({
 		.context = context
 		});
 
-	renderInterface.SetClearColor({ 0.2f, 0.3f, 0.5f, 1.0f });
+	residencyManager.Create({
+		.renderInterface = renderInterface,
+		.budget = memoryBudget
+		});
+	renderInterface.SetResidencyManager(residencyManager);
 
-	vertexBuffer.Create({
-		.context = context,
-		.usage = Pinewood::HLBufferUsage::Mutable,
-		.size = sizeof(vertices),
-		.data = vertices
+	resourceLoader.Create({
+		.context = context
 		});
 
-	indexBuffer.Create({
-		.context = context,
-		.usage = Pinewood::HLBufferUsage::Mutable,
-		.size = sizeof(indices),
-		.data = indices
+	renderTargetPool.Create({
+		.context = context
 		});
 
-	uniformBuffer.Create({
-		.context = context,
-		.usage = Pinewood::HLBufferUsage::Mutable,
-		.size = sizeof(PWMath::Matrix4x4F32)
+	renderGraph.Create({
+		.renderInterface = renderInterface,
+		.renderTargetPool = renderTargetPool
 		});
 
-	vertexLayout.Create({
-		.context = context,
-		.elements = layoutElements,
-		.bindings = layoutBindings
+	renderInterface.SetClearColor({ 0.2f, 0.3f, 0.5f, 1.0f });
+
+	culler.Create({
+		.renderInterface = renderInterface,
+		.maxObjectCount = GridSize * GridSize
 		});
 
-	vertexBinding.Create({
-		.context = context,
-		.vertexBuffers = std::span{ &vertexBuffer, 1 },
-		.indexBuffer = indexBuffer,
-		.vertexLayout = vertexLayout
+	{
+		std::vector<PWMath::Vector3F32> offsets;
+		for (uint32_t y = 0; y < GridSize; y++)
+		{
+			for (uint32_t x = 0; x < GridSize; x++)
+				offsets.push_back({ (x - GridSize / 2.0f) * GridSpacing, (y - GridSize / 2.0f) * GridSpacing, static_cast<float>((x + y) % 2) });
+		}
+
+		offsetBuffer.Create({
+			.context = context,
+			.usage = Pinewood::HLBufferUsage::Immutable,
+			.size = offsets.size() * sizeof(PWMath::Vector3F32),
+			.data = offsets.data()
+			});
+
+		vertexLayout.Create({
+			.context = context,
+			.elements = layoutElements,
+			.bindings = layoutBindings
+			});
+
+		Pinewood::HLBuffer instanceBuffers[]{ offsetBuffer };
+		geometryHeap.Create({
+			.context = context,
+			.vertexLayout = vertexLayout,
+			.otherBuffers = instanceBuffers,
+			.vertexCapacity = 1024,
+			.indexCapacity = 4096
+			});
+
+		Pinewood::HLGeometryMesh quad, triangle;
+		geometryHeap.Allocate(std::as_bytes(std::span{ vertices }), indices, quad);
+		geometryHeap.Allocate(std::as_bytes(std::span{ triangleVertices }), triangleIndices, triangle);
+		const Pinewood::HLGeometryRange meshRanges[]{ geometryHeap.GetRange(quad), geometryHeap.GetRange(triangle) };
+
+		std::vector<Pinewood::HLGPUCullerObject> objects;
+		for (uint32_t i = 0; i < offsets.size(); i++)
+		{
+			const Pinewood::HLGeometryRange& range = meshRanges[(i / GridSize) % 2];
+			objects.push_back({ .center = { offsets[i].x, offsets[i].y, 0.0f }, .radius = 0.71f, .indexCount = range.indexCount,
+				.firstIndex = range.firstIndex, .baseVertex = range.baseVertex });
+		}
+
+		culler.SetObjects(0, objects);
+		culler.SetObjectCount(static_cast<uint32_t>(objects.size()));
+	}
+
+	for (auto& uniformBuffer : uniformBuffers)
+	{
+		uniformBuffer.Create({
+			.context = context,
+			.usage = Pinewood::HLBufferUsage::Mutable,
+			.size = sizeof(PWMath::Matrix4x4F32)
+			});
+	}
+
+	// Storage buffer 0 is the bindless texture table
+	vertexPuller.Create({
+		.renderInterface = renderInterface,
+		.vertexLayout = vertexLayout,
+		.firstBufferIndex = 1
 		});
 
-	vertexShader.Create({
+	{
+		const std::string source = "#version 450\n" + vertexPuller.GetShaderSource() + vertexShaderSource;
+		vertexShader.Create({
+			.context = context,
+			.type = Pinewood::HLShaderModuleType::Vertex,
+			.shaderSource = source
+			});
+	}
+
+	pointSampler.Create({
 		.context = context,
-		.type = Pinewood::HLShaderModuleType::Vertex,
-		.shaderSource = vertexShaderSource
+		.minFilter = Pinewood::HLTextureFilter::Nearest,
+		.magFilter = Pinewood::HLTextureFilter::Nearest,
+		.mipFilter = Pinewood::HLSamplerMipFilter::None
 		});
 
-	pixelShader.Create({
-		.context = context,
-		.type = Pinewood::HLShaderModuleType::Pixel,
-		.shaderSource = pixelShaderSource
+	// Bindless if the driver supports it, otherwise the textures are copied into an array of their size and format
+	textureTable.Create({
+		.renderInterface = renderInterface,
+		.capacity = 2,
+		.sampler = pointSampler,
+		.bufferIndex = 0,
+		.textureLocation = 1,
+		.textureSlot = 0,
+		.width = 4,
+		.height = 2,
+		.format = Pinewood::HLImageFormat::R8G8B8_UNorm
 		});
 
+	{
+		const std::string source = "#version 450\n" + textureTable.GetShaderSource() + pixelShaderSource;
+		pixelShader.Create({
+			.context = context,
+			.type = Pinewood::HLShaderModuleType::Pixel,
+			.shaderSource = source
+			});
+	}
+
 	{
 		Pinewood::HLShaderModule shaderModules[]{ vertexShader, pixelShader };
 
@@ -247,6 +401,19 @@ int main()
 			});
 	}
 
+	scenePipeline.Create({
+		.context = context,
+		.program = shaderProgram,
+		.layout = vertexLayout,
+		.renderState = {
+			.blend = {
+				.enable = true,
+				.sourceColor = Pinewood::HLBlendFactor::SourceAlpha,
+				.destinationColor = Pinewood::HLBlendFactor::OneMinusSourceAlpha
+			}
+		}
+		});
+
 	postVertex.Create({
 		.context = context,
 		.type = Pinewood::HLShaderModuleType::Vertex,
@@ -268,15 +435,51 @@ int main()
 			});
 	}
 
-	texture.Create({
+	vignetteCompute.Create({
 		.context = context,
-		.width = 4,
-		.height = 2,
-		.sampleFilter = Pinewood::HLTextureFilter::Nearest,
-		.format = Pinewood::HLImageFormat::R8G8B8_UNorm,
-		.data = (void*)textureData
+		.type = Pinewood::HLShaderModuleType::Compute,
+		.shaderSource = vignetteComputeSource
 		});
-	
+
+	{
+		Pinewood::HLShaderModule shaderModules[]{ vignetteCompute };
+
+		vignetteProgram.Create({
+			.context = context,
+			.shaderModules = shaderModules
+			});
+	}
+
+	resourceLoader.Load([]()
+	{
+		texture.Create({
+			.context = context,
+			.width = 4,
+			.height = 2,
+			.sampleFilter = Pinewood::HLTextureFilter::Nearest,
+			.format = Pinewood::HLImageFormat::R8G8B8_UNorm,
+			.data = (void*)textureData
+			});
+
+		altTexture.Create({
+			.context = context,
+			.width = 4,
+			.height = 2,
+			.sampleFilter = Pinewood::HLTextureFilter::Nearest,
+			.format = Pinewood::HLImageFormat::R8G8B8_UNorm,
+			.data = (void*)altTextureData
+			});
+	}, []()
+	{
+		textureTable.SetTexture(0, texture);
+		textureTable.SetTexture(1, altTexture);
+		textureReady = true;
+
+		// The table copies them or keeps them alive, so they're always resident
+		Pinewood::HLResidentResource resource;
+		residencyManager.Register(texture, resource);
+		residencyManager.Register(altTexture, resource);
+	});
 
 	{
 		PWMath::Vector2F32 screenVertices[] = {
@@ -312,34 +515,35 @@ int main()
 			.vertexBuffers = screenVertexBuffers,
 			.vertexLayout = screenVertexLayout
 			});
-	}
 
-	// Create framebuffer
-	colorAttachment.Create({
-		.context = context,
-		.width = 1280,
-		.height = 720,
-		.sampleFilter = Pinewood::HLTextureFilter::Nearest,
-		.format = Pinewood::HLImageFormat::R8G8B8_UNorm,
-		.data = nullptr
-		});
+		postPipeline.Create({
+			.context = context,
+			.program = postProgram,
+			.layout = screenVertexLayout
+			});
 
-	{
-		Pinewood::HLTexture2D textures[]{ colorAttachment };
-		Pinewood::HLFramebufferAttachment attachments[]{ Pinewood::HLFramebufferAttachment::Color0 };
-		framebuffer.Create({
+		linearClampSampler.Create({
 			.context = context,
-			.textures = std::span{ textures },
-			.attachments = std::span{ attachments }
+			.mipFilter = Pinewood::HLSamplerMipFilter::None,
+			.wrapU = Pinewood::HLTextureWrapMode::ClampToEdge,
+			.wrapV = Pinewood::HLTextureWrapMode::ClampToEdge
 			});
 	}
 
 	PWMath::Vector3F32 position{ 0.0f };
+	float zoom = 0.0f;
 	uint32_t qwerty = 0;
 	// No need to call update, it's done automatically on a separate thread
 	while (window.IsRunning())
 	{
 		qwerty++;
+
+		// Event handlers run here, on the main thread
+		window.PollEvents();
+		keyboard.BeginFrame();
+		mouse.BeginFrame();
+		zoom += mouse.GetScrollDelta();
+
 		if (keyboard.IsKeyPressed(Pinewood::KeyCode::W)) position.y += 0.05f;
 		if (keyboard.IsKeyPressed(Pinewood::KeyCode::S)) position.y -= 0.05f;
 		if (keyboard.IsKeyPressed(Pinewood::KeyCode::A)) position.x -= 0.05f;
@@ -349,48 +553,151 @@ int main()
 
 		context.MakeCurrent();
 
-		context.SwapBuffers();
+		// Waits for the GPU to finish the frame from FramesInFlight frames ago
+		context.BeginFrame();
+
+		// Finished GPU zones from earlier frames, then close the profiler frame
+		renderInterface.CollectGPUZones();
+		Pinewood::Profiler::EndFrame();
+		Pinewood::HLRenderInterface::ResetGlobalStats();
+
+		// Textures finished by the resource loader
+		resourceLoader.Update();
+
+		PW_PROFILE_SCOPE("Render");
 
 		auto matrix = PWMath::Translate(PWMath::Matrix4x4F32{ 1 }, position);
-		matrix = PWMath::Scale(matrix, PWMath::Vector3F32{ std::expf(mouse.GetScrollDelta()) });
+		matrix = PWMath::Scale(matrix, PWMath::Vector3F32{ std::exp(zoom) });
 
+		auto& uniformBuffer = uniformBuffers[context.GetFrameSlot()];
 		void* uniformMapping;
 		uniformBuffer.Map(uniformMapping, Pinewood::HLBufferAccess::Write);
 		std::memcpy(uniformMapping, &matrix, sizeof(matrix));
 		uniformBuffer.Unmap();
 
 		// Render here
-		renderInterface.SetFramebuffer(framebuffer);
+		// The scene is rendered with 4x MSAA and resolved for the post pass, a resolve needs the same format on both sides
+		auto sceneColorMS = renderGraph.CreateTexture("Scene color MSAA", {
+			.width = targetWidth,
+			.height = targetHeight,
+			.format = Pinewood::HLImageFormat::R8G8B8A8_UNorm,
+			.samples = 4
+			});
+		auto sceneColor = renderGraph.CreateTexture("Scene color", {
+			.width = targetWidth,
+			.height = targetHeight,
+			.format = Pinewood::HLImageFormat::R8G8B8A8_UNorm
+			});
+		auto backbuffer = renderGraph.ImportBackbuffer("Backbuffer");
+		auto drawCommands = renderGraph.ImportBuffer("Draw commands", culler.GetCommandBuffer());
+
+		renderGraph.AddPass("Cull", [&](Pinewood::HLRenderGraphPassContext&)
+		{
+			float viewProjection[16];
+			std::memcpy(viewProjection, &matrix, sizeof(viewProjection));
+			culler.Cull(viewProjection);
+		}).Write(drawCommands);
 
-		renderInterface.ClearTarget(Pinewood::ClearTargetFlags::Color);
+		renderGraph.AddPass("Scene", [&](Pinewood::HLRenderGraphPassContext& pass)
+		{
+			auto& renderInterface = pass.GetRenderInterface();
+			renderInterface.ClearTarget(Pinewood::ClearTargetFlags::Color);
 
-		renderInterface.BindShaderProgram(shaderProgram);
+			if (textureReady)
+			{
+				renderInterface.BindPipelineState(scenePipeline);
 
-		renderInterface.BindVertexBinding(vertexBinding);
+				const Pinewood::HLBuffer sceneBuffers[]{ geometryHeap.GetVertexBuffer(), offsetBuffer };
+				vertexPuller.Bind(sceneBuffers, geometryHeap.GetIndexBuffer());
 
-		renderInterface.SetConstantBuffer(0, uniformBuffer);
+				renderInterface.SetConstantBuffer(0, uniformBuffer);
 
-		renderInterface.SetTexture2D(1, 0, texture);
+				textureTable.Bind();
 
-		renderInterface.DrawIndexed(6);
+				culler.Draw();
+			}
+		}).Read(drawCommands).Write(sceneColorMS, Pinewood::HLFramebufferAttachment::Color0);
 
+		renderGraph.AddPass("Resolve", [&](Pinewood::HLRenderGraphPassContext& pass)
+		{
+			pass.GetRenderInterface().Resolve(pass.GetReadFramebuffer(sceneColorMS), pass.GetFramebuffer());
+		}).Read(sceneColorMS).Write(sceneColor, Pinewood::HLFramebufferAttachment::Color0);
 
+		renderGraph.AddPass("Vignette", [&](Pinewood::HLRenderGraphPassContext& pass)
+		{
+			auto& renderInterface = pass.GetRenderInterface();
+			renderInterface.BindShaderProgram(vignetteProgram);
+			renderInterface.SetImage2D(0, pass.GetTexture(sceneColor), Pinewood::HLBufferAccess::Read | Pinewood::HLBufferAccess::Write);
+			renderInterface.Dispatch((targetWidth + 7) / 8, (targetHeight + 7) / 8);
 
-		renderInterface.ResetFramebuffer();
-		renderInterface.ClearTarget(Pinewood::ClearTargetFlags::Color);
+			// The post pass samples the image
+			renderInterface.Barrier(Pinewood::HLBarrierFlags::Texture);
+		}).Read(sceneColor).Write(sceneColor);
 
-		renderInterface.ClearTarget(Pinewood::ClearTargetFlags::Color | Pinewood::ClearTargetFlags::Depth | Pinewood::ClearTargetFlags::Stencil);
+		renderGraph.AddPass("Post", [&](Pinewood::HLRenderGraphPassContext& pass)
+		{
+			auto& renderInterface = pass.GetRenderInterface();
+			renderInterface.ClearTarget(Pinewood::ClearTargetFlags::Color | Pinewood::ClearTargetFlags::Depth | Pinewood::ClearTargetFlags::Stencil);
 
-		renderInterface.BindShaderProgram(postProgram);
+			renderInterface.BindPipelineState(postPipeline);
 
-		renderInterface.BindVertexBinding(screenVertexBinding);
+			renderInterface.BindVertexBinding(screenVertexBinding);
 
-		renderInterface.SetTexture2D(1, 0, colorAttachment);
+			renderInterface.SetTexture2D(1, 0, pass.GetTexture(sceneColor), linearClampSampler);
 
-		renderInterface.Draw(0, 3);
+			renderInterface.Draw(0, 3);
+		}).Read(sceneColor).Write(backbuffer, Pinewood::HLFramebufferAttachment::Color0);
 
+		renderGraph.Execute();
+		renderTargetPool.EndFrame();
+		residencyManager.Update();
+
+		context.EndFrame();
 		context.MakeObsolete();
+
+		if (headless && qwerty >= headlessFrames)
+		{
+			auto stats = context.GetFrameStats();
+			std::printf("%llu frames, CPU %.3f ms, GPU %.3f ms, latency %.3f ms, queue depth %u\n", static_cast<unsigned long long>(stats.frameIndex),
+				stats.cpuFrameTime, stats.gpuFrameTime, stats.latency, stats.queueDepth);
+
+			auto poolStats = renderTargetPool.GetStats();
+			std::printf("%u render targets (%llu created), %u framebuffers (%llu created), %.2f MiB\n", poolStats.targetCount,
+				static_cast<unsigned long long>(poolStats.targetsCreated), poolStats.framebufferCount,
+				static_cast<unsigned long long>(poolStats.framebuffersCreated), poolStats.memorySize / (1024.0 * 1024.0));
+			window.Destroy();
+		}
+	}
+
+	context.MakeCurrent();
+
+	if (headless)
+	{
+		// The count of the last frame, written by a shader
+		renderInterface.Barrier(Pinewood::HLBarrierFlags::BufferTransfer);
+		uint32_t visibleCount = 0;
+		culler.GetCountBuffer().GetData(&visibleCount, 0, sizeof(visibleCount));
+		std::printf("%u of %u objects visible (draw indirect count %s)\n", visibleCount, culler.GetObjectCount(),
+			renderInterface.IsDrawIndirectCountSupported() ? "supported" : "not supported");
+		std::printf("Texture table: %s\n", textureTable.IsBindless() ? "bindless" : "texture array fallback");
+
+		auto residencyStats = residencyManager.GetStats();
+		if (residencyStats.budget == UINT64_MAX)
+			std::printf("GPU memory: %.2f MiB, no budget\n", residencyStats.usedMemory / (1024.0 * 1024.0));
+		else
+			std::printf("GPU memory: %.2f MiB of %.2f MiB, %llu evictions\n", residencyStats.usedMemory / (1024.0 * 1024.0),
+				residencyStats.budget / (1024.0 * 1024.0), static_cast<unsigned long long>(residencyStats.evictions));
 	}
 
+	resourceLoader.Destroy();
+	renderInterface.SetResidencyManager(Pinewood::HLResidencyManager{});
+	residencyManager.Destroy();
+	textureTable.Destroy();
+	culler.Destroy();
+	vertexPuller.Destroy();
+	geometryHeap.Destroy();
+	renderGraph.Destroy();
+	renderTargetPool.Destroy();
+
 	return 0;
 }
@@ -0,0 +1,48 @@
+#include "BakeCommon.h"
+
+#include <fstream>
+#include <system_error>
+
+namespace AssetBaker
+{
+	Result ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& dataOut)
+	{
+		std::ifstream file{ path, std::ios::binary | std::ios::ate };
+		if (!file)
+			return Result::SystemError;
+
+		auto size = static_cast<size_t>(file.tellg());
+		file.seekg(0);
+
+		dataOut.resize(size);
+		if (!file.read(reinterpret_cast<char*>(dataOut.data()), size))
+			return Result::SystemError;
+
+		return Result::Success;
+	}
+
+	Result WriteFile(const std::filesystem::path& path, std::span<const uint8_t> data)
+	{
+		auto tempPath = path;
+		tempPath += ".tmp";
+
+		{
+			std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+			if (!file)
+				return Result::SystemError;
+
+			if (!file.write(reinterpret_cast<const char*>(data.data()), data.size()))
+				return Result::SystemError;
+		}
+
+		std::error_code error;
+		std::filesystem::rename(tempPath, path, error);
+		if (error)
+		{
+			std::filesystem::remove(tempPath, error);
+			return Result::SystemError;
+		}
+
+		return Result::Success;
+	}
+}
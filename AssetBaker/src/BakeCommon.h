@@ -0,0 +1,93 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/BakedAsset.h>
+
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace AssetBaker
+{
+	using Pinewood::Result;
+	using Pinewood::IsError;
+
+	// Bump this whenever the output of a baker changes, so old cache entries get rebuilt
+	constexpr uint64_t BakerSettingsVersion = 2;
+
+	struct BakeSettings
+	{
+		bool generateMips = true;
+		bool optimizeMesh = true;	// Vertex cache, overdraw and vertex fetch optimization
+		std::string shaderCompiler = "glslangValidator";	// Not part of the hash, -f rebuilds the shaders after changing it
+	};
+
+	// 64-bit FNV-1a, good enough to detect changed sources (this isn't for security)
+	constexpr uint64_t FNVOffsetBasis = 0xcbf29ce484222325ull;
+
+	inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = FNVOffsetBasis)
+	{
+		const auto* bytes = static_cast<const uint8_t*>(data);
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= bytes[i];
+			hash *= 0x100000001b3ull;
+		}
+
+		return hash;
+	}
+
+	inline uint64_t HashSource(std::span<const uint8_t> source, const BakeSettings& settings)
+	{
+		uint64_t hash = HashBytes(source.data(), source.size());
+		hash = HashBytes(&BakerSettingsVersion, sizeof(BakerSettingsVersion), hash);
+		hash = HashBytes(&settings.generateMips, sizeof(settings.generateMips), hash);
+		hash = HashBytes(&settings.optimizeMesh, sizeof(settings.optimizeMesh), hash);
+		return hash;
+	}
+
+	Result ReadFile(const std::filesystem::path& path, std::vector<uint8_t>& dataOut);
+
+	// Writes to a temporary file first and then renames it, so an interrupted bake never leaves a half written blob
+	Result WriteFile(const std::filesystem::path& path, std::span<const uint8_t> data);
+
+	// Little helper for building blobs
+	class BlobWriter
+	{
+	public:
+		template<typename T>
+		size_t Write(const T& value)
+		{
+			return Write(&value, sizeof(T));
+		}
+
+		size_t Write(const void* data, size_t size)
+		{
+			size_t offset = m_data.size();
+			m_data.resize(offset + size);
+			std::memcpy(m_data.data() + offset, data, size);
+			return offset;
+		}
+
+		// Pads the blob with zeros until it's aligned
+		size_t Align(size_t alignment)
+		{
+			m_data.resize((m_data.size() + alignment - 1) / alignment * alignment);
+			return m_data.size();
+		}
+
+		// Used to fill in headers once the offsets are known
+		template<typename T>
+		void Overwrite(size_t offset, const T& value)
+		{
+			std::memcpy(m_data.data() + offset, &value, sizeof(T));
+		}
+
+		std::span<const uint8_t> GetData() const { return m_data; }
+		std::vector<uint8_t> TakeData() { return std::move(m_data); }
+
+	private:
+		std::vector<uint8_t> m_data;
+	};
+}
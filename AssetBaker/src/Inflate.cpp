@@ -0,0 +1,296 @@
+#include "Inflate.h"
+
+namespace AssetBaker
+{
+	namespace
+	{
+		class BitReader
+		{
+		public:
+			BitReader(std::span<const uint8_t> data) :m_data(data) {}
+
+			// Returns false if we ran past the end of the stream
+			bool ReadBits(uint32_t count, uint32_t& valueOut)
+			{
+				valueOut = 0;
+				for (uint32_t i = 0; i < count; i++)
+				{
+					if (m_position >= m_data.size())
+						return false;
+
+					valueOut |= ((m_data[m_position] >> m_bit) & 1u) << i;
+					if (++m_bit == 8)
+					{
+						m_bit = 0;
+						m_position++;
+					}
+				}
+
+				return true;
+			}
+
+			void AlignToByte()
+			{
+				if (m_bit)
+				{
+					m_bit = 0;
+					m_position++;
+				}
+			}
+
+			bool ReadBytes(size_t count, std::vector<uint8_t>& dataOut)
+			{
+				if (m_position + count > m_data.size())
+					return false;
+
+				dataOut.insert(dataOut.end(), m_data.begin() + m_position, m_data.begin() + m_position + count);
+				m_position += count;
+				return true;
+			}
+
+		private:
+			std::span<const uint8_t> m_data;
+			size_t m_position = 0;
+			uint32_t m_bit = 0;
+		};
+
+		// Canonical huffman table (the same representation as zlib's puff)
+		struct Huffman
+		{
+			std::array<uint16_t, 16> counts;	// Number of codes of each length
+			std::array<uint16_t, 288> symbols;	// Symbols ordered by code
+		};
+
+		bool BuildHuffman(Huffman& huffman, std::span<const uint8_t> lengths)
+		{
+			huffman.counts.fill(0);
+			for (auto length : lengths)
+				huffman.counts[length]++;
+
+			// Make sure the code isn't over-subscribed
+			int32_t left = 1;
+			for (uint32_t length = 1; length < 16; length++)
+			{
+				left <<= 1;
+				left -= huffman.counts[length];
+				if (left < 0)
+					return false;
+			}
+
+			std::array<uint16_t, 16> offsets;
+			offsets[1] = 0;
+			for (uint32_t length = 1; length < 15; length++)
+				offsets[length + 1] = offsets[length] + huffman.counts[length];
+
+			for (uint16_t symbol = 0; symbol < lengths.size(); symbol++)
+				if (lengths[symbol])
+					huffman.symbols[offsets[lengths[symbol]]++] = symbol;
+
+			return true;
+		}
+
+		bool DecodeSymbol(BitReader& reader, const Huffman& huffman, uint32_t& symbolOut)
+		{
+			int32_t code = 0, first = 0, index = 0;
+			for (uint32_t length = 1; length < 16; length++)
+			{
+				uint32_t bit;
+				if (!reader.ReadBits(1, bit))
+					return false;
+
+				code |= bit;
+				int32_t count = huffman.counts[length];
+				if (code - count < first)
+				{
+					symbolOut = huffman.symbols[index + (code - first)];
+					return true;
+				}
+
+				index += count;
+				first += count;
+				first <<= 1;
+				code <<= 1;
+			}
+
+			return false;
+		}
+
+		constexpr uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+		constexpr uint16_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+		constexpr uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+		constexpr uint16_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+		Result InflateBlock(BitReader& reader, const Huffman& lengthCodes, const Huffman& distanceCodes, std::vector<uint8_t>& dataOut, size_t streamStart)
+		{
+			while (true)
+			{
+				uint32_t symbol;
+				if (!DecodeSymbol(reader, lengthCodes, symbol))
+					return Result::InvalidParameter;
+
+				if (symbol < 256)
+					dataOut.push_back(static_cast<uint8_t>(symbol));
+				else if (symbol == 256)
+					return Result::Success;
+				else
+				{
+					symbol -= 257;
+					if (symbol >= 29)
+						return Result::InvalidParameter;
+
+					uint32_t extra;
+					if (!reader.ReadBits(lengthExtra[symbol], extra))
+						return Result::InvalidParameter;
+					uint32_t length = lengthBase[symbol] + extra;
+
+					if (!DecodeSymbol(reader, distanceCodes, symbol) || symbol >= 30)
+						return Result::InvalidParameter;
+					if (!reader.ReadBits(distanceExtra[symbol], extra))
+						return Result::InvalidParameter;
+					uint32_t distance = distanceBase[symbol] + extra;
+
+					if (distance > dataOut.size() - streamStart)
+						return Result::InvalidParameter;
+
+					// The copy may overlap itself, so it has to be done byte by byte
+					size_t from = dataOut.size() - distance;
+					for (uint32_t i = 0; i < length; i++)
+						dataOut.push_back(dataOut[from + i]);
+				}
+			}
+		}
+	}
+
+	Result InflateZlib(std::span<const uint8_t> source, std::vector<uint8_t>& dataOut)
+	{
+		// zlib header: deflate compression, no preset dictionary
+		if (source.size() < 2 || (source[0] & 0x0f) != 8 || ((source[0] << 8) | source[1]) % 31 != 0 || (source[1] & 0x20))
+			return Result::InvalidParameter;
+
+		BitReader reader{ source.subspan(2) };
+		const size_t streamStart = dataOut.size();
+
+		uint32_t isFinal = 0;
+		while (!isFinal)
+		{
+			uint32_t type;
+			if (!reader.ReadBits(1, isFinal) || !reader.ReadBits(2, type))
+				return Result::InvalidParameter;
+
+			Result result = Result::Success;
+			switch (type)
+			{
+			case 0: // Stored
+			{
+				reader.AlignToByte();
+				uint32_t length, lengthComplement;
+				if (!reader.ReadBits(16, length) || !reader.ReadBits(16, lengthComplement) || (length != (~lengthComplement & 0xffff)))
+					return Result::InvalidParameter;
+
+				if (!reader.ReadBytes(length, dataOut))
+					return Result::InvalidParameter;
+				break;
+			}
+			case 1: // Fixed huffman codes
+			{
+				std::array<uint8_t, 288> lengths;
+				std::fill(lengths.begin(), lengths.begin() + 144, uint8_t{ 8 });
+				std::fill(lengths.begin() + 144, lengths.begin() + 256, uint8_t{ 9 });
+				std::fill(lengths.begin() + 256, lengths.begin() + 280, uint8_t{ 7 });
+				std::fill(lengths.begin() + 280, lengths.end(), uint8_t{ 8 });
+
+				std::array<uint8_t, 30> distanceLengths;
+				distanceLengths.fill(5);
+
+				Huffman lengthCodes, distanceCodes;
+				BuildHuffman(lengthCodes, lengths);
+				BuildHuffman(distanceCodes, distanceLengths);
+
+				result = InflateBlock(reader, lengthCodes, distanceCodes, dataOut, streamStart);
+				break;
+			}
+			case 2: // Dynamic huffman codes
+			{
+				uint32_t lengthCount, distanceCount, codeCount;
+				if (!reader.ReadBits(5, lengthCount) || !reader.ReadBits(5, distanceCount) || !reader.ReadBits(4, codeCount))
+					return Result::InvalidParameter;
+				lengthCount += 257;
+				distanceCount += 1;
+				codeCount += 4;
+
+				constexpr uint8_t codeOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+				std::array<uint8_t, 19> codeLengths{};
+				for (uint32_t i = 0; i < codeCount; i++)
+				{
+					uint32_t length;
+					if (!reader.ReadBits(3, length))
+						return Result::InvalidParameter;
+					codeLengths[codeOrder[i]] = static_cast<uint8_t>(length);
+				}
+
+				Huffman codeLengthCodes;
+				if (!BuildHuffman(codeLengthCodes, codeLengths))
+					return Result::InvalidParameter;
+
+				std::array<uint8_t, 320> lengths{};
+				for (uint32_t i = 0; i < lengthCount + distanceCount;)
+				{
+					uint32_t symbol;
+					if (!DecodeSymbol(reader, codeLengthCodes, symbol))
+						return Result::InvalidParameter;
+
+					if (symbol < 16)
+					{
+						lengths[i++] = static_cast<uint8_t>(symbol);
+						continue;
+					}
+
+					uint8_t repeatLength = 0;
+					uint32_t repeat;
+					if (symbol == 16)
+					{
+						if (i == 0 || !reader.ReadBits(2, repeat))
+							return Result::InvalidParameter;
+						repeatLength = lengths[i - 1];
+						repeat += 3;
+					}
+					else if (symbol == 17)
+					{
+						if (!reader.ReadBits(3, repeat))
+							return Result::InvalidParameter;
+						repeat += 3;
+					}
+					else
+					{
+						if (!reader.ReadBits(7, repeat))
+							return Result::InvalidParameter;
+						repeat += 11;
+					}
+
+					if (i + repeat > lengthCount + distanceCount)
+						return Result::InvalidParameter;
+
+					while (repeat--)
+						lengths[i++] = repeatLength;
+				}
+
+				Huffman lengthCodes, distanceCodes;
+				if (!BuildHuffman(lengthCodes, std::span{ lengths.data(), lengthCount }) ||
+					!BuildHuffman(distanceCodes, std::span{ lengths.data() + lengthCount, distanceCount }))
+					return Result::InvalidParameter;
+
+				result = InflateBlock(reader, lengthCodes, distanceCodes, dataOut, streamStart);
+				break;
+			}
+			default:
+				return Result::InvalidParameter;
+			}
+
+			if (IsError(result))
+				return result;
+		}
+
+		// NOTE: The adler32 checksum is not verified
+		return Result::Success;
+	}
+}
@@ -0,0 +1,11 @@
+#pragma once
+#include "BakeCommon.h"
+
+namespace AssetBaker
+{
+	// Decompresses a zlib stream (RFC 1950/1951), used for PNG image data
+	// Params:
+	//  - source = The zlib stream (including the 2 byte header).
+	//  - dataOut = The decompressed data is appended to this.
+	Result InflateZlib(std::span<const uint8_t> source, std::vector<uint8_t>& dataOut);
+}
@@ -0,0 +1,320 @@
+#include "BakeCommon.h"
+#include "MeshBaker.h"
+#include "ShaderBaker.h"
+#include "TextureBaker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+// Offline asset baker
+// Turns source assets into blobs the runtime can hand straight to HLBuffer/HLTexture2D (see Pinewood/BakedAsset.h)
+//
+// Usage: AssetBaker [options] -o <output directory> <inputs...>
+//  Inputs can be files or directories (directories are searched recursively, the outputs keep their subdirectories)
+//  Options:
+//   -o <dir>	Output directory (required)
+//   -j <n>		Number of worker threads (defaults to the number of hardware threads)
+//   -f			Force a rebuild, even if the cached blob is up to date
+//   -v			Print the vertex cache stats of every baked mesh
+//   --no-mips	Don't generate mip chains
+//   --no-optimize	Don't optimize the index/vertex order of meshes
+//   --glslang <path>	The glslangValidator used to compile shaders (.vert, .frag and .comp) to SPIR-V (defaults to the one in PATH)
+
+namespace AssetBaker
+{
+	enum class AssetKind
+	{
+		Unknown,
+		Mesh,
+		TexturePNG,
+		TextureTGA,
+		VertexShader,
+		PixelShader,
+		ComputeShader
+	};
+
+	struct BakeJob
+	{
+		std::filesystem::path source;
+		std::filesystem::path output;
+		AssetKind kind;
+	};
+
+	enum class BakeStatus
+	{
+		Baked,
+		UpToDate,
+		Failed
+	};
+
+	static AssetKind GetAssetKind(const std::filesystem::path& path)
+	{
+		auto extension = path.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+		if (extension == ".obj")
+			return AssetKind::Mesh;
+		if (extension == ".png")
+			return AssetKind::TexturePNG;
+		if (extension == ".tga")
+			return AssetKind::TextureTGA;
+		if (extension == ".vert")
+			return AssetKind::VertexShader;
+		if (extension == ".frag")
+			return AssetKind::PixelShader;
+		if (extension == ".comp")
+			return AssetKind::ComputeShader;
+
+		return AssetKind::Unknown;
+	}
+
+	// relativeSource is the path of the source in its input directory, so the outputs keep the directory structure of the inputs
+	static std::filesystem::path GetOutputPath(const std::filesystem::path& outputDirectory, const std::filesystem::path& relativeSource, AssetKind kind)
+	{
+		auto output = outputDirectory / relativeSource;
+		switch (kind)
+		{
+		case AssetKind::Mesh:
+			output.replace_extension(".pwmesh");
+			break;
+		case AssetKind::VertexShader:
+		case AssetKind::PixelShader:
+		case AssetKind::ComputeShader:
+			output += ".pwshader"; // Keeps the stage, ex: Scene.vert and Scene.frag
+			break;
+		default:
+			output.replace_extension(".pwtex");
+		}
+		return output;
+	}
+
+	// Checks if the blob at path was baked from the same source with the same settings
+	static bool IsUpToDate(const std::filesystem::path& path, uint64_t sourceHash)
+	{
+		std::ifstream file{ path, std::ios::binary };
+		if (!file)
+			return false;
+
+		Pinewood::BakedAssetHeader header;
+		if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+			return false;
+
+		return (header.magic == Pinewood::BakedAssetMagic) && (header.version == Pinewood::BakedAssetVersion) && (header.sourceHash == sourceHash);
+	}
+
+	static BakeStatus RunJob(const BakeJob& job, const BakeSettings& settings, bool force, MeshBakeStats& meshStatsOut)
+	{
+		std::vector<uint8_t> source;
+		if (IsError(ReadFile(job.source, source)))
+			return BakeStatus::Failed;
+
+		uint64_t sourceHash = HashSource(source, settings);
+		if (!force && IsUpToDate(job.output, sourceHash))
+			return BakeStatus::UpToDate;
+
+		std::vector<uint8_t> blob;
+		Result result;
+		switch (job.kind)
+		{
+		case AssetKind::Mesh:
+			result = BakeObjMesh(source, settings, sourceHash, blob, &meshStatsOut);
+			break;
+		case AssetKind::TexturePNG:
+			result = BakeTexture(source, ImageFileType::PNG, settings, sourceHash, blob);
+			break;
+		case AssetKind::TextureTGA:
+			result = BakeTexture(source, ImageFileType::TGA, settings, sourceHash, blob);
+			break;
+		case AssetKind::VertexShader:
+			result = BakeShader(job.source, Pinewood::HLShaderModuleType::Vertex, settings, sourceHash, job.output.string() + ".spv", blob);
+			break;
+		case AssetKind::PixelShader:
+			result = BakeShader(job.source, Pinewood::HLShaderModuleType::Pixel, settings, sourceHash, job.output.string() + ".spv", blob);
+			break;
+		case AssetKind::ComputeShader:
+			result = BakeShader(job.source, Pinewood::HLShaderModuleType::Compute, settings, sourceHash, job.output.string() + ".spv", blob);
+			break;
+		default:
+			result = Result::InvalidParameter;
+		}
+
+		if (IsError(result) || IsError(WriteFile(job.output, blob)))
+			return BakeStatus::Failed;
+
+		return BakeStatus::Baked;
+	}
+
+	static void AddInput(const std::filesystem::path& input, const std::filesystem::path& outputDirectory, std::vector<BakeJob>& jobs)
+	{
+		auto addFile = [&](const std::filesystem::path& path, const std::filesystem::path& relativePath)
+		{
+			AssetKind kind = GetAssetKind(path);
+			if (kind != AssetKind::Unknown)
+				jobs.push_back({ path, GetOutputPath(outputDirectory, relativePath, kind), kind });
+		};
+
+		if (std::filesystem::is_directory(input))
+		{
+			for (auto& entry : std::filesystem::recursive_directory_iterator{ input })
+				if (entry.is_regular_file())
+					addFile(entry.path(), entry.path().lexically_relative(input));
+		}
+		else
+			addFile(input, input.filename());
+	}
+
+	// Removes the jobs of sources given twice (ex: a file and its directory), and fails if two sources bake to the same file
+	// (ex: foo.png and foo.tga), their jobs would write it at the same time
+	static bool RemoveDuplicateJobs(std::vector<BakeJob>& jobs)
+	{
+		auto getOutput = [](const BakeJob& job) { return job.output.lexically_normal(); };
+		std::ranges::stable_sort(jobs, {}, getOutput);
+
+		bool unique = true;
+		auto duplicates = std::ranges::unique(jobs, [&](const BakeJob& lhs, const BakeJob& rhs)
+		{
+			if (getOutput(lhs) != getOutput(rhs))
+				return false;
+
+			std::error_code error;
+			if (!std::filesystem::equivalent(lhs.source, rhs.source, error))
+			{
+				std::fprintf(stderr, "'%s' and '%s' both bake to '%s'\n", lhs.source.string().c_str(), rhs.source.string().c_str(),
+					lhs.output.string().c_str());
+				unique = false;
+			}
+			return true;
+		});
+		jobs.erase(duplicates.begin(), duplicates.end());
+
+		return unique;
+	}
+
+	static void PrintUsage()
+	{
+		std::fprintf(stderr, "Usage: AssetBaker [-j <threads>] [-f] [-v] [--no-mips] [--no-optimize] [--glslang <path>] -o <output directory> <inputs...>\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace AssetBaker;
+
+	BakeSettings settings;
+	std::filesystem::path outputDirectory;
+	std::vector<std::filesystem::path> inputs;
+	uint32_t threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+	bool force = false;
+	bool verbose = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		if (arg == "-o" && i + 1 < argc)
+			outputDirectory = argv[++i];
+		else if (arg == "-j" && i + 1 < argc)
+			threadCount = std::max(static_cast<uint32_t>(std::atoi(argv[++i])), 1u);
+		else if (arg == "-f")
+			force = true;
+		else if (arg == "-v")
+			verbose = true;
+		else if (arg == "--no-mips")
+			settings.generateMips = false;
+		else if (arg == "--no-optimize")
+			settings.optimizeMesh = false;
+		else if (arg == "--glslang" && i + 1 < argc)
+			settings.shaderCompiler = argv[++i];
+		else if (!arg.empty() && arg[0] == '-')
+		{
+			PrintUsage();
+			return 1;
+		}
+		else
+			inputs.emplace_back(arg);
+	}
+
+	if (outputDirectory.empty() || inputs.empty())
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(outputDirectory, error);
+	if (error)
+	{
+		std::fprintf(stderr, "Failed to create output directory '%s'\n", outputDirectory.string().c_str());
+		return 1;
+	}
+
+	std::vector<BakeJob> jobs;
+	for (auto& input : inputs)
+		AddInput(input, outputDirectory, jobs);
+
+	if (!RemoveDuplicateJobs(jobs))
+		return 1;
+
+	// The outputs keep the subdirectories of the inputs
+	for (auto& job : jobs)
+	{
+		std::filesystem::create_directories(job.output.parent_path(), error);
+		if (error)
+		{
+			std::fprintf(stderr, "Failed to create output directory '%s'\n", job.output.parent_path().string().c_str());
+			return 1;
+		}
+	}
+
+	// Assets are independent, so the workers just pull the next job until they run out
+	std::atomic_size_t nextJob = 0;
+	std::atomic_uint32_t numBaked = 0, numUpToDate = 0, numFailed = 0;
+	std::mutex printMutex;
+
+	auto worker = [&]()
+	{
+		for (size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+		{
+			MeshBakeStats meshStats;
+			BakeStatus status = RunJob(jobs[i], settings, force, meshStats);
+
+			switch (status)
+			{
+			case BakeStatus::Baked:
+			{
+				numBaked++;
+				if (verbose && jobs[i].kind == AssetKind::Mesh)
+				{
+					std::lock_guard lock{ printMutex };
+					std::printf("%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", jobs[i].source.filename().string().c_str(),
+						meshStats.before.acmr, meshStats.after.acmr, meshStats.before.atvr, meshStats.after.atvr);
+				}
+				break;
+			}
+			case BakeStatus::UpToDate: numUpToDate++; break;
+			case BakeStatus::Failed:
+			{
+				numFailed++;
+				std::lock_guard lock{ printMutex };
+				std::fprintf(stderr, "Failed to bake '%s'\n", jobs[i].source.string().c_str());
+				break;
+			}
+			}
+		}
+	};
+
+	std::vector<std::thread> workers;
+	for (uint32_t i = 0; i < std::min<size_t>(threadCount, jobs.size()); i++)
+		workers.emplace_back(worker);
+	for (auto& thread : workers)
+		thread.join();
+
+	std::printf("%u baked, %u up to date, %u failed\n", numBaked.load(), numUpToDate.load(), numFailed.load());
+
+	return numFailed ? 1 : 0;
+}
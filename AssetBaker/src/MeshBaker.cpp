@@ -0,0 +1,301 @@
+#include "MeshBaker.h"
+
+#include <Pinewood/MeshOptimizer.h>
+#include <PWMath/Vector2.h>
+#include <PWMath/Vector3.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <string_view>
+#include <unordered_map>
+
+namespace AssetBaker
+{
+	namespace
+	{
+		struct ObjMesh
+		{
+			std::vector<PWMath::Vector3F32> positions;
+			std::vector<PWMath::Vector2F32> texCoords;
+			std::vector<PWMath::Vector3F32> normals;
+
+			// Every corner of every (triangulated) face, each corner is { position, texCoord, normal }, -1 means not present
+			std::vector<std::array<int32_t, 3>> corners;
+		};
+
+		struct CornerHash
+		{
+			size_t operator()(const std::array<int32_t, 3>& corner) const
+			{
+				return static_cast<size_t>(HashBytes(corner.data(), sizeof(corner)));
+			}
+		};
+
+		std::string_view NextToken(std::string_view& line)
+		{
+			size_t start = line.find_first_not_of(" \t\r");
+			if (start == std::string_view::npos)
+			{
+				line = {};
+				return {};
+			}
+
+			size_t end = line.find_first_of(" \t\r", start);
+			if (end == std::string_view::npos)
+				end = line.size();
+
+			auto token = line.substr(start, end - start);
+			line.remove_prefix(end);
+			return token;
+		}
+
+		bool ParseFloat(std::string_view token, float& valueOut)
+		{
+			auto [ptr, error] = std::from_chars(token.data(), token.data() + token.size(), valueOut);
+			return error == std::errc{};
+		}
+
+		// OBJ indices start at 1, and negative indices are relative to the end of the list
+		bool ResolveIndex(std::string_view token, size_t count, int32_t& indexOut)
+		{
+			if (token.empty())
+			{
+				indexOut = -1;
+				return true;
+			}
+
+			int32_t index;
+			auto [ptr, error] = std::from_chars(token.data(), token.data() + token.size(), index);
+			if (error != std::errc{} || index == 0)
+				return false;
+
+			indexOut = (index > 0) ? (index - 1) : (static_cast<int32_t>(count) + index);
+			return (indexOut >= 0) && (static_cast<size_t>(indexOut) < count);
+		}
+
+		Result ParseObj(std::string_view source, ObjMesh& meshOut)
+		{
+			std::vector<std::array<int32_t, 3>> face;
+
+			while (!source.empty())
+			{
+				size_t lineEnd = source.find('\n');
+				std::string_view line = source.substr(0, lineEnd);
+				source.remove_prefix((lineEnd == std::string_view::npos) ? source.size() : lineEnd + 1);
+
+				std::string_view keyword = NextToken(line);
+
+				if (keyword == "v" || keyword == "vn")
+				{
+					PWMath::Vector3F32 value{ 0.0f };
+					for (uint32_t i = 0; i < 3; i++)
+						if (!ParseFloat(NextToken(line), value[i]))
+							return Result::InvalidParameter;
+
+					(keyword == "v" ? meshOut.positions : meshOut.normals).push_back(value);
+				}
+				else if (keyword == "vt")
+				{
+					PWMath::Vector2F32 value{ 0.0f };
+					for (uint32_t i = 0; i < 2; i++)
+						if (!ParseFloat(NextToken(line), value[i]))
+							return Result::InvalidParameter;
+
+					meshOut.texCoords.push_back(value);
+				}
+				else if (keyword == "f")
+				{
+					face.clear();
+					for (auto token = NextToken(line); !token.empty(); token = NextToken(line))
+					{
+						// v, v/vt, v//vn or v/vt/vn
+						std::string_view parts[3];
+						for (uint32_t i = 0; i < 3 && !token.empty(); i++)
+						{
+							size_t slash = token.find('/');
+							parts[i] = token.substr(0, slash);
+							token.remove_prefix((slash == std::string_view::npos) ? token.size() : slash + 1);
+						}
+
+						std::array<int32_t, 3> corner;
+						if (!ResolveIndex(parts[0], meshOut.positions.size(), corner[0]) || corner[0] < 0 ||
+							!ResolveIndex(parts[1], meshOut.texCoords.size(), corner[1]) ||
+							!ResolveIndex(parts[2], meshOut.normals.size(), corner[2]))
+							return Result::InvalidParameter;
+
+						face.push_back(corner);
+					}
+
+					if (face.size() < 3)
+						return Result::InvalidParameter;
+
+					// Triangulate polygons as a fan
+					for (size_t i = 1; i + 1 < face.size(); i++)
+					{
+						meshOut.corners.push_back(face[0]);
+						meshOut.corners.push_back(face[i]);
+						meshOut.corners.push_back(face[i + 1]);
+					}
+				}
+				// Everything else (materials, groups, smoothing groups, etc.) doesn't affect the vertex data
+			}
+
+			return meshOut.corners.empty() ? Result::InvalidParameter : Result::Success;
+		}
+
+		int8_t PackNorm8(float value)
+		{
+			return static_cast<int8_t>(std::round(std::clamp(value, -1.0f, 1.0f) * 127.0f));
+		}
+
+		uint16_t PackUNorm16(float value)
+		{
+			return static_cast<uint16_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+		}
+	}
+
+	Result BakeObjMesh(std::span<const uint8_t> source, const BakeSettings& settings, uint64_t sourceHash, std::vector<uint8_t>& blobOut, MeshBakeStats* statsOut)
+	{
+		ObjMesh mesh;
+		Result result = ParseObj({ reinterpret_cast<const char*>(source.data()), source.size() }, mesh);
+		if (IsError(result))
+			return result;
+
+		// Weld identical corners into vertices
+		std::unordered_map<std::array<int32_t, 3>, uint32_t, CornerHash> vertexMap;
+		std::vector<std::array<int32_t, 3>> vertices;
+		std::vector<uint32_t> indices;
+		indices.reserve(mesh.corners.size());
+
+		for (auto& corner : mesh.corners)
+		{
+			auto [it, inserted] = vertexMap.try_emplace(corner, static_cast<uint32_t>(vertices.size()));
+			if (inserted)
+				vertices.push_back(corner);
+
+			indices.push_back(it->second);
+		}
+
+		const bool hasTexCoords = std::all_of(vertices.begin(), vertices.end(), [](auto& v) { return v[1] >= 0; });
+		const bool hasNormals = std::all_of(vertices.begin(), vertices.end(), [](auto& v) { return v[2] >= 0; });
+
+		// UNorm16 texture coordinates only work if nothing wraps
+		const bool texCoordsInRange = hasTexCoords && std::all_of(mesh.texCoords.begin(), mesh.texCoords.end(),
+			[](auto& uv) { return uv.x >= 0.0f && uv.x <= 1.0f && uv.y >= 0.0f && uv.y <= 1.0f; });
+
+		// Build the layout, everything lives in binding 0
+		std::vector<Pinewood::HLLayoutElement> elements;
+		uint32_t stride = 0;
+
+		auto addElement = [&](Pinewood::BakedMeshAttribute attribute, Pinewood::HLLayoutElementType type, uint32_t size)
+		{
+			elements.push_back({ stride, type, static_cast<uint32_t>(attribute), 0, 0 });
+			stride += size;
+		};
+
+		addElement(Pinewood::BakedMeshAttribute::Position, Pinewood::HLLayoutElementType::Vector3F32, 12);
+		if (hasTexCoords)
+		{
+			if (texCoordsInRange)
+				addElement(Pinewood::BakedMeshAttribute::TexCoord, Pinewood::HLLayoutElementType::Vector2UN16, 4);
+			else
+				addElement(Pinewood::BakedMeshAttribute::TexCoord, Pinewood::HLLayoutElementType::Vector2F32, 8);
+		}
+		if (hasNormals)
+			addElement(Pinewood::BakedMeshAttribute::Normal, Pinewood::HLLayoutElementType::Vector4N8, 4); // w is padding
+
+		// Interleave the vertices
+		std::vector<uint8_t> vertexData(vertices.size() * stride);
+		PWMath::Vector3F32 boundsMin{ std::numeric_limits<float>::max() }, boundsMax{ std::numeric_limits<float>::lowest() };
+
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			uint8_t* vertex = vertexData.data() + i * stride;
+			size_t element = 0;
+
+			const auto& position = mesh.positions[vertices[i][0]];
+			std::memcpy(vertex + elements[element++].offset, position.array, sizeof(position.array));
+			for (uint32_t j = 0; j < 3; j++)
+			{
+				boundsMin[j] = std::min(boundsMin[j], position[j]);
+				boundsMax[j] = std::max(boundsMax[j], position[j]);
+			}
+
+			if (hasTexCoords)
+			{
+				const auto& uv = mesh.texCoords[vertices[i][1]];
+				if (texCoordsInRange)
+				{
+					uint16_t packed[2]{ PackUNorm16(uv.x), PackUNorm16(uv.y) };
+					std::memcpy(vertex + elements[element++].offset, packed, sizeof(packed));
+				}
+				else
+					std::memcpy(vertex + elements[element++].offset, uv.array, sizeof(uv.array));
+			}
+
+			if (hasNormals)
+			{
+				const auto normal = PWMath::Normalize(mesh.normals[vertices[i][2]]);
+				int8_t packed[4]{ PackNorm8(normal.x), PackNorm8(normal.y), PackNorm8(normal.z), 0 };
+				std::memcpy(vertex + elements[element++].offset, packed, sizeof(packed));
+			}
+		}
+
+		// Reorder for the post-transform cache, then for overdraw and finally the vertices for fetch locality
+		uint32_t vertexCount = static_cast<uint32_t>(vertices.size());
+		if (statsOut)
+			statsOut->before = Pinewood::AnalyzeVertexCache(indices, vertexCount);
+
+		if (settings.optimizeMesh)
+		{
+			result = Pinewood::OptimizeVertexCache(indices, vertexCount, indices);
+			if (IsError(result))
+				return result;
+
+			result = Pinewood::OptimizeOverdraw(indices, vertexData, stride, elements[0].offset, indices);
+			if (IsError(result))
+				return result;
+
+			result = Pinewood::OptimizeVertexFetch(indices, vertexData, stride, vertexCount);
+			if (IsError(result))
+				return result;
+		}
+
+		if (statsOut)
+			statsOut->after = Pinewood::AnalyzeVertexCache(indices, vertexCount);
+
+		// Write the blob
+		BlobWriter writer;
+		writer.Write(Pinewood::BakedAssetHeader{
+			.magic = Pinewood::BakedAssetMagic,
+			.version = Pinewood::BakedAssetVersion,
+			.type = Pinewood::BakedAssetType::Mesh,
+			.reserved = 0,
+			.sourceHash = sourceHash
+		});
+
+		size_t meshHeaderOffset = writer.Write(Pinewood::BakedMeshHeader{});
+		writer.Write(elements.data(), elements.size() * sizeof(Pinewood::HLLayoutElement));
+
+		uint64_t vertexDataOffset = writer.Align(16);
+		writer.Write(vertexData.data(), static_cast<size_t>(vertexCount) * stride);
+
+		uint64_t indexDataOffset = writer.Align(16);
+		writer.Write(indices.data(), indices.size() * sizeof(uint32_t));
+
+		writer.Overwrite(meshHeaderOffset, Pinewood::BakedMeshHeader{
+			.vertexCount = vertexCount,
+			.indexCount = static_cast<uint32_t>(indices.size()),
+			.stride = stride,
+			.elementCount = static_cast<uint32_t>(elements.size()),
+			.vertexDataOffset = vertexDataOffset,
+			.indexDataOffset = indexDataOffset,
+			.boundsMin = { boundsMin.x, boundsMin.y, boundsMin.z },
+			.boundsMax = { boundsMax.x, boundsMax.y, boundsMax.z }
+		});
+
+		blobOut = writer.TakeData();
+		return Result::Success;
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "BakeCommon.h"
+
+#include <Pinewood/MeshOptimizer.h>
+
+namespace AssetBaker
+{
+	struct MeshBakeStats
+	{
+		Pinewood::VertexCacheStats before;
+		Pinewood::VertexCacheStats after;
+	};
+
+	// Bakes a Wavefront OBJ file into a Pinewood mesh blob
+	// Params:
+	//  - source = The contents of the OBJ file.
+	//  - settings = The bake settings.
+	//  - sourceHash = The hash stored in the blob header.
+	//  - blobOut = The baked blob.
+	//  - statsOut = Receives the vertex cache stats before and after optimization (optional).
+	Result BakeObjMesh(std::span<const uint8_t> source, const BakeSettings& settings, uint64_t sourceHash, std::vector<uint8_t>& blobOut, MeshBakeStats* statsOut = nullptr);
+}
@@ -0,0 +1,99 @@
+#include "ShaderBaker.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <system_error>
+
+namespace AssetBaker
+{
+	namespace
+	{
+		constexpr uint32_t SpirVMagic = 0x07230203;
+
+		// Whether an argument means the same thing inside double quotes, the shell would interpret these characters there
+		bool CanQuote(const std::string& argument)
+		{
+#if PW_PLATFORM_WINDOWS
+			constexpr const char* shellCharacters = "\"%";
+#else // ^^^ PW_PLATFORM_WINDOWS // Other platforms vvv
+			constexpr const char* shellCharacters = "\"$`\\";
+#endif // ^^^ Other platforms
+			return argument.find_first_of(shellCharacters) == std::string::npos;
+		}
+
+		const char* GetStageName(Pinewood::HLShaderModuleType type)
+		{
+			switch (type)
+			{
+			case Pinewood::HLShaderModuleType::Vertex: return "vert";
+			case Pinewood::HLShaderModuleType::Pixel: return "frag";
+			case Pinewood::HLShaderModuleType::Compute: return "comp";
+			default: return nullptr;
+			}
+		}
+	}
+
+	Result BakeShader(const std::filesystem::path& sourcePath, Pinewood::HLShaderModuleType type, const BakeSettings& settings, uint64_t sourceHash,
+		const std::filesystem::path& spirvPath, std::vector<uint8_t>& blobOut)
+	{
+		const char* stage = GetStageName(type);
+		if (!stage)
+			return Result::InvalidParameter;
+
+		// The command goes through the shell, refuse the paths it would change instead of escaping them for every shell
+		const std::string compiler = settings.shaderCompiler, spirvFile = spirvPath.string(), sourceFile = sourcePath.string();
+		for (const std::string* argument : { &compiler, &spirvFile, &sourceFile })
+		{
+			if (!CanQuote(*argument))
+			{
+				std::fprintf(stderr, "Can't pass '%s' to the shader compiler, it has quotes or shell characters\n", argument->c_str());
+				return Result::InvalidParameter;
+			}
+		}
+
+		// -G compiles for OpenGL (glShaderBinary + glSpecializeShader) instead of Vulkan, the compiler prints the errors
+		std::string command = "\"" + compiler + "\" -G -S " + stage + " -o \"" + spirvFile + "\" \"" + sourceFile + "\"";
+#if PW_PLATFORM_WINDOWS
+		command = "\"" + command + "\""; // cmd /c strips the outer quotes of a command that starts with one
+#endif // ^^^ PW_PLATFORM_WINDOWS
+
+		const int exitCode = std::system(command.c_str());
+
+		std::vector<uint8_t> code;
+		Result result = (exitCode == 0) ? ReadFile(spirvPath, code) : Result::SystemError;
+
+		std::error_code error;
+		std::filesystem::remove(spirvPath, error);
+
+		if (IsError(result))
+			return result;
+
+		uint32_t magic = 0;
+		if (code.size() < sizeof(magic) || code.size() % sizeof(uint32_t))
+			return Result::InvalidParameter;
+		std::memcpy(&magic, code.data(), sizeof(magic));
+		if (magic != SpirVMagic)
+			return Result::InvalidParameter;
+
+		BlobWriter writer;
+		writer.Write(Pinewood::BakedAssetHeader{
+			.magic = Pinewood::BakedAssetMagic,
+			.version = Pinewood::BakedAssetVersion,
+			.type = Pinewood::BakedAssetType::Shader,
+			.reserved = 0,
+			.sourceHash = sourceHash
+		});
+
+		size_t shaderHeaderOffset = writer.Write(Pinewood::BakedShaderHeader{});
+		uint64_t codeOffset = writer.Align(16);
+		writer.Write(code.data(), code.size());
+		writer.Overwrite(shaderHeaderOffset, Pinewood::BakedShaderHeader{
+			.type = type,
+			.codeSize = static_cast<uint32_t>(code.size()),
+			.codeOffset = codeOffset
+		});
+
+		blobOut = writer.TakeData();
+		return Result::Success;
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "BakeCommon.h"
+
+#include <Pinewood/Renderer/HL/HLShaderModule.h>
+
+namespace AssetBaker
+{
+	// Bakes a GLSL shader into a Pinewood shader blob, the SPIR-V is compiled by glslangValidator (see BakeSettings::shaderCompiler)
+	// so the runtime skips the GLSL compiler of the driver
+	// Params:
+	//  - sourcePath = The GLSL file (it's compiled as-is, so it needs its #version line).
+	//  - type = The stage of the shader.
+	//  - settings = The bake settings.
+	//  - sourceHash = The hash stored in the blob header.
+	//  - spirvPath = Where the compiler writes the SPIR-V, it's removed after the bake.
+	//  - blobOut = The baked blob.
+	Result BakeShader(const std::filesystem::path& sourcePath, Pinewood::HLShaderModuleType type, const BakeSettings& settings, uint64_t sourceHash,
+		const std::filesystem::path& spirvPath, std::vector<uint8_t>& blobOut);
+}
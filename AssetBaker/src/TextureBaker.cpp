@@ -0,0 +1,311 @@
+#include "TextureBaker.h"
+#include "Inflate.h"
+
+#include <algorithm>
+
+namespace AssetBaker
+{
+	namespace
+	{
+		// Every decoded image ends up as tightly packed RGBA8, rows from top to bottom
+		struct Image
+		{
+			uint32_t width = 0, height = 0;
+			std::vector<uint8_t> pixels;
+		};
+
+		uint32_t ReadBigEndian32(const uint8_t* data)
+		{
+			return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) | (static_cast<uint32_t>(data[2]) << 8) | data[3];
+		}
+
+		uint8_t PaethPredictor(int32_t a, int32_t b, int32_t c)
+		{
+			int32_t p = a + b - c;
+			int32_t pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+			if (pa <= pb && pa <= pc)
+				return static_cast<uint8_t>(a);
+			return static_cast<uint8_t>((pb <= pc) ? b : c);
+		}
+
+		// Supports non-interlaced, 8-bit images of every color type
+		Result DecodePNG(std::span<const uint8_t> source, Image& imageOut)
+		{
+			constexpr uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+			if (source.size() < 8 || !std::equal(signature, signature + 8, source.begin()))
+				return Result::InvalidParameter;
+
+			uint32_t bitDepth = 0, colorType = 0, interlace = 0;
+			std::vector<uint8_t> compressed, palette, paletteAlpha;
+
+			for (size_t offset = 8; offset + 12 <= source.size();)
+			{
+				uint32_t length = ReadBigEndian32(&source[offset]);
+				std::string_view type{ reinterpret_cast<const char*>(&source[offset + 4]), 4 };
+				if (offset + 12 + length > source.size())
+					return Result::InvalidParameter;
+
+				auto chunk = source.subspan(offset + 8, length);
+				offset += 12 + length;
+
+				if (type == "IHDR")
+				{
+					if (length < 13)
+						return Result::InvalidParameter;
+
+					imageOut.width = ReadBigEndian32(&chunk[0]);
+					imageOut.height = ReadBigEndian32(&chunk[4]);
+					bitDepth = chunk[8];
+					colorType = chunk[9];
+					interlace = chunk[12];
+				}
+				else if (type == "PLTE")
+					palette.assign(chunk.begin(), chunk.end());
+				else if (type == "tRNS")
+					paletteAlpha.assign(chunk.begin(), chunk.end());
+				else if (type == "IDAT")
+					compressed.insert(compressed.end(), chunk.begin(), chunk.end());
+				else if (type == "IEND")
+					break;
+			}
+
+			if (bitDepth != 8 || interlace != 0 || imageOut.width == 0 || imageOut.height == 0)
+				return Result::InvalidParameter;
+
+			uint32_t channels;
+			switch (colorType)
+			{
+			case 0: channels = 1; break; // Grayscale
+			case 2: channels = 3; break; // RGB
+			case 3: channels = 1; break; // Palette
+			case 4: channels = 2; break; // Grayscale + alpha
+			case 6: channels = 4; break; // RGBA
+			default: return Result::InvalidParameter;
+			}
+
+			std::vector<uint8_t> filtered;
+			Result result = InflateZlib(compressed, filtered);
+			if (IsError(result))
+				return result;
+
+			const size_t rowSize = static_cast<size_t>(imageOut.width) * channels;
+			if (filtered.size() < (rowSize + 1) * imageOut.height)
+				return Result::InvalidParameter;
+
+			// Undo the per-row filters
+			std::vector<uint8_t> raw(rowSize * imageOut.height);
+			for (uint32_t y = 0; y < imageOut.height; y++)
+			{
+				const uint8_t filter = filtered[y * (rowSize + 1)];
+				const uint8_t* in = &filtered[y * (rowSize + 1) + 1];
+				uint8_t* out = &raw[y * rowSize];
+				const uint8_t* previous = (y > 0) ? &raw[(y - 1) * rowSize] : nullptr;
+
+				for (size_t x = 0; x < rowSize; x++)
+				{
+					int32_t a = (x >= channels) ? out[x - channels] : 0;
+					int32_t b = previous ? previous[x] : 0;
+					int32_t c = (previous && x >= channels) ? previous[x - channels] : 0;
+
+					switch (filter)
+					{
+					case 0: out[x] = in[x]; break;
+					case 1: out[x] = static_cast<uint8_t>(in[x] + a); break;
+					case 2: out[x] = static_cast<uint8_t>(in[x] + b); break;
+					case 3: out[x] = static_cast<uint8_t>(in[x] + ((a + b) >> 1)); break;
+					case 4: out[x] = static_cast<uint8_t>(in[x] + PaethPredictor(a, b, c)); break;
+					default: return Result::InvalidParameter;
+					}
+				}
+			}
+
+			// Expand to RGBA8
+			imageOut.pixels.resize(static_cast<size_t>(imageOut.width) * imageOut.height * 4);
+			for (size_t i = 0; i < static_cast<size_t>(imageOut.width) * imageOut.height; i++)
+			{
+				const uint8_t* in = &raw[i * channels];
+				uint8_t* out = &imageOut.pixels[i * 4];
+
+				switch (colorType)
+				{
+				case 0: out[0] = out[1] = out[2] = in[0]; out[3] = 0xff; break;
+				case 2: out[0] = in[0]; out[1] = in[1]; out[2] = in[2]; out[3] = 0xff; break;
+				case 3:
+					if (static_cast<size_t>(in[0]) * 3 + 2 >= palette.size())
+						return Result::InvalidParameter;
+					out[0] = palette[in[0] * 3 + 0];
+					out[1] = palette[in[0] * 3 + 1];
+					out[2] = palette[in[0] * 3 + 2];
+					out[3] = (in[0] < paletteAlpha.size()) ? paletteAlpha[in[0]] : 0xff;
+					break;
+				case 4: out[0] = out[1] = out[2] = in[0]; out[3] = in[1]; break;
+				case 6: std::copy(in, in + 4, out); break;
+				}
+			}
+
+			return Result::Success;
+		}
+
+		// Supports uncompressed and RLE true-color/grayscale images with 8, 24 or 32 bits per pixel
+		Result DecodeTGA(std::span<const uint8_t> source, Image& imageOut)
+		{
+			if (source.size() < 18)
+				return Result::InvalidParameter;
+
+			const uint8_t idLength = source[0];
+			const uint8_t colorMapType = source[1];
+			const uint8_t imageType = source[2];
+			imageOut.width = source[12] | (source[13] << 8);
+			imageOut.height = source[14] | (source[15] << 8);
+			const uint32_t bytesPerPixel = source[16] / 8;
+			const bool topToBottom = source[17] & 0x20;
+
+			const bool isRLE = (imageType == 10 || imageType == 11);
+			const bool isGray = (imageType == 3 || imageType == 11);
+			if (colorMapType != 0 || !(imageType == 2 || imageType == 3 || isRLE) || imageOut.width == 0 || imageOut.height == 0)
+				return Result::InvalidParameter;
+			if (isGray ? (bytesPerPixel != 1) : (bytesPerPixel != 3 && bytesPerPixel != 4))
+				return Result::InvalidParameter;
+
+			const size_t pixelCount = static_cast<size_t>(imageOut.width) * imageOut.height;
+			imageOut.pixels.resize(pixelCount * 4);
+
+			size_t offset = 18 + idLength;
+			auto readPixel = [&](uint8_t* out) -> bool
+			{
+				if (offset + bytesPerPixel > source.size())
+					return false;
+
+				// TGA stores BGR(A)
+				const uint8_t* in = &source[offset];
+				if (isGray)
+					out[0] = out[1] = out[2] = in[0], out[3] = 0xff;
+				else
+					out[0] = in[2], out[1] = in[1], out[2] = in[0], out[3] = (bytesPerPixel == 4) ? in[3] : 0xff;
+
+				offset += bytesPerPixel;
+				return true;
+			};
+
+			std::vector<uint8_t> decoded(pixelCount * 4);
+			for (size_t i = 0; i < pixelCount;)
+			{
+				if (!isRLE)
+				{
+					if (!readPixel(&decoded[i++ * 4]))
+						return Result::InvalidParameter;
+					continue;
+				}
+
+				if (offset >= source.size())
+					return Result::InvalidParameter;
+
+				const uint8_t packet = source[offset++];
+				const size_t count = std::min<size_t>((packet & 0x7f) + 1, pixelCount - i);
+				if (packet & 0x80)
+				{
+					// Run-length packet, one pixel repeated
+					if (!readPixel(&decoded[i * 4]))
+						return Result::InvalidParameter;
+					for (size_t j = 1; j < count; j++)
+						std::copy_n(&decoded[i * 4], 4, &decoded[(i + j) * 4]);
+				}
+				else
+				{
+					// Raw packet
+					for (size_t j = 0; j < count; j++)
+						if (!readPixel(&decoded[(i + j) * 4]))
+							return Result::InvalidParameter;
+				}
+
+				i += count;
+			}
+
+			// Flip to top to bottom if needed
+			const size_t rowSize = static_cast<size_t>(imageOut.width) * 4;
+			for (uint32_t y = 0; y < imageOut.height; y++)
+			{
+				uint32_t sourceRow = topToBottom ? y : (imageOut.height - 1 - y);
+				std::copy_n(&decoded[sourceRow * rowSize], rowSize, &imageOut.pixels[y * rowSize]);
+			}
+
+			return Result::Success;
+		}
+
+		// 2x2 box filter, odd sizes clamp at the edge
+		Image Downsample(const Image& image)
+		{
+			Image mip;
+			mip.width = std::max(image.width / 2, 1u);
+			mip.height = std::max(image.height / 2, 1u);
+			mip.pixels.resize(static_cast<size_t>(mip.width) * mip.height * 4);
+
+			for (uint32_t y = 0; y < mip.height; y++)
+			{
+				const uint32_t y0 = std::min(y * 2, image.height - 1), y1 = std::min(y * 2 + 1, image.height - 1);
+				for (uint32_t x = 0; x < mip.width; x++)
+				{
+					const uint32_t x0 = std::min(x * 2, image.width - 1), x1 = std::min(x * 2 + 1, image.width - 1);
+					for (uint32_t c = 0; c < 4; c++)
+					{
+						uint32_t sum =
+							image.pixels[(static_cast<size_t>(y0) * image.width + x0) * 4 + c] +
+							image.pixels[(static_cast<size_t>(y0) * image.width + x1) * 4 + c] +
+							image.pixels[(static_cast<size_t>(y1) * image.width + x0) * 4 + c] +
+							image.pixels[(static_cast<size_t>(y1) * image.width + x1) * 4 + c];
+						mip.pixels[(static_cast<size_t>(y) * mip.width + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+					}
+				}
+			}
+
+			return mip;
+		}
+	}
+
+	Result BakeTexture(std::span<const uint8_t> source, ImageFileType type, const BakeSettings& settings, uint64_t sourceHash, std::vector<uint8_t>& blobOut)
+	{
+		std::vector<Image> mips(1);
+		Result result = (type == ImageFileType::PNG) ? DecodePNG(source, mips[0]) : DecodeTGA(source, mips[0]);
+		if (IsError(result))
+			return result;
+
+		if (settings.generateMips)
+			while (mips.back().width > 1 || mips.back().height > 1)
+				mips.push_back(Downsample(mips.back()));
+
+		BlobWriter writer;
+		writer.Write(Pinewood::BakedAssetHeader{
+			.magic = Pinewood::BakedAssetMagic,
+			.version = Pinewood::BakedAssetVersion,
+			.type = Pinewood::BakedAssetType::Texture,
+			.reserved = 0,
+			.sourceHash = sourceHash
+		});
+
+		writer.Write(Pinewood::BakedTextureHeader{
+			.width = mips[0].width,
+			.height = mips[0].height,
+			.mipLevels = static_cast<uint32_t>(mips.size()),
+			.format = Pinewood::HLImageFormat::R8G8B8A8_UNorm
+		});
+
+		size_t mipTableOffset = writer.GetData().size();
+		for (size_t i = 0; i < mips.size(); i++)
+			writer.Write(Pinewood::BakedMipLevel{});
+
+		for (size_t i = 0; i < mips.size(); i++)
+		{
+			uint64_t offset = writer.Align(16);
+			writer.Write(mips[i].pixels.data(), mips[i].pixels.size());
+			writer.Overwrite(mipTableOffset + i * sizeof(Pinewood::BakedMipLevel), Pinewood::BakedMipLevel{
+				.width = mips[i].width,
+				.height = mips[i].height,
+				.offset = offset,
+				.size = mips[i].pixels.size()
+			});
+		}
+
+		blobOut = writer.TakeData();
+		return Result::Success;
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "BakeCommon.h"
+
+namespace AssetBaker
+{
+	enum class ImageFileType
+	{
+		PNG,
+		TGA
+	};
+
+	// Bakes a PNG or TGA image into a Pinewood texture blob (R8G8B8A8_UNorm, with a precomputed mip chain)
+	// Params:
+	//  - source = The contents of the image file.
+	//  - type = The type of the image file.
+	//  - settings = The bake settings.
+	//  - sourceHash = The hash stored in the blob header.
+	//  - blobOut = The baked blob.
+	Result BakeTexture(std::span<const uint8_t> source, ImageFileType type, const BakeSettings& settings, uint64_t sourceHash, std::vector<uint8_t>& blobOut);
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <Pinewood/Core.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+
+namespace Benchmarks
+{
+	struct BenchmarkSettings
+	{
+		uint32_t minThreads = 1;
+		uint32_t maxThreads = 64;	// Thread counts double from minThreads up to this
+		uint32_t repeat = 5;		// Every measurement is the best of this many runs
+	};
+
+	// Runs function settings.repeat times and returns the fastest run in milliseconds
+	template<typename TFunction>
+	double MeasureBestMs(const BenchmarkSettings& settings, TFunction&& function)
+	{
+		double best = std::numeric_limits<double>::max();
+		for (uint32_t i = 0; i < std::max(settings.repeat, 1u); i++)
+		{
+			const auto begin = std::chrono::steady_clock::now();
+			function();
+			const auto end = std::chrono::steady_clock::now();
+			best = std::min(best, std::chrono::duration<double, std::milli>(end - begin).count());
+		}
+
+		return best;
+	}
+
+	int RunJobSystemBenchmark(const BenchmarkSettings& settings);
+}
@@ -0,0 +1,92 @@
+#include "Benchmark.h"
+#include <Pinewood/JobSystem.h>
+
+#include <cmath>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace Benchmarks
+{
+	using namespace Pinewood;
+
+	namespace
+	{
+		constexpr uint32_t ComputeCount = 1 << 20;
+		constexpr uint32_t MemoryCount = 1 << 24;	// 64 MiB per array, well past the caches
+		constexpr uint32_t EmptyJobCount = 1 << 20;
+		constexpr uint32_t EmptyJobBatch = 1024;
+
+		// ALU bound, no memory traffic
+		float ComputeKernel(uint32_t index)
+		{
+			float x = static_cast<float>(index) * 1e-6f;
+			for (uint32_t i = 0; i < 64; i++)
+				x = std::sqrt(x * x + 1.0f) * 0.5f;
+
+			return x;
+		}
+	}
+
+	int RunJobSystemBenchmark(const BenchmarkSettings& settings)
+	{
+		std::vector<float> computeOut(ComputeCount);
+		std::vector<float> memoryA(MemoryCount, 1.0f), memoryB(MemoryCount, 2.0f);
+		const std::vector<JobDesc> emptyJobs(EmptyJobBatch, JobDesc{ .function = [](void*, uint32_t, uint32_t) {} });
+
+		const uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		std::printf("Hardware threads: %u\n", hardwareThreads);
+		std::printf("%8s %13s %8s %13s %8s %14s\n", "Threads", "Compute (ms)", "Speedup", "Memory (ms)", "Speedup", "Empty jobs/s");
+
+		double computeBaseMs = 0.0, memoryBaseMs = 0.0;
+		for (uint32_t threads = settings.minThreads; ; threads = std::min(threads * 2, settings.maxThreads))
+		{
+			if (IsError(JobSystem::Initialize({ .numThreads = threads })))
+			{
+				std::fprintf(stderr, "Failed to initialize the job system with %u threads\n", threads);
+				return 1;
+			}
+
+			const double computeMs = MeasureBestMs(settings, [&]()
+			{
+				JobSystem::ParallelFor(ComputeCount, 0, [&](uint32_t i) { computeOut[i] = ComputeKernel(i); });
+			});
+
+			const double memoryMs = MeasureBestMs(settings, [&]()
+			{
+				JobSystem::ParallelForRanges(MemoryCount, 0, [&](uint32_t begin, uint32_t end)
+				{
+					for (uint32_t i = begin; i < end; i++)
+						memoryA[i] = memoryA[i] * 0.5f + memoryB[i];
+				});
+			});
+
+			// The overhead of a job, queued from thread 0 and stolen by everyone else
+			const double emptyMs = MeasureBestMs(settings, [&]()
+			{
+				for (uint32_t i = 0; i < EmptyJobCount; i += EmptyJobBatch)
+				{
+					JobCounter counter;
+					JobSystem::Run(emptyJobs, &counter);
+					JobSystem::Wait(counter);
+				}
+			});
+
+			JobSystem::Shutdown();
+
+			if (computeBaseMs == 0.0)
+			{
+				computeBaseMs = computeMs;
+				memoryBaseMs = memoryMs;
+			}
+
+			std::printf("%8u %13.3f %7.2fx %13.3f %7.2fx %14.0f%s\n", threads, computeMs, computeBaseMs / computeMs, memoryMs, memoryBaseMs / memoryMs,
+				EmptyJobCount / (emptyMs / 1000.0), (threads > hardwareThreads) ? " (oversubscribed)" : "");
+
+			if (threads >= settings.maxThreads)
+				break;
+		}
+
+		return 0;
+	}
+}
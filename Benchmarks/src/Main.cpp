@@ -0,0 +1,55 @@
+#include "Benchmark.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <string_view>
+
+// Engine benchmarks
+//
+// Usage: Benchmarks [options] <benchmark>
+//  Benchmarks:
+//   jobs			JobSystem scaling: ParallelFor over compute and memory bound loops, and the cost of empty jobs
+//  Options:
+//   --min-threads <n>	The first thread count (default 1)
+//   --max-threads <n>	The last thread count, counts double up to it (default 64)
+//   --repeat <n>		Number of runs per measurement, the best one is reported (default 5)
+
+namespace Benchmarks
+{
+	static void PrintUsage()
+	{
+		std::fprintf(stderr, "Usage: Benchmarks [--min-threads <n>] [--max-threads <n>] [--repeat <n>] <jobs>\n");
+	}
+}
+
+int main(int argc, char** argv)
+{
+	using namespace Benchmarks;
+
+	BenchmarkSettings settings;
+	std::string_view benchmark;
+
+	for (int i = 1; i < argc; i++)
+	{
+		std::string_view arg = argv[i];
+		if (arg == "--min-threads" && i + 1 < argc)
+			settings.minThreads = std::max(static_cast<uint32_t>(std::atoi(argv[++i])), 1u);
+		else if (arg == "--max-threads" && i + 1 < argc)
+			settings.maxThreads = std::max(static_cast<uint32_t>(std::atoi(argv[++i])), 1u);
+		else if (arg == "--repeat" && i + 1 < argc)
+			settings.repeat = std::max(static_cast<uint32_t>(std::atoi(argv[++i])), 1u);
+		else if (!arg.empty() && arg[0] == '-')
+		{
+			PrintUsage();
+			return 1;
+		}
+		else
+			benchmark = arg;
+	}
+
+	if (benchmark == "jobs")
+		return RunJobSystemBenchmark(settings);
+
+	PrintUsage();
+	return 1;
+}
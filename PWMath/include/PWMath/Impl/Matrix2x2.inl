@@ -96,7 +96,7 @@ namespace PWMath
 	template<typename T, PackingMode P>
 	const Matrix<T, 2, 2, P>& operator*=(Matrix<T, 2, 2, P>& lhs, const Matrix<T, 2, 2, P>& rhs)
 	{
-		return *this = *this * rhs;
+		return lhs = lhs * rhs;
 	}
 
 #pragma endregion
@@ -100,7 +100,7 @@ namespace PWMath
 	template<typename T, PackingMode P>
 	const Matrix<T, 3, 3, P>& operator*=(Matrix<T, 3, 3, P>& lhs, const Matrix<T, 3, 3, P>& rhs)
 	{
-		return *this = *this * rhs;
+		return lhs = lhs * rhs;
 	}
 
 #pragma endregion
@@ -104,7 +104,7 @@ namespace PWMath
 	template<typename T, PackingMode P>
 	const Matrix<T, 4, 4, P>& operator*=(Matrix<T, 4, 4, P>& lhs, const Matrix<T, 4, 4, P>& rhs)
 	{
-		return *this = *this * rhs;
+		return lhs = lhs * rhs;
 	}
 
 #pragma endregion
@@ -0,0 +1,215 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLLayout.h>
+#include <Pinewood/Renderer/HL/HLImageFormat.h>
+#include <Pinewood/Renderer/HL/HLShaderModule.h>
+
+#include <cstring>
+
+// Blob formats written by the offline asset baker (see AssetBaker/)
+// Everything in a blob is already in the layout the GPU wants, so loading one is just pointing spans into the file
+namespace Pinewood
+{
+	constexpr uint32_t BakedAssetMagic		= 0x41425750; // "PWBA" (little-endian)
+	constexpr uint32_t BakedAssetVersion	= 1;
+
+	enum class BakedAssetType : uint32_t
+	{
+		Unknown		= 0,
+		Mesh		= 1,
+		Texture		= 2,
+		Shader		= 3
+	};
+
+	// Attribute indices (HLLayoutElement::index) used by baked meshes
+	enum class BakedMeshAttribute : uint32_t
+	{
+		Position	= 0,
+		TexCoord	= 1,
+		Normal		= 2
+	};
+
+	struct BakedAssetHeader
+	{
+		uint32_t magic;
+		uint32_t version;
+		BakedAssetType type;
+		uint32_t reserved;
+		uint64_t sourceHash;	// Hash of the source file and bake settings, used by the baker to skip unchanged assets
+	};
+
+	// Layout (all offsets are from the start of the blob):
+	//  BakedAssetHeader, BakedMeshHeader, HLLayoutElement[elementCount], vertex data, index data (uint32_t)
+	struct BakedMeshHeader
+	{
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t stride;			// Size of one interleaved vertex (binding 0)
+		uint32_t elementCount;
+		uint64_t vertexDataOffset;
+		uint64_t indexDataOffset;
+		float boundsMin[3];
+		float boundsMax[3];
+	};
+
+	// Layout (all offsets are from the start of the blob):
+	//  BakedAssetHeader, BakedTextureHeader, BakedMipLevel[mipLevels], pixel data for each mip
+	struct BakedTextureHeader
+	{
+		uint32_t width, height;
+		uint32_t mipLevels;
+		HLImageFormat format;
+	};
+
+	struct BakedMipLevel
+	{
+		uint32_t width, height;
+		uint64_t offset;
+		uint64_t size;
+	};
+
+	// Layout (all offsets are from the start of the blob):
+	//  BakedAssetHeader, BakedShaderHeader, SPIR-V code (OpenGL flavored, compiled from GLSL)
+	struct BakedShaderHeader
+	{
+		HLShaderModuleType type;
+		uint32_t codeSize;		// In bytes, a multiple of 4
+		uint64_t codeOffset;
+	};
+
+	// Views into a baked blob, the blob must outlive the view
+	struct BakedMeshView
+	{
+		const BakedMeshHeader* header;
+		std::span<const HLLayoutElement> elements;
+		HLLayoutBinding binding;
+		std::span<const uint8_t> vertexData;
+		std::span<const uint32_t> indices;
+	};
+
+	struct BakedTextureView
+	{
+		const BakedTextureHeader* header;
+		std::span<const BakedMipLevel> mipLevels;
+		std::span<const uint8_t> blob; // Mip data is at blob.data() + mipLevels[i].offset
+	};
+
+	struct BakedShaderView
+	{
+		const BakedShaderHeader* header;
+		std::span<const uint32_t> code; // For HLShaderModuleCreateInfo::spirv
+	};
+
+	namespace Impl
+	{
+		inline Result ValidateBakedAsset(std::span<const uint8_t> blob, BakedAssetType type)
+		{
+			// The headers are read in place and have 64-bit fields
+			if (blob.size() < sizeof(BakedAssetHeader) || (reinterpret_cast<uintptr_t>(blob.data()) % alignof(uint64_t)))
+				return Result::InvalidParameter;
+
+			BakedAssetHeader header;
+			std::memcpy(&header, blob.data(), sizeof(header));
+			if ((header.magic != BakedAssetMagic) || (header.version != BakedAssetVersion) || (header.type != type))
+				return Result::InvalidParameter;
+
+			return Result::Success;
+		}
+
+		inline bool IsRangeInBlob(std::span<const uint8_t> blob, uint64_t offset, uint64_t size)
+		{
+			return (offset <= blob.size()) && (size <= blob.size() - offset);
+		}
+	}
+
+	// Parses a baked mesh, no data is copied or converted
+	// NOTE: blob must be at least 8-byte aligned (it is if it came from new/malloc or a file mapping)
+	inline Result GetBakedMeshView(std::span<const uint8_t> blob, BakedMeshView& viewOut)
+	{
+		Result result = Impl::ValidateBakedAsset(blob, BakedAssetType::Mesh);
+		if (IsError(result))
+			return result;
+
+		constexpr size_t meshHeaderOffset = sizeof(BakedAssetHeader);
+		constexpr size_t elementsOffset = meshHeaderOffset + sizeof(BakedMeshHeader);
+		if (!Impl::IsRangeInBlob(blob, meshHeaderOffset, sizeof(BakedMeshHeader)))
+			return Result::InvalidParameter;
+
+		const auto* header = reinterpret_cast<const BakedMeshHeader*>(blob.data() + meshHeaderOffset);
+		const uint64_t vertexDataSize = static_cast<uint64_t>(header->vertexCount) * header->stride;
+		const uint64_t indexDataSize = static_cast<uint64_t>(header->indexCount) * sizeof(uint32_t);
+
+		if (!Impl::IsRangeInBlob(blob, elementsOffset, header->elementCount * sizeof(HLLayoutElement)) ||
+			!Impl::IsRangeInBlob(blob, header->vertexDataOffset, vertexDataSize) ||
+			!Impl::IsRangeInBlob(blob, header->indexDataOffset, indexDataSize) ||
+			(header->indexDataOffset % alignof(uint32_t)))
+			return Result::InvalidParameter;
+
+		viewOut = BakedMeshView{
+			.header = header,
+			.elements = { reinterpret_cast<const HLLayoutElement*>(blob.data() + elementsOffset), header->elementCount },
+			.binding = { 0, header->stride },
+			.vertexData = blob.subspan(header->vertexDataOffset, vertexDataSize),
+			.indices = { reinterpret_cast<const uint32_t*>(blob.data() + header->indexDataOffset), header->indexCount }
+		};
+
+		return Result::Success;
+	}
+
+	// Parses a baked texture, no data is copied or converted
+	// NOTE: blob must be at least 8-byte aligned (it is if it came from new/malloc or a file mapping)
+	inline Result GetBakedTextureView(std::span<const uint8_t> blob, BakedTextureView& viewOut)
+	{
+		Result result = Impl::ValidateBakedAsset(blob, BakedAssetType::Texture);
+		if (IsError(result))
+			return result;
+
+		constexpr size_t textureHeaderOffset = sizeof(BakedAssetHeader);
+		constexpr size_t mipsOffset = textureHeaderOffset + sizeof(BakedTextureHeader);
+		if (!Impl::IsRangeInBlob(blob, textureHeaderOffset, sizeof(BakedTextureHeader)))
+			return Result::InvalidParameter;
+
+		const auto* header = reinterpret_cast<const BakedTextureHeader*>(blob.data() + textureHeaderOffset);
+		if (!Impl::IsRangeInBlob(blob, mipsOffset, header->mipLevels * sizeof(BakedMipLevel)))
+			return Result::InvalidParameter;
+
+		std::span<const BakedMipLevel> mipLevels{ reinterpret_cast<const BakedMipLevel*>(blob.data() + mipsOffset), header->mipLevels };
+		for (auto& mip : mipLevels)
+			if (!Impl::IsRangeInBlob(blob, mip.offset, mip.size))
+				return Result::InvalidParameter;
+
+		viewOut = BakedTextureView{
+			.header = header,
+			.mipLevels = mipLevels,
+			.blob = blob
+		};
+
+		return Result::Success;
+	}
+
+	// Parses a baked shader, no data is copied or converted
+	// NOTE: blob must be at least 8-byte aligned (it is if it came from new/malloc or a file mapping)
+	inline Result GetBakedShaderView(std::span<const uint8_t> blob, BakedShaderView& viewOut)
+	{
+		Result result = Impl::ValidateBakedAsset(blob, BakedAssetType::Shader);
+		if (IsError(result))
+			return result;
+
+		constexpr size_t shaderHeaderOffset = sizeof(BakedAssetHeader);
+		if (!Impl::IsRangeInBlob(blob, shaderHeaderOffset, sizeof(BakedShaderHeader)))
+			return Result::InvalidParameter;
+
+		const auto* header = reinterpret_cast<const BakedShaderHeader*>(blob.data() + shaderHeaderOffset);
+		if (!Impl::IsRangeInBlob(blob, header->codeOffset, header->codeSize) || (header->codeOffset % alignof(uint32_t)) ||
+			(header->codeSize % sizeof(uint32_t)))
+			return Result::InvalidParameter;
+
+		viewOut = BakedShaderView{
+			.header = header,
+			.code = { reinterpret_cast<const uint32_t*>(blob.data() + header->codeOffset), header->codeSize / sizeof(uint32_t) }
+		};
+
+		return Result::Success;
+	}
+}
@@ -15,6 +15,7 @@ namespace Pinewood
 		InvalidParameter	= 0x80000002,
 		OutOfMemory			= 0x80000003,
 		NotInitialized		= 0x80000004,
+		Unsupported			= 0x80000005,	// The driver doesn't support it
 
 		// Rendering subsystems
 		BufferMapCorrupt	= 0x90000000,	// The buffer got corrupted while mapped, buffer must be reloaded
@@ -2,10 +2,14 @@
 #include <Pinewood/Core.h>
 #include <Pinewood/Error.h>
 #include <Pinewood/Window.h>
+#include <Pinewood/TripleBuffer.h>
 #include <PWMath/Vector2.h>
 
 #include <bitset>
-#include <mutex>
+
+// Input state is double buffered: the event handlers write it on the window thread (or wherever the window's events are polled)
+// and BeginFrame publishes a snapshot, every query reads that snapshot without locks. Call BeginFrame once per frame.
+// ProcessEvent feeds events in without a window (ex: replays and tests), from the same thread as the window's events.
 
 namespace Pinewood
 {
@@ -13,7 +17,7 @@ namespace Pinewood
 	{
 	public:
 		KeyboardInput() = default;
-		KeyboardInput(const KeyboardInput&) = default;
+		KeyboardInput(const KeyboardInput&) = delete;
 		inline ~KeyboardInput()
 		{
 			Destroy();
@@ -77,45 +81,96 @@ namespace Pinewood
 				return Result::NotInitialized;
 		}
 
-		inline bool IsKeyPressed(KeyCode key)
+		// Takes a snapshot of the input received since the last call, queries return the snapshot until the next call
+		inline void BeginFrame()
+		{
+			m_buffer.Update();
+			const State& state = m_buffer.GetReadBuffer();
+
+			m_previousKeys = m_keys;
+			m_keys = state.keys;
+
+			// A key that went down and up between two frames still counts as pressed and released
+			std::bitset<256> tapped;
+			for (size_t i = 0; i < 256; i++)
+				tapped[i] = state.pressCounts[i] != m_pressCounts[i];
+			m_pressCounts = state.pressCounts;
+
+			m_pressedKeys = (m_keys & ~m_previousKeys) | tapped;
+			m_releasedKeys = (~m_keys & m_previousKeys) | (tapped & ~m_keys);
+		}
+
+		// Feeds a KeyDown or KeyUp event in, other events are ignored
+		// Params:
+		//  - event = The event.
+		inline void ProcessEvent(const WindowEventData& event)
 		{
-			std::lock_guard guard{ m_mutex };
-			return m_keys[static_cast<uint32_t>(key) % 256];
+			if (event.code == WindowEventCode::KeyDown || event.code == WindowEventCode::KeyUp)
+				SetKey(event.key.key, event.code == WindowEventCode::KeyDown);
 		}
 
+		// The key is held down
+		inline bool IsKeyPressed(KeyCode key) const { return m_keys[static_cast<uint32_t>(key) % 256]; }
+
+		// The key went down since the last frame
+		inline bool WasKeyPressed(KeyCode key) const { return m_pressedKeys[static_cast<uint32_t>(key) % 256]; }
+
+		// The key went up since the last frame
+		inline bool WasKeyReleased(KeyCode key) const { return m_releasedKeys[static_cast<uint32_t>(key) % 256]; }
+
+		inline const std::bitset<256>& GetKeys() const { return m_keys; }
+		inline const std::bitset<256>& GetPreviousKeys() const { return m_previousKeys; }
+
 		inline const Window& GetWindow() { return m_window; }
 
 		inline bool IsInitialized() { return m_window.IsInitialized(); }
 
 	private:
+		// Written by the event handlers
+		struct State
+		{
+			std::bitset<256> keys;
+			std::array<uint8_t, 256> pressCounts{}; // Wraps around, only compared between frames
+		};
+
+		inline void SetKey(KeyCode key, bool down)
+		{
+			const uint32_t index = static_cast<uint32_t>(key) % 256;
+			State& state = m_buffer.GetWriteBuffer();
+
+			// Key repeats don't count as presses
+			if (down && !state.keys[index])
+				state.pressCounts[index]++;
+			state.keys[index] = down;
+
+			m_buffer.Publish();
+		}
+
 		static inline void KeyDownHandler(const Window&, const WindowEvent& e, void* ptr)
 		{
 			const WindowKeyEvent& event = static_cast<const WindowKeyEvent&>(e);
-			auto* keyboard = reinterpret_cast<KeyboardInput*>(ptr);
-			std::lock_guard guard{ keyboard->m_mutex };
-
-			keyboard->m_keys[static_cast<uint32_t>(event.key) % 256] = true;
+			reinterpret_cast<KeyboardInput*>(ptr)->SetKey(event.key, true);
 		}
 
 		static inline void KeyUpHandler(const Window&, const WindowEvent& e, void* ptr)
 		{
 			const WindowKeyEvent& event = static_cast<const WindowKeyEvent&>(e);
-			auto* keyboard = reinterpret_cast<KeyboardInput*>(ptr);
-			std::lock_guard guard{ keyboard->m_mutex };
-
-			keyboard->m_keys[static_cast<uint32_t>(event.key) % 256] = false;
+			reinterpret_cast<KeyboardInput*>(ptr)->SetKey(event.key, false);
 		}
 
-		std::mutex m_mutex;
 		Window m_window;
-		std::bitset<256> m_keys;
+		TripleBuffer<State> m_buffer;
+
+		// Snapshot
+		std::bitset<256> m_keys, m_previousKeys, m_pressedKeys, m_releasedKeys;
+		std::array<uint8_t, 256> m_pressCounts{};
 	};
 
 	class MouseInput
 	{
 	public:
 		MouseInput() = default;
-		MouseInput(const MouseInput&) = default;
+		MouseInput(const MouseInput&) = delete;
 		inline ~MouseInput()
 		{
 			Destroy();
@@ -211,89 +266,163 @@ namespace Pinewood
 				return Result::NotInitialized;
 		}
 
-		inline MouseButton GetButtons() { std::lock_guard guard{ m_mutex }; return m_buttons; }
-		inline int16_t GetX() { std::lock_guard guard{ m_mutex };  return m_x; }
-		inline int16_t GetY() { std::lock_guard guard{ m_mutex }; return m_y; }
-		inline PWMath::Vector2I16 GetPosition() { std::lock_guard guard{ m_mutex }; return { m_x, m_y }; }
-		inline float GetScrollDelta() { std::lock_guard guard{ m_mutex }; return m_scrollDelta; }
+		// Takes a snapshot of the input received since the last call, queries return the snapshot until the next call
+		inline void BeginFrame()
+		{
+			m_buffer.Update();
+			const State& state = m_buffer.GetReadBuffer();
+
+			const int16_t previousX = m_x, previousY = m_y;
+			m_previousButtons = m_buttons;
+			m_buttons = state.buttons;
+			m_x = state.x;
+			m_y = state.y;
+			m_deltaX = m_x - previousX;
+			m_deltaY = m_y - previousY;
+			m_scrollDelta = static_cast<float>(state.scroll - m_scroll);
+			m_scroll = state.scroll;
+
+			// A button that went down and up between two frames still counts as pressed and released
+			MouseButton tapped = MouseButton::Null;
+			for (uint32_t i = 0; i < ButtonCount; i++)
+				if (state.pressCounts[i] != m_pressCounts[i])
+					tapped |= static_cast<MouseButton>(1u << i);
+			m_pressCounts = state.pressCounts;
+
+			const MouseButton buttons = m_buttons & MouseButton::AllButtons, previousButtons = m_previousButtons & MouseButton::AllButtons;
+			m_pressedButtons = (buttons & ~previousButtons) | tapped;
+			m_releasedButtons = (~buttons & previousButtons) | (tapped & ~buttons);
+		}
+
+		// Feeds a mouse event in, other events are ignored
+		// Params:
+		//  - event = The event.
+		inline void ProcessEvent(const WindowEventData& event)
+		{
+			switch (event.code)
+			{
+			case WindowEventCode::MouseButtonDown: ButtonDown(event.mouse); break;
+			case WindowEventCode::MouseButtonUp: ButtonUp(event.mouse); break;
+			case WindowEventCode::MouseMove: Move(event.mouse); break;
+			case WindowEventCode::MouseScroll: Scroll(event.mouseScroll); break;
+			default: break;
+			}
+		}
+
+		// The buttons held down and the control and shift keys
+		inline MouseButton GetButtons() const { return m_buttons; }
+
+		// The buttons (AllButtons only) that went down since the last frame
+		inline MouseButton GetPressedButtons() const { return m_pressedButtons; }
+
+		// The buttons (AllButtons only) that went up since the last frame
+		inline MouseButton GetReleasedButtons() const { return m_releasedButtons; }
+
+		inline int16_t GetX() const { return m_x; }
+		inline int16_t GetY() const { return m_y; }
+		inline PWMath::Vector2I16 GetPosition() const { return { m_x, m_y }; }
+
+		// Movement since the last frame
+		inline PWMath::Vector2I32 GetDelta() const { return { m_deltaX, m_deltaY }; }
+
+		// Scrolling since the last frame
+		inline float GetScrollDelta() const { return m_scrollDelta; }
 
 		inline const Window& GetWindow() { return m_window; }
 
 		inline bool IsInitialized() { return m_window.IsInitialized(); }
 
-		inline void ResetScrollDelta() { std::lock_guard guard{ m_mutex }; m_scrollDelta = 0; }
-
 	private:
-		static inline void ButtonDownHandler(const Window&, const WindowEvent& e, void* ptr)
+		static constexpr uint32_t ButtonCount = 5;
+
+		// Written by the event handlers
+		struct State
 		{
-			const WindowMouseEvent& event = static_cast<const WindowMouseEvent&>(e);
-			auto* mouse = reinterpret_cast<MouseInput*>(ptr);
-			std::lock_guard guard{ mouse->m_mutex };
+			MouseButton buttons = MouseButton::Null;
+			int16_t x = 0, y = 0;
+			double scroll = 0.0; // Total, only compared between frames
+			std::array<uint8_t, ButtonCount> pressCounts{}; // Wraps around, only compared between frames
+		};
 
-			// Mark this mouse button as pressed
-			mouse->m_buttons |= (event.buttons & MouseButton::AllButtons);
+		inline void ButtonDown(const WindowMouseEvent& event)
+		{
+			State& state = m_buffer.GetWriteBuffer();
 
-			// Update the keyboard keys
-			mouse->m_buttons = (mouse->m_buttons & MouseButton::AllButtons) | (event.buttons & MouseButton::AllKeys);
+			// Count the presses of buttons that weren't already down
+			const MouseButton pressed = event.buttons & MouseButton::AllButtons & ~state.buttons;
+			for (uint32_t i = 0; i < ButtonCount; i++)
+				if (static_cast<uint32_t>(pressed) & (1u << i))
+					state.pressCounts[i]++;
 
-			// Update position
-			mouse->m_x = event.x;
-			mouse->m_y = event.y;
+			// Mark this mouse button as pressed and update the keyboard keys
+			state.buttons = ((state.buttons | event.buttons) & MouseButton::AllButtons) | (event.buttons & MouseButton::AllKeys);
+			state.x = event.x;
+			state.y = event.y;
+
+			m_buffer.Publish();
 		}
 
-		static inline void ButtonUpHandler(const Window&, const WindowEvent& e, void* ptr)
+		inline void ButtonUp(const WindowMouseEvent& event)
 		{
-			const WindowMouseEvent& event = static_cast<const WindowMouseEvent&>(e);
-			auto* mouse = reinterpret_cast<MouseInput*>(ptr);
-			std::lock_guard guard{ mouse->m_mutex };
-
-			// Mark this mouse button as not pressed
-			mouse->m_buttons &= ~(event.buttons & MouseButton::AllButtons);
-
-			// Update the keyboard keys
-			mouse->m_buttons = (mouse->m_buttons & MouseButton::AllButtons) | (event.buttons & MouseButton::AllKeys);
-			
-			// Update position
-			mouse->m_x = event.x;
-			mouse->m_y = event.y;
+			State& state = m_buffer.GetWriteBuffer();
+
+			// Mark this mouse button as not pressed and update the keyboard keys
+			state.buttons = (state.buttons & ~event.buttons & MouseButton::AllButtons) | (event.buttons & MouseButton::AllKeys);
+			state.x = event.x;
+			state.y = event.y;
+
+			m_buffer.Publish();
 		}
 
-		static inline void MoveHandler(const Window&, const WindowEvent& e, void* ptr)
+		inline void Move(const WindowMouseEvent& event)
 		{
-			const WindowMouseEvent& event = static_cast<const WindowMouseEvent&>(e);
-			auto* mouse = reinterpret_cast<MouseInput*>(ptr);
-			std::lock_guard guard{ mouse->m_mutex };
-
-			// Update the buttons and keys
-			mouse->m_buttons = mouse->m_buttons;
+			State& state = m_buffer.GetWriteBuffer();
+			state.x = event.x;
+			state.y = event.y;
 
-			// Update position
-			mouse->m_x = event.x;
-			mouse->m_y = event.y;
+			m_buffer.Publish();
 		}
 
-		static inline void ScrollHandler(const Window&, const WindowEvent& e, void* ptr)
+		inline void Scroll(const WindowMouseScrollEvent& event)
 		{
-			const WindowMouseScrollEvent& event = static_cast<const WindowMouseScrollEvent&>(e);
-			auto* mouse = reinterpret_cast<MouseInput*>(ptr);
-			std::lock_guard guard{ mouse->m_mutex };
+			State& state = m_buffer.GetWriteBuffer();
+			state.x = event.x;
+			state.y = event.y;
+			state.scroll += event.scroll;
 
-			// Update the buttons and keys
-			mouse->m_buttons = mouse->m_buttons;
+			m_buffer.Publish();
+		}
 
-			// Update position
-			mouse->m_x = event.x;
-			mouse->m_y = event.y;
+		static inline void ButtonDownHandler(const Window&, const WindowEvent& e, void* ptr)
+		{
+			reinterpret_cast<MouseInput*>(ptr)->ButtonDown(static_cast<const WindowMouseEvent&>(e));
+		}
+
+		static inline void ButtonUpHandler(const Window&, const WindowEvent& e, void* ptr)
+		{
+			reinterpret_cast<MouseInput*>(ptr)->ButtonUp(static_cast<const WindowMouseEvent&>(e));
+		}
 
-			// Add the scroll delta
-			mouse->m_scrollDelta += event.scroll;
+		static inline void MoveHandler(const Window&, const WindowEvent& e, void* ptr)
+		{
+			reinterpret_cast<MouseInput*>(ptr)->Move(static_cast<const WindowMouseEvent&>(e));
 		}
 
-		std::mutex m_mutex;
+		static inline void ScrollHandler(const Window&, const WindowEvent& e, void* ptr)
+		{
+			reinterpret_cast<MouseInput*>(ptr)->Scroll(static_cast<const WindowMouseScrollEvent&>(e));
+		}
 
 		Window m_window;
-		MouseButton m_buttons = MouseButton::Null;
+		TripleBuffer<State> m_buffer;
+
+		// Snapshot
+		MouseButton m_buttons = MouseButton::Null, m_previousButtons = MouseButton::Null;
+		MouseButton m_pressedButtons = MouseButton::Null, m_releasedButtons = MouseButton::Null;
 		int16_t m_x = 0, m_y = 0;
-		float m_scrollDelta = 0;
+		int32_t m_deltaX = 0, m_deltaY = 0;
+		double m_scroll = 0.0;
+		float m_scrollDelta = 0.0f;
+		std::array<uint8_t, ButtonCount> m_pressCounts{};
 	};
 }
@@ -0,0 +1,169 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+
+#include <atomic>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Job system
+// One worker thread per core, each with a work-stealing deque. Jobs pushed by a worker (or the thread that called
+// JobSystem::Initialize) go into its own deque, idle workers steal from the others. Waiting on a JobCounter runs other
+// jobs until the counter reaches zero, so no thread ever blocks on a job.
+
+namespace Pinewood
+{
+	class JobCounter;
+
+	struct JobDesc
+	{
+		// Params:
+		//  - userPointer = The JobDesc::userPointer.
+		//  - begin = The JobDesc::begin.
+		//  - end = The JobDesc::end.
+		using Function = void(*)(void* userPointer, uint32_t begin, uint32_t end);
+
+		Function function;
+		void* userPointer = nullptr;
+		uint32_t begin = 0, end = 1; // A range for the job to work on, the job system doesn't use it
+	};
+
+	namespace Impl
+	{
+		struct Job
+		{
+			JobDesc desc;
+			JobCounter* counter;	// Decremented when the job finished, can be nullptr
+		};
+	}
+
+	// Counts unfinished jobs, a job decrements the counter it was run with when it finishes
+	// Must outlive the jobs that use it (JobSystem::Wait on it before it goes out of scope)
+	class JobCounter
+	{
+	public:
+		JobCounter() = default;
+
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsDone() const { return m_value.load(std::memory_order_acquire) == 0; }
+		uint32_t GetValue() const { return m_value.load(std::memory_order_acquire); }
+
+	private:
+		friend class JobSystem;
+
+		std::atomic_uint32_t m_value = 0;
+
+		// Jobs queued with JobSystem::RunAfter, they run when the value reaches zero
+		std::mutex m_continuationMutex;
+		std::vector<Impl::Job> m_continuations;
+	};
+
+	struct JobSystemCreateInfo
+	{
+		uint32_t numThreads = 0;	// Including the calling thread, 0 = One per core
+		uint32_t queueSize = 4096;	// The capacity of each worker's deque, rounded up to a power of 2. Jobs that don't fit run right away
+	};
+
+	class JobSystem
+	{
+	public:
+		// Starts the worker threads, the calling thread becomes thread 0 and can run jobs while it waits
+		// Params:
+		//  - createInfo = The JobSystemCreateInfo.
+		static Result Initialize(const JobSystemCreateInfo& createInfo);
+
+		// Waits for the queued jobs and stops the worker threads, call from the thread that called Initialize
+		static void Shutdown();
+
+		static bool IsInitialized();
+
+		// The number of threads that run jobs (the workers and the thread that called Initialize)
+		static uint32_t GetThreadCount();
+
+		// 0 for the thread that called Initialize, 1..GetThreadCount()-1 for the workers, UINT32_MAX for any other thread
+		static uint32_t GetThreadIndex();
+
+		// Queues jobs, without an initialized job system they run right away on the calling thread
+		// Params:
+		//  - jobs = The jobs to run.
+		//  - counter = Incremented by the number of jobs, every job decrements it when it finishes. Can be nullptr.
+		static void Run(std::span<const JobDesc> jobs, JobCounter* counter = nullptr);
+		static void Run(const JobDesc& job, JobCounter* counter = nullptr) { Run(std::span{ &job, 1 }, counter); }
+
+		// Queues jobs once the dependency reaches zero (right away if it already is), for chaining jobs without waiting
+		// Params:
+		//  - dependency = The counter to wait for.
+		//  - jobs = The jobs to run.
+		//  - counter = Incremented by the number of jobs right away, every job decrements it when it finishes. Can be nullptr.
+		static void RunAfter(JobCounter& dependency, std::span<const JobDesc> jobs, JobCounter* counter = nullptr);
+
+		// Runs queued jobs on the calling thread until the counter reaches zero
+		// Params:
+		//  - counter = The counter to wait for.
+		static void Wait(JobCounter& counter);
+
+		// Calls function(index) for every index in [0, count) on every thread and waits for it to finish
+		// The range is split in halves until a half is at most batchSize, idle threads steal the big halves first.
+		// Params:
+		//  - count = The number of indices.
+		//  - batchSize = The number of indices a single job calls function for, 0 picks one based on the thread count.
+		//  - function = Called with each index, must be thread-safe.
+		template<typename TFunction>
+		static void ParallelFor(uint32_t count, uint32_t batchSize, TFunction&& function)
+		{
+			ParallelForRanges(count, batchSize, [&function](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; i++)
+					function(i);
+			});
+		}
+
+		// Calls function(value, index) for every value in the span, see ParallelFor above
+		template<typename TValue, typename TFunction>
+		static void ParallelFor(std::span<TValue> values, uint32_t batchSize, TFunction&& function)
+		{
+			ParallelForRanges(static_cast<uint32_t>(values.size()), batchSize, [&](uint32_t begin, uint32_t end)
+			{
+				for (uint32_t i = begin; i < end; i++)
+					function(values[i], i);
+			});
+		}
+
+		// Calls function(begin, end) for ranges that cover [0, count), for loops that want to work on a whole batch at once
+		template<typename TFunction>
+		static void ParallelForRanges(uint32_t count, uint32_t batchSize, TFunction&& function)
+		{
+			if (count == 0)
+				return;
+
+			using TCallable = std::remove_reference_t<TFunction>;
+			ParallelForState state{
+				.function = [](void* userPointer, uint32_t begin, uint32_t end) { (*static_cast<TCallable*>(userPointer))(begin, end); },
+				.userPointer = const_cast<void*>(static_cast<const void*>(&function)),
+				.batchSize = (batchSize != 0) ? batchSize : GetDefaultBatchSize(count)
+			};
+			RunParallelFor(state, count);
+		}
+
+	private:
+		struct ParallelForState
+		{
+			JobDesc::Function function;
+			void* userPointer;
+			uint32_t batchSize;
+			JobCounter counter;
+		};
+
+		static uint32_t GetDefaultBatchSize(uint32_t count);
+		static void RunParallelFor(ParallelForState& state, uint32_t count);
+		static void ParallelForJob(void* userPointer, uint32_t begin, uint32_t end);
+
+		static void QueueJob(const Impl::Job& job);
+		static void ExecuteJob(const Impl::Job& job);
+		static void WorkerThread(uint32_t index);
+	};
+}
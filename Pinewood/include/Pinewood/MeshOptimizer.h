@@ -0,0 +1,116 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+
+#include <vector>
+
+// Index and vertex reordering for the index/vertex data passed to HLBuffer
+// All functions work on triangle lists with uint32_t indices. The usual order is:
+//  1. OptimizeVertexCache
+//  2. OptimizeOverdraw (optional, needs positions)
+//  3. OptimizeVertexFetch (always last, it changes the vertex indices)
+
+namespace Pinewood
+{
+	// Results of simulating a FIFO post-transform cache
+	struct VertexCacheStats
+	{
+		uint32_t vertexTransforms;	// Number of cache misses (vertex shader invocations)
+		float acmr;					// Average cache miss ratio, transforms per triangle (0.5 is optimal, 3.0 is the worst)
+		float atvr;					// Average transform to vertex ratio, transforms per referenced vertex (1.0 is optimal)
+	};
+
+	// A cluster of triangles with bounds for culling
+	// The triangles index into the meshlet's vertices, which index into the original vertex buffer
+	struct Meshlet
+	{
+		uint32_t vertexOffset;		// Offset into meshletVertices
+		uint32_t triangleOffset;	// Offset into meshletTriangles (3 bytes per triangle)
+		uint32_t vertexCount;
+		uint32_t triangleCount;
+
+		float center[3];			// Bounding sphere
+		float radius;
+
+		// Normal cone, the whole meshlet faces away from the camera if
+		// dot(normalize(coneApex - cameraPosition), coneAxis) >= coneCutoff
+		float coneApex[3];
+		float coneAxis[3];
+		float coneCutoff;			// 1 when the triangles face too many ways for the cone to be useful
+	};
+
+	constexpr uint32_t DefaultVertexCacheSize = 32;
+
+	// Simulates a FIFO post-transform cache
+	// Params:
+	//  - indices = The triangle list.
+	//  - vertexCount = The number of vertices in the vertex buffer.
+	//  - cacheSize = The number of entries in the simulated cache.
+	VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize = DefaultVertexCacheSize);
+
+	// Reorders triangles for the post-transform cache (Tom Forsyth's linear-speed vertex cache optimization)
+	// Params:
+	//  - indices = The triangle list.
+	//  - vertexCount = The number of vertices in the vertex buffer.
+	//  - indicesOut = The reordered triangle list, can be the same as indices.
+	Result OptimizeVertexCache(std::span<const uint32_t> indices, uint32_t vertexCount, std::span<uint32_t> indicesOut);
+
+	// Reorders clusters of triangles so outward facing ones get drawn first, reducing overdraw (Sander et al., "Fast Triangle Reordering")
+	// The input should already be optimized for the vertex cache, the cache efficiency is kept within threshold of the input
+	// Params:
+	//  - indices = The triangle list.
+	//  - vertexData = The vertex buffer.
+	//  - vertexStride = The size of a vertex.
+	//  - positionOffset = The offset of the position in a vertex, positions must be Vector3F32.
+	//  - indicesOut = The reordered triangle list, can be the same as indices.
+	//  - threshold = How much worse the ACMR is allowed to get (1.05 allows 5% more vertex transforms).
+	Result OptimizeOverdraw(std::span<const uint32_t> indices, std::span<const uint8_t> vertexData, uint32_t vertexStride, uint32_t positionOffset,
+		std::span<uint32_t> indicesOut, float threshold = 1.05f);
+
+	// Generates a remap table that orders vertices by first use in the index buffer, unused vertices get removed
+	// Params:
+	//  - indices = The triangle list.
+	//  - vertexCount = The number of vertices in the vertex buffer.
+	//  - remapOut = Receives the new index of each vertex (or UINT32_MAX for unused ones), must hold vertexCount entries.
+	//  - remappedVertexCountOut = Receives the number of vertices after remapping.
+	Result GenerateVertexFetchRemap(std::span<const uint32_t> indices, uint32_t vertexCount, std::span<uint32_t> remapOut, uint32_t& remappedVertexCountOut);
+
+	// Applies a remap table to an index buffer
+	// Params:
+	//  - indices = The indices to remap (in place).
+	//  - remap = The remap table from GenerateVertexFetchRemap.
+	Result RemapIndices(std::span<uint32_t> indices, std::span<const uint32_t> remap);
+
+	// Applies a remap table to a vertex buffer, call once for every vertex stream
+	// Params:
+	//  - vertexData = The vertex buffer.
+	//  - vertexStride = The size of a vertex.
+	//  - remap = The remap table from GenerateVertexFetchRemap.
+	//  - vertexDataOut = The remapped vertex buffer, must not overlap vertexData and must hold the remapped vertex count.
+	Result RemapVertices(std::span<const uint8_t> vertexData, uint32_t vertexStride, std::span<const uint32_t> remap, std::span<uint8_t> vertexDataOut);
+
+	// Reorders a single interleaved vertex buffer for fetch locality (GenerateVertexFetchRemap + RemapIndices + RemapVertices)
+	// Params:
+	//  - indices = The triangle list, remapped in place.
+	//  - vertexData = The vertex buffer, remapped in place (unused vertices are moved out of the first vertexCountOut vertices).
+	//  - vertexStride = The size of a vertex.
+	//  - vertexCountOut = Receives the number of vertices that are still used.
+	Result OptimizeVertexFetch(std::span<uint32_t> indices, std::span<uint8_t> vertexData, uint32_t vertexStride, uint32_t& vertexCountOut);
+
+	constexpr uint32_t DefaultMeshletMaxVertices = 64;
+	constexpr uint32_t DefaultMeshletMaxTriangles = 124;
+
+	// Splits a triangle list into meshlets, in index order (so run OptimizeVertexCache first)
+	// Params:
+	//  - indices = The triangle list.
+	//  - vertexData = The vertex buffer.
+	//  - vertexStride = The size of a vertex.
+	//  - positionOffset = The offset of the position in a vertex, positions must be Vector3F32.
+	//  - maxVertices = The maximum number of vertices in a meshlet (at most 255).
+	//  - maxTriangles = The maximum number of triangles in a meshlet.
+	//  - meshletsOut = Receives the meshlets.
+	//  - meshletVerticesOut = Receives the vertex indices of every meshlet.
+	//  - meshletTrianglesOut = Receives the meshlet local triangle indices of every meshlet.
+	Result BuildMeshlets(std::span<const uint32_t> indices, std::span<const uint8_t> vertexData, uint32_t vertexStride, uint32_t positionOffset,
+		uint32_t maxVertices, uint32_t maxTriangles, std::vector<Meshlet>& meshletsOut, std::vector<uint32_t>& meshletVerticesOut, std::vector<uint8_t>& meshletTrianglesOut);
+}
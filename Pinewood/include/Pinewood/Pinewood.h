@@ -2,9 +2,15 @@
 
 #include <Pinewood/Core.h>
 #include <Pinewood/Error.h>
+#include <Pinewood/SPSCQueue.h>
+#include <Pinewood/TripleBuffer.h>
 #include <Pinewood/Window.h>
 #include <Pinewood/Input.h>
 #include <Pinewood/InputX.h>
+#include <Pinewood/MeshOptimizer.h>
+#include <Pinewood/VertexCompression.h>
+#include <Pinewood/Profiler.h>
+#include <Pinewood/JobSystem.h>
 
 #if PW_RENDERER_OPENGL4
 #include <Pinewood/Renderer/HL/HLContext.h>
@@ -15,5 +21,16 @@
 #include <Pinewood/Renderer/HL/HLShaderModule.h>
 #include <Pinewood/Renderer/HL/HLShaderProgram.h>
 #include <Pinewood/Renderer/HL/HLTexture2D.h>
+#include <Pinewood/Renderer/HL/HLTexture2DArray.h>
+#include <Pinewood/Renderer/HL/HLSampler.h>
 #include <Pinewood/Renderer/HL/HLFramebuffer.h>
+#include <Pinewood/Renderer/HL/HLPipelineState.h>
+#include <Pinewood/Renderer/HL/HLResourceLoader.h>
+#include <Pinewood/Renderer/HL/HLRenderTargetPool.h>
+#include <Pinewood/Renderer/HL/HLRenderGraph.h>
+#include <Pinewood/Renderer/HL/HLGPUCuller.h>
+#include <Pinewood/Renderer/HL/HLTextureTable.h>
+#include <Pinewood/Renderer/HL/HLGeometryHeap.h>
+#include <Pinewood/Renderer/HL/HLVertexPuller.h>
+#include <Pinewood/Renderer/HL/HLResidencyManager.h>
 #endif // ^^^ PW_RENDERER_OPENGL4
@@ -0,0 +1,127 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Frame profiler
+// CPU zones are recorded with PW_PROFILE_SCOPE/PW_PROFILE_FUNCTION into per-thread buffers (no locks on the hot path),
+// GPU zones are recorded by HLRenderInterface (see PW_PROFILE_GPU_SCOPE). Profiler::EndFrame collects everything once a frame.
+// Define PW_DISABLE_PROFILER to compile the macros out.
+
+namespace Pinewood
+{
+	// Zone timings over the frame history, per frame times are the sum of every time the zone ran in that frame
+	struct ProfilerZoneStats
+	{
+		std::string name;
+		bool gpu;
+		uint32_t frameCount;	// Number of frames in the history the zone ran in
+		float callsPerFrame;	// Average number of times the zone ran per frame
+		double minMs, avgMs, p99Ms, maxMs;
+	};
+
+	class Profiler
+	{
+	public:
+		// Enables or disables recording, zones cost a single atomic load while disabled
+		static void SetEnabled(bool enabled);
+		static bool IsEnabled() { return s_enabled.load(std::memory_order_relaxed); }
+
+		// Names the calling thread in Chrome traces
+		// Params:
+		//  - name = The name of the thread.
+		static void SetThreadName(std::string_view name);
+
+		// Collects the zones of every thread and adds the frame to the history, call once per frame
+		static void EndFrame();
+
+		// Sets the number of frames the stats are calculated over (default 300), clears the history
+		// Params:
+		//  - frameCount = The number of frames.
+		static void SetHistorySize(uint32_t frameCount);
+
+		// Gets the stats of every zone, the frame time is reported as the zone "Frame"
+		static std::vector<ProfilerZoneStats> GetZoneStats();
+
+		// Gets the stats of a single zone
+		// Params:
+		//  - name = The name of the zone.
+		//  - statsOut = Receives the stats.
+		static Result GetZoneStats(std::string_view name, ProfilerZoneStats& statsOut);
+
+		// Number of zones that got dropped because a thread buffer was full
+		static uint64_t GetDroppedZoneCount();
+
+		// Starts recording every zone for a Chrome trace (chrome://tracing or Perfetto)
+		static void BeginCapture();
+
+		// Stops recording and writes the captured zones as Chrome trace JSON
+		// Params:
+		//  - path = The file to write.
+		static Result EndCapture(const std::filesystem::path& path);
+
+		// Time in nanoseconds (steady clock), the time base of every zone
+		static uint64_t GetTime();
+
+		// Adds a finished zone to the calling thread's buffer, name must outlive the profiler (ex: a string literal)
+		// Params:
+		//  - name = The name of the zone.
+		//  - begin = The start time (see GetTime).
+		//  - end = The end time (see GetTime).
+		//  - depth = The nesting depth of the zone.
+		//  - gpu = The zone was measured on the GPU.
+		static void SubmitZone(const char* name, uint64_t begin, uint64_t end, uint32_t depth, bool gpu);
+
+	private:
+		static std::atomic_bool s_enabled;
+	};
+
+	// Measures the CPU time until the end of the scope
+	class ProfilerScope
+	{
+	public:
+		explicit ProfilerScope(const char* name)
+		{
+			if (Profiler::IsEnabled())
+			{
+				m_name = name;
+				m_begin = Profiler::GetTime();
+				s_depth++;
+			}
+		}
+
+		~ProfilerScope()
+		{
+			if (m_name)
+			{
+				s_depth--;
+				Profiler::SubmitZone(m_name, m_begin, Profiler::GetTime(), s_depth, false);
+			}
+		}
+
+		ProfilerScope(const ProfilerScope&) = delete;
+		ProfilerScope& operator=(const ProfilerScope&) = delete;
+
+	private:
+		const char* m_name = nullptr;
+		uint64_t m_begin = 0;
+
+		static thread_local uint32_t s_depth;
+	};
+}
+
+#define PW_PROFILER_CONCAT_IMPL(a, b) a##b
+#define PW_PROFILER_CONCAT(a, b) PW_PROFILER_CONCAT_IMPL(a, b)
+
+#ifndef PW_DISABLE_PROFILER
+// Measures the CPU time of the rest of the scope, name must be a string literal
+#define PW_PROFILE_SCOPE(name) ::Pinewood::ProfilerScope PW_PROFILER_CONCAT(pwProfilerScope, __LINE__){ name }
+#define PW_PROFILE_FUNCTION() PW_PROFILE_SCOPE(__func__)
+#else // ^^^ !PW_DISABLE_PROFILER // PW_DISABLE_PROFILER vvv
+#define PW_PROFILE_SCOPE(name)
+#define PW_PROFILE_FUNCTION()
+#endif // ^^^ PW_DISABLE_PROFILER
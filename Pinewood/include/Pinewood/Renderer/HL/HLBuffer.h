@@ -63,6 +63,14 @@ namespace Pinewood
 		//  - size = The number of bytes to read from the GPU.
 		Result GetData(void* dataOut, size_t offset, size_t size);
 
+		// Copies data from a buffer on the GPU, the source can be this buffer if the ranges don't overlap.
+		// Params:
+		//  - source = The buffer to copy from.
+		//  - sourceOffset = The offset into the source buffer.
+		//  - offset = The offset into this buffer.
+		//  - size = The number of bytes to copy.
+		Result CopyData(const HLBuffer& source, size_t sourceOffset, size_t offset, size_t size);
+
 		// Maps the buffer into memory.
 		// Params:
 		//  - ptrOut = The returned pointer to the.
@@ -72,6 +80,9 @@ namespace Pinewood
 		// Unmaps the buffer
 		Result Unmap();
 
+		// The size given to Create
+		size_t GetSize();
+
 		NativeHandle GetNativeHandle();
 
 		bool IsInitialized();
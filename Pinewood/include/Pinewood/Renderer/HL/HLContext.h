@@ -4,20 +4,38 @@
 #include <Pinewood/Error.h>
 #include <Pinewood/Window.h>
 
+#include <functional>
+
 namespace Pinewood
 {
 	struct HLContextCreateInfo
 	{
 		Window window;
 		uint32_t swapInterval = 0;
+		uint32_t framesInFlight = 2;		// Frames the CPU can be ahead of the GPU (see BeginFrame)
+		float targetFrameTime = 0.0f;		// In milliseconds, BeginFrame sleeps so frames don't start faster than this. 0 = no pacing
+	};
+
+	// Timings of the frame API (BeginFrame/EndFrame), in milliseconds
+	// GPU times and the latency are from the newest frame the GPU finished, which is framesInFlight frames behind
+	struct HLFrameStats
+	{
+		uint64_t frameIndex;		// Number of frames ended so far
+		double cpuFrameTime;		// BeginFrame to EndFrame of the last frame, without waiting and pacing
+		double frameInterval;		// Time between the last two BeginFrame calls
+		double gpuFrameTime;		// GPU time between the BeginFrame and EndFrame of the finished frame
+		double fenceWaitTime;		// Time the last BeginFrame waited on the GPU (GPU bound when this is high)
+		double pacingTime;			// Time the last BeginFrame slept for the target frame time
+		double latency;				// From the BeginFrame of the finished frame to the GPU finishing it
+		uint32_t queueDepth;		// Frames the GPU had not finished at the last EndFrame
 	};
 
 	// Context for high-level rendering APIs
 	class HLContext
 	{
 	public:
-		// OpenGL 4.5 native handle
-		using NativeHandle = struct { void* renderContext, * gl; };
+		// OpenGL 4.5 native handle, extensions are the backend's extensions loaded when the context was created
+		using NativeHandle = struct { void* renderContext, * gl, * extensions; };
 		
 		HLContext() = default;
 		HLContext(const HLContext&) = default;
@@ -30,6 +48,13 @@ namespace Pinewood
 		// Creates a context for a window
 		Result Create(const HLContextCreateInfo& createInfo);
 
+		// Creates a context without a window that shares buffers, textures, shader modules and programs with shareContext,
+		// so they can be created on another thread (see HLResourceLoader). Vertex bindings and framebuffers are not shared.
+		// The context isn't made current and has no frame API, make it current on the thread that uses it
+		// Params:
+		//  - shareContext = The context to share with.
+		Result CreateShared(const HLContext& shareContext);
+
 		// Destroys the context
 		Result Destroy();
 
@@ -40,6 +65,30 @@ namespace Pinewood
 		// NOTE: interval may have a maximum depending on API
 		Result SetSwapInterval(uint32_t interval);
 
+		// Starts a frame: waits until the GPU finished the frame that used this frame slot framesInFlight frames ago,
+		// runs its DeferUntilFrameFinished functions and sleeps for the target frame time.
+		// Everything between BeginFrame and EndFrame belongs to the frame, resources written by the CPU each frame
+		// should have framesInFlight copies indexed by GetFrameSlot
+		Result BeginFrame();
+
+		// Ends the frame: swaps the buffers and fences the frame's GPU work, doesn't wait for the GPU
+		Result EndFrame();
+
+		// The frame slot of the current frame, in [0, framesInFlight)
+		uint32_t GetFrameSlot();
+
+		// Calls function once the GPU finished the current frame (at a later BeginFrame), ex: to release per-frame transient resources
+		// Params:
+		//  - function = The function to call, with this context current.
+		Result DeferUntilFrameFinished(std::function<void()> function);
+
+		// Sets the target frame time (see HLContextCreateInfo::targetFrameTime)
+		// Params:
+		//  - targetFrameTime = In milliseconds, 0 disables pacing.
+		void SetTargetFrameTime(float targetFrameTime);
+
+		HLFrameStats GetFrameStats();
+
 		// Resize the swap chain (may change viewport and scissor settings)
 		Result ResizeSwapChain(uint16_t width, uint32_t height);
 
@@ -49,7 +98,7 @@ namespace Pinewood
 		//  - Each thread can has a separate current context
 		//  - The context must be current before any HLContext call (except Destroy)
 		//  - The context must be current before any HLRenderInterface
-		//  - The context can only be current on 1 thread at a time
+		//  - The context can only be current on 1 thread at a time, use CreateShared for other threads
 		Result MakeCurrent();
 
 		Result MakeObsolete();
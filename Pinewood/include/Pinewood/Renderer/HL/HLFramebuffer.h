@@ -51,6 +51,11 @@ namespace Pinewood
 		Result Create(const HLFramebufferCreateInfo& createInfo);
 		Result Destroy();
 
+		// Gets the size of the attachments
+		Result GetSize(uint32_t& widthOut, uint32_t& heightOut);
+
+		uint32_t GetSampleCount();
+
 		NativeHandle GetNativeHandle();
 
 		bool IsInitialized();
@@ -0,0 +1,82 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLBuffer.h>
+#include <Pinewood/Renderer/HL/HLRenderInterface.h>
+
+#include <span>
+
+// GPU culling
+// The bounds and draw parameters of every object live in a storage buffer on the GPU. Cull runs a compute shader that tests
+// every object against the frustum and appends the visible ones to a compacted indirect command buffer and a count buffer,
+// Draw draws them with one multi-draw-indirect. Neither touches the objects on the CPU, so their cost doesn't depend on the
+// object count. The baseInstance of a command is the index of its object: fetch per object data (ex: a transform) with an
+// instanced vertex attribute (instanceDivisor 1), it's offset by baseInstance.
+
+namespace Pinewood
+{
+	// An object, in the layout of the shader (std430)
+	struct HLGPUCullerObject
+	{
+		float center[3];		// Bounding sphere, in the space transformed by the view projection matrix given to Cull
+		float radius;
+		uint32_t indexCount;	// The draw, indices are read from the bound index buffer
+		uint32_t firstIndex;
+		int32_t baseVertex;
+		uint32_t padding;		// Unused, pads the object to 32 bytes
+	};
+
+	struct HLGPUCullerCreateInfo
+	{
+		HLRenderInterface renderInterface;
+		uint32_t maxObjectCount;
+	};
+
+	class HLGPUCuller
+	{
+	public:
+		HLGPUCuller() = default;
+		HLGPUCuller(const HLGPUCuller&) = default;
+		HLGPUCuller(HLGPUCuller&& rhs) noexcept :m_details(std::move(rhs.m_details)) {}
+		~HLGPUCuller() = default;
+
+		HLGPUCuller& operator=(const HLGPUCuller&) = default;
+		HLGPUCuller& operator=(HLGPUCuller&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
+
+		Result Create(const HLGPUCullerCreateInfo& createInfo);
+		Result Destroy();
+
+		// Uploads objects, the objects after them are kept
+		// Params:
+		//  - firstObject = The index of the first object to write.
+		//  - objects = The objects, firstObject + objects.size() can't be more than maxObjectCount.
+		Result SetObjects(uint32_t firstObject, std::span<const HLGPUCullerObject> objects);
+
+		// Sets how many of the uploaded objects are culled and drawn
+		Result SetObjectCount(uint32_t objectCount);
+
+		// Culls the objects against the frustum of a matrix, the commands are ready for Draw (and any other indirect draw) after it
+		// Params:
+		//  - viewProjection = The 16 floats of the matrix, as uploaded to a GLSL mat4 (ex: a PWMath::Matrix4x4F32).
+		Result Cull(const float (&viewProjection)[16]);
+
+		// Draws the visible objects of the last Cull with the bound program and vertex binding (which needs an index buffer)
+		Result Draw();
+
+		// The compacted HLDrawIndexedIndirectCommand of the visible objects. Without draw indirect count support every object has
+		// a command instead, at the index of the object, with an instanceCount of 0 if it's culled
+		HLBuffer GetCommandBuffer();
+
+		// The uint32_t number of visible objects
+		HLBuffer GetCountBuffer();
+
+		uint32_t GetObjectCount();
+
+		bool IsInitialized();
+
+	private:
+		class Details;
+
+		std::shared_ptr<Details> m_details;
+	};
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLContext.h>
+#include <Pinewood/Renderer/HL/HLBuffer.h>
+#include <Pinewood/Renderer/HL/HLLayout.h>
+#include <Pinewood/Renderer/HL/HLVertexBinding.h>
+
+#include <cstddef>
+#include <span>
+
+// Geometry heaps
+// A geometry heap holds the vertices and indices of many meshes in one vertex buffer and one index buffer, so they're all drawn
+// with one vertex binding (ex: by one multi-draw, see HLGPUCuller). Every mesh gets a range of vertices and a range of indices,
+// drawn with the baseVertex and firstIndex of its range: its indices start at 0 like the indices of a separate mesh.
+// Freed ranges are reused (best fit), Defragment moves the meshes together on the GPU when the free space is too fragmented.
+
+namespace Pinewood
+{
+	// A mesh of a heap
+	struct HLGeometryMesh
+	{
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0; // So the heap rejects the mesh after it's freed, even when its index is reused
+
+		bool IsValid() const { return index != UINT32_MAX; }
+	};
+
+	// Where a mesh is in the heap, changes when the heap is defragmented
+	struct HLGeometryRange
+	{
+		int32_t baseVertex;
+		uint32_t vertexCount;
+		uint32_t firstIndex;
+		uint32_t indexCount;
+	};
+
+	struct HLGeometryHeapCreateInfo
+	{
+		HLContext context;
+		HLLayout vertexLayout;						// Binding 0 reads the vertices of the heap
+		std::span<const HLBuffer> otherBuffers;		// The buffers of the other bindings of the layout (ex: per-instance data)
+		uint32_t vertexCapacity;					// In vertices, of the stride of binding 0
+		uint32_t indexCapacity;						// In 32 bit indices
+	};
+
+	struct HLGeometryHeapStats
+	{
+		uint32_t meshCount;
+		uint32_t usedVertices;
+		uint32_t largestFreeVertexRange;
+		uint32_t usedIndices;
+		uint32_t largestFreeIndexRange;
+		uint32_t freeRangeCount; // Of both buffers, 2 or less without fragmentation
+	};
+
+	class HLGeometryHeap
+	{
+	public:
+		HLGeometryHeap() = default;
+		HLGeometryHeap(const HLGeometryHeap&) = default;
+		HLGeometryHeap(HLGeometryHeap&& rhs) noexcept :m_details(std::move(rhs.m_details)) {}
+		~HLGeometryHeap() = default;
+
+		HLGeometryHeap& operator=(const HLGeometryHeap&) = default;
+		HLGeometryHeap& operator=(HLGeometryHeap&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
+
+		Result Create(const HLGeometryHeapCreateInfo& createInfo);
+		Result Destroy();
+
+		// Allocates the ranges of a mesh and uploads it
+		// NOTE: Returns Result::OutOfMemory if no free range is large enough, Defragment may make one
+		// Params:
+		//  - vertices = The vertices, in the layout of binding 0 (its size must be a multiple of the stride).
+		//  - indices = The indices, relative to the first vertex of the mesh.
+		//  - meshOut = The mesh.
+		Result Allocate(std::span<const std::byte> vertices, std::span<const uint32_t> indices, HLGeometryMesh& meshOut);
+
+		// Frees the ranges of a mesh, they can be reused right away: make sure the GPU doesn't draw it anymore
+		Result Free(HLGeometryMesh mesh);
+
+		// Replaces the vertices of a mesh, starting at a vertex of it
+		Result SetVertices(HLGeometryMesh mesh, uint32_t firstVertex, std::span<const std::byte> vertices);
+
+		// Moves the meshes to the start of the buffers on the GPU, so the free space is one range in each buffer
+		// NOTE: The ranges of the moved meshes change, get them again with GetRange (ex: to update the objects of a culler)
+		// Params:
+		//  - movedCountOut = The number of meshes that moved. Can be nullptr.
+		Result Defragment(uint32_t* movedCountOut = nullptr);
+
+		HLGeometryRange GetRange(HLGeometryMesh mesh);
+
+		// The binding of the heap's buffers, bind it once for all the meshes
+		HLVertexBinding GetVertexBinding();
+
+		HLBuffer GetVertexBuffer();
+		HLBuffer GetIndexBuffer();
+
+		HLGeometryHeapStats GetStats();
+
+		bool IsInitialized();
+
+	private:
+		class Details;
+
+		std::shared_ptr<Details> m_details;
+	};
+}
@@ -69,4 +69,21 @@ namespace Pinewood
 		// Depth + stencil formats
 		D24S8_UInt
 	};
+
+	// Returns the size of a pixel in bytes
+	constexpr uint32_t GetImageFormatSize(HLImageFormat format)
+	{
+		const auto value = static_cast<uint32_t>(format);
+		if (format == HLImageFormat::Unknown)
+			return 0;
+		if (value <= static_cast<uint32_t>(HLImageFormat::R8G8B8A8_SInt))
+			return (value - static_cast<uint32_t>(HLImageFormat::R8_UNorm)) % 4 + 1;
+		if (value <= static_cast<uint32_t>(HLImageFormat::R16G16B16A16_Float))
+			return ((value - static_cast<uint32_t>(HLImageFormat::R16_UNorm)) % 4 + 1) * 2;
+		if (value <= static_cast<uint32_t>(HLImageFormat::R32G32B32A32_Float))
+			return ((value - static_cast<uint32_t>(HLImageFormat::R32_UInt)) % 4 + 1) * 4;
+
+		// Every special and depth format is packed into 32 bits
+		return 4;
+	}
 }
@@ -38,6 +38,11 @@ namespace Pinewood
 		Vector3I32	= 0x62,
 		Vector4I32	= 0x63,
 
+		Float16		= 0x70,
+		Vector2F16	= 0x71,
+		Vector3F16	= 0x72,
+		Vector4F16	= 0x73,
+
 		Float32		= 0x80,
 		Vector2F32	= 0x81,
 		Vector3F32	= 0x82,
@@ -76,12 +81,16 @@ namespace Pinewood
 		uint32_t index;
 		uint32_t binding;
 		uint32_t instanceDivisor; // 0 means per-vertex data
+
+		bool operator==(const HLLayoutElement&) const = default;
 	};
 
 	struct HLLayoutBinding
 	{
 		uint32_t offset;
 		uint32_t stride;
+
+		bool operator==(const HLLayoutBinding&) const = default;
 	};
 
 	struct HLLayoutCreateInfo
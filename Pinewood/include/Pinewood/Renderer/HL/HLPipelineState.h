@@ -0,0 +1,203 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/EnumSupport.h>
+#include <Pinewood/Renderer/HL/HLContext.h>
+#include <Pinewood/Renderer/HL/HLLayout.h>
+#include <Pinewood/Renderer/HL/HLShaderProgram.h>
+
+// Pipeline states
+// A pipeline state bundles a shader program, the vertex layout it's drawn with and the fixed function state (blending, depth,
+// stencil and rasterization). States are immutable and deduplicated when they are created: creating a state equal to a live one
+// returns the same state, so the sort key identifies the state. HLRenderInterface::BindPipelineState only sets what differs from
+// the state that's bound. The default values of the structs are the defaults of the rendering API.
+
+namespace Pinewood
+{
+	enum class HLCompareOp : uint32_t
+	{
+		Never,
+		Less,
+		Equal,
+		LessEqual,
+		Greater,
+		NotEqual,
+		GreaterEqual,
+		Always
+	};
+
+	enum class HLBlendFactor : uint32_t
+	{
+		Zero,
+		One,
+		SourceColor,
+		OneMinusSourceColor,
+		DestinationColor,
+		OneMinusDestinationColor,
+		SourceAlpha,
+		OneMinusSourceAlpha,
+		DestinationAlpha,
+		OneMinusDestinationAlpha
+	};
+
+	enum class HLBlendOp : uint32_t
+	{
+		Add,
+		Subtract,			// Source - destination
+		ReverseSubtract,	// Destination - source
+		Min,				// The factors are ignored
+		Max
+	};
+
+	enum class HLStencilOp : uint32_t
+	{
+		Keep,
+		Zero,
+		Replace,
+		Increment,		// Clamps
+		IncrementWrap,
+		Decrement,		// Clamps
+		DecrementWrap,
+		Invert
+	};
+
+	enum class HLCullMode : uint32_t
+	{
+		None,
+		Front,
+		Back
+	};
+
+	enum class HLFrontFace : uint32_t
+	{
+		CounterClockwise,
+		Clockwise
+	};
+
+	enum class HLColorWriteMask : uint32_t
+	{
+		None	= 0x0,
+		Red		= 0x1,
+		Green	= 0x2,
+		Blue	= 0x4,
+		Alpha	= 0x8,
+		All		= 0xf
+	};
+
+	namespace Operators
+	{
+		PW_DEFINE_ENUMCLASS_OPERATOR_OR(HLColorWriteMask);
+		PW_DEFINE_ENUMCLASS_OPERATOR_AND(HLColorWriteMask);
+		PW_DEFINE_ENUMCLASS_OPERATOR_NOT(HLColorWriteMask);
+	}
+
+	// Blending of every color attachment
+	struct HLBlendState
+	{
+		bool enable = false;
+		HLBlendFactor sourceColor = HLBlendFactor::One;
+		HLBlendFactor destinationColor = HLBlendFactor::Zero;
+		HLBlendOp colorOp = HLBlendOp::Add;
+		HLBlendFactor sourceAlpha = HLBlendFactor::One;
+		HLBlendFactor destinationAlpha = HLBlendFactor::Zero;
+		HLBlendOp alphaOp = HLBlendOp::Add;
+		HLColorWriteMask writeMask = HLColorWriteMask::All; // Also applies when blending is disabled
+
+		bool operator==(const HLBlendState&) const = default;
+	};
+
+	struct HLDepthState
+	{
+		bool testEnable = false;
+		bool writeEnable = true; // Only when the test is enabled
+		HLCompareOp compareOp = HLCompareOp::Less;
+
+		bool operator==(const HLDepthState&) const = default;
+	};
+
+	struct HLStencilFaceState
+	{
+		HLStencilOp failOp = HLStencilOp::Keep;			// The stencil test failed
+		HLStencilOp depthFailOp = HLStencilOp::Keep;	// The stencil test passed, the depth test failed
+		HLStencilOp passOp = HLStencilOp::Keep;
+		HLCompareOp compareOp = HLCompareOp::Always;
+
+		bool operator==(const HLStencilFaceState&) const = default;
+	};
+
+	struct HLStencilState
+	{
+		bool testEnable = false;
+		HLStencilFaceState front;
+		HLStencilFaceState back;
+		uint8_t readMask = 0xff;
+		uint8_t writeMask = 0xff;
+		uint8_t reference = 0;
+
+		bool operator==(const HLStencilState&) const = default;
+	};
+
+	struct HLRasterState
+	{
+		HLCullMode cullMode = HLCullMode::None;
+		HLFrontFace frontFace = HLFrontFace::CounterClockwise;
+		bool scissorEnable = false;		// The rectangle is set with HLRenderInterface::SetScissor
+		bool wireframe = false;
+		float depthBiasConstant = 0.0f;	// In units of the smallest depth difference
+		float depthBiasSlope = 0.0f;	// Scaled by the depth slope of the triangle
+
+		bool operator==(const HLRasterState&) const = default;
+	};
+
+	// The fixed function part of a pipeline state
+	struct HLRenderState
+	{
+		HLBlendState blend;
+		HLDepthState depth;
+		HLStencilState stencil;
+		HLRasterState raster;
+
+		bool operator==(const HLRenderState&) const = default;
+	};
+
+	struct HLPipelineStateCreateInfo
+	{
+		HLContext context;
+		HLShaderProgram program;
+		HLLayout layout; // The layout of the vertex bindings drawn with the state, can be left uninitialized (ex: no vertex buffers)
+		HLRenderState renderState;
+	};
+
+	class HLPipelineState
+	{
+	public:
+		HLPipelineState() = default;
+		HLPipelineState(const HLPipelineState&) = default;
+		HLPipelineState(HLPipelineState&& rhs) noexcept :m_details(std::move(rhs.m_details)) {}
+		~HLPipelineState() = default;
+
+		HLPipelineState& operator=(const HLPipelineState&) = default;
+		HLPipelineState& operator=(HLPipelineState&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
+
+		// Gets the live state equal to the create info, creates it if there is none
+		Result Create(const HLPipelineStateCreateInfo& createInfo);
+
+		// Releases the state, it's destroyed with its last reference
+		Result Destroy();
+
+		HLShaderProgram GetProgram();
+		HLLayout GetLayout();
+		const HLRenderState& GetRenderState();
+
+		// Unique for every live state, and states with the same program are next to each other when sorted by it
+		// (ex: to sort draws by material)
+		uint64_t GetSortKey();
+
+		bool IsInitialized();
+
+	private:
+		class Details;
+
+		std::shared_ptr<Details> m_details;
+	};
+}
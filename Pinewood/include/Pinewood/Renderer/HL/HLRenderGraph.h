@@ -0,0 +1,158 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLBuffer.h>
+#include <Pinewood/Renderer/HL/HLTexture2D.h>
+#include <Pinewood/Renderer/HL/HLFramebuffer.h>
+#include <Pinewood/Renderer/HL/HLRenderInterface.h>
+#include <Pinewood/Renderer/HL/HLRenderTargetPool.h>
+
+#include <functional>
+
+// Render graph
+// The graph is built every frame: passes declare which textures and buffers they read and write, Execute culls the passes
+// nothing depends on, gets the transient textures from the render target pool for exactly the passes that use them (so
+// textures with lifetimes that don't overlap alias), binds a framebuffer with the pass's attachments and runs the pass.
+// Passes run in the order they were added, every pass is a CPU and a GPU profiler zone with the pass name (unless PW_DISABLE_PROFILER
+// is defined).
+
+namespace Pinewood
+{
+	class HLRenderGraph;
+
+	// A virtual texture or buffer of the graph, only valid until the graph executed
+	struct HLRenderGraphResource
+	{
+		uint32_t index = UINT32_MAX;
+
+		bool IsValid() const { return index != UINT32_MAX; }
+	};
+
+	// Passed to the execute function of a pass
+	class HLRenderGraphPassContext
+	{
+	public:
+		HLRenderInterface& GetRenderInterface();
+
+		// Gets the texture of a resource the pass reads or writes
+		HLTexture2D GetTexture(HLRenderGraphResource resource);
+
+		// Gets the buffer of a resource the pass reads or writes
+		HLBuffer GetBuffer(HLRenderGraphResource resource);
+
+		// Gets the framebuffer the graph bound for the pass, not initialized for the backbuffer (ex: to resolve into it)
+		HLFramebuffer GetFramebuffer();
+
+		// Gets a cached framebuffer with a texture the pass reads as its only color attachment (ex: to resolve or blit from it)
+		// Params:
+		//  - resource = The texture.
+		HLFramebuffer GetReadFramebuffer(HLRenderGraphResource resource);
+
+	private:
+		friend class HLRenderGraph;
+
+		HLRenderGraphPassContext(HLRenderGraph& graph) :m_graph(graph) {}
+
+		HLRenderGraph& m_graph;
+	};
+
+	// Declares the resources of a pass, returned by HLRenderGraph::AddPass
+	class HLRenderGraphPassBuilder
+	{
+	public:
+		// The pass samples or reads the resource
+		HLRenderGraphPassBuilder& Read(HLRenderGraphResource resource);
+
+		// The pass writes the resource
+		// Params:
+		//  - resource = The resource.
+		//  - attachment = Where to attach a texture to the pass's framebuffer, Null if it isn't rendered to (ex: written by a compute shader).
+		HLRenderGraphPassBuilder& Write(HLRenderGraphResource resource, HLFramebufferAttachment attachment = HLFramebufferAttachment::Null);
+
+		// The pass is never culled, for passes with effects outside of the graph (ex: reading back to the CPU)
+		HLRenderGraphPassBuilder& KeepAlive();
+
+	private:
+		friend class HLRenderGraph;
+
+		HLRenderGraphPassBuilder(HLRenderGraph& graph, uint32_t pass) :m_graph(graph), m_pass(pass) {}
+
+		HLRenderGraph& m_graph;
+		uint32_t m_pass;
+	};
+
+	struct HLRenderGraphCreateInfo
+	{
+		HLRenderInterface renderInterface;
+		HLRenderTargetPool renderTargetPool;	// The transient textures are acquired from it
+	};
+
+	// Counts of the last Execute
+	struct HLRenderGraphStats
+	{
+		uint32_t passCount;
+		uint32_t culledPassCount;
+		uint32_t transientTextureCount;
+	};
+
+	class HLRenderGraph
+	{
+	public:
+		using ExecuteFunction = std::function<void(HLRenderGraphPassContext& context)>;
+
+		HLRenderGraph() = default;
+		HLRenderGraph(const HLRenderGraph&) = default;
+		HLRenderGraph(HLRenderGraph&& rhs) noexcept :m_details(std::move(rhs.m_details)) {}
+		~HLRenderGraph() = default;
+
+		HLRenderGraph& operator=(const HLRenderGraph&) = default;
+		HLRenderGraph& operator=(HLRenderGraph&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
+
+		Result Create(const HLRenderGraphCreateInfo& createInfo);
+		Result Destroy();
+
+		// Declares a transient texture, it only exists from the first to the last pass that uses it
+		// Params:
+		//  - name = The name of the texture, must outlive the graph (ex: a string literal).
+		//  - desc = The size and format of the texture.
+		HLRenderGraphResource CreateTexture(const char* name, const HLRenderTargetDesc& desc);
+
+		// Adds a texture from outside of the graph, passes that write it are never culled
+		// Params:
+		//  - name = The name of the texture, must outlive the graph (ex: a string literal).
+		//  - texture = The texture.
+		HLRenderGraphResource ImportTexture(const char* name, const HLTexture2D& texture);
+
+		// Adds a buffer from outside of the graph, passes that write it are never culled
+		// Params:
+		//  - name = The name of the buffer, must outlive the graph (ex: a string literal).
+		//  - buffer = The buffer.
+		HLRenderGraphResource ImportBuffer(const char* name, const HLBuffer& buffer);
+
+		// Adds the default framebuffer, write it as Color0 to render to the window
+		// Params:
+		//  - name = The name of the backbuffer, must outlive the graph (ex: a string literal).
+		HLRenderGraphResource ImportBackbuffer(const char* name);
+
+		// Adds a pass, declare its resources with the returned builder
+		// Params:
+		//  - name = The name of the pass and its profiler zones, must outlive the profiler (ex: a string literal).
+		//  - execute = Records the pass, the pass's framebuffer is already bound.
+		HLRenderGraphPassBuilder AddPass(const char* name, ExecuteFunction execute);
+
+		// Culls the unused passes, runs the others and clears the graph for the next frame
+		Result Execute();
+
+		HLRenderGraphStats GetStats();
+
+		bool IsInitialized();
+
+	private:
+		friend class HLRenderGraphPassContext;
+		friend class HLRenderGraphPassBuilder;
+
+		class Details;
+
+		std::shared_ptr<Details> m_details;
+	};
+}
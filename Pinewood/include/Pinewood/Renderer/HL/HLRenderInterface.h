@@ -2,11 +2,17 @@
 #include <Pinewood/Core.h>
 #include <Pinewood/Error.h>
 #include <Pinewood/EnumSupport.h>
+#include <Pinewood/Profiler.h>
 #include <Pinewood/Renderer/HL/HLContext.h>
+#include <Pinewood/Renderer/HL/HLBuffer.h>
 #include <Pinewood/Renderer/HL/HLVertexBinding.h>
 #include <Pinewood/Renderer/HL/HLShaderProgram.h>
 #include <Pinewood/Renderer/HL/HLTexture2D.h>
+#include <Pinewood/Renderer/HL/HLTexture2DArray.h>
+#include <Pinewood/Renderer/HL/HLSampler.h>
 #include <Pinewood/Renderer/HL/HLFramebuffer.h>
+#include <Pinewood/Renderer/HL/HLPipelineState.h>
+#include <Pinewood/Renderer/HL/HLRenderStats.h>
 
 namespace Pinewood
 {
@@ -17,13 +23,59 @@ namespace Pinewood
 		Stencil	= 0x04
 	};
 
+	// What has to see the writes of compute shaders (storage buffers and images) before the next commands, see Barrier
+	enum class HLBarrierFlags : uint32_t
+	{
+		VertexBuffer	= 0x001,
+		IndexBuffer		= 0x002,
+		ConstantBuffer	= 0x004,
+		Texture			= 0x008,	// Sampling
+		Image			= 0x010,	// Image load/store
+		IndirectBuffer	= 0x020,	// DispatchIndirect and indirect draws
+		BufferTransfer	= 0x040,	// HLBuffer::SetData/GetData
+		BufferMapping	= 0x080,	// HLBuffer::Map
+		TextureTransfer	= 0x100,	// HLTexture2D::SetImage/GetImage
+		Framebuffer		= 0x200,
+		StorageBuffer	= 0x400,
+		All				= 0x7ff
+	};
+
 	namespace Operators
 	{
 		PW_DEFINE_ENUMCLASS_OPERATOR_OR(ClearTargetFlags);
 		PW_DEFINE_ENUMCLASS_OPERATOR_AND(ClearTargetFlags);
 		PW_DEFINE_ENUMCLASS_OPERATOR_NOT(ClearTargetFlags);
+
+		PW_DEFINE_ENUMCLASS_OPERATOR_OR(HLBarrierFlags);
+		PW_DEFINE_ENUMCLASS_OPERATOR_AND(HLBarrierFlags);
+		PW_DEFINE_ENUMCLASS_OPERATOR_NOT(HLBarrierFlags);
 	}
 
+	// A rectangle in pixels, x1 and y1 are exclusive. Flipping x0 and x1 (or y0 and y1) mirrors a blit
+	struct HLBlitRegion
+	{
+		int32_t x0, y0, x1, y1;
+	};
+
+	// The memory of the GPU reported by the driver, in bytes
+	struct HLMemoryInfo
+	{
+		uint64_t totalMemory;		// The dedicated memory, 0 if the driver only reports the available memory
+		uint64_t availableMemory;
+	};
+
+	class HLResidencyManager;
+
+	// The layout of an indexed indirect draw in a command buffer (DrawElementsIndirectCommand in OpenGL), 20 bytes
+	struct HLDrawIndexedIndirectCommand
+	{
+		uint32_t indexCount;
+		uint32_t instanceCount;	// 0 skips the draw
+		uint32_t firstIndex;
+		int32_t baseVertex;
+		uint32_t baseInstance;	// Offsets the instanced attributes (instanceDivisor > 0)
+	};
+
 	struct HLRenderInterfaceCreateInfo
 	{
 		HLContext context;
@@ -53,7 +105,7 @@ namespace Pinewood
 		// Sets the stencil value for clear target (behavior for values above the maximum are undefined)
 		Result SetClearStencil(uint32_t stencil);
 		
-		// Clears the render target
+		// Clears the render target, the whole target is cleared whatever the bound pipeline state's write masks and scissor
 		Result ClearTarget(ClearTargetFlags flags);
 
 		// Binds a vertex binding for rending
@@ -62,24 +114,154 @@ namespace Pinewood
 		// Binds a vertex binding for rending
 		Result BindShaderProgram(const HLShaderProgram& program);
 
+		// Binds the program and the fixed function state of a pipeline state, only the state that differs from the last
+		// pipeline state is set (state changed with the native handles isn't tracked)
+		// Params:
+		//  - pipelineState = The pipeline state, bind the vertex bindings drawn with it separately.
+		Result BindPipelineState(const HLPipelineState& pipelineState);
+
+		// Sets the rectangle that's rendered to, in pixels from the bottom left corner of the framebuffer
+		Result SetViewport(int32_t x, int32_t y, uint32_t width, uint32_t height);
+
+		// Sets the scissor rectangle, only used by pipeline states with scissorEnable
+		Result SetScissor(int32_t x, int32_t y, uint32_t width, uint32_t height);
+
 		// Sets a constant buffer
 		Result SetConstantBuffer(uint32_t index, const HLBuffer& buffer);
 
-		// Sets a texture
+		// Sets a texture, sampled with its own filter and wrap mode
 		Result SetTexture2D(uint32_t location, uint32_t slot, const HLTexture2D& texture);
 
+		// Sets a texture with a sampler, the sampler replaces the filter and wrap mode of the texture
+		Result SetTexture2D(uint32_t location, uint32_t slot, const HLTexture2D& texture, const HLSampler& sampler);
+
+		// Sets a texture array (a sampler2DArray in GLSL), sampled with its own filter and wrap mode
+		Result SetTexture2DArray(uint32_t location, uint32_t slot, const HLTexture2DArray& textures);
+
+		// Sets a texture array with a sampler, the sampler replaces the filter and wrap mode of the textures
+		Result SetTexture2DArray(uint32_t location, uint32_t slot, const HLTexture2DArray& textures, const HLSampler& sampler);
+
+		// Sets a storage buffer (a 'buffer' block with 'layout(binding = index)' in GLSL)
+		// Params:
+		//  - index = The binding of the block.
+		//  - buffer = The buffer.
+		//  - offset = The start of the range, a multiple of GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT (at most 256).
+		//  - size = The size of the range, 0 for the rest of the buffer.
+		Result SetStorageBuffer(uint32_t index, const HLBuffer& buffer, size_t offset = 0, size_t size = 0);
+
+		// Sets an image for image load/store ('layout(binding = unit, <format>) uniform image2D' in GLSL)
+		// NOTE: Formats with 3 channels (ex: R8G8B8_UNorm) can't be used as images
+		// Params:
+		//  - unit = The image unit.
+		//  - texture = The texture, can't be multisampled.
+		//  - access = Read, Write or both.
+		//  - mipLevel = The mip to bind.
+		Result SetImage2D(uint32_t unit, const HLTexture2D& texture, HLBufferAccess access, uint32_t mipLevel = 0);
+
 		// Draws using the vertex buffer
 		Result Draw(uint32_t startIndex, uint32_t count);
 
 		// Draws using the index buffer and the vertex buffer
 		Result DrawIndexed(uint32_t count);
 
+		// Draws the commands of a buffer with the bound index buffer and vertex buffer in one call
+		// Params:
+		//  - commandBuffer = The buffer with tightly packed HLDrawIndexedIndirectCommand.
+		//  - offset = The offset of the first command in the buffer, a multiple of 4.
+		//  - drawCount = The number of commands to draw.
+		Result DrawIndexedIndirect(const HLBuffer& commandBuffer, size_t offset, uint32_t drawCount);
+
+		// Draws the commands of a buffer with the number of commands read from another buffer, ex: written by a compute shader
+		// NOTE: Without driver support (see IsDrawIndirectCountSupported) all maxDrawCount commands are drawn, the commands past
+		// the count must have an instanceCount of 0
+		// Params:
+		//  - commandBuffer = The buffer with tightly packed HLDrawIndexedIndirectCommand.
+		//  - offset = The offset of the first command in the buffer, a multiple of 4.
+		//  - countBuffer = The buffer with the uint32_t number of commands.
+		//  - countOffset = The offset of the number of commands in the buffer, a multiple of 4.
+		//  - maxDrawCount = The most commands drawn.
+		Result DrawIndexedIndirectCount(const HLBuffer& commandBuffer, size_t offset, const HLBuffer& countBuffer, size_t countOffset, uint32_t maxDrawCount);
+
+		// Whether DrawIndexedIndirectCount reads the count on the GPU (OpenGL 4.6 or GL_ARB_indirect_parameters)
+		bool IsDrawIndirectCountSupported();
+
+		// Whether textures can be sampled through handles in buffers (GL_ARB_bindless_texture), see HLTextureTable
+		bool IsBindlessTextureSupported();
+
+		// Whether shader modules can be created from SPIR-V (OpenGL 4.6 or GL_ARB_gl_spirv), see HLShaderModuleCreateInfo::spirv
+		bool IsSpirVSupported();
+
+		// Gets the memory of the GPU
+		// NOTE: Returns Result::Unsupported if the driver doesn't report it (GL_NVX_gpu_memory_info or GL_ATI_meminfo)
+		Result GetMemoryInfo(HLMemoryInfo& infoOut);
+
+		// Sets the manager that the binds of textures and buffers mark the resources used in, an uninitialized manager stops it
+		Result SetResidencyManager(const HLResidencyManager& manager);
+
+		// Gets the manager set by SetResidencyManager, uninitialized if none is set
+		HLResidencyManager GetResidencyManager();
+
+		// Runs the bound compute program
+		// Params:
+		//  - groupCountX = The number of work groups in x (the work group size is set by the shader).
+		//  - groupCountY = The number of work groups in y.
+		//  - groupCountZ = The number of work groups in z.
+		Result Dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1);
+
+		// Runs the bound compute program with the group counts read from a buffer, ex: written by an earlier dispatch
+		// Params:
+		//  - buffer = The buffer with 3 uint32_t group counts.
+		//  - offset = The offset of the group counts in the buffer, a multiple of 4.
+		Result DispatchIndirect(const HLBuffer& buffer, size_t offset = 0);
+
+		// Makes the writes of earlier shaders to storage buffers and images visible to the commands after it
+		// Params:
+		//  - flags = How the written data is used next.
+		Result Barrier(HLBarrierFlags flags);
+
 		// Sets the framebuffer
 		Result SetFramebuffer(const HLFramebuffer& framebuffer);
 
 		// Use default framebuffer
 		Result ResetFramebuffer();
 
+		// Copies a region from one framebuffer to another, scaling it if the regions differ in size.
+		// A framebuffer that isn't initialized (HLFramebuffer{}) is the default framebuffer.
+		// Params:
+		//  - source = The framebuffer to read, color is read from its first color attachment.
+		//  - sourceRegion = The region to read.
+		//  - destination = The framebuffer to write.
+		//  - destinationRegion = The region to write.
+		//  - flags = The buffers to copy.
+		//  - filter = Linear is only allowed for color, and when the source isn't multisampled.
+		Result BlitFramebuffer(const HLFramebuffer& source, const HLBlitRegion& sourceRegion, const HLFramebuffer& destination,
+			const HLBlitRegion& destinationRegion, ClearTargetFlags flags, HLTextureFilter filter = HLTextureFilter::Nearest);
+
+		// Resolves a multisampled framebuffer into a single sampled one with the same size and formats
+		// Params:
+		//  - source = The multisampled framebuffer.
+		//  - destination = The framebuffer to write, can be the default framebuffer (HLFramebuffer{}, must be the size of the source).
+		//  - flags = The buffers to resolve, depth and stencil take one of the samples.
+		Result Resolve(const HLFramebuffer& source, const HLFramebuffer& destination, ClearTargetFlags flags = ClearTargetFlags::Color);
+
+		// Starts a GPU profiler zone (timestamp queries), zones can be nested
+		// Params:
+		//  - name = The name of the zone, must outlive the profiler (ex: a string literal).
+		Result BeginGPUZone(const char* name);
+
+		// Ends the last GPU profiler zone that was started
+		Result EndGPUZone();
+
+		// Submits the GPU zones that finished to the profiler, call once per frame
+		// Results are read a few frames late, this never waits on the GPU
+		Result CollectGPUZones();
+
+		// Gets the renderer counters of the process, they count every context and render interface (not only this one)
+		static HLRenderStats GetGlobalStats();
+
+		// Resets the per frame counters of the global stats (live resources and memory are kept), call once per frame
+		static Result ResetGlobalStats();
+
 
 		HLContext GetContext();
 
@@ -92,4 +274,25 @@ namespace Pinewood
 
 		std::shared_ptr<Details> m_details;
 	};
+
+	// Measures the GPU time of the commands until the end of the scope
+	class HLGPUProfilerScope
+	{
+	public:
+		HLGPUProfilerScope(HLRenderInterface& renderInterface, const char* name) :m_renderInterface(renderInterface) { m_renderInterface.BeginGPUZone(name); }
+		~HLGPUProfilerScope() { m_renderInterface.EndGPUZone(); }
+
+		HLGPUProfilerScope(const HLGPUProfilerScope&) = delete;
+		HLGPUProfilerScope& operator=(const HLGPUProfilerScope&) = delete;
+
+	private:
+		HLRenderInterface& m_renderInterface;
+	};
 }
+
+#ifndef PW_DISABLE_PROFILER
+// Measures the GPU time of the rest of the scope, name must be a string literal
+#define PW_PROFILE_GPU_SCOPE(renderInterface, name) ::Pinewood::HLGPUProfilerScope PW_PROFILER_CONCAT(pwGPUProfilerScope, __LINE__){ renderInterface, name }
+#else // ^^^ !PW_DISABLE_PROFILER // PW_DISABLE_PROFILER vvv
+#define PW_PROFILE_GPU_SCOPE(renderInterface, name)
+#endif // ^^^ PW_DISABLE_PROFILER
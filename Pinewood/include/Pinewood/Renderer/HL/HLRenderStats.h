@@ -0,0 +1,51 @@
+#pragma once
+#include <Pinewood/Core.h>
+
+#include <array>
+
+namespace Pinewood
+{
+	enum class HLResourceType : uint32_t
+	{
+		Buffer,
+		Texture2D,
+		Texture2DArray,
+		Framebuffer,
+		ShaderModule,
+		ShaderProgram,
+		VertexBinding,
+		Sampler,
+
+		Count
+	};
+
+	// Renderer counters of the whole process, every context and render interface adds to the same ones (see
+	// HLRenderInterface::GetGlobalStats, define PW_DISABLE_RENDER_STATS to compile the counting out)
+	struct HLRenderStats
+	{
+		// Counted since the last reset (usually once per frame)
+		uint64_t drawCalls;
+		uint64_t triangles;
+		uint64_t dispatches;
+		uint64_t programBinds;
+		uint64_t pipelineStateBinds;	// HLRenderInterface::BindPipelineState, without the redundant ones
+		uint64_t renderStateChanges;	// Fixed function state changes made by BindPipelineState
+		uint64_t vertexBindingBinds;	// Without the redundant ones
+		uint64_t vertexBufferBinds;		// HLVertexBinding::SetBuffers, without the redundant ones
+		uint64_t textureBinds;
+		uint64_t samplerBinds;			// Sampler changes made by HLRenderInterface::SetTexture2D
+		uint64_t constantBufferBinds;
+		uint64_t storageBufferBinds;	// HLRenderInterface::SetStorageBuffer
+		uint64_t framebufferBinds;
+		uint64_t framebufferBlits;		// HLRenderInterface::BlitFramebuffer and Resolve
+		uint64_t bufferUploadBytes;		// HLBuffer::SetData
+		uint64_t textureUploadBytes;	// HLTexture2D::SetImage, HLTexture2DArray::SetImage
+		uint64_t mappedBytes;			// HLBuffer::Map
+		uint64_t resourcesCreated;
+		uint64_t resourcesDestroyed;
+
+		// Current totals, never reset (index with HLResourceType)
+		std::array<uint64_t, static_cast<size_t>(HLResourceType::Count)> liveResources;
+		std::array<uint64_t, static_cast<size_t>(HLResourceType::Count)> liveMemory; // Estimated from the sizes and formats, drivers may pad
+	};
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLContext.h>
+#include <Pinewood/Renderer/HL/HLTexture2D.h>
+#include <Pinewood/Renderer/HL/HLFramebuffer.h>
+
+#include <span>
+
+// Render target pool
+// Passes acquire transient render targets when they start writing them and release them after the last pass read them.
+// A released target goes back to the pool and is handed to the next pass that asks for the same size and format, even in the
+// same frame (commands run in order, so targets with lifetimes that don't overlap alias the same memory). Framebuffers are
+// cached by their attachments, and targets and framebuffers that weren't used for a few frames are destroyed.
+
+namespace Pinewood
+{
+	struct HLRenderTargetDesc
+	{
+		uint32_t width, height;
+		HLImageFormat format;
+		uint32_t samples = 1; // > 1 for multisampled targets
+		HLTextureFilter sampleFilter = HLTextureFilter::Nearest;
+	};
+
+	struct HLRenderTargetPoolCreateInfo
+	{
+		HLContext context;
+		uint32_t maxUnusedFrames = 3; // Targets and framebuffers that weren't used for this many frames are destroyed in EndFrame
+	};
+
+	struct HLRenderTargetPoolStats
+	{
+		uint32_t targetCount;		// Targets in the pool, acquired or not
+		uint32_t acquiredCount;		// Targets currently acquired
+		uint32_t peakAcquiredCount;	// The most targets that were acquired at once in the last frame
+		uint32_t framebufferCount;	// Cached framebuffers
+		uint64_t memorySize;		// Memory of the targets in the pool, in bytes
+		uint64_t targetsCreated;	// Since the pool was created, stays flat once the pool warmed up
+		uint64_t framebuffersCreated;
+	};
+
+	class HLRenderTargetPool
+	{
+	public:
+		HLRenderTargetPool() = default;
+		HLRenderTargetPool(const HLRenderTargetPool&) = default;
+		HLRenderTargetPool(HLRenderTargetPool&& rhs) noexcept :m_details(std::move(rhs.m_details)) {}
+		~HLRenderTargetPool() = default;
+
+		HLRenderTargetPool& operator=(const HLRenderTargetPool&) = default;
+		HLRenderTargetPool& operator=(HLRenderTargetPool&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
+
+		Result Create(const HLRenderTargetPoolCreateInfo& createInfo);
+
+		// Destroys every target and framebuffer of the pool, including the acquired ones
+		Result Destroy();
+
+		// Acquires a target that isn't acquired by another pass, creates one if there is none with the same description
+		// Params:
+		//  - desc = The size and format of the target.
+		//  - textureOut = Receives the target, its contents are undefined.
+		Result Acquire(const HLRenderTargetDesc& desc, HLTexture2D& textureOut);
+
+		// Gives a target back to the pool once the last pass that reads it was recorded
+		// Params:
+		//  - texture = A target from Acquire.
+		Result Release(const HLTexture2D& texture);
+
+		// Gets a cached framebuffer with these attachments, creates it if there is none
+		// Params:
+		//  - textures = The textures to attach, can be pool targets or any other texture.
+		//  - attachments = The attachment point of each texture.
+		//  - framebufferOut = Receives the framebuffer, don't destroy it.
+		Result GetFramebuffer(std::span<HLTexture2D> textures, std::span<HLFramebufferAttachment> attachments, HLFramebuffer& framebufferOut);
+
+		// Ages the targets and framebuffers and destroys those that weren't used for maxUnusedFrames frames, call once per frame
+		void EndFrame();
+
+		HLRenderTargetPoolStats GetStats();
+
+		bool IsInitialized();
+
+	private:
+		class Details;
+
+		std::shared_ptr<Details> m_details;
+	};
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLRenderInterface.h>
+#include <Pinewood/Renderer/HL/HLBuffer.h>
+#include <Pinewood/Renderer/HL/HLTexture2D.h>
+#include <Pinewood/Renderer/HL/HLTexture2DArray.h>
+
+#include <functional>
+
+// Residency manager
+// Keeps the GPU memory of the HL resources under a budget. The memory used is the memory of every live HL resource (see
+// HLRenderStats::liveMemory, estimated from the sizes, formats and mip chains). Registered resources get the frame they were
+// last used in, from the binds of the render interfaces that use the manager (see HLRenderInterface::SetResidencyManager) or
+// from Touch. When the memory is over the budget, Update evicts the streamable resources (registered with an evict function)
+// that weren't used for the longest time, and Touch reloads an evicted resource when it's needed again.
+// The budget is set, or a fraction of the memory the driver reports (GL_NVX_gpu_memory_info or GL_ATI_meminfo). Set it to test
+// eviction with drivers that don't report their memory (ex: software renderers).
+
+namespace Pinewood
+{
+	// A resource of a residency manager
+	struct HLResidentResource
+	{
+		uint32_t index = UINT32_MAX;
+		uint32_t generation = 0; // So the manager rejects the resource after it's unregistered, even when its index is reused
+
+		bool IsValid() const { return index != UINT32_MAX; }
+	};
+
+	// How a streamable resource is evicted and reloaded
+	struct HLResidencyStreamInfo
+	{
+		std::function<void()> evict;	// Destroys the resource (ex: HLTexture2D::Destroy), nullptr if it's never evicted
+		std::function<void()> reload;	// Loads it again (ex: with HLResourceLoader), then call SetReloaded with the new resource
+	};
+
+	struct HLResidencyManagerCreateInfo
+	{
+		HLRenderInterface renderInterface;	// Reports the memory of the driver
+		uint64_t budget = 0;				// In bytes, 0 for budgetFraction of the driver's memory (no eviction if it isn't reported)
+		float budgetFraction = 0.8f;
+		uint32_t keepFrames = 2;			// Resources used in the last frames aren't evicted, the GPU may still read them
+	};
+
+	struct HLResidencyStats
+	{
+		uint64_t budget;
+		uint64_t usedMemory;		// Of every live HL resource
+		uint64_t registeredMemory;	// Of the resident registered resources
+		uint32_t residentCount;
+		uint32_t evictedCount;		// Includes the ones that are reloading
+		uint64_t evictions;			// Since Create
+		uint64_t reloads;			// Since Create
+	};
+
+	class HLResidencyManager
+	{
+	public:
+		HLResidencyManager() = default;
+		HLResidencyManager(const HLResidencyManager&) = default;
+		HLResidencyManager(HLResidencyManager&& rhs) noexcept :m_details(std::move(rhs.m_details)) {}
+		~HLResidencyManager() = default;
+
+		HLResidencyManager& operator=(const HLResidencyManager&) = default;
+		HLResidencyManager& operator=(HLResidencyManager&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
+
+		Result Create(const HLResidencyManagerCreateInfo& createInfo);
+		Result Destroy();
+
+		// Registers a resource, it's used in the current frame
+		// NOTE: Unregister a resource before destroying it (other than with the evict function)
+		// Params:
+		//  - texture = The resource.
+		//  - resourceOut = The resource in the manager.
+		//  - streamInfo = How the resource is evicted and reloaded, a resource without an evict function is always resident.
+		Result Register(const HLTexture2D& texture, HLResidentResource& resourceOut, HLResidencyStreamInfo streamInfo = {});
+		Result Register(const HLTexture2DArray& textures, HLResidentResource& resourceOut, HLResidencyStreamInfo streamInfo = {});
+		Result Register(const HLBuffer& buffer, HLResidentResource& resourceOut, HLResidencyStreamInfo streamInfo = {});
+
+		Result Unregister(HLResidentResource resource);
+
+		// Gives the resource that the reload function loaded, the resource is resident again
+		Result SetReloaded(HLResidentResource resource, const HLTexture2D& texture);
+		Result SetReloaded(HLResidentResource resource, const HLTexture2DArray& textures);
+		Result SetReloaded(HLResidentResource resource, const HLBuffer& buffer);
+
+		// Marks a resource used in the current frame, calls the reload function if it was evicted
+		// Resources bound by a render interface that uses the manager are marked by the bind
+		Result Touch(HLResidentResource resource);
+
+		// Marks a registered resource used in the current frame, does nothing for other resources (called by the binds)
+		void Touch(const HLTexture2D& texture);
+		void Touch(const HLTexture2DArray& textures);
+		void Touch(const HLBuffer& buffer);
+
+		// Evicts the least recently used streamable resources while the memory is over the budget, then starts the next frame
+		// Call once per frame, after the frame's draws. Returns the number of evicted resources
+		uint32_t Update();
+
+		// Whether the resource can be used (it isn't evicted or reloading)
+		bool IsResident(HLResidentResource resource);
+
+		// Replaces the budget, 0 for the driver's memory like Create
+		Result SetBudget(uint64_t budget);
+
+		HLResidencyStats GetStats();
+
+		bool IsInitialized();
+
+	private:
+		class Details;
+
+		std::shared_ptr<Details> m_details;
+	};
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLContext.h>
+
+#include <functional>
+
+// Resource loader
+// Runs load functions on a thread with its own context that shares resources with the render context (HLContext::CreateShared),
+// so uploading textures, buffers and compiling shaders doesn't stall the render thread. Every load is fenced, Update hands a
+// load over to the render thread (calls its ready function) once the GPU finished it, without waiting for the GPU.
+
+namespace Pinewood
+{
+	struct HLResourceLoaderCreateInfo
+	{
+		HLContext context; // The render context
+	};
+
+	class HLResourceLoader
+	{
+	public:
+		HLResourceLoader() = default;
+		HLResourceLoader(const HLResourceLoader&) = default;
+		HLResourceLoader(HLResourceLoader&& rhs) noexcept :m_details(std::move(rhs.m_details)) {}
+		~HLResourceLoader() = default;
+
+		HLResourceLoader& operator=(const HLResourceLoader&) = default;
+		HLResourceLoader& operator=(HLResourceLoader&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
+
+		// Creates the shared context and starts the loader thread
+		Result Create(const HLResourceLoaderCreateInfo& createInfo);
+
+		// Finishes the queued loads, hands them over and stops the loader thread
+		// The render context must be current (see Flush)
+		Result Destroy();
+
+		// Queues a load, the loads run in order on the loader thread
+		// NOTES:
+		//  - Create the resources with the render context (HLResourceLoaderCreateInfo::context), not a context of the loader
+		//  - Vertex bindings and framebuffers aren't shared between contexts, create them in the ready function
+		//  - Don't use the resources on the render thread before ready was called
+		// Params:
+		//  - load = Creates the resources, runs on the loader thread.
+		//  - ready = Runs on the render thread in Update once the GPU finished the load. Can be nullptr.
+		Result Load(std::function<void()> load, std::function<void()> ready = nullptr);
+
+		// Hands the finished loads over to the render thread and calls their ready functions, call once per frame
+		// The render context must be current. Returns the number of loads that were handed over
+		uint32_t Update();
+
+		// Waits until every queued load ran and the GPU finished it, then hands them over like Update
+		// The render context must be current
+		Result Flush();
+
+		// The number of loads that weren't handed over yet
+		uint32_t GetPendingCount();
+
+		bool IsInitialized();
+
+	private:
+		class Details;
+
+		std::shared_ptr<Details> m_details;
+	};
+}
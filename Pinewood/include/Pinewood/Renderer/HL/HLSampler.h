@@ -0,0 +1,68 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLContext.h>
+#include <Pinewood/Renderer/HL/HLTexture2D.h>
+#include <Pinewood/Renderer/HL/HLPipelineState.h>
+
+// Samplers
+// A sampler holds how textures are sampled, separately from the textures: the same texture can be sampled with different samplers
+// without a copy of it. Samplers are immutable and deduplicated when they are created, creating a sampler equal to a live one
+// returns the same sampler. Bind one with HLRenderInterface::SetTexture2D, a texture without a sampler uses its own filter and
+// wrap mode.
+
+namespace Pinewood
+{
+	enum class HLSamplerMipFilter
+	{
+		None,		// Only the first mip is sampled
+		Nearest,
+		Linear
+	};
+
+	struct HLSamplerCreateInfo
+	{
+		HLContext context;
+		HLTextureFilter minFilter = HLTextureFilter::Linear;
+		HLTextureFilter magFilter = HLTextureFilter::Linear;
+		HLSamplerMipFilter mipFilter = HLSamplerMipFilter::Linear;
+		float maxAnisotropy = 1.0f;							// > 1 enables anisotropic filtering, clamped to what the driver supports
+		HLTextureWrapMode wrapU = HLTextureWrapMode::Repeat;
+		HLTextureWrapMode wrapV = HLTextureWrapMode::Repeat;
+		float borderColor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };	// Used by HLTextureWrapMode::Border
+		float lodBias = 0.0f;
+		float minLod = -1000.0f;
+		float maxLod = 1000.0f;
+		bool compareEnable = false;							// Depth comparison, for a sampler2DShadow in GLSL
+		HLCompareOp compareOp = HLCompareOp::LessEqual;
+	};
+
+	class HLSampler
+	{
+	public:
+		using NativeHandle = uint32_t;
+
+		HLSampler() = default;
+		HLSampler(const HLSampler&) = default;
+		HLSampler(HLSampler&& rhs) noexcept :m_details(std::move(rhs.m_details)) {}
+		~HLSampler() = default;
+
+		HLSampler& operator=(const HLSampler&) = default;
+		HLSampler& operator=(HLSampler&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
+
+		// Gets the live sampler equal to the create info, creates it if there is none
+		Result Create(const HLSamplerCreateInfo& createInfo);
+
+		// Releases the sampler, it's destroyed with its last reference
+		Result Destroy();
+
+		NativeHandle GetNativeHandle();
+
+		bool IsInitialized();
+
+	private:
+		class Details;
+
+		std::shared_ptr<Details> m_details;
+	};
+}
@@ -3,13 +3,23 @@
 #include <Pinewood/Error.h>
 #include <Pinewood/Renderer/HL/HLContext.h>
 
+#include <span>
+
 namespace Pinewood
 {
 	enum class HLShaderModuleType
 	{
 		Unknown		= 0,
 		Vertex		= 1,
-		Pixel		= 2
+		Pixel		= 2,
+		Compute		= 3		// A program with a compute module can't have other modules, run it with HLRenderInterface::Dispatch
+	};
+
+	// Sets a constant declared with layout(constant_id = N) in a SPIR-V module
+	struct HLSpecializationConstant
+	{
+		uint32_t id;		// N
+		uint32_t value;		// The bits of the value (ex: std::bit_cast<uint32_t>(1.0f) for a float, 0 or 1 for a bool)
 	};
 
 	struct HLShaderModuleCreateInfo
@@ -19,7 +29,12 @@ namespace Pinewood
 		HLShaderModuleType type;
 
 		// Subject to change
-		std::string_view shaderSource;
+		std::string_view shaderSource;			// GLSL, ignored if spirv isn't empty
+
+		// A precompiled module (ex: baked by the AssetBaker, see BakedShaderView), it skips the GLSL compiler of the driver
+		std::span<const uint32_t> spirv;
+		std::string_view entryPoint = "main";
+		std::span<const HLSpecializationConstant> specializationConstants;	// The others keep the default of the module
 	};
 
 	class HLShaderModule
@@ -35,6 +50,8 @@ namespace Pinewood
 		HLShaderModule& operator=(const HLShaderModule&) = default;
 		HLShaderModule& operator=(HLShaderModule&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
 
+		// NOTE: Returns Result::Unsupported for a SPIR-V module if the driver can't load them (see
+		// HLRenderInterface::IsSpirVSupported)
 		Result Create(const HLShaderModuleCreateInfo& createInfo);
 		Result Destroy();
 
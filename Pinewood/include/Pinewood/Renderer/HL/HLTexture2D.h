@@ -20,7 +20,8 @@ namespace Pinewood
 		White,
 		Repeat,
 		MirroredRepeat,
-		ClampToEdge
+		ClampToEdge,
+		Border			// The border color of the sampler, only for HLSampler
 	};
 
 	struct HLTexture2DCreateInfo
@@ -32,6 +33,7 @@ namespace Pinewood
 		HLTextureWrapMode wrapMode = HLTextureWrapMode::Repeat;
 		HLImageFormat format;
 		const void* data;			// Can be nullptr
+		uint32_t samples = 1;		// > 1 creates a multisampled render target: no mips, no data, sampled with texelFetch on a sampler2DMS
 	};
 
 	class HLTexture2D
@@ -67,6 +69,16 @@ namespace Pinewood
 		// Generates the mips in the mip chain
 		Result GenerateMips();
 
+		// Gets the size of the first mip
+		Result GetSize(uint32_t& widthOut, uint32_t& heightOut);
+
+		uint32_t GetSampleCount();
+
+		HLImageFormat GetFormat();
+
+		// The estimated GPU memory of the texture with its mips (and samples), from its size and format
+		uint64_t GetMemorySize();
+
 		NativeHandle GetNativeHandle();
 
 		bool IsInitialized();
@@ -3,26 +3,10 @@
 #include <Pinewood/Error.h>
 #include <Pinewood/Renderer/HL/HLContext.h>
 #include <Pinewood/Renderer/HL/HLImageFormat.h>
+#include <Pinewood/Renderer/HL/HLTexture2D.h> // HLTextureFilter and HLTextureWrapMode
 
 namespace Pinewood
 {
-	enum class HLTextureFilter
-	{
-		Null,
-		Nearest,
-		Linear
-	};
-
-	enum class HLTextureWrapMode
-	{
-		Null,
-		Black,
-		White,
-		Repeat,
-		MirroredRepeat,
-		ClampToEdge
-	};
-
 	struct HLTexture2DArrayCreateInfo
 	{
 		HLContext context;
@@ -68,6 +52,9 @@ namespace Pinewood
 		// Generates the mips in the mip chain
 		Result GenerateMips();
 
+		// The estimated GPU memory of the textures with their mips, from their size and format
+		uint64_t GetMemorySize();
+
 		NativeHandle GetNativeHandle();
 
 		bool IsInitialized();
@@ -0,0 +1,88 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLRenderInterface.h>
+#include <Pinewood/Renderer/HL/HLTexture2D.h>
+#include <Pinewood/Renderer/HL/HLTexture2DArray.h>
+#include <Pinewood/Renderer/HL/HLSampler.h>
+
+#include <string>
+
+// Texture tables
+// A table of textures that shaders index, so draws with different textures don't need texture binds between them (ex: one
+// multi-draw with a texture index per draw). With GL_ARB_bindless_texture the table is a storage buffer of resident
+// texture handles, every texture keeps its own size and format. Without it the textures are copied into the layers of one
+// texture array, so they must all have the size and format given to Create.
+// Shaders sample the table with 'vec4 SampleTextureTable(uint index, vec2 uv)', declared by GetShaderSource. The index must
+// be dynamically uniform for the bindless table, so per draw (ex: gl_DrawID), a per-instance index needs GL_NV_gpu_shader5.
+
+namespace Pinewood
+{
+	struct HLTextureTableCreateInfo
+	{
+		HLRenderInterface renderInterface;
+		uint32_t capacity;				// The number of textures
+		HLSampler sampler;				// How every texture is sampled, a linear repeating sampler if it's uninitialized
+		uint32_t bufferIndex = 0;		// The storage buffer index of the bindless table
+		uint32_t textureLocation = 0;	// The uniform location of the texture array of the fallback
+		uint32_t textureSlot = 0;		// The texture unit of the texture array of the fallback
+		bool forceFallback = false;		// Uses the texture array even if bindless textures are supported
+
+		// The texture array of the fallback, every texture must match it
+		uint32_t width, height;
+		HLImageFormat format;
+		uint32_t mipLevels = 1;			// 0 means a full mip chain
+	};
+
+	class HLTextureTable
+	{
+	public:
+		HLTextureTable() = default;
+		HLTextureTable(const HLTextureTable&) = default;
+		HLTextureTable(HLTextureTable&& rhs) noexcept :m_details(std::move(rhs.m_details)) {}
+		~HLTextureTable() = default;
+
+		HLTextureTable& operator=(const HLTextureTable&) = default;
+		HLTextureTable& operator=(HLTextureTable&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
+
+		Result Create(const HLTextureTableCreateInfo& createInfo);
+		Result Destroy();
+
+		// Puts a texture in the table, replacing the texture at the index
+		// NOTE: The bindless table keeps the texture alive until it's replaced or removed, and its filter and wrap mode can't
+		// change anymore. The fallback copies it, later changes to the texture aren't seen by the table.
+		// Params:
+		//  - index = The index in the table, less than the capacity.
+		//  - texture = The texture, can't be multisampled.
+		Result SetTexture(uint32_t index, const HLTexture2D& texture);
+
+		// Puts one texture of a texture array in the table, replacing the texture at the index
+		// Params:
+		//  - index = The index in the table, less than the capacity.
+		//  - textures = The texture array.
+		//  - layer = The texture of the array.
+		Result SetTexture(uint32_t index, const HLTexture2DArray& textures, uint32_t layer);
+
+		// Removes a texture from the table, sampling its index is undefined after it
+		Result RemoveTexture(uint32_t index);
+
+		// Binds the table for the next draws, after the shader program (or pipeline state) is bound
+		// The textures of a bindless table are marked used in the residency manager of the render interface, like bound textures
+		Result Bind();
+
+		// The GLSL that declares the table and SampleTextureTable, insert it right after the #version line
+		const std::string& GetShaderSource();
+
+		// Whether the table uses bindless textures, or the texture array fallback
+		bool IsBindless();
+
+		uint32_t GetCapacity();
+
+		bool IsInitialized();
+
+	private:
+		class Details;
+
+		std::shared_ptr<Details> m_details;
+	};
+}
@@ -5,14 +5,23 @@
 #include <Pinewood/Renderer/HL/HLBuffer.h>
 #include <Pinewood/Renderer/HL/HLLayout.h>
 
+#include <span>
+
+// Vertex bindings
+// Bindings are cached: creating a binding with the same layout and buffers as a live one returns the same binding. A binding
+// without vertex buffers is layout-only, its buffers are set with SetBuffers (one call for all of them), so one binding per
+// layout can draw any number of meshes. Every user of the layout gets the same layout-only binding, so set its buffers before
+// each draw. A binding without a layout is empty: it has no attributes, only the index buffer set with SetBuffers (see
+// HLVertexPuller).
+
 namespace Pinewood
 {
 	struct HLVertexBindingCreateInfo
 	{
 		HLContext context;
-		std::span<const HLBuffer> vertexBuffers;
-		HLBuffer indexBuffer;	// Optional
-		HLLayout vertexLayout;
+		std::span<const HLBuffer> vertexBuffers;	// One for every binding of the layout, or none for a layout-only binding
+		HLBuffer indexBuffer;						// Optional, none for a layout-only binding (set it with SetBuffers)
+		HLLayout vertexLayout;						// Uninitialized for an empty binding (without vertex buffers)
 	};
 
 	class HLVertexBinding
@@ -28,9 +37,23 @@ namespace Pinewood
 		HLVertexBinding& operator=(const HLVertexBinding&) = default;
 		HLVertexBinding& operator=(HLVertexBinding&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
 
+		// Gets the live binding equal to the create info, creates it if there is none
 		Result Create(const HLVertexBindingCreateInfo& createInfo);
+
+		// Releases the binding, it's destroyed with its last reference
 		Result Destroy();
 
+		// Sets the buffers of a layout-only binding, skipped if they didn't change
+		// NOTE: The binding is shared by every user of the layout, call it before each draw (it draws with the buffers set last)
+		// Params:
+		//  - vertexBuffers = One for every binding of the layout, none for an empty binding.
+		//  - indexBuffer = Can be uninitialized.
+		//  - offsets = Added to the offsets of the layout bindings (ex: to draw a mesh in a larger buffer), none or one per buffer.
+		Result SetBuffers(std::span<const HLBuffer> vertexBuffers, const HLBuffer& indexBuffer = HLBuffer{}, std::span<const size_t> offsets = {});
+
+		// Whether the buffers are set with SetBuffers
+		bool IsLayoutOnly();
+
 		NativeHandle GetNativeHandle();
 
 		bool IsInitialized();
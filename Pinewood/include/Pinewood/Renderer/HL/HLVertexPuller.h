@@ -0,0 +1,64 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLRenderInterface.h>
+#include <Pinewood/Renderer/HL/HLBuffer.h>
+#include <Pinewood/Renderer/HL/HLLayout.h>
+#include <Pinewood/Renderer/HL/HLVertexBinding.h>
+
+#include <span>
+#include <string>
+
+// Vertex pulling
+// A vertex puller turns a layout into GLSL functions that read the attributes from storage buffers, so every mesh is drawn
+// with the same empty vertex binding: changing the buffers of a mesh only binds storage buffers, the vertex binding is bound
+// once. Per-instance elements (instanceDivisor > 0) are read with gl_InstanceID and the baseInstance of the draw like with a
+// vertex binding, so instancing and indirect draws work the same.
+// Shaders read the element with index N with 'vec4 PWPullAttribute<N>()' (dvec4 for the 64 bit types), declared by
+// GetShaderSource. Like an attribute the missing components are (0, 0, 0, 1), integers are converted to floats and the
+// normalized types are normalized.
+
+namespace Pinewood
+{
+	struct HLVertexPullerCreateInfo
+	{
+		HLRenderInterface renderInterface;
+		HLLayout vertexLayout;			// Its elements must be aligned to their component size (4 bytes for the 64 bit types)
+		uint32_t firstBufferIndex = 0;	// Binding N of the layout is read from the storage buffer firstBufferIndex + N
+	};
+
+	class HLVertexPuller
+	{
+	public:
+		HLVertexPuller() = default;
+		HLVertexPuller(const HLVertexPuller&) = default;
+		HLVertexPuller(HLVertexPuller&& rhs) noexcept :m_details(std::move(rhs.m_details)) {}
+		~HLVertexPuller() = default;
+
+		HLVertexPuller& operator=(const HLVertexPuller&) = default;
+		HLVertexPuller& operator=(HLVertexPuller&& rhs) noexcept { m_details = std::move(rhs.m_details); return *this; }
+
+		// NOTE: Returns Result::Unsupported if the layout has per-instance elements and the driver can't read the baseInstance
+		// of draws in shaders (OpenGL 4.6 or GL_ARB_shader_draw_parameters)
+		Result Create(const HLVertexPullerCreateInfo& createInfo);
+		Result Destroy();
+
+		// Binds the empty vertex binding and the buffers for the next draws, instead of a vertex binding
+		// Params:
+		//  - vertexBuffers = One for every binding of the layout.
+		//  - indexBuffer = Can be uninitialized.
+		//  - offsets = The start of the buffers, none or one per buffer. Multiples of GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+		//    (at most 256), draw with a baseVertex for other offsets.
+		Result Bind(std::span<const HLBuffer> vertexBuffers, const HLBuffer& indexBuffer = HLBuffer{}, std::span<const size_t> offsets = {});
+
+		// The GLSL that declares the buffers and the PWPullAttribute functions, insert it right after the #version line
+		const std::string& GetShaderSource();
+
+		bool IsInitialized();
+
+	private:
+		class Details;
+
+		std::shared_ptr<Details> m_details;
+	};
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <Pinewood/Core.h>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+namespace Pinewood
+{
+	// Bounded lock-free queue with a single producer thread and a single consumer thread
+	// Never allocates after construction, TValue should be cheap to copy
+	template<typename TValue>
+	class SPSCQueue
+	{
+	public:
+		// Params:
+		//  - capacity = The maximum number of values in the queue, rounded up to a power of 2.
+		explicit SPSCQueue(size_t capacity)
+		{
+			size_t size = 1;
+			while (size < capacity)
+				size <<= 1;
+
+			m_values.resize(size);
+			m_mask = size - 1;
+		}
+
+		SPSCQueue(const SPSCQueue&) = delete;
+		SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+		// Producer only, returns false if the queue is full
+		bool Push(const TValue& value)
+		{
+			const size_t head = m_head.load(std::memory_order_relaxed);
+			if (head - m_tailCache > m_mask)
+			{
+				// Only look at the consumer's cache line when the queue seems full
+				m_tailCache = m_tail.load(std::memory_order_acquire);
+				if (head - m_tailCache > m_mask)
+					return false;
+			}
+
+			m_values[head & m_mask] = value;
+			m_head.store(head + 1, std::memory_order_release);
+			return true;
+		}
+
+		// Consumer only, pops up to valuesOut.size() values and returns the number of values popped
+		size_t Pop(std::span<TValue> valuesOut)
+		{
+			const size_t tail = m_tail.load(std::memory_order_relaxed);
+			if (m_headCache - tail < valuesOut.size())
+				m_headCache = m_head.load(std::memory_order_acquire);
+
+			const size_t count = std::min(m_headCache - tail, valuesOut.size());
+			for (size_t i = 0; i < count; i++)
+				valuesOut[i] = m_values[(tail + i) & m_mask];
+
+			m_tail.store(tail + count, std::memory_order_release);
+			return count;
+		}
+
+		// Consumer only
+		bool Pop(TValue& valueOut)
+		{
+			return Pop(std::span{ &valueOut, 1 }) == 1;
+		}
+
+		// Approximate when called while the other thread is working on the queue
+		size_t GetSize() const
+		{
+			return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+		}
+
+		size_t GetCapacity() const { return m_mask + 1; }
+
+	private:
+		std::vector<TValue> m_values;
+		size_t m_mask;
+
+		// Each side keeps a copy of the other side's index on its own cache line, so they only share a line when needed
+		alignas(64) std::atomic_size_t m_head = 0;
+		size_t m_tailCache = 0; // Producer
+		alignas(64) std::atomic_size_t m_tail = 0;
+		size_t m_headCache = 0; // Consumer
+	};
+}
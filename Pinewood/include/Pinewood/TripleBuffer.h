@@ -0,0 +1,56 @@
+#pragma once
+#include <Pinewood/Core.h>
+
+#include <array>
+#include <atomic>
+
+namespace Pinewood
+{
+	// Lock-free handoff of a value from a single producer thread to a single consumer thread
+	// The producer writes into its own buffer and publishes it, the consumer takes the latest published buffer whenever it wants.
+	// Neither side ever waits on the other
+	template<typename TValue>
+	class TripleBuffer
+	{
+	public:
+		TripleBuffer() = default;
+
+		TripleBuffer(const TripleBuffer&) = delete;
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		// Producer only, the buffer being written (starts as a copy of the last published value)
+		TValue& GetWriteBuffer() { return m_buffers[m_writeIndex]; }
+
+		// Producer only, makes the write buffer the latest value
+		void Publish()
+		{
+			const uint32_t published = m_writeIndex;
+			m_writeIndex = m_middle.exchange(published | DirtyBit, std::memory_order_acq_rel) & IndexMask;
+
+			// The consumer only ever reads the published buffer, so copying from it here is safe
+			m_buffers[m_writeIndex] = m_buffers[published];
+		}
+
+		// Consumer only, takes the latest published value if there is a new one, returns false if there isn't
+		bool Update()
+		{
+			if (!(m_middle.load(std::memory_order_relaxed) & DirtyBit))
+				return false;
+
+			m_readIndex = m_middle.exchange(m_readIndex, std::memory_order_acq_rel) & IndexMask;
+			return true;
+		}
+
+		// Consumer only, the value taken by the last Update
+		const TValue& GetReadBuffer() const { return m_buffers[m_readIndex]; }
+
+	private:
+		static constexpr uint32_t IndexMask = 0x3;
+		static constexpr uint32_t DirtyBit = 0x4;
+
+		std::array<TValue, 3> m_buffers{};
+		uint32_t m_writeIndex = 0;
+		alignas(64) std::atomic_uint32_t m_middle = 1;
+		alignas(64) uint32_t m_readIndex = 2;
+	};
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include <Pinewood/Core.h>
+#include <Pinewood/Error.h>
+#include <Pinewood/Renderer/HL/HLLayout.h>
+
+#include <vector>
+
+// Vertex stream quantization
+// Rewrites float vertex attributes into the smallest normalized/half float HLLayoutElementType that stays within an error bound
+
+namespace Pinewood
+{
+	// Tells the compressor what an attribute holds, which decides the formats it tries
+	enum class VertexAttributeHint : uint32_t
+	{
+		Generic,	// Any value, Float16 or kept as is
+		Position,	// Quantized relative to the bounding box of the attribute (UNorm8/UNorm16), or Float16
+		Normal,		// Unit vector (3 components), octahedral encoded into Vector2N8/Vector2N16
+		TexCoord,	// UNorm8/UNorm16 when inside [0, 1], otherwise relative to the bounding box, or Float16
+		Color,		// Values in [0, 1], UNorm8/UNorm16
+		Keep		// Copied without changes
+	};
+
+	struct VertexCompressionAttribute
+	{
+		VertexAttributeHint hint = VertexAttributeHint::Generic;
+		float maxError = 0.001f;	// Maximum absolute error of any component after decoding (for normals, of the decoded unit vector)
+	};
+
+	// How to get the original value back from what the shader reads: value = offset + stored * scale
+	struct CompressedVertexAttribute
+	{
+		HLLayoutElement element;	// The rewritten element
+		bool octahedral;			// The stored value is an octahedral encoded unit vector, decode with OctahedralDecodeGLSL
+		float offset[4];
+		float scale[4];
+		float maxError;				// The actual maximum error
+	};
+
+	struct CompressedVertexData
+	{
+		std::vector<HLLayoutElement> elements;				// Ready to use with HLLayoutCreateInfo, everything is in binding 0
+		std::vector<CompressedVertexAttribute> attributes;	// Same order as elements
+		HLLayoutBinding binding;
+		std::vector<uint8_t> vertexData;
+	};
+
+	// GLSL for decoding octahedral normals
+	constexpr std::string_view OctahedralDecodeGLSL =
+		"vec3 OctahedralDecode(vec2 e)\n"
+		"{\n"
+		"	vec3 v = vec3(e, 1.0 - abs(e.x) - abs(e.y));\n"
+		"	if (v.z < 0.0)\n"
+		"		v.xy = (1.0 - abs(v.yx)) * vec2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);\n"
+		"	return normalize(v);\n"
+		"}\n";
+
+	// Returns the size of an element type in bytes
+	uint32_t GetLayoutElementSize(HLLayoutElementType type);
+
+	// Quantizes an interleaved vertex buffer
+	// Float32 elements are compressed according to their hint, everything else is copied. Elements are kept in the same order
+	// (with the same attribute indices) and 4 byte aligned
+	// Params:
+	//  - vertexData = The vertex buffer.
+	//  - vertexStride = The size of a vertex.
+	//  - elements = The layout of the vertex buffer (binding 0 only).
+	//  - attributes = How to compress each element, same order as elements.
+	//  - compressedOut = The compressed layout and vertex data.
+	Result CompressVertices(std::span<const uint8_t> vertexData, uint32_t vertexStride, std::span<const HLLayoutElement> elements,
+		std::span<const VertexCompressionAttribute> attributes, CompressedVertexData& compressedOut);
+}
@@ -5,6 +5,7 @@
 #include <Pinewood/Input.h>
 
 #include <bitset>
+#include <functional>
 
 namespace Pinewood
 {
@@ -25,7 +26,9 @@ namespace Pinewood
 		DefaultStyle	= MinimizeButton | MaximizeButton | SystemMenu | Resizeable,
 
 		// Other flags
-		Async			= 0x0100, // Not yet implemented. Creates and updates window on separate thread (message handlers will need o be thread-safe)
+		Async			= 0x0100, // Creates and updates window on the window thread (message handlers will need to be thread-safe, or use EventQueue)
+		EventQueue		= 0x0200, // Events are queued instead of calling the event handlers, get them with Window::PollEvents (handlers are called from there)
+		Headless		= 0x0400, // No native window, events only come from Window::InjectEvent (ex: automated tests). The style and Async flags are ignored
 
 		// Other values
 		ShowBitMask		= 0x0030 // Bitmask for the show field
@@ -53,6 +56,7 @@ namespace Pinewood
 		int16_t x, y;			// Position of the window
 		uint16_t width, height;	// Size of the window client area
 		WindowCreateFlags flags = WindowCreateFlags::DefaultStyle;	// Create flags and style
+		uint32_t eventQueueSize = 1024;	// Maximum number of queued events with WindowCreateFlags::EventQueue, events past it are dropped
 	};
 
 	enum class WindowEventCode
@@ -118,6 +122,50 @@ namespace Pinewood
 		int16_t x, y;
 	};
 
+	// An event with its data, as stored in the event queue (see WindowCreateFlags::EventQueue)
+	struct WindowEventData
+	{
+		WindowEventCode code;
+		union
+		{
+			WindowKeyEvent key;						// KeyDown and KeyUp
+			WindowKeyCharEvent keyChar;				// KeyChar
+			WindowMouseEvent mouse;					// MouseButtonDown, MouseButtonUp, and MouseMove
+			WindowMouseScrollEvent mouseScroll;		// MouseScroll
+			WindowResizeEvent resize;				// WindowResize and WindowResizing
+			WindowMoveEvent move;					// WindowMove and WindowMoving
+		};
+
+		// The event for the code, as passed to event handlers
+		const WindowEvent& GetEvent() const
+		{
+			static constexpr WindowEvent emptyEvent{};
+
+			switch (code)
+			{
+			case WindowEventCode::KeyDown:
+			case WindowEventCode::KeyUp:
+				return key;
+			case WindowEventCode::KeyChar:
+				return keyChar;
+			case WindowEventCode::MouseButtonDown:
+			case WindowEventCode::MouseButtonUp:
+			case WindowEventCode::MouseMove:
+				return mouse;
+			case WindowEventCode::MouseScroll:
+				return mouseScroll;
+			case WindowEventCode::WindowResize:
+			case WindowEventCode::WindowResizing:
+				return resize;
+			case WindowEventCode::WindowMove:
+			case WindowEventCode::WindowMoving:
+				return move;
+			default:
+				return emptyEvent;
+			}
+		}
+	};
+
 	struct WindowEventHandler
 	{
 		using Function = void(*)(const Window& window, const WindowEvent& event, void* userPointer);
@@ -158,13 +206,24 @@ namespace Pinewood
 		Result Create(const WindowCreateInfo& createInfo);
 		Result Destroy();
 
+		// Processes the window's events on the calling thread, does nothing for async windows (the window thread does it)
 		Result Update();
 		bool IsRunning();
 
 		Result SetShowMode(WindowShowMode showMode);
 
+		// The native window (HWND on Windows, the X11 Window on Linux), nullptr for headless windows
 		NativeHandle GetNativeHandle();
 
+		// The native display connection (the X11 Display on Linux), nullptr on platforms without one and for headless windows
+		NativeHandle GetNativeDisplay();
+
+		// Gets the size of the client area
+		// Params:
+		//  - widthOut = Receives the width.
+		//  - heightOut = Receives the height.
+		Result GetSize(uint16_t& widthOut, uint16_t& heightOut);
+
 		bool IsInitialized();
 
 		// If the eventHandler is already present, it will not be added and Result::InvalidParameter will be returned
@@ -173,6 +232,35 @@ namespace Pinewood
 		// If the eventHandler is not present, Result::InvalidParameter will be returned
 		Result RemoveEventHandler(const WindowEventHandler& eventHandler);
 
+		// Pops queued events and calls the event handlers for them on the calling thread, requires WindowCreateFlags::EventQueue
+		// Only one thread may poll a window. Never allocates or locks
+		// Params:
+		//  - eventsOut = Receives the events, at most eventsOut.size() events are popped.
+		//  - countOut = The number of events written to eventsOut.
+		Result PollEvents(std::span<WindowEventData> eventsOut, size_t& countOut);
+
+		// Pops every queued event and calls the event handlers for them on the calling thread, requires WindowCreateFlags::EventQueue
+		Result PollEvents();
+
+		// Number of events that were dropped because the event queue was full
+		uint64_t GetDroppedEventCount();
+
+		// Sends an event as if it came from the platform (queued or passed to the event handlers)
+		// NOTE: Only for headless windows, always call it from the same thread
+		// Params:
+		//  - event = The event, a WindowResize changes the size of headless windows.
+		Result InjectEvent(const WindowEventData& event);
+
+		// Runs functions on the window thread (the thread that creates and updates WindowCreateFlags::Async windows), in order
+		// The thread sleeps until there are messages or tasks. Runs the functions right away when called from the window thread
+		// Params:
+		//  - tasks = The functions to run, they are copied.
+		//  - wait = Wait until every function ran.
+		static Result RunOnWindowThread(std::span<const std::function<void()>> tasks, bool wait);
+
+		// The calling thread is the window thread
+		static bool IsWindowThread();
+
 	private:
 		class Details;
 
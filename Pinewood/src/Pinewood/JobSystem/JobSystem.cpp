@@ -0,0 +1,498 @@
+#include "pch.h"
+#include <Pinewood/JobSystem.h>
+#include <Pinewood/Profiler.h>
+
+#include <bit>
+#include <deque>
+#include <thread>
+
+#if defined(_M_X64) || defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace Pinewood
+{
+	namespace
+	{
+		void CPUPause()
+		{
+#if defined(_M_X64) || defined(__x86_64__)
+			_mm_pause();
+#else
+			std::this_thread::yield();
+#endif
+		}
+
+		// Chase-Lev work-stealing deque (Lê et al., "Correct and Efficient Work-Stealing for Weak Memory Models")
+		// The owner thread pushes and pops at the bottom, any thread steals from the top. Fixed capacity, Push fails when full.
+		class WorkStealingDeque
+		{
+		public:
+			explicit WorkStealingDeque(uint32_t capacity)
+			{
+				const uint32_t size = std::bit_ceil(std::max(capacity, 2u));
+				m_slots = std::make_unique<Slot[]>(size);
+				m_mask = size - 1;
+			}
+
+			// Owner only
+			bool Push(const Impl::Job& job)
+			{
+				const int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+				const int64_t top = m_top.load(std::memory_order_acquire);
+				if (bottom - top > m_mask)
+					return false;
+
+				Store(m_slots[bottom & m_mask], job);
+				m_bottom.store(bottom + 1, std::memory_order_release);
+				return true;
+			}
+
+			// Owner only, takes the most recently pushed job
+			bool Pop(Impl::Job& jobOut)
+			{
+				const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+				m_bottom.store(bottom, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t top = m_top.load(std::memory_order_relaxed);
+
+				if (top > bottom)
+				{
+					// Empty
+					m_bottom.store(bottom + 1, std::memory_order_relaxed);
+					return false;
+				}
+
+				jobOut = Load(m_slots[bottom & m_mask]);
+				if (top == bottom)
+				{
+					// The last job, race the thieves for it
+					const bool won = m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+					m_bottom.store(bottom + 1, std::memory_order_relaxed);
+					return won;
+				}
+
+				return true;
+			}
+
+			// Any thread, takes the oldest job
+			bool Steal(Impl::Job& jobOut)
+			{
+				int64_t top = m_top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+				if (top >= bottom)
+					return false;
+
+				// The slot can only be overwritten after top moved past it, and then the exchange fails
+				jobOut = Load(m_slots[top & m_mask]);
+				return m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			}
+
+		private:
+			// Jobs are copied in and out word by word, so a thief reading a slot the owner is writing is not a data race
+			using JobWords = std::array<uintptr_t, sizeof(Impl::Job) / sizeof(uintptr_t)>;
+			static_assert(sizeof(Impl::Job) % sizeof(uintptr_t) == 0);
+
+			struct Slot
+			{
+				std::array<std::atomic_uintptr_t, std::tuple_size_v<JobWords>> words;
+			};
+
+			static void Store(Slot& slot, const Impl::Job& job)
+			{
+				const auto words = std::bit_cast<JobWords>(job);
+				for (size_t i = 0; i < words.size(); i++)
+					slot.words[i].store(words[i], std::memory_order_relaxed);
+			}
+
+			static Impl::Job Load(const Slot& slot)
+			{
+				JobWords words;
+				for (size_t i = 0; i < words.size(); i++)
+					words[i] = slot.words[i].load(std::memory_order_relaxed);
+				return std::bit_cast<Impl::Job>(words);
+			}
+
+			std::unique_ptr<Slot[]> m_slots;
+			int64_t m_mask;
+
+			// The thieves only write the top, the owner mostly writes the bottom
+			alignas(64) std::atomic_int64_t m_top = 0;
+			alignas(64) std::atomic_int64_t m_bottom = 0;
+		};
+
+		struct JobSystemState
+		{
+			std::atomic_bool initialized = false;
+			std::atomic_bool running = false;
+
+			std::vector<std::unique_ptr<WorkStealingDeque>> deques; // One per thread index
+			std::vector<std::thread> workers;
+
+			// Jobs run from threads without a deque
+			std::mutex injectedMutex;
+			std::deque<Impl::Job> injectedJobs;
+			std::atomic_size_t injectedCount = 0;
+
+			std::atomic_uint32_t sleepingWorkers = 0;
+			std::atomic_uint32_t waitingThreads = 0;	// Sleeping in JobSystem::Wait, they're also counted as sleeping workers
+			std::atomic_uint32_t wakeGeneration = 0;	// Sleeping workers wait for it to change
+		};
+
+		JobSystemState& GetState()
+		{
+			static JobSystemState state;
+			return state;
+		}
+
+		thread_local uint32_t threadIndex = std::numeric_limits<uint32_t>::max();
+		thread_local uint32_t stealSeed = 0;
+
+		void WakeWorkers(JobSystemState& state, size_t jobCount)
+		{
+			// Pairs with the fence in WorkerThread, either the worker sees the job or we see the worker sleeping
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			const uint32_t sleeping = state.sleepingWorkers.load(std::memory_order_relaxed);
+			if (sleeping == 0)
+				return;
+
+			state.wakeGeneration.fetch_add(1, std::memory_order_release);
+			if (jobCount >= sleeping)
+				state.wakeGeneration.notify_all();
+			else
+				for (size_t i = 0; i < jobCount; i++)
+					state.wakeGeneration.notify_one();
+		}
+
+		// Wakes the threads sleeping in JobSystem::Wait after a counter is done, they check if it's theirs
+		void WakeWaitingThreads(JobSystemState& state)
+		{
+			// Pairs with the fence in Wait, either the thread sees the counter done or we see the thread waiting
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (state.waitingThreads.load(std::memory_order_relaxed) == 0)
+				return;
+
+			state.wakeGeneration.fetch_add(1, std::memory_order_release);
+			state.wakeGeneration.notify_all();
+		}
+
+		bool FindJob(JobSystemState& state, uint32_t index, Impl::Job& jobOut)
+		{
+			const uint32_t threadCount = static_cast<uint32_t>(state.deques.size());
+			if (index < threadCount && state.deques[index]->Pop(jobOut))
+				return true;
+
+			if (state.injectedCount.load(std::memory_order_acquire) != 0)
+			{
+				std::lock_guard lock{ state.injectedMutex };
+				if (!state.injectedJobs.empty())
+				{
+					jobOut = state.injectedJobs.front();
+					state.injectedJobs.pop_front();
+					state.injectedCount.fetch_sub(1, std::memory_order_relaxed);
+					return true;
+				}
+			}
+
+			// Start at a random victim, so thieves don't all hit the same deque
+			stealSeed = stealSeed * 1664525u + 1013904223u;
+			const uint32_t start = (stealSeed >> 16) % std::max(threadCount, 1u);
+			for (uint32_t i = 0; i < threadCount; i++)
+			{
+				const uint32_t victim = (start + i) % threadCount;
+				if (victim != index && state.deques[victim]->Steal(jobOut))
+					return true;
+			}
+
+			return false;
+		}
+	}
+
+	Result JobSystem::Initialize(const JobSystemCreateInfo& createInfo)
+	{
+		auto& state = GetState();
+		if (state.initialized.load(std::memory_order_acquire))
+			return Result::InvalidParameter; // Already initialized
+
+		const uint32_t numThreads = (createInfo.numThreads != 0) ? createInfo.numThreads : std::max(std::thread::hardware_concurrency(), 1u);
+		const uint32_t numWorkers = numThreads - 1;
+
+		state.deques.clear();
+		for (uint32_t i = 0; i <= numWorkers; i++)
+			state.deques.push_back(std::make_unique<WorkStealingDeque>(createInfo.queueSize));
+
+		threadIndex = 0;
+		stealSeed = 0;
+		state.running.store(true, std::memory_order_release);
+		state.initialized.store(true, std::memory_order_release);
+
+		state.workers.reserve(numWorkers);
+		for (uint32_t i = 1; i <= numWorkers; i++)
+			state.workers.emplace_back(WorkerThread, i);
+
+		return Result::Success;
+	}
+
+	void JobSystem::Shutdown()
+	{
+		auto& state = GetState();
+		if (!state.initialized.load(std::memory_order_acquire))
+			return;
+
+		// Help finishing what's left, the workers only stop once they can't find any job either
+		Impl::Job job;
+		while (FindJob(state, threadIndex, job))
+			ExecuteJob(job);
+
+		state.running.store(false, std::memory_order_release);
+		state.wakeGeneration.fetch_add(1, std::memory_order_release);
+		state.wakeGeneration.notify_all();
+
+		for (auto& worker : state.workers)
+			worker.join();
+
+		state.workers.clear();
+		state.deques.clear();
+		state.initialized.store(false, std::memory_order_release);
+		threadIndex = std::numeric_limits<uint32_t>::max();
+	}
+
+	bool JobSystem::IsInitialized()
+	{
+		return GetState().initialized.load(std::memory_order_acquire);
+	}
+
+	uint32_t JobSystem::GetThreadCount()
+	{
+		auto& state = GetState();
+		return state.initialized.load(std::memory_order_acquire) ? static_cast<uint32_t>(state.deques.size()) : 1;
+	}
+
+	uint32_t JobSystem::GetThreadIndex()
+	{
+		return threadIndex;
+	}
+
+	void JobSystem::Run(std::span<const JobDesc> jobs, JobCounter* counter)
+	{
+		if (jobs.empty())
+			return;
+
+		// Count every job before the first one can finish
+		if (counter)
+			counter->m_value.fetch_add(static_cast<uint32_t>(jobs.size()), std::memory_order_relaxed);
+
+		auto& state = GetState();
+		for (auto& job : jobs)
+			QueueJob({ job, counter });
+
+		WakeWorkers(state, jobs.size());
+	}
+
+	void JobSystem::RunAfter(JobCounter& dependency, std::span<const JobDesc> jobs, JobCounter* counter)
+	{
+		if (jobs.empty())
+			return;
+
+		if (counter)
+			counter->m_value.fetch_add(static_cast<uint32_t>(jobs.size()), std::memory_order_relaxed);
+
+		{
+			std::lock_guard lock{ dependency.m_continuationMutex };
+			if (dependency.m_value.load(std::memory_order_acquire) != 0)
+			{
+				for (auto& job : jobs)
+					dependency.m_continuations.push_back({ job, counter });
+				return;
+			}
+		}
+
+		// Already done
+		auto& state = GetState();
+		for (auto& job : jobs)
+			QueueJob({ job, counter });
+
+		WakeWorkers(state, jobs.size());
+	}
+
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		auto& state = GetState();
+
+		constexpr uint32_t SpinCount = 64;
+		uint32_t spins = 0;
+		Impl::Job job;
+		while (!counter.IsDone())
+		{
+			if (FindJob(state, threadIndex, job))
+			{
+				ExecuteJob(job);
+				spins = 0;
+				continue;
+			}
+
+			if (++spins < SpinCount)
+			{
+				CPUPause();
+				continue;
+			}
+
+			// The jobs left are running on other threads, sleep like a worker until a job is queued or a counter is done
+			const uint32_t generation = state.wakeGeneration.load(std::memory_order_acquire);
+			state.sleepingWorkers.fetch_add(1, std::memory_order_relaxed);
+			state.waitingThreads.fetch_add(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			const bool found = FindJob(state, threadIndex, job);
+			if (!found && !counter.IsDone())
+				state.wakeGeneration.wait(generation, std::memory_order_acquire);
+
+			state.waitingThreads.fetch_sub(1, std::memory_order_relaxed);
+			state.sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+			spins = 0;
+
+			if (found)
+				ExecuteJob(job);
+		}
+
+		// The last job may still hold the mutex, after this it doesn't touch the counter anymore
+		std::lock_guard lock{ counter.m_continuationMutex };
+	}
+
+	uint32_t JobSystem::GetDefaultBatchSize(uint32_t count)
+	{
+		// Enough batches for every thread to steal a few times
+		return std::max(count / (GetThreadCount() * 8), 1u);
+	}
+
+	void JobSystem::RunParallelFor(ParallelForState& state, uint32_t count)
+	{
+		ParallelForJob(&state, 0, count);
+		Wait(state.counter);
+	}
+
+	void JobSystem::ParallelForJob(void* userPointer, uint32_t begin, uint32_t end)
+	{
+		// Pushes the upper half of the range until the rest fits a batch, thieves take the oldest (biggest) halves
+		auto& state = *static_cast<ParallelForState*>(userPointer);
+		while (end - begin > state.batchSize)
+		{
+			const uint32_t middle = begin + (end - begin) / 2;
+			Run({ .function = ParallelForJob, .userPointer = &state, .begin = middle, .end = end }, &state.counter);
+			end = middle;
+		}
+
+		state.function(state.userPointer, begin, end);
+	}
+
+	void JobSystem::QueueJob(const Impl::Job& job)
+	{
+		auto& state = GetState();
+		if (!state.initialized.load(std::memory_order_acquire))
+		{
+			// Nothing would ever run it
+			ExecuteJob(job);
+			return;
+		}
+
+		if (threadIndex < state.deques.size())
+		{
+			if (!state.deques[threadIndex]->Push(job))
+			{
+				// Our deque is full, running it right away keeps the memory bounded
+				ExecuteJob(job);
+			}
+			return;
+		}
+
+		std::lock_guard lock{ state.injectedMutex };
+		state.injectedJobs.push_back(job);
+		state.injectedCount.fetch_add(1, std::memory_order_release);
+	}
+
+	void JobSystem::ExecuteJob(const Impl::Job& job)
+	{
+		job.desc.function(job.desc.userPointer, job.desc.begin, job.desc.end);
+
+		if (JobCounter* counter = job.counter)
+		{
+			// Not the last job, nobody can be done waiting on the counter yet
+			uint32_t value = counter->m_value.load(std::memory_order_relaxed);
+			while (value > 1)
+			{
+				if (counter->m_value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+					return;
+			}
+
+			// Maybe the last job, Wait takes the mutex before returning, so the counter stays alive until we unlock it
+			std::vector<Impl::Job> continuations;
+			bool done = false;
+			{
+				std::lock_guard lock{ counter->m_continuationMutex };
+				done = counter->m_value.fetch_sub(1, std::memory_order_acq_rel) == 1;
+				if (done)
+					continuations.swap(counter->m_continuations);
+			}
+
+			for (auto& continuation : continuations)
+				QueueJob(continuation);
+
+			if (!continuations.empty())
+				WakeWorkers(GetState(), continuations.size());
+			if (done)
+				WakeWaitingThreads(GetState());
+		}
+	}
+
+	void JobSystem::WorkerThread(uint32_t index)
+	{
+		auto& state = GetState();
+		threadIndex = index;
+		stealSeed = index;
+		Profiler::SetThreadName("Job Worker " + std::to_string(index));
+
+		constexpr uint32_t SpinCount = 64;
+		uint32_t spins = 0;
+		Impl::Job job;
+		while (true)
+		{
+			if (FindJob(state, index, job))
+			{
+				ExecuteJob(job);
+				spins = 0;
+				continue;
+			}
+
+			if (!state.running.load(std::memory_order_acquire))
+				break;
+
+			if (++spins < SpinCount)
+			{
+				CPUPause();
+				continue;
+			}
+
+			// Announce we're going to sleep, then look once more before actually sleeping
+			const uint32_t generation = state.wakeGeneration.load(std::memory_order_acquire);
+			state.sleepingWorkers.fetch_add(1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (FindJob(state, index, job))
+			{
+				state.sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+				ExecuteJob(job);
+				spins = 0;
+				continue;
+			}
+
+			if (state.running.load(std::memory_order_acquire))
+				state.wakeGeneration.wait(generation, std::memory_order_acquire);
+
+			state.sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+			spins = 0;
+		}
+
+		threadIndex = std::numeric_limits<uint32_t>::max();
+	}
+}
@@ -0,0 +1,556 @@
+#include "pch.h"
+#include <Pinewood/MeshOptimizer.h>
+
+#include <PWMath/Vector3.h>
+
+#include <cmath>
+#include <cstring>
+
+namespace Pinewood
+{
+	namespace
+	{
+		using Float3 = PWMath::Vector3F32;
+
+		bool ValidateIndices(std::span<const uint32_t> indices, uint32_t vertexCount)
+		{
+			if (indices.size() % 3)
+				return false;
+
+			return std::all_of(indices.begin(), indices.end(), [=](uint32_t index) { return index < vertexCount; });
+		}
+
+		bool ValidateVertexData(std::span<const uint8_t> vertexData, uint32_t vertexStride, uint32_t positionOffset)
+		{
+			return (vertexStride != 0) && (positionOffset + sizeof(Float3) <= vertexStride) && (vertexData.size() % vertexStride == 0);
+		}
+
+		Float3 ReadPosition(std::span<const uint8_t> vertexData, uint32_t vertexStride, uint32_t positionOffset, uint32_t index)
+		{
+			Float3 position;
+			std::memcpy(position.array, vertexData.data() + static_cast<size_t>(index) * vertexStride + positionOffset, sizeof(position.array));
+			return position;
+		}
+
+		// FIFO post-transform cache, a vertex is a hit if it was transformed less than cacheSize misses ago
+		class FifoCache
+		{
+		public:
+			FifoCache(uint32_t vertexCount, uint32_t cacheSize) :m_timestamps(vertexCount, 0), m_cacheSize(cacheSize), m_time(cacheSize + 1) {}
+
+			// Returns 1 for a miss, 0 for a hit
+			uint32_t Access(uint32_t vertex)
+			{
+				if (m_time - m_timestamps[vertex] > m_cacheSize)
+				{
+					m_timestamps[vertex] = m_time++;
+					return 1;
+				}
+
+				return 0;
+			}
+
+			uint32_t AccessTriangle(const uint32_t* triangle)
+			{
+				return Access(triangle[0]) + Access(triangle[1]) + Access(triangle[2]);
+			}
+
+			void Flush()
+			{
+				m_time += m_cacheSize + 1;
+			}
+
+		private:
+			std::vector<uint32_t> m_timestamps;
+			uint32_t m_cacheSize;
+			uint32_t m_time;
+		};
+
+		// Scoring from Tom Forsyth's "Linear-Speed Vertex Cache Optimisation"
+		constexpr uint32_t ForsythCacheSize = 32;
+		constexpr float ForsythCacheDecayPower = 1.5f;
+		constexpr float ForsythLastTriangleScore = 0.75f;
+		constexpr float ForsythValenceBoostScale = 2.0f;
+		constexpr float ForsythValenceBoostPower = 0.5f;
+
+		float ForsythVertexScore(int32_t cachePosition, uint32_t remainingValence)
+		{
+			// Vertices without triangles left don't matter
+			if (remainingValence == 0)
+				return -1.0f;
+
+			float score = 0.0f;
+			if (cachePosition >= 0)
+			{
+				// The last triangle's vertices get a fixed score, so the next triangle doesn't just reuse the same edge
+				if (cachePosition < 3)
+					score = ForsythLastTriangleScore;
+				else
+					score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / (ForsythCacheSize - 3), ForsythCacheDecayPower);
+			}
+
+			// Boost vertices with few triangles left, so lone triangles don't get left behind
+			score += ForsythValenceBoostScale * std::pow(static_cast<float>(remainingValence), -ForsythValenceBoostPower);
+			return score;
+		}
+	}
+
+	VertexCacheStats AnalyzeVertexCache(std::span<const uint32_t> indices, uint32_t vertexCount, uint32_t cacheSize)
+	{
+		VertexCacheStats stats{ 0, 0.0f, 0.0f };
+		if (indices.empty() || !ValidateIndices(indices, vertexCount))
+			return stats;
+
+		FifoCache cache{ vertexCount, cacheSize };
+		std::vector<bool> referenced(vertexCount, false);
+		uint32_t referencedCount = 0;
+
+		for (auto index : indices)
+		{
+			stats.vertexTransforms += cache.Access(index);
+			if (!referenced[index])
+			{
+				referenced[index] = true;
+				referencedCount++;
+			}
+		}
+
+		stats.acmr = static_cast<float>(stats.vertexTransforms) / (indices.size() / 3);
+		stats.atvr = static_cast<float>(stats.vertexTransforms) / referencedCount;
+		return stats;
+	}
+
+	Result OptimizeVertexCache(std::span<const uint32_t> indices, uint32_t vertexCount, std::span<uint32_t> indicesOut)
+	{
+		if (!ValidateIndices(indices, vertexCount) || indicesOut.size() < indices.size())
+			return Result::InvalidParameter;
+
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return Result::Success;
+
+		// Copy the input, indicesOut is allowed to alias it
+		std::vector<uint32_t> source{ indices.begin(), indices.end() };
+
+		// Triangle adjacency of every vertex, the first liveCount entries are the triangles that haven't been emitted yet
+		std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0), liveCount(vertexCount, 0), adjacency(source.size());
+		for (auto index : source)
+			liveCount[index]++;
+		for (uint32_t i = 0; i < vertexCount; i++)
+			adjacencyOffsets[i + 1] = adjacencyOffsets[i] + liveCount[i];
+
+		std::vector<uint32_t> fill{ adjacencyOffsets.begin(), adjacencyOffsets.end() - 1 };
+		for (size_t i = 0; i < source.size(); i++)
+			adjacency[fill[source[i]]++] = static_cast<uint32_t>(i / 3);
+
+		std::vector<int32_t> cachePosition(vertexCount, -1);
+		std::vector<float> vertexScore(vertexCount);
+		for (uint32_t i = 0; i < vertexCount; i++)
+			vertexScore[i] = ForsythVertexScore(-1, liveCount[i]);
+
+		std::vector<float> triangleScore(triangleCount);
+		for (size_t i = 0; i < triangleCount; i++)
+			triangleScore[i] = vertexScore[source[i * 3]] + vertexScore[source[i * 3 + 1]] + vertexScore[source[i * 3 + 2]];
+
+		std::vector<bool> emitted(triangleCount, false);
+
+		// The cache holds up to 3 extra entries while a triangle gets added
+		std::array<uint32_t, ForsythCacheSize + 3> cache, newCache;
+		size_t cacheCount = 0;
+
+		int64_t bestTriangle = -1;
+		size_t cursor = 0;
+
+		for (size_t outputTriangle = 0; outputTriangle < triangleCount; outputTriangle++)
+		{
+			// Nothing in the cache is connected to anything that's left, so start somewhere new
+			if (bestTriangle < 0)
+			{
+				while (emitted[cursor])
+					cursor++;
+				bestTriangle = static_cast<int64_t>(cursor);
+			}
+
+			const uint32_t triangle = static_cast<uint32_t>(bestTriangle);
+			const uint32_t* vertices = &source[triangle * 3];
+			std::copy_n(vertices, 3, &indicesOut[outputTriangle * 3]);
+			emitted[triangle] = true;
+
+			// Move the triangle's vertices to the front of the cache
+			size_t newCacheCount = 0;
+			for (uint32_t i = 0; i < 3; i++)
+				if (std::find(newCache.begin(), newCache.begin() + newCacheCount, vertices[i]) == newCache.begin() + newCacheCount)
+					newCache[newCacheCount++] = vertices[i];
+			for (size_t i = 0; i < cacheCount; i++)
+				if (std::find(vertices, vertices + 3, cache[i]) == vertices + 3)
+					newCache[newCacheCount++] = cache[i];
+
+			// Remove the triangle from its vertices' adjacency
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				uint32_t* begin = &adjacency[adjacencyOffsets[vertices[i]]];
+				uint32_t* end = begin + liveCount[vertices[i]];
+				uint32_t* it = std::find(begin, end, triangle);
+				std::swap(*it, *(end - 1));
+				liveCount[vertices[i]]--;
+			}
+
+			// Rescore everything that moved, including the vertices that fell out of the cache
+			for (size_t i = 0; i < newCacheCount; i++)
+			{
+				const uint32_t vertex = newCache[i];
+				cachePosition[vertex] = (i < ForsythCacheSize) ? static_cast<int32_t>(i) : -1;
+
+				const float score = ForsythVertexScore(cachePosition[vertex], liveCount[vertex]);
+				const float delta = score - vertexScore[vertex];
+				vertexScore[vertex] = score;
+
+				for (uint32_t j = 0; j < liveCount[vertex]; j++)
+					triangleScore[adjacency[adjacencyOffsets[vertex] + j]] += delta;
+			}
+
+			cacheCount = std::min<size_t>(newCacheCount, ForsythCacheSize);
+			std::copy_n(newCache.begin(), cacheCount, cache.begin());
+
+			// Only triangles that touch the cache are candidates for the next one
+			bestTriangle = -1;
+			float bestScore = -std::numeric_limits<float>::max();
+			for (size_t i = 0; i < cacheCount; i++)
+			{
+				const uint32_t vertex = cache[i];
+				for (uint32_t j = 0; j < liveCount[vertex]; j++)
+				{
+					const uint32_t candidate = adjacency[adjacencyOffsets[vertex] + j];
+					if (triangleScore[candidate] > bestScore)
+					{
+						bestScore = triangleScore[candidate];
+						bestTriangle = candidate;
+					}
+				}
+			}
+		}
+
+		return Result::Success;
+	}
+
+	Result OptimizeOverdraw(std::span<const uint32_t> indices, std::span<const uint8_t> vertexData, uint32_t vertexStride, uint32_t positionOffset,
+		std::span<uint32_t> indicesOut, float threshold)
+	{
+		if (!ValidateVertexData(vertexData, vertexStride, positionOffset))
+			return Result::InvalidParameter;
+
+		const uint32_t vertexCount = static_cast<uint32_t>(vertexData.size() / vertexStride);
+		if (!ValidateIndices(indices, vertexCount) || indicesOut.size() < indices.size())
+			return Result::InvalidParameter;
+
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+			return Result::Success;
+
+		std::vector<uint32_t> source{ indices.begin(), indices.end() };
+
+		// Hard boundaries are where the cache optimizer started over (every vertex of the triangle missed)
+		std::vector<size_t> hardBoundaries;
+		FifoCache cache{ vertexCount, DefaultVertexCacheSize };
+		for (size_t i = 0; i < triangleCount; i++)
+			if (cache.AccessTriangle(&source[i * 3]) == 3)
+				hardBoundaries.push_back(i);
+		hardBoundaries.push_back(triangleCount);
+
+		// Soft boundaries split clusters further, wherever flushing the cache keeps the ACMR under the threshold
+		std::vector<size_t> clusters;
+		for (size_t i = 0; i + 1 < hardBoundaries.size(); i++)
+		{
+			const size_t start = hardBoundaries[i], end = hardBoundaries[i + 1];
+
+			cache.Flush();
+			uint32_t clusterMisses = 0;
+			for (size_t j = start; j < end; j++)
+				clusterMisses += cache.AccessTriangle(&source[j * 3]);
+			const float clusterThreshold = threshold * clusterMisses / (end - start);
+
+			cache.Flush();
+			size_t softStart = start;
+			uint32_t misses = 0;
+			for (size_t j = start; j < end; j++)
+			{
+				misses += cache.AccessTriangle(&source[j * 3]);
+				if (j + 1 < end && static_cast<float>(misses) / (j + 1 - softStart) <= clusterThreshold)
+				{
+					clusters.push_back(softStart);
+					softStart = j + 1;
+					misses = 0;
+					cache.Flush();
+				}
+			}
+
+			clusters.push_back(softStart);
+		}
+		clusters.push_back(triangleCount);
+
+		// Area weighted centroid and normal of every cluster, and the centroid of the whole mesh
+		struct ClusterInfo
+		{
+			size_t start, end;
+			float sortKey;
+		};
+
+		std::vector<ClusterInfo> clusterInfos(clusters.size() - 1);
+		std::vector<Float3> clusterCentroids(clusterInfos.size()), clusterNormals(clusterInfos.size());
+		Float3 meshCentroid{ 0.0f };
+		float meshArea = 0.0f;
+
+		for (size_t i = 0; i < clusterInfos.size(); i++)
+		{
+			Float3 centroid{ 0.0f }, normal{ 0.0f };
+			float area = 0.0f;
+
+			for (size_t j = clusters[i]; j < clusters[i + 1]; j++)
+			{
+				const Float3 p0 = ReadPosition(vertexData, vertexStride, positionOffset, source[j * 3]);
+				const Float3 p1 = ReadPosition(vertexData, vertexStride, positionOffset, source[j * 3 + 1]);
+				const Float3 p2 = ReadPosition(vertexData, vertexStride, positionOffset, source[j * 3 + 2]);
+
+				const Float3 triangleNormal = PWMath::Cross(p1 - p0, p2 - p0);
+				const float triangleArea = PWMath::Length(triangleNormal);
+
+				centroid += (p0 + p1 + p2) * (triangleArea / 3.0f);
+				normal += triangleNormal;
+				area += triangleArea;
+			}
+
+			meshCentroid += centroid;
+			meshArea += area;
+
+			clusterInfos[i] = { clusters[i], clusters[i + 1], 0.0f };
+			clusterCentroids[i] = (area > 0.0f) ? centroid / area : centroid;
+			clusterNormals[i] = normal;
+		}
+
+		if (meshArea > 0.0f)
+			meshCentroid /= meshArea;
+
+		// Clusters that face away from the center are more likely to occlude the rest, so draw them first
+		for (size_t i = 0; i < clusterInfos.size(); i++)
+		{
+			const float normalLength = PWMath::Length(clusterNormals[i]);
+			if (normalLength > 0.0f)
+				clusterInfos[i].sortKey = PWMath::Dot(clusterCentroids[i] - meshCentroid, clusterNormals[i] / normalLength);
+		}
+
+		std::stable_sort(clusterInfos.begin(), clusterInfos.end(), [](const ClusterInfo& lhs, const ClusterInfo& rhs) { return lhs.sortKey > rhs.sortKey; });
+
+		size_t output = 0;
+		for (auto& cluster : clusterInfos)
+		{
+			std::copy(source.begin() + cluster.start * 3, source.begin() + cluster.end * 3, indicesOut.begin() + output);
+			output += (cluster.end - cluster.start) * 3;
+		}
+
+		return Result::Success;
+	}
+
+	Result GenerateVertexFetchRemap(std::span<const uint32_t> indices, uint32_t vertexCount, std::span<uint32_t> remapOut, uint32_t& remappedVertexCountOut)
+	{
+		if (!ValidateIndices(indices, vertexCount) || remapOut.size() < vertexCount)
+			return Result::InvalidParameter;
+
+		std::fill_n(remapOut.begin(), vertexCount, UINT32_MAX);
+
+		uint32_t nextVertex = 0;
+		for (auto index : indices)
+			if (remapOut[index] == UINT32_MAX)
+				remapOut[index] = nextVertex++;
+
+		remappedVertexCountOut = nextVertex;
+		return Result::Success;
+	}
+
+	Result RemapIndices(std::span<uint32_t> indices, std::span<const uint32_t> remap)
+	{
+		for (auto& index : indices)
+		{
+			if (index >= remap.size() || remap[index] == UINT32_MAX)
+				return Result::InvalidParameter;
+
+			index = remap[index];
+		}
+
+		return Result::Success;
+	}
+
+	Result RemapVertices(std::span<const uint8_t> vertexData, uint32_t vertexStride, std::span<const uint32_t> remap, std::span<uint8_t> vertexDataOut)
+	{
+		if (vertexStride == 0 || vertexData.size() / vertexStride < remap.size())
+			return Result::InvalidParameter;
+
+		for (size_t i = 0; i < remap.size(); i++)
+		{
+			if (remap[i] == UINT32_MAX)
+				continue;
+
+			if ((static_cast<size_t>(remap[i]) + 1) * vertexStride > vertexDataOut.size())
+				return Result::InvalidParameter;
+
+			std::memcpy(vertexDataOut.data() + static_cast<size_t>(remap[i]) * vertexStride, vertexData.data() + i * vertexStride, vertexStride);
+		}
+
+		return Result::Success;
+	}
+
+	Result OptimizeVertexFetch(std::span<uint32_t> indices, std::span<uint8_t> vertexData, uint32_t vertexStride, uint32_t& vertexCountOut)
+	{
+		if (vertexStride == 0 || vertexData.size() % vertexStride)
+			return Result::InvalidParameter;
+
+		const uint32_t vertexCount = static_cast<uint32_t>(vertexData.size() / vertexStride);
+		std::vector<uint32_t> remap(vertexCount);
+
+		Result result = GenerateVertexFetchRemap(indices, vertexCount, remap, vertexCountOut);
+		if (IsError(result))
+			return result;
+
+		result = RemapIndices(indices, remap);
+		if (IsError(result))
+			return result;
+
+		std::vector<uint8_t> source{ vertexData.begin(), vertexData.end() };
+		return RemapVertices(source, vertexStride, remap, vertexData);
+	}
+
+	Result BuildMeshlets(std::span<const uint32_t> indices, std::span<const uint8_t> vertexData, uint32_t vertexStride, uint32_t positionOffset,
+		uint32_t maxVertices, uint32_t maxTriangles, std::vector<Meshlet>& meshletsOut, std::vector<uint32_t>& meshletVerticesOut, std::vector<uint8_t>& meshletTrianglesOut)
+	{
+		if (!ValidateVertexData(vertexData, vertexStride, positionOffset) || maxVertices < 3 || maxVertices > 255 || maxTriangles == 0)
+			return Result::InvalidParameter;
+
+		const uint32_t vertexCount = static_cast<uint32_t>(vertexData.size() / vertexStride);
+		if (!ValidateIndices(indices, vertexCount))
+			return Result::InvalidParameter;
+
+		meshletsOut.clear();
+		meshletVerticesOut.clear();
+		meshletTrianglesOut.clear();
+
+		// Index of each vertex inside the current meshlet, 0xff if it isn't in it
+		std::vector<uint8_t> localIndex(vertexCount, 0xff);
+
+		Meshlet meshlet{};
+
+		auto finishMeshlet = [&]()
+		{
+			std::span<const uint32_t> vertices{ meshletVerticesOut.data() + meshlet.vertexOffset, meshlet.vertexCount };
+			std::span<const uint8_t> triangles{ meshletTrianglesOut.data() + meshlet.triangleOffset, meshlet.triangleCount * 3 };
+
+			// Bounding sphere around the center of the bounding box
+			Float3 boundsMin{ std::numeric_limits<float>::max() }, boundsMax{ std::numeric_limits<float>::lowest() };
+			for (auto vertex : vertices)
+			{
+				const Float3 position = ReadPosition(vertexData, vertexStride, positionOffset, vertex);
+				for (uint32_t i = 0; i < 3; i++)
+				{
+					boundsMin[i] = std::min(boundsMin[i], position[i]);
+					boundsMax[i] = std::max(boundsMax[i], position[i]);
+				}
+			}
+
+			const Float3 center = (boundsMin + boundsMax) * 0.5f;
+			float radius = 0.0f;
+			for (auto vertex : vertices)
+				radius = std::max(radius, PWMath::Length(ReadPosition(vertexData, vertexStride, positionOffset, vertex) - center));
+
+			// Normal cone from the triangle normals, degenerate triangles are skipped
+			std::vector<std::pair<Float3, Float3>> planes; // { point, normal }
+			planes.reserve(meshlet.triangleCount);
+			Float3 axis{ 0.0f };
+			for (uint32_t i = 0; i < meshlet.triangleCount; i++)
+			{
+				const Float3 p0 = ReadPosition(vertexData, vertexStride, positionOffset, vertices[triangles[i * 3]]);
+				const Float3 p1 = ReadPosition(vertexData, vertexStride, positionOffset, vertices[triangles[i * 3 + 1]]);
+				const Float3 p2 = ReadPosition(vertexData, vertexStride, positionOffset, vertices[triangles[i * 3 + 2]]);
+
+				const Float3 normal = PWMath::Cross(p1 - p0, p2 - p0);
+				const float length = PWMath::Length(normal);
+				if (length <= 0.0f)
+					continue;
+
+				planes.emplace_back(p0, normal / length);
+				axis += normal / length;
+			}
+
+			float minDot = 1.0f;
+			const float axisLength = PWMath::Length(axis);
+			if (axisLength > 0.0f)
+			{
+				axis /= axisLength;
+				for (auto& [point, normal] : planes)
+					minDot = std::min(minDot, PWMath::Dot(axis, normal));
+			}
+
+			Float3 apex = center;
+			float cutoff = 1.0f;
+
+			// Past ~85 degrees the cone would almost never cull anything
+			if (axisLength > 0.0f && minDot > 0.1f)
+			{
+				// Move the apex back until it's behind every triangle's plane
+				float maxT = 0.0f;
+				for (auto& [point, normal] : planes)
+					maxT = std::max(maxT, PWMath::Dot(center - point, normal) / PWMath::Dot(axis, normal));
+
+				apex = center - axis * maxT;
+				cutoff = std::sqrt(1.0f - minDot * minDot);
+			}
+
+			meshletsOut.push_back({
+				.vertexOffset = meshlet.vertexOffset,
+				.triangleOffset = meshlet.triangleOffset,
+				.vertexCount = meshlet.vertexCount,
+				.triangleCount = meshlet.triangleCount,
+				.center = { center.x, center.y, center.z },
+				.radius = radius,
+				.coneApex = { apex.x, apex.y, apex.z },
+				.coneAxis = { axis.x, axis.y, axis.z },
+				.coneCutoff = cutoff
+			});
+
+			for (auto vertex : vertices)
+				localIndex[vertex] = 0xff;
+
+			meshlet = {};
+			meshlet.vertexOffset = static_cast<uint32_t>(meshletVerticesOut.size());
+			meshlet.triangleOffset = static_cast<uint32_t>(meshletTrianglesOut.size());
+		};
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const uint32_t* triangle = &indices[i];
+
+			uint32_t newVertices = 0;
+			for (uint32_t j = 0; j < 3; j++)
+				if (localIndex[triangle[j]] == 0xff && std::find(triangle, triangle + j, triangle[j]) == triangle + j)
+					newVertices++;
+
+			if (meshlet.vertexCount + newVertices > maxVertices || meshlet.triangleCount + 1 > maxTriangles)
+				finishMeshlet();
+
+			for (uint32_t j = 0; j < 3; j++)
+			{
+				if (localIndex[triangle[j]] == 0xff)
+				{
+					localIndex[triangle[j]] = static_cast<uint8_t>(meshlet.vertexCount++);
+					meshletVerticesOut.push_back(triangle[j]);
+				}
+
+				meshletTrianglesOut.push_back(localIndex[triangle[j]]);
+			}
+
+			meshlet.triangleCount++;
+		}
+
+		if (meshlet.triangleCount)
+			finishMeshlet();
+
+		return Result::Success;
+	}
+}
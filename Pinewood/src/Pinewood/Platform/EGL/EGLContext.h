@@ -0,0 +1,350 @@
+#pragma once
+#include "pch.h"
+#include <Pinewood/Renderer/HL/HLContext.h>
+#include "../GL4/GL4DebugOutput.h"
+#include "../GL4/GL4FrameQueue.h"
+#include "../GL4/GL4Extensions.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include "../X11/X11Include.h"
+
+#include <cstring>
+
+namespace Pinewood
+{
+	thread_local static HLContext* g_currentContext;
+
+	class HLContext::Details
+		:std::enable_shared_from_this<HLContext::Details>
+	{
+	public:
+		EGLDisplay display;
+		EGLConfig config;
+		EGLSurface surface;		// A window surface, a pbuffer for headless windows, or none for shared contexts if supported
+		EGLContext renderContext;
+		GladGLContext gl;
+		GL4Extensions extensions;
+		GL4FrameQueue frames;
+
+		~Details();
+
+		static EGLDisplay GetDisplay(::Display* nativeDisplay);
+		static Result ChooseConfig(EGLDisplay display, ::Display* nativeDisplay, ::Window nativeWindow, EGLConfig& configOut);
+		Result MakeObsolete();
+		Result Destroy();
+	};
+
+	HLContext::Details::~Details()
+	{
+		Destroy();
+	}
+
+	static GLADapiproc glLoadFunc(const char* name)
+	{
+		// EGL 1.5 also returns the core functions
+		return reinterpret_cast<GLADapiproc>(eglGetProcAddress(name));
+	}
+
+	GLADapiproc Impl::GL4GetProcAddress(const char* name)
+	{
+		return glLoadFunc(name);
+	}
+
+	static constexpr EGLint g_contextAttribs[]{
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 5,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+#if PW_DEBUG
+		EGL_CONTEXT_OPENGL_DEBUG, EGL_TRUE,
+#endif // ^^^ PW_DEBUG
+		EGL_NONE, // End
+	};
+
+	EGLDisplay HLContext::Details::GetDisplay(::Display* nativeDisplay)
+	{
+		if (nativeDisplay)
+			return eglGetPlatformDisplay(EGL_PLATFORM_X11_KHR, nativeDisplay, nullptr);
+
+		// Headless windows, Mesa can render without any window system (and without a GPU, with llvmpipe)
+		EGLDisplay display = eglGetPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+		return (display != EGL_NO_DISPLAY) ? display : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+	}
+
+	Result HLContext::Details::ChooseConfig(EGLDisplay display, ::Display* nativeDisplay, ::Window nativeWindow, EGLConfig& configOut)
+	{
+		const EGLint configAttribs[]{
+			EGL_SURFACE_TYPE, nativeWindow ? EGL_WINDOW_BIT : EGL_PBUFFER_BIT,
+			EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+			EGL_RED_SIZE, 8,
+			EGL_GREEN_SIZE, 8,
+			EGL_BLUE_SIZE, 8,
+			EGL_DEPTH_SIZE, 24,
+			EGL_STENCIL_SIZE, 8,
+			EGL_NONE, // End
+		};
+
+		EGLint numConfigs = 0;
+		if (!eglChooseConfig(display, configAttribs, nullptr, 0, &numConfigs) || numConfigs == 0)
+			return Result::SystemError;
+
+		std::vector<EGLConfig> configs(numConfigs);
+		if (!eglChooseConfig(display, configAttribs, configs.data(), numConfigs, &numConfigs) || numConfigs == 0)
+			return Result::SystemError;
+
+		// The configs are sorted best first, but a window surface needs a config with the same visual as the window
+		configOut = configs[0];
+		if (nativeWindow)
+		{
+			XWindowAttributes windowAttributes;
+			if (!XGetWindowAttributes(nativeDisplay, nativeWindow, &windowAttributes))
+				return Result::SystemError;
+
+			const VisualID visualID = XVisualIDFromVisual(windowAttributes.visual);
+			for (EGLint i = 0; i < numConfigs; i++)
+			{
+				EGLint configVisualID;
+				if (eglGetConfigAttrib(display, configs[i], EGL_NATIVE_VISUAL_ID, &configVisualID) && static_cast<VisualID>(configVisualID) == visualID)
+				{
+					configOut = configs[i];
+					break;
+				}
+			}
+		}
+
+		return Result::Success;
+	}
+
+	Result HLContext::Details::MakeObsolete()
+	{
+		// The context is already current, don't need to do anything
+		if (g_currentContext == nullptr)
+			return Result::Success;
+
+		// If an error occurs, the previous context will be made invalid anyways
+		g_currentContext = nullptr;
+
+		// Try to make it current
+		if (!eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT))
+			return Result::SystemError;
+
+		return Result::Success;
+	}
+
+	Result HLContext::MakeObsolete()
+	{
+		return m_details->MakeObsolete();
+	}
+
+	Result HLContext::MakeCurrent()
+	{
+		// The context is already current, don't need to do anything
+		if (g_currentContext == this)
+			return Result::Success;
+
+		// If an error occurs, the previous context will be made invalid
+		g_currentContext = nullptr;
+
+		// The bound API is per thread
+		if (!eglBindAPI(EGL_OPENGL_API))
+			return Result::SystemError;
+
+		// Try to make it current
+		if (!eglMakeCurrent(m_details->display, m_details->surface, m_details->surface, m_details->renderContext))
+			return Result::SystemError;
+
+		// The context was successfully made current
+		g_currentContext = this;
+
+		return Result::Success;
+	}
+
+	Result HLContext::Details::Destroy()
+	{
+		if (!renderContext)
+			return Result::NotInitialized;
+
+		MakeObsolete();
+		frames.Reset();
+		eglDestroyContext(display, renderContext);
+		if (surface != EGL_NO_SURFACE)
+			eglDestroySurface(display, surface);
+
+		// Prevent double free (the display is never terminated, other contexts may share it)
+		renderContext = EGL_NO_CONTEXT;
+		surface = EGL_NO_SURFACE;
+
+		return Result::Success;
+	}
+
+	Result HLContext::Create(const HLContextCreateInfo& createInfo)
+	{
+		Window window = createInfo.window;
+		auto* nativeDisplay = static_cast<::Display*>(window.GetNativeDisplay());
+		auto nativeWindow = reinterpret_cast<::Window>(window.GetNativeHandle());
+
+		EGLDisplay display = Details::GetDisplay(nativeDisplay);
+		if (display == EGL_NO_DISPLAY)
+			return Result::SystemError;
+
+		if (!eglInitialize(display, nullptr, nullptr))
+			return Result::SystemError;
+
+		if (!eglBindAPI(EGL_OPENGL_API))
+			return Result::SystemError;
+
+		EGLConfig config;
+		Result result = Details::ChooseConfig(display, nativeDisplay, nativeWindow, config);
+		if (IsError(result))
+			return result;
+
+		EGLContext renderContext = eglCreateContext(display, config, EGL_NO_CONTEXT, g_contextAttribs);
+		if (renderContext == EGL_NO_CONTEXT)
+			return Result::SystemError;
+
+		EGLSurface surface;
+		if (nativeWindow)
+			surface = eglCreateWindowSurface(display, config, nativeWindow, nullptr);
+		else
+		{
+			// Headless windows render into a pbuffer with the size of the window
+			uint16_t width, height;
+			result = window.GetSize(width, height);
+			if (IsError(result))
+			{
+				eglDestroyContext(display, renderContext);
+				return result;
+			}
+
+			const EGLint pbufferAttribs[]{
+				EGL_WIDTH, std::max<EGLint>(width, 1),
+				EGL_HEIGHT, std::max<EGLint>(height, 1),
+				EGL_NONE, // End
+			};
+			surface = eglCreatePbufferSurface(display, config, pbufferAttribs);
+		}
+
+		if (surface == EGL_NO_SURFACE)
+		{
+			eglDestroyContext(display, renderContext);
+			return Result::SystemError;
+		}
+
+		m_details = std::make_shared<Details>();
+		m_details->display = display;
+		m_details->config = config;
+		m_details->surface = surface;
+		m_details->renderContext = renderContext;
+
+		result = MakeCurrent();
+		if (IsError(result))
+		{
+			m_details.reset(); // Destroys the context and surface
+			return result;
+		}
+
+		if (!gladLoadGLContext(&m_details->gl, glLoadFunc))
+		{
+			m_details.reset();
+			return Result::UnknownError;
+		}
+
+		GL4EnableDebugOutput(m_details->gl);
+		m_details->extensions = GL4LoadExtensions(m_details->gl);
+
+		m_details->frames.Create(createInfo.framesInFlight, createInfo.targetFrameTime);
+
+		// Pbuffers aren't presented, so there is nothing to sync with
+		if (nativeWindow)
+		{
+			result = SetSwapInterval(createInfo.swapInterval);
+			if (IsError(result))
+				return result;
+		}
+
+		return Result::Success;
+	}
+
+	Result HLContext::CreateShared(const HLContext& shareContext)
+	{
+		if (!shareContext.m_details || !shareContext.m_details->renderContext)
+			return Result::InvalidParameter;
+
+		const Details& shareDetails = *shareContext.m_details;
+		EGLDisplay display = shareDetails.display;
+
+		// The bound API is per thread
+		if (!eglBindAPI(EGL_OPENGL_API))
+			return Result::SystemError;
+
+		EGLContext renderContext = eglCreateContext(display, shareDetails.config, shareDetails.renderContext, g_contextAttribs);
+		if (renderContext == EGL_NO_CONTEXT)
+			return Result::SystemError;
+
+		// A shared context never draws to the screen, only make a tiny pbuffer if it can't be current without a surface
+		EGLSurface surface = EGL_NO_SURFACE;
+		const char* extensions = eglQueryString(display, EGL_EXTENSIONS);
+		if (!extensions || !std::strstr(extensions, "EGL_KHR_surfaceless_context"))
+		{
+			constexpr EGLint pbufferAttribs[]{
+				EGL_WIDTH, 1,
+				EGL_HEIGHT, 1,
+				EGL_NONE, // End
+			};
+			surface = eglCreatePbufferSurface(display, shareDetails.config, pbufferAttribs);
+			if (surface == EGL_NO_SURFACE)
+			{
+				eglDestroyContext(display, renderContext);
+				return Result::SystemError;
+			}
+		}
+
+		m_details = std::make_shared<Details>();
+		m_details->display = display;
+		m_details->config = shareDetails.config;
+		m_details->surface = surface;
+		m_details->renderContext = renderContext;
+
+		// The functions and extensions are the same for every context of the display, and loading them needs the context to be current
+		m_details->gl = shareDetails.gl;
+		m_details->extensions = shareDetails.extensions;
+
+		return Result::Success;
+	}
+
+	Result HLContext::SwapBuffers()
+	{
+		if (!eglSwapBuffers(m_details->display, m_details->surface))
+			return Result::SystemError;
+
+		return Result::Success;
+	}
+
+	Result HLContext::SetSwapInterval(uint32_t interval)
+	{
+		if (!eglSwapInterval(m_details->display, static_cast<EGLint>(interval)))
+			return Result::SystemError;
+
+		return Result::Success;
+	}
+
+	Result HLContext::ResizeSwapChain(uint16_t width, uint32_t height)
+	{
+		m_details->gl.Viewport(0, 0, width, height);
+
+		if (m_details->gl.IsEnabled(GL_SCISSOR_TEST))
+			m_details->gl.Scissor(0, 0, width, height);
+
+		return Result::Success;
+	}
+
+	HLContext::NativeHandle HLContext::GetNativeHandle()
+	{
+		return NativeHandle{ m_details->renderContext, &m_details->gl, &m_details->extensions };
+	}
+
+	bool HLContext::IsInitialized()
+	{
+		return m_details && m_details->renderContext;
+	}
+}
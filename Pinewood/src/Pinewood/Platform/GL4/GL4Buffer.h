@@ -1,6 +1,7 @@
 #pragma once
 #include "pch.h"
 #include <Pinewood/Renderer/HL/HLBuffer.h>
+#include "../../Renderer/HL/HLRenderStatsCounters.h"
 
 namespace Pinewood
 {
@@ -11,6 +12,7 @@ namespace Pinewood
 		const GladGLContext* gl; // So I don't need to get it from the context all the time
 		
 		uint32_t buffer;
+		size_t size;
 
 		~Details();
 
@@ -24,7 +26,11 @@ namespace Pinewood
 	
 	Result HLBuffer::Details::Destroy()
 	{
+		if (!gl)
+			return Result::Success; // Already destroyed
+
 		gl->DeleteBuffers(1, &buffer);
+		Impl::CountResourceDestroyed(HLResourceType::Buffer, size);
 
 		gl = nullptr;
 		context = HLContext{};
@@ -38,7 +44,10 @@ namespace Pinewood
 		m_details->context = createInfo.context;
 		m_details->gl = static_cast<const GladGLContext*>(m_details->context.GetNativeHandle().gl);
 
+		m_details->size = createInfo.size;
+
 		m_details->gl->CreateBuffers(1, &m_details->buffer);
+		Impl::CountResourceCreated(HLResourceType::Buffer, createInfo.size);
 
 		m_details->gl->NamedBufferStorage(m_details->buffer, createInfo.size, createInfo.data, 
 			(createInfo.usage == HLBufferUsage::Mutable) ? (GL_MAP_READ_BIT | GL_MAP_WRITE_BIT | GL_DYNAMIC_STORAGE_BIT) : 0);
@@ -54,6 +63,7 @@ namespace Pinewood
 	Result HLBuffer::SetData(void* data, size_t offset, size_t size)
 	{
 		m_details->gl->NamedBufferSubData(m_details->buffer, offset, size, data);
+		Impl::CountStat(Impl::renderStats.bufferUploadBytes, size);
 
 		return Result();
 	}
@@ -65,12 +75,26 @@ namespace Pinewood
 		return Result();
 	}
 
+	Result HLBuffer::CopyData(const HLBuffer& source, size_t sourceOffset, size_t offset, size_t size)
+	{
+		// non-const copy
+		HLBuffer src = source;
+
+		if (src.GetNativeHandle() == m_details->buffer && sourceOffset < offset + size && offset < sourceOffset + size)
+			return Result::InvalidParameter;
+
+		m_details->gl->CopyNamedBufferSubData(src.GetNativeHandle(), m_details->buffer, sourceOffset, offset, size);
+
+		return Result::Success;
+	}
+
 	Result HLBuffer::Map(void*& ptrOut, HLBufferAccess access)
 	{
 		ptrOut = m_details->gl->MapNamedBuffer(m_details->buffer,
 			(access == HLBufferAccess::Read ? GL_READ_ONLY :
 			(access == HLBufferAccess::Write ? GL_WRITE_ONLY :
 			(access == (HLBufferAccess::Read | HLBufferAccess::Write) ? GL_READ_WRITE : 0))));
+		Impl::CountStat(Impl::renderStats.mappedBytes, m_details->size);
 
 		return Result::Success;
 	}
@@ -82,6 +106,11 @@ namespace Pinewood
 		return ok ? Result::Success : Result::BufferMapCorrupt;
 	}
 
+	size_t HLBuffer::GetSize()
+	{
+		return m_details->size;
+	}
+
 	HLBuffer::NativeHandle HLBuffer::GetNativeHandle()
 	{
 		return m_details->buffer;
@@ -0,0 +1,55 @@
+#pragma once
+#include "pch.h"
+#include <Pinewood/Renderer/HL/HLContext.h>
+#include "GL4FrameQueue.h"
+
+// The parts of HLContext that are the same for every OpenGL context backend, included after the backend (WGL/EGL)
+// The backend's HLContext::Details has the GladGLContext 'gl', the GL4Extensions 'extensions' and the GL4FrameQueue 'frames'
+
+namespace Pinewood
+{
+	Result HLContext::Destroy()
+	{
+		auto result = m_details->Destroy();
+		m_details = nullptr;
+		return result;
+	}
+
+	Result HLContext::BeginFrame()
+	{
+		return m_details->frames.BeginFrame(m_details->gl);
+	}
+
+	Result HLContext::EndFrame()
+	{
+		Result result = m_details->frames.EndFrame(m_details->gl);
+		if (IsError(result))
+			return result;
+
+		// Fence the frame even if the swap failed, so the next BeginFrame for this slot doesn't break
+		result = SwapBuffers();
+		m_details->frames.FenceFrame(m_details->gl);
+
+		return result;
+	}
+
+	uint32_t HLContext::GetFrameSlot()
+	{
+		return m_details->frames.GetFrameSlot();
+	}
+
+	Result HLContext::DeferUntilFrameFinished(std::function<void()> function)
+	{
+		return m_details->frames.DeferUntilFrameFinished(std::move(function));
+	}
+
+	void HLContext::SetTargetFrameTime(float targetFrameTime)
+	{
+		m_details->frames.SetTargetFrameTime(targetFrameTime);
+	}
+
+	HLFrameStats HLContext::GetFrameStats()
+	{
+		return m_details->frames.GetStats();
+	}
+}
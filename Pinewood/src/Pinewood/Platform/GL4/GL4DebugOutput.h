@@ -0,0 +1,108 @@
+#pragma once
+#include "pch.h"
+
+#include <cstdio>
+
+namespace Pinewood
+{
+	// Prints the messages of GL_DEBUG_OUTPUT, shared by every OpenGL context implementation
+	static void GLAD_API_PTR GL4DebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei, const GLchar* message, const void*)
+	{
+		const char* messageSource;
+		const char* messageType;
+		const char* messageSeverity;
+		bool isSevere = false;
+
+		switch (source)
+		{
+		case GL_DEBUG_SOURCE_API:
+			messageSource = "OpenGL";
+			break;
+		case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
+			messageSource = "Window System";
+			break;
+		case GL_DEBUG_SOURCE_SHADER_COMPILER:
+			messageSource = "Shader Compiler";
+			break;
+		case GL_DEBUG_SOURCE_THIRD_PARTY:
+			messageSource = "Third Party";
+			break;
+		case GL_DEBUG_SOURCE_APPLICATION:
+			messageSource = "Application";
+			break;
+		case GL_DEBUG_SOURCE_OTHER:
+			messageSource = "Other";
+			break;
+		default:
+			messageSource = "Unknown";
+		}
+
+		switch (type)
+		{
+		case GL_DEBUG_TYPE_ERROR:
+			messageType = "Error";
+			break;
+		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
+			messageType = "Deprecated Behavior";
+			break;
+		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
+			messageType = "Undefined Behavior";
+			break;
+		case GL_DEBUG_TYPE_PORTABILITY:
+			messageType = "Portability";
+			break;
+		case GL_DEBUG_TYPE_PERFORMANCE:
+			messageType = "Performance";
+			break;
+		case GL_DEBUG_TYPE_MARKER:
+			messageType = "Marker";
+			break;
+		case GL_DEBUG_TYPE_PUSH_GROUP:
+			messageType = "Push Group";
+			break;
+		case GL_DEBUG_TYPE_POP_GROUP:
+			messageType = "Pop Group";
+			break;
+		case GL_DEBUG_TYPE_OTHER:
+			messageType = "Other";
+			break;
+		default:
+			messageType = "Unknown";
+		}
+
+		switch (severity)
+		{
+		case GL_DEBUG_SEVERITY_HIGH:
+			messageSeverity = "High";
+			isSevere = true;
+			break;
+		case GL_DEBUG_SEVERITY_MEDIUM:
+			messageSeverity = "Medium";
+			isSevere = true;
+			break;
+		case GL_DEBUG_SEVERITY_LOW:
+			messageSeverity = "Low";
+			break;
+		case GL_DEBUG_SEVERITY_NOTIFICATION:
+			messageSeverity = "Notification";
+			break;
+		default:
+			messageSeverity = "Unknown";
+		}
+
+		// Severe messages go to stderr, so they still show up when stdout is redirected or buffered
+		std::fprintf(isSevere ? stderr : stdout, "OpenGL Error (source = %s, type = %s, id = %u, severity = %s):\n%s\n\n", messageSource, messageType, id,
+			messageSeverity, message);
+	}
+
+	// Sends the debug output of the current context to GL4DebugMessageCallback, only the severe messages in release builds
+	static void GL4EnableDebugOutput(const GladGLContext& gl)
+	{
+		gl.Enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+		gl.DebugMessageCallback(GL4DebugMessageCallback, nullptr);
+#if !PW_DEBUG
+		gl.DebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_LOW, 0, nullptr, GL_FALSE);
+		gl.DebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
+#endif // ^^^ !PW_DEBUG
+	}
+}
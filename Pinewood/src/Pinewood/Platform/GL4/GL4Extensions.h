@@ -0,0 +1,123 @@
+#pragma once
+#include "pch.h"
+
+#include <cstring>
+
+// glad only loads OpenGL 4.5 core, the functions of newer versions and extensions are loaded here
+
+namespace Pinewood
+{
+	namespace Impl
+	{
+		// Implemented by the platform's context (WGL or EGL), loads any OpenGL function of the current context
+		GLADapiproc GL4GetProcAddress(const char* name);
+
+		// GL_PARAMETER_BUFFER of OpenGL 4.6 and GL_ARB_indirect_parameters (same value)
+		constexpr GLenum GLParameterBuffer = 0x80EE;
+
+		// GL_TEXTURE_MAX_ANISOTROPY and GL_MAX_TEXTURE_MAX_ANISOTROPY of OpenGL 4.6 and GL_ARB_texture_filter_anisotropic
+		constexpr GLenum GLTextureMaxAnisotropy = 0x84FE;
+		constexpr GLenum GLMaxTextureMaxAnisotropy = 0x84FF;
+
+		// GL_GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX and GL_GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, in KiB
+		constexpr GLenum GLGPUMemoryInfoDedicatedVidmemNVX = 0x9047;
+		constexpr GLenum GLGPUMemoryInfoCurrentAvailableVidmemNVX = 0x9049;
+
+		// GL_TEXTURE_FREE_MEMORY_ATI, 4 values in KiB (the first is the free memory)
+		constexpr GLenum GLTextureFreeMemoryATI = 0x87FC;
+
+		// GL_SHADER_BINARY_FORMAT_SPIR_V of OpenGL 4.6 and GL_ARB_gl_spirv (same value)
+		constexpr GLenum GLShaderBinaryFormatSpirV = 0x9551;
+	}
+
+	struct GL4Extensions
+	{
+		using MultiDrawElementsIndirectCountFunction = void (GLAD_API_PTR*)(GLenum mode, GLenum type, const void* indirect, GLintptr drawCount,
+			GLsizei maxDrawCount, GLsizei stride);
+
+		// OpenGL 4.6 or GL_ARB_indirect_parameters, nullptr if neither is supported
+		MultiDrawElementsIndirectCountFunction MultiDrawElementsIndirectCount = nullptr;
+
+		// OpenGL 4.6 or GL_ARB_texture_filter_anisotropic (or the EXT), 1 if anisotropic filtering isn't supported
+		float maxAnisotropy = 1.0f;
+
+		using GetTextureSamplerHandleFunction = GLuint64 (GLAD_API_PTR*)(GLuint texture, GLuint sampler);
+		using TextureHandleResidencyFunction = void (GLAD_API_PTR*)(GLuint64 handle);
+
+		// GL_ARB_bindless_texture, nullptr if it isn't supported
+		GetTextureSamplerHandleFunction GetTextureSamplerHandle = nullptr;
+		TextureHandleResidencyFunction MakeTextureHandleResident = nullptr;
+		TextureHandleResidencyFunction MakeTextureHandleNonResident = nullptr;
+
+		// GL_ARB_shader_draw_parameters, gl_BaseInstanceARB in shaders (OpenGL 4.6 only has gl_BaseInstance in GLSL 4.60)
+		bool shaderDrawParameters = false;
+
+		// GL_NVX_gpu_memory_info and GL_ATI_meminfo, the memory of the GPU
+		bool memoryInfoNVX = false;
+		bool memoryInfoATI = false;
+
+		using SpecializeShaderFunction = void (GLAD_API_PTR*)(GLuint shader, const GLchar* entryPoint, GLuint numSpecializationConstants,
+			const GLuint* constantIndex, const GLuint* constantValue);
+
+		// OpenGL 4.6 or GL_ARB_gl_spirv, nullptr if SPIR-V shaders aren't supported
+		SpecializeShaderFunction SpecializeShader = nullptr;
+	};
+
+	inline bool GL4HasExtension(const GladGLContext& gl, const char* name)
+	{
+		GLint count = 0;
+		gl.GetIntegerv(GL_NUM_EXTENSIONS, &count);
+		for (GLint i = 0; i < count; i++)
+		{
+			if (std::strcmp(reinterpret_cast<const char*>(gl.GetStringi(GL_EXTENSIONS, i)), name) == 0)
+				return true;
+		}
+
+		return false;
+	}
+
+	// Loads the extensions of the current context, done once by the context (see HLContext::NativeHandle::extensions)
+	inline GL4Extensions GL4LoadExtensions(const GladGLContext& gl)
+	{
+		GL4Extensions extensions;
+
+		GLint major = 0, minor = 0;
+		gl.GetIntegerv(GL_MAJOR_VERSION, &major);
+		gl.GetIntegerv(GL_MINOR_VERSION, &minor);
+		const bool gl46 = major > 4 || (major == 4 && minor >= 6);
+
+		if (gl46)
+			extensions.MultiDrawElementsIndirectCount = reinterpret_cast<GL4Extensions::MultiDrawElementsIndirectCountFunction>(
+				Impl::GL4GetProcAddress("glMultiDrawElementsIndirectCount"));
+		else if (GL4HasExtension(gl, "GL_ARB_indirect_parameters"))
+			extensions.MultiDrawElementsIndirectCount = reinterpret_cast<GL4Extensions::MultiDrawElementsIndirectCountFunction>(
+				Impl::GL4GetProcAddress("glMultiDrawElementsIndirectCountARB"));
+
+		if (gl46 || GL4HasExtension(gl, "GL_ARB_texture_filter_anisotropic") ||
+			GL4HasExtension(gl, "GL_EXT_texture_filter_anisotropic"))
+			gl.GetFloatv(Impl::GLMaxTextureMaxAnisotropy, &extensions.maxAnisotropy);
+
+		if (GL4HasExtension(gl, "GL_ARB_bindless_texture"))
+		{
+			extensions.GetTextureSamplerHandle = reinterpret_cast<GL4Extensions::GetTextureSamplerHandleFunction>(
+				Impl::GL4GetProcAddress("glGetTextureSamplerHandleARB"));
+			extensions.MakeTextureHandleResident = reinterpret_cast<GL4Extensions::TextureHandleResidencyFunction>(
+				Impl::GL4GetProcAddress("glMakeTextureHandleResidentARB"));
+			extensions.MakeTextureHandleNonResident = reinterpret_cast<GL4Extensions::TextureHandleResidencyFunction>(
+				Impl::GL4GetProcAddress("glMakeTextureHandleNonResidentARB"));
+		}
+
+		extensions.shaderDrawParameters = GL4HasExtension(gl, "GL_ARB_shader_draw_parameters");
+		extensions.memoryInfoNVX = GL4HasExtension(gl, "GL_NVX_gpu_memory_info");
+		extensions.memoryInfoATI = GL4HasExtension(gl, "GL_ATI_meminfo");
+
+		if (gl46)
+			extensions.SpecializeShader = reinterpret_cast<GL4Extensions::SpecializeShaderFunction>(
+				Impl::GL4GetProcAddress("glSpecializeShader"));
+		else if (GL4HasExtension(gl, "GL_ARB_gl_spirv"))
+			extensions.SpecializeShader = reinterpret_cast<GL4Extensions::SpecializeShaderFunction>(
+				Impl::GL4GetProcAddress("glSpecializeShaderARB"));
+
+		return extensions;
+	}
+}
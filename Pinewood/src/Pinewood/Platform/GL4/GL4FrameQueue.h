@@ -0,0 +1,191 @@
+#pragma once
+#include "pch.h"
+#include <Pinewood/Renderer/HL/HLContext.h>
+#include <Pinewood/Profiler.h>
+
+#include <chrono>
+#include <thread>
+
+namespace Pinewood
+{
+	// The frames in flight of an OpenGL context (HLContext::BeginFrame/EndFrame), the same for every platform
+	class GL4FrameQueue
+	{
+	public:
+		void Create(uint32_t framesInFlight, float targetFrameTime)
+		{
+			m_frames = std::vector<Frame>(std::max(framesInFlight, 1u));
+			m_targetFrameTime = targetFrameTime;
+		}
+
+		// The context is being destroyed, its fences and queries go with it
+		void Reset()
+		{
+			m_frames.clear();
+			m_queriesCreated = false;
+			m_inFrame = false;
+		}
+
+		Result BeginFrame(GladGLContext& gl)
+		{
+			if (m_inFrame || m_frames.empty())
+				return Result::InvalidParameter;
+
+			if (!m_queriesCreated)
+			{
+				for (auto& frame : m_frames)
+				{
+					gl.CreateQueries(GL_TIMESTAMP, 1, &frame.beginQuery);
+					gl.CreateQueries(GL_TIMESTAMP, 1, &frame.endQuery);
+				}
+				m_queriesCreated = true;
+			}
+
+			Frame& frame = m_frames[m_frameIndex % m_frames.size()];
+
+			// Wait until the GPU is done with the frame that used this slot
+			const uint64_t waitBegin = Profiler::GetTime();
+			if (frame.fence)
+			{
+				GLenum status = gl.ClientWaitSync(frame.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+				while (status == GL_TIMEOUT_EXPIRED)
+					status = gl.ClientWaitSync(frame.fence, 0, 100'000'000); // 100 ms
+
+				gl.DeleteSync(frame.fence);
+				frame.fence = nullptr;
+				if (status == GL_WAIT_FAILED)
+					return Result::SystemError;
+
+				// The frame is finished, so its queries are available
+				GLuint64 gpuBegin = 0, gpuEnd = 0;
+				gl.GetQueryObjectui64v(frame.beginQuery, GL_QUERY_RESULT, &gpuBegin);
+				gl.GetQueryObjectui64v(frame.endQuery, GL_QUERY_RESULT, &gpuEnd);
+				m_stats.gpuFrameTime = (gpuEnd - std::min(gpuBegin, gpuEnd)) / 1'000'000.0;
+				m_stats.latency = (static_cast<int64_t>(gpuEnd) + frame.gpuToCPUOffset - static_cast<int64_t>(frame.cpuBegin)) / 1'000'000.0;
+
+				auto functions = std::move(frame.deferred);
+				frame.deferred.clear();
+				for (auto& function : functions)
+					function();
+			}
+			const uint64_t waitEnd = Profiler::GetTime();
+			m_stats.fenceWaitTime = (waitEnd - waitBegin) / 1'000'000.0;
+
+			// Don't start the frame before the target frame time since the last one
+			uint64_t now = waitEnd;
+			m_stats.pacingTime = 0.0;
+			if (m_targetFrameTime > 0.0f && m_lastBegin != 0)
+			{
+				const uint64_t target = m_lastBegin + static_cast<uint64_t>(m_targetFrameTime * 1'000'000.0);
+				if (now < target)
+				{
+					// The scheduler can oversleep by a millisecond or more, so sleep most of it and yield the rest
+					constexpr uint64_t SpinTime = 2'000'000;
+					if (target - now > SpinTime)
+						std::this_thread::sleep_for(std::chrono::nanoseconds(target - now - SpinTime));
+
+					while ((now = Profiler::GetTime()) < target)
+						std::this_thread::yield();
+
+					m_stats.pacingTime = (now - waitEnd) / 1'000'000.0;
+				}
+			}
+
+			m_stats.frameInterval = (m_lastBegin != 0) ? (now - m_lastBegin) / 1'000'000.0 : 0.0;
+			m_lastBegin = now;
+
+			frame.cpuBegin = now;
+			gl.QueryCounter(frame.beginQuery, GL_TIMESTAMP);
+			m_inFrame = true;
+
+			return Result::Success;
+		}
+
+		// Before swapping the buffers
+		Result EndFrame(GladGLContext& gl)
+		{
+			if (!m_inFrame)
+				return Result::InvalidParameter;
+
+			Frame& frame = m_frames[m_frameIndex % m_frames.size()];
+			gl.QueryCounter(frame.endQuery, GL_TIMESTAMP);
+			m_stats.cpuFrameTime = (Profiler::GetTime() - frame.cpuBegin) / 1'000'000.0;
+
+			return Result::Success;
+		}
+
+		// After swapping the buffers, so the fence also covers the swap
+		void FenceFrame(GladGLContext& gl)
+		{
+			Frame& frame = m_frames[m_frameIndex % m_frames.size()];
+			frame.fence = gl.FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+			// Timestamp queries are in GPU time, remember how it relates to our clock for the latency
+			GLint64 gpuNow = 0;
+			gl.GetInteger64v(GL_TIMESTAMP, &gpuNow);
+			frame.gpuToCPUOffset = static_cast<int64_t>(Profiler::GetTime()) - gpuNow;
+
+			m_stats.queueDepth = 0;
+			for (auto& other : m_frames)
+			{
+				GLint status = GL_SIGNALED;
+				if (other.fence)
+					gl.GetSynciv(other.fence, GL_SYNC_STATUS, 1, nullptr, &status);
+				if (status != GL_SIGNALED)
+					m_stats.queueDepth++;
+			}
+
+			m_frameIndex++;
+			m_stats.frameIndex = m_frameIndex;
+			m_inFrame = false;
+		}
+
+		uint32_t GetFrameSlot() const
+		{
+			return m_frames.empty() ? 0 : static_cast<uint32_t>(m_frameIndex % m_frames.size());
+		}
+
+		Result DeferUntilFrameFinished(std::function<void()> function)
+		{
+			if (m_frames.empty())
+				return Result::NotInitialized;
+
+			// Outside of a frame, wait for the last frame that was ended
+			const uint64_t frameIndex = m_inFrame ? m_frameIndex : m_frameIndex + m_frames.size() - 1;
+			Frame& frame = m_frames[frameIndex % m_frames.size()];
+			if (!m_inFrame && !frame.fence)
+			{
+				// Nothing is in flight
+				function();
+				return Result::Success;
+			}
+
+			frame.deferred.push_back(std::move(function));
+			return Result::Success;
+		}
+
+		void SetTargetFrameTime(float targetFrameTime) { m_targetFrameTime = targetFrameTime; }
+
+		const HLFrameStats& GetStats() const { return m_stats; }
+
+	private:
+		struct Frame
+		{
+			GLsync fence = nullptr;
+			GLuint beginQuery = 0, endQuery = 0;
+			uint64_t cpuBegin = 0;			// Profiler::GetTime
+			int64_t gpuToCPUOffset = 0;		// Added to a GPU timestamp to get Profiler::GetTime
+			std::vector<std::function<void()>> deferred;
+		};
+
+		std::vector<Frame> m_frames;
+		uint64_t m_frameIndex = 0;
+		bool m_inFrame = false;
+		bool m_queriesCreated = false;
+
+		float m_targetFrameTime = 0.0f;
+		uint64_t m_lastBegin = 0;
+
+		HLFrameStats m_stats{};
+	};
+}
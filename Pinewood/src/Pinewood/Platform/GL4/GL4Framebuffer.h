@@ -1,6 +1,7 @@
 #pragma once
 #include "pch.h"
 #include <Pinewood/Renderer/HL/HLFramebuffer.h>
+#include "../../Renderer/HL/HLRenderStatsCounters.h"
 
 namespace Pinewood
 {
@@ -11,6 +12,7 @@ namespace Pinewood
 		const GladGLContext* gl; // So I don't need to get it from the context all the time
 		
 		uint32_t framebuffer;
+		uint32_t width, height, samples; // Of the first attachment, all attachments must match
 
 		std::vector<HLTexture2D> textures; // To make sure they don't disappear
 
@@ -52,7 +54,11 @@ namespace Pinewood
 	
 	Result HLFramebuffer::Details::Destroy()
 	{
+		if (!gl)
+			return Result::Success; // Already destroyed
+
 		gl->DeleteFramebuffers(1, &framebuffer);
+		Impl::CountResourceDestroyed(HLResourceType::Framebuffer);
 
 		gl = nullptr;
 		context = HLContext{};
@@ -71,6 +77,7 @@ namespace Pinewood
 		m_details->gl = static_cast<const GladGLContext*>(m_details->context.GetNativeHandle().gl);
 
 		m_details->gl->CreateFramebuffers(1, &m_details->framebuffer);
+		Impl::CountResourceCreated(HLResourceType::Framebuffer);
 
 		for (uint32_t i = 0; i < createInfo.textures.size(); i++)
 			m_details->gl->NamedFramebufferTexture(m_details->framebuffer,
@@ -78,6 +85,14 @@ namespace Pinewood
 
 		std::copy(createInfo.textures.begin(), createInfo.textures.end(), std::back_inserter(m_details->textures));
 
+		m_details->width = m_details->height = 0;
+		m_details->samples = 1;
+		if (!m_details->textures.empty())
+		{
+			m_details->textures[0].GetSize(m_details->width, m_details->height);
+			m_details->samples = m_details->textures[0].GetSampleCount();
+		}
+
 		if (m_details->gl->CheckNamedFramebufferStatus(m_details->framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 			return Result::SystemError;
 
@@ -89,6 +104,19 @@ namespace Pinewood
 		return m_details->Destroy();
 	}
 
+	Result HLFramebuffer::GetSize(uint32_t& widthOut, uint32_t& heightOut)
+	{
+		widthOut = m_details->width;
+		heightOut = m_details->height;
+
+		return Result::Success;
+	}
+
+	uint32_t HLFramebuffer::GetSampleCount()
+	{
+		return m_details->samples;
+	}
+
 	HLFramebuffer::NativeHandle HLFramebuffer::GetNativeHandle()
 	{
 		return m_details->framebuffer;
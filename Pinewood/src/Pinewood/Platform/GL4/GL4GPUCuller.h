@@ -0,0 +1,296 @@
+#pragma once
+#include "pch.h"
+#include <Pinewood/Renderer/HL/HLGPUCuller.h>
+#include <Pinewood/Renderer/HL/HLShaderModule.h>
+#include <Pinewood/Renderer/HL/HLShaderProgram.h>
+#include <Pinewood/Profiler.h>
+
+#include <cmath>
+#include <string>
+
+namespace Pinewood
+{
+	// COMPACT is defined before it: 1 appends the visible objects, 0 writes a command for every object (no draw indirect count)
+	static constexpr const char* g_cullComputeSource = R"(
+layout(local_size_x = 64) in;
+
+struct Object
+{
+	vec4 sphere;
+	uint indexCount;
+	uint firstIndex;
+	int baseVertex;
+	uint padding;
+};
+
+struct Command
+{
+	uint indexCount;
+	uint instanceCount;
+	uint firstIndex;
+	int baseVertex;
+	uint baseInstance;
+};
+
+layout(std140, binding = 0) uniform CullParams
+{
+	vec4 u_planes[6];
+	uint u_objectCount;
+};
+
+layout(std430, binding = 0) readonly buffer Objects { Object objects[]; };
+layout(std430, binding = 1) writeonly buffer Commands { Command commands[]; };
+layout(std430, binding = 2) buffer Count { uint drawCount; };
+
+void main()
+{
+	uint index = gl_GlobalInvocationID.x;
+	if (index >= u_objectCount)
+		return;
+
+	Object object = objects[index];
+
+	bool visible = true;
+	for (int i = 0; i < 6; i++)
+		visible = visible && dot(u_planes[i].xyz, object.sphere.xyz) + u_planes[i].w >= -object.sphere.w;
+
+#if COMPACT
+	if (!visible)
+		return;
+
+	commands[atomicAdd(drawCount, 1)] = Command(object.indexCount, 1, object.firstIndex, object.baseVertex, index);
+#else
+	if (visible)
+		atomicAdd(drawCount, 1);
+
+	commands[index] = Command(object.indexCount, visible ? 1 : 0, object.firstIndex, object.baseVertex, index);
+#endif
+}
+)";
+
+	class HLGPUCuller::Details
+	{
+	public:
+		// The uniform block of the shader (std140)
+		struct CullParams
+		{
+			float planes[6][4]; // xyz = normal pointing inside, w = distance
+			uint32_t objectCount;
+			uint32_t padding[3];
+		};
+
+		static constexpr uint32_t GroupSize = 64;
+
+		HLRenderInterface renderInterface;
+		uint32_t maxObjectCount;
+		uint32_t objectCount = 0;
+
+		HLBuffer objectBuffer, commandBuffer, countBuffer, paramsBuffer;
+		HLShaderModule computeModule;
+		HLShaderProgram computeProgram;
+
+		~Details();
+
+		static void ExtractFrustumPlanes(const float (&matrix)[16], float (&planesOut)[6][4]);
+		Result Destroy();
+	};
+
+	HLGPUCuller::Details::~Details()
+	{
+		Destroy();
+	}
+
+	void HLGPUCuller::Details::ExtractFrustumPlanes(const float (&matrix)[16], float (&planesOut)[6][4])
+	{
+		// The matrix is column major, row r of the matrix is (m[r], m[4 + r], m[8 + r], m[12 + r]).
+		// A point is inside if -w <= x, y, z <= w in clip space, so each plane is the w row plus or minus the x, y or z row
+		auto row = [&matrix](uint32_t r, uint32_t c) { return matrix[c * 4 + r]; };
+		for (uint32_t axis = 0; axis < 3; axis++)
+		{
+			for (uint32_t side = 0; side < 2; side++)
+			{
+				float (&plane)[4] = planesOut[axis * 2 + side];
+				const float sign = side == 0 ? 1.0f : -1.0f;
+				for (uint32_t c = 0; c < 4; c++)
+					plane[c] = row(3, c) + sign * row(axis, c);
+
+				// Normalized, so the distance can be compared with the radius
+				const float length = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+				if (length > 0.0f)
+				{
+					for (float& value : plane)
+						value /= length;
+				}
+			}
+		}
+	}
+
+	Result HLGPUCuller::Details::Destroy()
+	{
+		if (!renderInterface.IsInitialized())
+			return Result::Success; // Already destroyed
+
+		computeProgram.Destroy();
+		computeModule.Destroy();
+		paramsBuffer.Destroy();
+		countBuffer.Destroy();
+		commandBuffer.Destroy();
+		objectBuffer.Destroy();
+
+		renderInterface = HLRenderInterface{};
+
+		return Result::Success;
+	}
+
+	Result HLGPUCuller::Create(const HLGPUCullerCreateInfo& createInfo)
+	{
+		HLRenderInterface renderInterface = createInfo.renderInterface;
+		if (!renderInterface.IsInitialized() || createInfo.maxObjectCount == 0)
+			return Result::InvalidParameter;
+
+		m_details = std::make_shared<Details>();
+		m_details->renderInterface = renderInterface;
+		m_details->maxObjectCount = createInfo.maxObjectCount;
+
+		HLContext context = renderInterface.GetContext();
+
+		Result result = m_details->objectBuffer.Create({
+			.context = context,
+			.usage = HLBufferUsage::Mutable,
+			.size = sizeof(HLGPUCullerObject) * createInfo.maxObjectCount,
+			.data = nullptr
+			});
+		if (!IsError(result))
+			result = m_details->commandBuffer.Create({
+				.context = context,
+				.usage = HLBufferUsage::Immutable, // Only written by the shader
+				.size = sizeof(HLDrawIndexedIndirectCommand) * createInfo.maxObjectCount,
+				.data = nullptr
+				});
+		if (!IsError(result))
+			result = m_details->countBuffer.Create({
+				.context = context,
+				.usage = HLBufferUsage::Mutable,
+				.size = sizeof(uint32_t),
+				.data = nullptr
+				});
+		if (!IsError(result))
+			result = m_details->paramsBuffer.Create({
+				.context = context,
+				.usage = HLBufferUsage::Mutable,
+				.size = sizeof(Details::CullParams),
+				.data = nullptr
+				});
+
+		if (!IsError(result))
+		{
+			const std::string source = std::string{ "#version 450\n#define COMPACT " } +
+				(renderInterface.IsDrawIndirectCountSupported() ? "1" : "0") + g_cullComputeSource;
+			result = m_details->computeModule.Create({
+				.context = context,
+				.type = HLShaderModuleType::Compute,
+				.shaderSource = source
+				});
+		}
+		if (!IsError(result))
+		{
+			HLShaderModule shaderModules[]{ m_details->computeModule };
+			result = m_details->computeProgram.Create({
+				.context = context,
+				.shaderModules = shaderModules
+				});
+		}
+
+		if (IsError(result))
+		{
+			m_details = nullptr;
+			return result;
+		}
+
+		return Result::Success;
+	}
+
+	Result HLGPUCuller::Destroy()
+	{
+		auto result = m_details->Destroy();
+		m_details = nullptr;
+		return result;
+	}
+
+	Result HLGPUCuller::SetObjects(uint32_t firstObject, std::span<const HLGPUCullerObject> objects)
+	{
+		if (static_cast<uint64_t>(firstObject) + objects.size() > m_details->maxObjectCount)
+			return Result::InvalidParameter;
+
+		if (objects.empty())
+			return Result::Success;
+
+		return m_details->objectBuffer.SetData(const_cast<HLGPUCullerObject*>(objects.data()), sizeof(HLGPUCullerObject) * firstObject,
+			objects.size_bytes());
+	}
+
+	Result HLGPUCuller::SetObjectCount(uint32_t objectCount)
+	{
+		if (objectCount > m_details->maxObjectCount)
+			return Result::InvalidParameter;
+
+		m_details->objectCount = objectCount;
+		return Result::Success;
+	}
+
+	Result HLGPUCuller::Cull(const float (&viewProjection)[16])
+	{
+		PW_PROFILE_SCOPE("GPU Cull");
+
+		Details::CullParams params{};
+		Details::ExtractFrustumPlanes(viewProjection, params.planes);
+		params.objectCount = m_details->objectCount;
+		m_details->paramsBuffer.SetData(&params, 0, sizeof(params));
+
+		uint32_t zero = 0;
+		m_details->countBuffer.SetData(&zero, 0, sizeof(zero));
+
+		if (m_details->objectCount == 0)
+			return Result::Success;
+
+		auto& renderInterface = m_details->renderInterface;
+		renderInterface.BindShaderProgram(m_details->computeProgram);
+		renderInterface.SetConstantBuffer(0, m_details->paramsBuffer);
+		renderInterface.SetStorageBuffer(0, m_details->objectBuffer);
+		renderInterface.SetStorageBuffer(1, m_details->commandBuffer);
+		renderInterface.SetStorageBuffer(2, m_details->countBuffer);
+		renderInterface.Dispatch((m_details->objectCount + Details::GroupSize - 1) / Details::GroupSize);
+
+		// The commands and the count are read as indirect parameters
+		return renderInterface.Barrier(HLBarrierFlags::IndirectBuffer);
+	}
+
+	Result HLGPUCuller::Draw()
+	{
+		if (m_details->objectCount == 0)
+			return Result::Success;
+
+		// Falls back to drawing every command (with the culled ones empty) without draw indirect count support
+		return m_details->renderInterface.DrawIndexedIndirectCount(m_details->commandBuffer, 0, m_details->countBuffer, 0, m_details->objectCount);
+	}
+
+	HLBuffer HLGPUCuller::GetCommandBuffer()
+	{
+		return m_details->commandBuffer;
+	}
+
+	HLBuffer HLGPUCuller::GetCountBuffer()
+	{
+		return m_details->countBuffer;
+	}
+
+	uint32_t HLGPUCuller::GetObjectCount()
+	{
+		return m_details->objectCount;
+	}
+
+	bool HLGPUCuller::IsInitialized()
+	{
+		return m_details && m_details->renderInterface.IsInitialized();
+	}
+}
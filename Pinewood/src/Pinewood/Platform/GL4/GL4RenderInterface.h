@@ -1,22 +1,127 @@
 #pragma once
 #include "pch.h"
 #include <Pinewood/Renderer/HL/HLRenderInterface.h>
+#include <Pinewood/Renderer/HL/HLResidencyManager.h>
+#include "../../Renderer/HL/HLRenderStatsCounters.h"
+#include "TextureCommon.h"
+#include "GL4Extensions.h"
+
+#include <deque>
 
 namespace Pinewood
 {
 	class HLRenderInterface::Details
 	{
 	public:
+		// A GPU profiler zone, a zone without a name wasn't recorded
+		struct GPUZone
+		{
+			const char* name;
+			GLuint beginQuery, endQuery;
+			uint32_t depth;
+		};
+
+		// Stop recording if zones are never collected
+		static constexpr size_t MaxPendingGPUZones = 4096;
+
 		HLContext context;
 		GladGLContext* gl; // So I don't need to get it from the context all the time
 
 		HLShaderProgram program; // Used for uniforms
+		GL4Extensions extensions;
+
+		HLRenderState renderState;			// The fixed function state that's set in the context
+		uint64_t pipelineStateKey = 0;		// The sort key of the bound pipeline state, 0 if the state changed since
+		HLVertexBinding vertexBinding;		// The bound vertex binding, kept alive so a new binding can't get its name
+		std::vector<HLSampler> boundSamplers;	// The sampler of every texture unit, uninitialized if the texture's own parameters are used
+		HLResidencyManager residencyManager;	// Marks the bound resources used, can be uninitialized
+
+		std::vector<GLuint> timestampQueries, freeTimestampQueries;
+		std::vector<GPUZone> openGPUZones;
+		std::deque<GPUZone> pendingGPUZones;
+		int64_t gpuTimeOffset = 0; // Profiler time - GPU time
+		bool gpuTimeCalibrated = false;
 
 		~Details();
 
 		Result Destroy();
+
+		// Sets the fixed function state that differs from renderState, or all of it with force
+		uint32_t ApplyRenderState(const HLRenderState& state, bool force);
+
+		// Binds the sampler of a texture unit if it changed, nullptr uses the parameters of the texture
+		void BindSampler(uint32_t slot, const HLSampler* sampler);
+
+		GLuint AcquireTimestampQuery();
 	};
 
+	constexpr static GLenum GetGLCompareOp(HLCompareOp op)
+	{
+		constexpr GLenum translationTable[] = { GL_NEVER, GL_LESS, GL_EQUAL, GL_LEQUAL, GL_GREATER, GL_NOTEQUAL, GL_GEQUAL, GL_ALWAYS };
+		return translationTable[static_cast<uint32_t>(op)];
+	}
+
+	constexpr static GLenum GetGLBlendFactor(HLBlendFactor factor)
+	{
+		constexpr GLenum translationTable[] = {
+			GL_ZERO, GL_ONE, GL_SRC_COLOR, GL_ONE_MINUS_SRC_COLOR, GL_DST_COLOR, GL_ONE_MINUS_DST_COLOR,
+			GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_DST_ALPHA, GL_ONE_MINUS_DST_ALPHA
+		};
+		return translationTable[static_cast<uint32_t>(factor)];
+	}
+
+	constexpr static GLenum GetGLBlendOp(HLBlendOp op)
+	{
+		constexpr GLenum translationTable[] = { GL_FUNC_ADD, GL_FUNC_SUBTRACT, GL_FUNC_REVERSE_SUBTRACT, GL_MIN, GL_MAX };
+		return translationTable[static_cast<uint32_t>(op)];
+	}
+
+	constexpr static GLenum GetGLStencilOp(HLStencilOp op)
+	{
+		constexpr GLenum translationTable[] = { GL_KEEP, GL_ZERO, GL_REPLACE, GL_INCR, GL_INCR_WRAP, GL_DECR, GL_DECR_WRAP, GL_INVERT };
+		return translationTable[static_cast<uint32_t>(op)];
+	}
+
+	static GLbitfield GetGLBufferMask(ClearTargetFlags flags)
+	{
+		GLbitfield mask = 0;
+		if (static_cast<uint32_t>(flags & ClearTargetFlags::Color))
+			mask |= GL_COLOR_BUFFER_BIT;
+		if (static_cast<uint32_t>(flags & ClearTargetFlags::Depth))
+			mask |= GL_DEPTH_BUFFER_BIT;
+		if (static_cast<uint32_t>(flags & ClearTargetFlags::Stencil))
+			mask |= GL_STENCIL_BUFFER_BIT;
+
+		return mask;
+	}
+
+	static GLbitfield GetGLBarrierBits(HLBarrierFlags flags)
+	{
+		constexpr static GLbitfield translationTable[] =
+		{
+			GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT,
+			GL_ELEMENT_ARRAY_BARRIER_BIT,
+			GL_UNIFORM_BARRIER_BIT,
+			GL_TEXTURE_FETCH_BARRIER_BIT,
+			GL_SHADER_IMAGE_ACCESS_BARRIER_BIT,
+			GL_COMMAND_BARRIER_BIT,
+			GL_BUFFER_UPDATE_BARRIER_BIT,
+			GL_CLIENT_MAPPED_BUFFER_BARRIER_BIT,
+			GL_TEXTURE_UPDATE_BARRIER_BIT,
+			GL_FRAMEBUFFER_BARRIER_BIT,
+			GL_SHADER_STORAGE_BARRIER_BIT
+		};
+
+		GLbitfield bits = 0;
+		for (uint32_t i = 0; i < std::size(translationTable); i++)
+		{
+			if (static_cast<uint32_t>(flags) & (1u << i))
+				bits |= translationTable[i];
+		}
+
+		return bits;
+	}
+
 	HLRenderInterface::Details::~Details()
 	{
 		Destroy();
@@ -24,18 +129,166 @@ namespace Pinewood
 	
 	Result HLRenderInterface::Details::Destroy()
 	{
+		if (gl && !timestampQueries.empty())
+			gl->DeleteQueries(static_cast<GLsizei>(timestampQueries.size()), timestampQueries.data());
+
+		timestampQueries.clear();
+		freeTimestampQueries.clear();
+		openGPUZones.clear();
+		pendingGPUZones.clear();
+		boundSamplers.clear();
+		vertexBinding = HLVertexBinding{};
+		residencyManager = HLResidencyManager{};
+
 		gl = nullptr;
 		context = HLContext{};
 
 		return Result::Success;
 	}
 
+	uint32_t HLRenderInterface::Details::ApplyRenderState(const HLRenderState& state, bool force)
+	{
+		HLRenderState& current = renderState;
+		uint32_t changes = 0;
+
+		auto setEnabled = [this, &changes](GLenum capability, bool enable)
+		{
+			if (enable)
+				gl->Enable(capability);
+			else
+				gl->Disable(capability);
+			changes++;
+		};
+
+		// Blending
+		const HLBlendState& blend = state.blend;
+		if (force || blend.enable != current.blend.enable)
+			setEnabled(GL_BLEND, blend.enable);
+
+		if (force || blend.sourceColor != current.blend.sourceColor || blend.destinationColor != current.blend.destinationColor ||
+			blend.sourceAlpha != current.blend.sourceAlpha || blend.destinationAlpha != current.blend.destinationAlpha)
+		{
+			gl->BlendFuncSeparate(GetGLBlendFactor(blend.sourceColor), GetGLBlendFactor(blend.destinationColor),
+				GetGLBlendFactor(blend.sourceAlpha), GetGLBlendFactor(blend.destinationAlpha));
+			changes++;
+		}
+
+		if (force || blend.colorOp != current.blend.colorOp || blend.alphaOp != current.blend.alphaOp)
+		{
+			gl->BlendEquationSeparate(GetGLBlendOp(blend.colorOp), GetGLBlendOp(blend.alphaOp));
+			changes++;
+		}
+
+		if (force || blend.writeMask != current.blend.writeMask)
+		{
+			auto hasChannel = [&blend](HLColorWriteMask channel) { return static_cast<uint32_t>(blend.writeMask & channel) ? GL_TRUE : GL_FALSE; };
+			gl->ColorMask(hasChannel(HLColorWriteMask::Red), hasChannel(HLColorWriteMask::Green), hasChannel(HLColorWriteMask::Blue),
+				hasChannel(HLColorWriteMask::Alpha));
+			changes++;
+		}
+
+		// Depth
+		const HLDepthState& depth = state.depth;
+		if (force || depth.testEnable != current.depth.testEnable)
+			setEnabled(GL_DEPTH_TEST, depth.testEnable);
+
+		if (force || depth.writeEnable != current.depth.writeEnable)
+		{
+			gl->DepthMask(depth.writeEnable ? GL_TRUE : GL_FALSE);
+			changes++;
+		}
+
+		if (force || depth.compareOp != current.depth.compareOp)
+		{
+			gl->DepthFunc(GetGLCompareOp(depth.compareOp));
+			changes++;
+		}
+
+		// Stencil
+		const HLStencilState& stencil = state.stencil;
+		if (force || stencil.testEnable != current.stencil.testEnable)
+			setEnabled(GL_STENCIL_TEST, stencil.testEnable);
+
+		for (GLenum glFace : { GL_FRONT, GL_BACK })
+		{
+			const HLStencilFaceState& face = (glFace == GL_FRONT) ? stencil.front : stencil.back;
+			const HLStencilFaceState& currentFace = (glFace == GL_FRONT) ? current.stencil.front : current.stencil.back;
+
+			if (force || face.failOp != currentFace.failOp || face.depthFailOp != currentFace.depthFailOp || face.passOp != currentFace.passOp)
+			{
+				gl->StencilOpSeparate(glFace, GetGLStencilOp(face.failOp), GetGLStencilOp(face.depthFailOp), GetGLStencilOp(face.passOp));
+				changes++;
+			}
+
+			if (force || face.compareOp != currentFace.compareOp || stencil.reference != current.stencil.reference ||
+				stencil.readMask != current.stencil.readMask)
+			{
+				gl->StencilFuncSeparate(glFace, GetGLCompareOp(face.compareOp), stencil.reference, stencil.readMask);
+				changes++;
+			}
+		}
+
+		if (force || stencil.writeMask != current.stencil.writeMask)
+		{
+			gl->StencilMask(stencil.writeMask);
+			changes++;
+		}
+
+		// Rasterization
+		const HLRasterState& raster = state.raster;
+		if (force || (raster.cullMode == HLCullMode::None) != (current.raster.cullMode == HLCullMode::None))
+			setEnabled(GL_CULL_FACE, raster.cullMode != HLCullMode::None);
+
+		if (raster.cullMode != HLCullMode::None && (force || raster.cullMode != current.raster.cullMode))
+		{
+			gl->CullFace(raster.cullMode == HLCullMode::Front ? GL_FRONT : GL_BACK);
+			changes++;
+		}
+
+		if (force || raster.frontFace != current.raster.frontFace)
+		{
+			gl->FrontFace(raster.frontFace == HLFrontFace::Clockwise ? GL_CW : GL_CCW);
+			changes++;
+		}
+
+		if (force || raster.scissorEnable != current.raster.scissorEnable)
+			setEnabled(GL_SCISSOR_TEST, raster.scissorEnable);
+
+		if (force || raster.wireframe != current.raster.wireframe)
+		{
+			gl->PolygonMode(GL_FRONT_AND_BACK, raster.wireframe ? GL_LINE : GL_FILL);
+			changes++;
+		}
+
+		const bool depthBias = raster.depthBiasConstant != 0.0f || raster.depthBiasSlope != 0.0f;
+		const bool currentDepthBias = current.raster.depthBiasConstant != 0.0f || current.raster.depthBiasSlope != 0.0f;
+		if (force || depthBias != currentDepthBias)
+		{
+			setEnabled(GL_POLYGON_OFFSET_FILL, depthBias);
+			setEnabled(GL_POLYGON_OFFSET_LINE, depthBias);
+		}
+
+		if (depthBias && (force || raster.depthBiasConstant != current.raster.depthBiasConstant || raster.depthBiasSlope != current.raster.depthBiasSlope))
+		{
+			gl->PolygonOffset(raster.depthBiasSlope, raster.depthBiasConstant);
+			changes++;
+		}
+
+		current = state;
+		return changes;
+	}
+
 	Result HLRenderInterface::Create(const HLRenderInterfaceCreateInfo& createInfo)
 	{
-		// Save the context and cache the gl functions
+		// Save the context and cache the gl functions and extensions
 		m_details = std::make_shared<Details>();
 		m_details->context = createInfo.context;
-		m_details->gl = static_cast<GladGLContext*>(m_details->context.GetNativeHandle().gl);
+		const auto contextHandle = m_details->context.GetNativeHandle();
+		m_details->gl = static_cast<GladGLContext*>(contextHandle.gl);
+		m_details->extensions = *static_cast<const GL4Extensions*>(contextHandle.extensions);
+
+		// Start from a known state, the context may have been used by something else
+		m_details->ApplyRenderState(HLRenderState{}, true);
 
 		return Result::Success;
 	}
@@ -65,10 +318,20 @@ namespace Pinewood
 
 	Result HLRenderInterface::ClearTarget(ClearTargetFlags flags)
 	{
-		m_details->gl->Clear(
-			static_cast<uint32_t>(flags & ClearTargetFlags::Color) ? GL_COLOR_BUFFER_BIT : 0 &
-			static_cast<uint32_t>(flags & ClearTargetFlags::Depth) ? GL_DEPTH_BUFFER_BIT : 0 &
-			static_cast<uint32_t>(flags & ClearTargetFlags::Stencil) ? GL_STENCIL_BUFFER_BIT : 0);
+		// The write masks and the scissor test apply to clears too
+		HLRenderState clearState = m_details->renderState;
+		if (static_cast<uint32_t>(flags & ClearTargetFlags::Color))
+			clearState.blend.writeMask = HLColorWriteMask::All;
+		if (static_cast<uint32_t>(flags & ClearTargetFlags::Depth))
+			clearState.depth.writeEnable = true;
+		if (static_cast<uint32_t>(flags & ClearTargetFlags::Stencil))
+			clearState.stencil.writeMask = 0xff;
+		clearState.raster.scissorEnable = false;
+
+		if (m_details->ApplyRenderState(clearState, false) != 0)
+			m_details->pipelineStateKey = 0;
+
+		m_details->gl->Clear(GetGLBufferMask(flags));
 		return Result::Success;
 	}
 
@@ -77,15 +340,62 @@ namespace Pinewood
 		// Get a copy that's not const
 		auto vb = vertexBinding;
 
+		// Cached bindings make the same binding likely (ex: a layout-only binding for every mesh)
+		if (m_details->vertexBinding.IsInitialized() && m_details->vertexBinding.GetNativeHandle() == vb.GetNativeHandle())
+			return Result::Success;
+
 		m_details->gl->BindVertexArray(vb.GetNativeHandle());
+		m_details->vertexBinding = vb;
+		Impl::CountStat(Impl::renderStats.vertexBindingBinds);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::BindPipelineState(const HLPipelineState& pipelineState)
+	{
+		HLPipelineState state = pipelineState;
+		if (!state.IsInitialized())
+			return Result::InvalidParameter;
 
+		const uint64_t key = state.GetSortKey();
+		if (key == m_details->pipelineStateKey)
+			return Result::Success;
+
+		HLShaderProgram program = state.GetProgram();
+		if (!m_details->program.IsInitialized() || m_details->program.GetNativeHandle() != program.GetNativeHandle())
+		{
+			m_details->program = program;
+			m_details->gl->UseProgram(m_details->program.GetNativeHandle());
+			Impl::CountStat(Impl::renderStats.programBinds);
+		}
+
+		Impl::CountStat(Impl::renderStats.renderStateChanges, m_details->ApplyRenderState(state.GetRenderState(), false));
+		Impl::CountStat(Impl::renderStats.pipelineStateBinds);
+		m_details->pipelineStateKey = key;
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::SetViewport(int32_t x, int32_t y, uint32_t width, uint32_t height)
+	{
+		m_details->gl->Viewport(x, y, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::SetScissor(int32_t x, int32_t y, uint32_t width, uint32_t height)
+	{
+		m_details->gl->Scissor(x, y, static_cast<GLsizei>(width), static_cast<GLsizei>(height));
 		return Result::Success;
 	}
 
 	Result HLRenderInterface::BindShaderProgram(const HLShaderProgram& program)
 	{
+		// The program of the pipeline state isn't bound anymore
+		m_details->pipelineStateKey = 0;
+
 		m_details->program = program;
 		m_details->gl->UseProgram(m_details->program.GetNativeHandle());
+		Impl::CountStat(Impl::renderStats.programBinds);
 
 		return Result::Success;
 	}
@@ -97,6 +407,10 @@ namespace Pinewood
 
 		m_details->gl->BindBufferBase(GL_UNIFORM_BUFFER, index, buf.GetNativeHandle());
 		m_details->gl->UniformBlockBinding(m_details->program.GetNativeHandle(), index, index);
+		Impl::CountStat(Impl::renderStats.constantBufferBinds);
+
+		if (m_details->residencyManager.IsInitialized())
+			m_details->residencyManager.Touch(buf);
 
 		return Result::Success;
 	}
@@ -107,6 +421,110 @@ namespace Pinewood
 
 		m_details->gl->BindTextureUnit(slot, tex.GetNativeHandle());
 		m_details->gl->Uniform1i(location, slot);
+		Impl::CountStat(Impl::renderStats.textureBinds);
+
+		if (m_details->residencyManager.IsInitialized())
+			m_details->residencyManager.Touch(tex);
+
+		// A sampler left in the slot would override the texture's parameters
+		m_details->BindSampler(slot, nullptr);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::SetTexture2D(uint32_t location, uint32_t slot, const HLTexture2D& texture, const HLSampler& sampler)
+	{
+		HLTexture2D tex = texture;
+
+		m_details->gl->BindTextureUnit(slot, tex.GetNativeHandle());
+		m_details->gl->Uniform1i(location, slot);
+		Impl::CountStat(Impl::renderStats.textureBinds);
+
+		if (m_details->residencyManager.IsInitialized())
+			m_details->residencyManager.Touch(tex);
+
+		m_details->BindSampler(slot, &sampler);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::SetTexture2DArray(uint32_t location, uint32_t slot, const HLTexture2DArray& textures)
+	{
+		HLTexture2DArray tex = textures;
+
+		m_details->gl->BindTextureUnit(slot, tex.GetNativeHandle());
+		m_details->gl->Uniform1i(location, slot);
+		Impl::CountStat(Impl::renderStats.textureBinds);
+
+		if (m_details->residencyManager.IsInitialized())
+			m_details->residencyManager.Touch(tex);
+
+		m_details->BindSampler(slot, nullptr);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::SetTexture2DArray(uint32_t location, uint32_t slot, const HLTexture2DArray& textures, const HLSampler& sampler)
+	{
+		HLTexture2DArray tex = textures;
+
+		m_details->gl->BindTextureUnit(slot, tex.GetNativeHandle());
+		m_details->gl->Uniform1i(location, slot);
+		Impl::CountStat(Impl::renderStats.textureBinds);
+
+		if (m_details->residencyManager.IsInitialized())
+			m_details->residencyManager.Touch(tex);
+
+		m_details->BindSampler(slot, &sampler);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::SetStorageBuffer(uint32_t index, const HLBuffer& buffer, size_t offset, size_t size)
+	{
+		// non-const copy
+		HLBuffer buf = buffer;
+
+		if (size == 0 && offset == 0)
+			m_details->gl->BindBufferBase(GL_SHADER_STORAGE_BUFFER, index, buf.GetNativeHandle());
+		else
+		{
+			// 0 is the rest of the buffer from the offset
+			if (size == 0)
+			{
+				if (offset >= buf.GetSize())
+					return Result::InvalidParameter;
+				size = buf.GetSize() - offset;
+			}
+
+			m_details->gl->BindBufferRange(GL_SHADER_STORAGE_BUFFER, index, buf.GetNativeHandle(), offset, size);
+		}
+		Impl::CountStat(Impl::renderStats.storageBufferBinds);
+
+		if (m_details->residencyManager.IsInitialized())
+			m_details->residencyManager.Touch(buf);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::SetImage2D(uint32_t unit, const HLTexture2D& texture, HLBufferAccess access, uint32_t mipLevel)
+	{
+		HLTexture2D tex = texture;
+		if (tex.GetSampleCount() > 1)
+			return Result::InvalidParameter;
+
+		const bool read = static_cast<uint32_t>(access & HLBufferAccess::Read);
+		const bool write = static_cast<uint32_t>(access & HLBufferAccess::Write);
+		if (!read && !write)
+			return Result::InvalidParameter;
+
+		const GLenum glAccess = (read && write) ? GL_READ_WRITE : (read ? GL_READ_ONLY : GL_WRITE_ONLY);
+
+		m_details->gl->BindImageTexture(unit, tex.GetNativeHandle(), mipLevel, GL_FALSE, 0, glAccess, Impl::GetGLFormat(tex.GetFormat()).sizeFormat);
+		Impl::CountStat(Impl::renderStats.textureBinds);
+
+		if (m_details->residencyManager.IsInitialized())
+			m_details->residencyManager.Touch(tex);
 
 		return Result::Success;
 	}
@@ -114,6 +532,8 @@ namespace Pinewood
 	Result HLRenderInterface::Draw(uint32_t startIndex, uint32_t count)
 	{
 		m_details->gl->DrawArrays(GL_TRIANGLES, startIndex, count);
+		Impl::CountStat(Impl::renderStats.drawCalls);
+		Impl::CountStat(Impl::renderStats.triangles, count / 3);
 
 		return Result::Success;
 	}
@@ -121,6 +541,115 @@ namespace Pinewood
 	Result HLRenderInterface::DrawIndexed(uint32_t count)
 	{
 		m_details->gl->DrawElements(GL_TRIANGLES, count, GL_UNSIGNED_INT, nullptr);
+		Impl::CountStat(Impl::renderStats.drawCalls);
+		Impl::CountStat(Impl::renderStats.triangles, count / 3);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::DrawIndexedIndirect(const HLBuffer& commandBuffer, size_t offset, uint32_t drawCount)
+	{
+		if (offset % 4 != 0)
+			return Result::InvalidParameter;
+
+		HLBuffer commands = commandBuffer;
+		m_details->gl->BindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.GetNativeHandle());
+		m_details->gl->MultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(offset), drawCount, 0);
+		Impl::CountStat(Impl::renderStats.drawCalls); // The triangles are only known by the GPU
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::DrawIndexedIndirectCount(const HLBuffer& commandBuffer, size_t offset, const HLBuffer& countBuffer, size_t countOffset, uint32_t maxDrawCount)
+	{
+		if (offset % 4 != 0 || countOffset % 4 != 0)
+			return Result::InvalidParameter;
+
+		if (!m_details->extensions.MultiDrawElementsIndirectCount)
+			return DrawIndexedIndirect(commandBuffer, offset, maxDrawCount);
+
+		HLBuffer commands = commandBuffer, count = countBuffer;
+		m_details->gl->BindBuffer(GL_DRAW_INDIRECT_BUFFER, commands.GetNativeHandle());
+		m_details->gl->BindBuffer(Impl::GLParameterBuffer, count.GetNativeHandle());
+		m_details->extensions.MultiDrawElementsIndirectCount(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<const void*>(offset),
+			static_cast<GLintptr>(countOffset), maxDrawCount, 0);
+		Impl::CountStat(Impl::renderStats.drawCalls);
+
+		return Result::Success;
+	}
+
+	bool HLRenderInterface::IsDrawIndirectCountSupported()
+	{
+		return m_details->extensions.MultiDrawElementsIndirectCount != nullptr;
+	}
+
+	bool HLRenderInterface::IsBindlessTextureSupported()
+	{
+		return m_details->extensions.GetTextureSamplerHandle != nullptr;
+	}
+
+	bool HLRenderInterface::IsSpirVSupported()
+	{
+		return m_details->extensions.SpecializeShader != nullptr;
+	}
+
+	Result HLRenderInterface::GetMemoryInfo(HLMemoryInfo& infoOut)
+	{
+		if (m_details->extensions.memoryInfoNVX)
+		{
+			GLint total = 0, available = 0;
+			m_details->gl->GetIntegerv(Impl::GLGPUMemoryInfoDedicatedVidmemNVX, &total);
+			m_details->gl->GetIntegerv(Impl::GLGPUMemoryInfoCurrentAvailableVidmemNVX, &available);
+			infoOut = HLMemoryInfo{ .totalMemory = static_cast<uint64_t>(total) * 1024, .availableMemory = static_cast<uint64_t>(available) * 1024 };
+			return Result::Success;
+		}
+
+		if (m_details->extensions.memoryInfoATI)
+		{
+			GLint values[4]{};
+			m_details->gl->GetIntegerv(Impl::GLTextureFreeMemoryATI, values);
+			infoOut = HLMemoryInfo{ .totalMemory = 0, .availableMemory = static_cast<uint64_t>(values[0]) * 1024 };
+			return Result::Success;
+		}
+
+		return Result::Unsupported;
+	}
+
+	Result HLRenderInterface::SetResidencyManager(const HLResidencyManager& manager)
+	{
+		m_details->residencyManager = manager;
+		return Result::Success;
+	}
+
+	HLResidencyManager HLRenderInterface::GetResidencyManager()
+	{
+		return m_details->residencyManager;
+	}
+
+	Result HLRenderInterface::Dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ)
+	{
+		m_details->gl->DispatchCompute(groupCountX, groupCountY, groupCountZ);
+		Impl::CountStat(Impl::renderStats.dispatches);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::DispatchIndirect(const HLBuffer& buffer, size_t offset)
+	{
+		if (offset % 4 != 0)
+			return Result::InvalidParameter;
+
+		HLBuffer buf = buffer;
+		m_details->gl->BindBuffer(GL_DISPATCH_INDIRECT_BUFFER, buf.GetNativeHandle());
+		m_details->gl->DispatchComputeIndirect(static_cast<GLintptr>(offset));
+		Impl::CountStat(Impl::renderStats.dispatches);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::Barrier(HLBarrierFlags flags)
+	{
+		m_details->gl->MemoryBarrier(GetGLBarrierBits(flags));
 
 		return Result::Success;
 	}
@@ -128,12 +657,229 @@ namespace Pinewood
 	Result HLRenderInterface::SetFramebuffer(const HLFramebuffer& framebuffer)
 	{
 		m_details->gl->BindFramebuffer(GL_FRAMEBUFFER, HLFramebuffer{ framebuffer }.GetNativeHandle());
+		Impl::CountStat(Impl::renderStats.framebufferBinds);
 		return Result::Success;
 	}
 
 	Result HLRenderInterface::ResetFramebuffer()
 	{
 		m_details->gl->BindFramebuffer(GL_FRAMEBUFFER, 0);
+		Impl::CountStat(Impl::renderStats.framebufferBinds);
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::BlitFramebuffer(const HLFramebuffer& source, const HLBlitRegion& sourceRegion, const HLFramebuffer& destination,
+		const HLBlitRegion& destinationRegion, ClearTargetFlags flags, HLTextureFilter filter)
+	{
+		// Non-const copies
+		HLFramebuffer src = source, dst = destination;
+
+		const GLbitfield mask = GetGLBufferMask(flags);
+		if (mask == 0)
+			return Result::InvalidParameter;
+
+		if (filter == HLTextureFilter::Linear && (mask != GL_COLOR_BUFFER_BIT || (src.IsInitialized() && src.GetSampleCount() > 1)))
+			return Result::InvalidParameter;
+
+		// The scissor test applies to blits too
+		if (m_details->renderState.raster.scissorEnable)
+		{
+			HLRenderState blitState = m_details->renderState;
+			blitState.raster.scissorEnable = false;
+			m_details->ApplyRenderState(blitState, false);
+			m_details->pipelineStateKey = 0;
+		}
+
+		m_details->gl->BlitNamedFramebuffer(src.IsInitialized() ? src.GetNativeHandle() : 0, dst.IsInitialized() ? dst.GetNativeHandle() : 0,
+			sourceRegion.x0, sourceRegion.y0, sourceRegion.x1, sourceRegion.y1,
+			destinationRegion.x0, destinationRegion.y0, destinationRegion.x1, destinationRegion.y1,
+			mask, (filter == HLTextureFilter::Linear) ? GL_LINEAR : GL_NEAREST);
+		Impl::CountStat(Impl::renderStats.framebufferBlits);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::Resolve(const HLFramebuffer& source, const HLFramebuffer& destination, ClearTargetFlags flags)
+	{
+		HLFramebuffer src = source;
+		if (!src.IsInitialized())
+			return Result::InvalidParameter;
+
+		uint32_t width, height;
+		src.GetSize(width, height);
+
+		// A resolve can't scale, the size of the default framebuffer is the window's (not known here)
+		HLFramebuffer dst = destination;
+		if (dst.IsInitialized())
+		{
+			uint32_t destinationWidth, destinationHeight;
+			dst.GetSize(destinationWidth, destinationHeight);
+			if (destinationWidth != width || destinationHeight != height)
+				return Result::InvalidParameter;
+		}
+
+		const HLBlitRegion region{ 0, 0, static_cast<int32_t>(width), static_cast<int32_t>(height) };
+		return BlitFramebuffer(source, region, destination, region, flags, HLTextureFilter::Nearest);
+	}
+
+	void HLRenderInterface::Details::BindSampler(uint32_t slot, const HLSampler* sampler)
+	{
+		// Bound samplers are kept alive so a new sampler can't get the name of a bound one
+		if (slot >= boundSamplers.size())
+		{
+			if (!sampler)
+				return;
+			boundSamplers.resize(slot + 1);
+		}
+
+		HLSampler& boundSampler = boundSamplers[slot];
+		if (!sampler)
+		{
+			if (!boundSampler.IsInitialized())
+				return;
+
+			gl->BindSampler(slot, 0);
+			boundSampler = HLSampler{};
+			Impl::CountStat(Impl::renderStats.samplerBinds);
+			return;
+		}
+
+		HLSampler samp = *sampler;
+		if (boundSampler.IsInitialized() && boundSampler.GetNativeHandle() == samp.GetNativeHandle())
+			return;
+
+		gl->BindSampler(slot, samp.GetNativeHandle());
+		boundSampler = samp;
+		Impl::CountStat(Impl::renderStats.samplerBinds);
+	}
+
+	GLuint HLRenderInterface::Details::AcquireTimestampQuery()
+	{
+		if (freeTimestampQueries.empty())
+		{
+			// Grow the pool in chunks
+			constexpr GLsizei chunkSize = 64;
+			freeTimestampQueries.resize(chunkSize);
+			gl->CreateQueries(GL_TIMESTAMP, chunkSize, freeTimestampQueries.data());
+			timestampQueries.insert(timestampQueries.end(), freeTimestampQueries.begin(), freeTimestampQueries.end());
+		}
+
+		GLuint query = freeTimestampQueries.back();
+		freeTimestampQueries.pop_back();
+		return query;
+	}
+
+	Result HLRenderInterface::BeginGPUZone(const char* name)
+	{
+		if (!Profiler::IsEnabled() || m_details->pendingGPUZones.size() >= Details::MaxPendingGPUZones)
+		{
+			// Still push the zone, so EndGPUZone stays balanced
+			m_details->openGPUZones.push_back({ nullptr, 0, 0, 0 });
+			return Result::Success;
+		}
+
+		if (!m_details->gpuTimeCalibrated)
+		{
+			// Line up the GPU clock with the profiler clock
+			GLint64 gpuTime = 0;
+			m_details->gl->GetInteger64v(GL_TIMESTAMP, &gpuTime);
+			m_details->gpuTimeOffset = static_cast<int64_t>(Profiler::GetTime()) - gpuTime;
+			m_details->gpuTimeCalibrated = true;
+		}
+
+		Details::GPUZone zone{ name, m_details->AcquireTimestampQuery(), 0, static_cast<uint32_t>(m_details->openGPUZones.size()) };
+		m_details->gl->QueryCounter(zone.beginQuery, GL_TIMESTAMP);
+		m_details->openGPUZones.push_back(zone);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::EndGPUZone()
+	{
+		if (m_details->openGPUZones.empty())
+			return Result::InvalidParameter;
+
+		Details::GPUZone zone = m_details->openGPUZones.back();
+		m_details->openGPUZones.pop_back();
+		if (!zone.name)
+			return Result::Success;
+
+		zone.endQuery = m_details->AcquireTimestampQuery();
+		m_details->gl->QueryCounter(zone.endQuery, GL_TIMESTAMP);
+		m_details->pendingGPUZones.push_back(zone);
+
+		return Result::Success;
+	}
+
+	Result HLRenderInterface::CollectGPUZones()
+	{
+		// Zones finish in the order they ended, so stop at the first one that isn't ready
+		while (!m_details->pendingGPUZones.empty())
+		{
+			const Details::GPUZone& zone = m_details->pendingGPUZones.front();
+
+			GLint available = GL_FALSE;
+			m_details->gl->GetQueryObjectiv(zone.endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+			if (!available)
+				break;
+
+			GLuint64 begin = 0, end = 0;
+			m_details->gl->GetQueryObjectui64v(zone.beginQuery, GL_QUERY_RESULT, &begin);
+			m_details->gl->GetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &end);
+
+			Profiler::SubmitZone(zone.name, static_cast<uint64_t>(begin + m_details->gpuTimeOffset),
+				static_cast<uint64_t>(end + m_details->gpuTimeOffset), zone.depth, true);
+
+			m_details->freeTimestampQueries.push_back(zone.beginQuery);
+			m_details->freeTimestampQueries.push_back(zone.endQuery);
+			m_details->pendingGPUZones.pop_front();
+		}
+
+		return Result::Success;
+	}
+
+	HLRenderStats HLRenderInterface::GetGlobalStats()
+	{
+		auto& counters = Impl::renderStats;
+		HLRenderStats stats{
+			.drawCalls = counters.drawCalls.load(std::memory_order_relaxed),
+			.triangles = counters.triangles.load(std::memory_order_relaxed),
+			.dispatches = counters.dispatches.load(std::memory_order_relaxed),
+			.programBinds = counters.programBinds.load(std::memory_order_relaxed),
+			.pipelineStateBinds = counters.pipelineStateBinds.load(std::memory_order_relaxed),
+			.renderStateChanges = counters.renderStateChanges.load(std::memory_order_relaxed),
+			.vertexBindingBinds = counters.vertexBindingBinds.load(std::memory_order_relaxed),
+			.vertexBufferBinds = counters.vertexBufferBinds.load(std::memory_order_relaxed),
+			.textureBinds = counters.textureBinds.load(std::memory_order_relaxed),
+			.samplerBinds = counters.samplerBinds.load(std::memory_order_relaxed),
+			.constantBufferBinds = counters.constantBufferBinds.load(std::memory_order_relaxed),
+			.storageBufferBinds = counters.storageBufferBinds.load(std::memory_order_relaxed),
+			.framebufferBinds = counters.framebufferBinds.load(std::memory_order_relaxed),
+			.framebufferBlits = counters.framebufferBlits.load(std::memory_order_relaxed),
+			.bufferUploadBytes = counters.bufferUploadBytes.load(std::memory_order_relaxed),
+			.textureUploadBytes = counters.textureUploadBytes.load(std::memory_order_relaxed),
+			.mappedBytes = counters.mappedBytes.load(std::memory_order_relaxed),
+			.resourcesCreated = counters.resourcesCreated.load(std::memory_order_relaxed),
+			.resourcesDestroyed = counters.resourcesDestroyed.load(std::memory_order_relaxed)
+		};
+
+		for (size_t i = 0; i < stats.liveResources.size(); i++)
+		{
+			stats.liveResources[i] = counters.liveResources[i].load(std::memory_order_relaxed);
+			stats.liveMemory[i] = counters.liveMemory[i].load(std::memory_order_relaxed);
+		}
+
+		return stats;
+	}
+
+	Result HLRenderInterface::ResetGlobalStats()
+	{
+		auto& counters = Impl::renderStats;
+		for (auto* counter : { &counters.drawCalls, &counters.triangles, &counters.dispatches, &counters.programBinds, &counters.pipelineStateBinds,
+			&counters.renderStateChanges, &counters.vertexBindingBinds, &counters.vertexBufferBinds, &counters.textureBinds, &counters.samplerBinds, &counters.constantBufferBinds,
+			&counters.storageBufferBinds, &counters.framebufferBinds, &counters.framebufferBlits, &counters.bufferUploadBytes, &counters.textureUploadBytes, &counters.mappedBytes, &counters.resourcesCreated, &counters.resourcesDestroyed })
+			counter->store(0, std::memory_order_relaxed);
+
 		return Result::Success;
 	}
 
@@ -0,0 +1,256 @@
+#pragma once
+#include "pch.h"
+#include "GL4DebugOutput.h"
+
+#include <Pinewood/Renderer/HL/HLResourceLoader.h>
+#include <Pinewood/Profiler.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace Pinewood
+{
+	class HLResourceLoader::Details
+	{
+	public:
+		struct QueuedLoad
+		{
+			std::function<void()> load, ready;
+		};
+
+		struct FinishedLoad
+		{
+			GLsync fence; // Created by the loader context, sync objects are shared so the render context can wait on it
+			std::function<void()> ready;
+		};
+
+		HLContext context;			// The render context
+		HLContext loaderContext;	// Shared with the render context, only used on the loader thread
+		const GladGLContext* gl;	// The render context's functions
+
+		std::thread thread;
+		std::mutex mutex;
+		std::condition_variable queueCondition;		// A load was queued or the thread has to stop
+		std::condition_variable finishedCondition;	// A load finished
+		std::deque<QueuedLoad> queue;
+		std::vector<FinishedLoad> finished;			// Finished on the loader thread, not handed to the render thread yet
+		bool running = false;						// The loader thread is running a load
+		bool stop = false;
+
+		std::deque<FinishedLoad> handover;			// Render thread only, waiting for the GPU in order
+		std::atomic_uint32_t pendingCount = 0;
+
+		~Details();
+
+		void LoaderThread(std::promise<Result> started);
+		uint32_t HandOver(bool wait);
+		Result Destroy();
+	};
+
+	HLResourceLoader::Details::~Details()
+	{
+		Destroy();
+	}
+
+	void HLResourceLoader::Details::LoaderThread(std::promise<Result> started)
+	{
+		Profiler::SetThreadName("Resource Loader");
+
+		Result result = loaderContext.MakeCurrent();
+		if (IsError(result))
+			loaderContext.Destroy();
+
+		started.set_value(result);
+		if (IsError(result))
+			return;
+
+		GL4EnableDebugOutput(*gl);
+
+		std::unique_lock<std::mutex> lock{ mutex };
+		while (true)
+		{
+			queueCondition.wait(lock, [this]() { return stop || !queue.empty(); });
+
+			// Finish what was queued before stopping
+			if (queue.empty())
+				break;
+
+			QueuedLoad queuedLoad = std::move(queue.front());
+			queue.pop_front();
+			running = true;
+			lock.unlock();
+
+			{
+				PW_PROFILE_SCOPE("Load");
+				queuedLoad.load();
+			}
+
+			// The flush makes the fence (and the commands before it) visible to the render context
+			GLsync fence = gl->FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			gl->Flush();
+
+			lock.lock();
+			finished.push_back({ fence, std::move(queuedLoad.ready) });
+			running = false;
+			finishedCondition.notify_all();
+		}
+
+		// Loads that never got handed over (the loader was destroyed without Destroy)
+		for (auto& finishedLoad : finished)
+			gl->DeleteSync(finishedLoad.fence);
+		finished.clear();
+		lock.unlock();
+
+		// A context can only be deleted on the thread it's current on
+		loaderContext.Destroy();
+	}
+
+	uint32_t HLResourceLoader::Details::HandOver(bool wait)
+	{
+		{
+			std::lock_guard<std::mutex> lock{ mutex };
+			for (auto& finishedLoad : finished)
+				handover.push_back(std::move(finishedLoad));
+			finished.clear();
+		}
+
+		// In order, so a load can depend on the loads before it
+		uint32_t count = 0;
+		while (!handover.empty())
+		{
+			FinishedLoad& finishedLoad = handover.front();
+
+			GLenum status = gl->ClientWaitSync(finishedLoad.fence, 0, 0);
+			if (wait)
+			{
+				while (status == GL_TIMEOUT_EXPIRED)
+					status = gl->ClientWaitSync(finishedLoad.fence, 0, 100'000'000); // 100 ms
+			}
+
+			if (status == GL_TIMEOUT_EXPIRED)
+				break;
+
+			gl->DeleteSync(finishedLoad.fence);
+			auto ready = std::move(finishedLoad.ready);
+			handover.pop_front();
+			pendingCount.fetch_sub(1, std::memory_order_relaxed);
+			count++;
+
+			if (ready)
+				ready();
+		}
+
+		return count;
+	}
+
+	Result HLResourceLoader::Details::Destroy()
+	{
+		if (!thread.joinable())
+			return Result::NotInitialized;
+
+		{
+			// The loader thread deletes the fences that didn't get handed over
+			std::lock_guard<std::mutex> lock{ mutex };
+			for (auto& finishedLoad : handover)
+				finished.push_back(std::move(finishedLoad));
+			handover.clear();
+			stop = true;
+		}
+		queueCondition.notify_one();
+		thread.join();
+
+		gl = nullptr;
+		context = HLContext{};
+
+		return Result::Success;
+	}
+
+	Result HLResourceLoader::Create(const HLResourceLoaderCreateInfo& createInfo)
+	{
+		m_details = std::make_shared<Details>();
+		m_details->context = createInfo.context;
+		m_details->gl = static_cast<const GladGLContext*>(m_details->context.GetNativeHandle().gl);
+
+		Result result = m_details->loaderContext.CreateShared(m_details->context);
+		if (IsError(result))
+		{
+			m_details = nullptr;
+			return result;
+		}
+
+		std::promise<Result> started;
+		auto startedFuture = started.get_future();
+		m_details->thread = std::thread{ &Details::LoaderThread, m_details.get(), std::move(started) };
+
+		result = startedFuture.get();
+		if (IsError(result))
+		{
+			// The thread already destroyed the shared context and returned
+			m_details->thread.join();
+			m_details = nullptr;
+			return result;
+		}
+
+		return Result::Success;
+	}
+
+	Result HLResourceLoader::Destroy()
+	{
+		if (!m_details)
+			return Result::NotInitialized;
+
+		Result result = Flush();
+		if (IsError(result))
+			return result;
+
+		result = m_details->Destroy();
+		m_details = nullptr;
+		return result;
+	}
+
+	Result HLResourceLoader::Load(std::function<void()> load, std::function<void()> ready)
+	{
+		if (!load)
+			return Result::InvalidParameter;
+
+		m_details->pendingCount.fetch_add(1, std::memory_order_relaxed);
+		{
+			std::lock_guard<std::mutex> lock{ m_details->mutex };
+			m_details->queue.push_back({ std::move(load), std::move(ready) });
+		}
+		m_details->queueCondition.notify_one();
+
+		return Result::Success;
+	}
+
+	uint32_t HLResourceLoader::Update()
+	{
+		return m_details->HandOver(false);
+	}
+
+	Result HLResourceLoader::Flush()
+	{
+		{
+			std::unique_lock<std::mutex> lock{ m_details->mutex };
+			m_details->finishedCondition.wait(lock, [this]() { return m_details->queue.empty() && !m_details->running; });
+		}
+
+		m_details->HandOver(true);
+
+		return Result::Success;
+	}
+
+	uint32_t HLResourceLoader::GetPendingCount()
+	{
+		return m_details->pendingCount.load(std::memory_order_relaxed);
+	}
+
+	bool HLResourceLoader::IsInitialized()
+	{
+		return m_details && m_details->thread.joinable();
+	}
+}
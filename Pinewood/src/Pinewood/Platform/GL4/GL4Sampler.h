@@ -0,0 +1,213 @@
+#pragma once
+#include "pch.h"
+#include "GL4Extensions.h"
+#include "../../Renderer/HL/HLRenderStatsCounters.h"
+#include "../../Renderer/HL/HLObjectCache.h"
+
+#include <Pinewood/Renderer/HL/HLSampler.h>
+
+#include <bit>
+
+namespace Pinewood
+{
+	class HLSampler::Details
+	{
+	public:
+		HLContext context;
+		const GladGLContext* gl; // So I don't need to get it from the context all the time
+
+		HLSamplerCreateInfo info; // To compare with the samplers that are created after it
+		uint32_t sampler;
+
+		Impl::ObjectCacheEntry<Details> cacheEntry;
+
+		static inline Impl::ObjectCache<Details> cache;
+
+		~Details();
+
+		Result Destroy();
+	};
+
+	HLSampler::Details::~Details()
+	{
+		Destroy();
+	}
+
+	Result HLSampler::Details::Destroy()
+	{
+		if (!gl)
+			return Result::Success; // Already destroyed
+
+		gl->DeleteSamplers(1, &sampler);
+		Impl::CountResourceDestroyed(HLResourceType::Sampler);
+
+		gl = nullptr;
+		context = HLContext{};
+
+		return Result::Success;
+	}
+
+	static uint64_t HashSampler(const void* renderContext, const HLSamplerCreateInfo& info)
+	{
+		uint64_t hash = Impl::ObjectHashBasis;
+		auto add = [&hash](uint64_t value) { Impl::HashValue(hash, value); };
+
+		add(reinterpret_cast<uintptr_t>(renderContext));
+		add(static_cast<uint32_t>(info.minFilter));
+		add(static_cast<uint32_t>(info.magFilter));
+		add(static_cast<uint32_t>(info.mipFilter));
+		add(std::bit_cast<uint32_t>(info.maxAnisotropy));
+		add(static_cast<uint32_t>(info.wrapU));
+		add(static_cast<uint32_t>(info.wrapV));
+		for (float channel : info.borderColor)
+			add(std::bit_cast<uint32_t>(channel));
+		add(std::bit_cast<uint32_t>(info.lodBias));
+		add(std::bit_cast<uint32_t>(info.minLod));
+		add(std::bit_cast<uint32_t>(info.maxLod));
+		add(info.compareEnable);
+		add(static_cast<uint32_t>(info.compareOp));
+
+		return hash;
+	}
+
+	static bool IsSameSampling(const HLSamplerCreateInfo& lhs, const HLSamplerCreateInfo& rhs)
+	{
+		return lhs.minFilter == rhs.minFilter && lhs.magFilter == rhs.magFilter && lhs.mipFilter == rhs.mipFilter &&
+			lhs.maxAnisotropy == rhs.maxAnisotropy && lhs.wrapU == rhs.wrapU && lhs.wrapV == rhs.wrapV &&
+			std::equal(std::begin(lhs.borderColor), std::end(lhs.borderColor), std::begin(rhs.borderColor)) &&
+			lhs.lodBias == rhs.lodBias && lhs.minLod == rhs.minLod && lhs.maxLod == rhs.maxLod &&
+			lhs.compareEnable == rhs.compareEnable && lhs.compareOp == rhs.compareOp;
+	}
+
+	static GLenum GetGLWrapMode(HLTextureWrapMode wrapMode)
+	{
+		switch (wrapMode)
+		{
+		case HLTextureWrapMode::Black:
+		case HLTextureWrapMode::White:
+		case HLTextureWrapMode::Border:
+			return GL_CLAMP_TO_BORDER;
+		case HLTextureWrapMode::Repeat:
+			return GL_REPEAT;
+		case HLTextureWrapMode::MirroredRepeat:
+			return GL_MIRRORED_REPEAT;
+		case HLTextureWrapMode::ClampToEdge:
+			return GL_CLAMP_TO_EDGE;
+		default:
+			return 0;
+		}
+	}
+
+	static GLenum GetGLCompareFunc(HLCompareOp compareOp)
+	{
+		constexpr GLenum compareFuncs[] = { GL_NEVER, GL_LESS, GL_EQUAL, GL_LEQUAL, GL_GREATER, GL_NOTEQUAL, GL_GEQUAL, GL_ALWAYS };
+		const auto index = static_cast<uint32_t>(compareOp);
+		return (index < std::size(compareFuncs)) ? compareFuncs[index] : 0;
+	}
+
+	static GLenum GetGLMinFilter(HLTextureFilter filter, HLSamplerMipFilter mipFilter)
+	{
+		const bool linear = filter == HLTextureFilter::Linear;
+		switch (mipFilter)
+		{
+		case HLSamplerMipFilter::None:
+			return linear ? GL_LINEAR : GL_NEAREST;
+		case HLSamplerMipFilter::Nearest:
+			return linear ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST_MIPMAP_NEAREST;
+		case HLSamplerMipFilter::Linear:
+			return linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_LINEAR;
+		default:
+			return 0;
+		}
+	}
+
+	Result HLSampler::Create(const HLSamplerCreateInfo& createInfo)
+	{
+		HLContext context = createInfo.context;
+		if (!context.IsInitialized())
+			return Result::InvalidParameter;
+
+		const GLenum wrapU = GetGLWrapMode(createInfo.wrapU), wrapV = GetGLWrapMode(createInfo.wrapV);
+		const GLenum minFilter = GetGLMinFilter(createInfo.minFilter, createInfo.mipFilter);
+		const GLenum compareFunc = GetGLCompareFunc(createInfo.compareOp);
+		if (wrapU == 0 || wrapV == 0 || minFilter == 0 || createInfo.magFilter == HLTextureFilter::Null || createInfo.minFilter == HLTextureFilter::Null ||
+			(createInfo.compareEnable && compareFunc == 0))
+			return Result::InvalidParameter;
+
+		const void* renderContext = context.GetNativeHandle().renderContext;
+		const uint64_t hash = HashSampler(renderContext, createInfo);
+
+		auto isSame = [&](Details& details)
+		{
+			// Not if it was destroyed with its context
+			return details.gl && details.context.GetNativeHandle().renderContext == renderContext && IsSameSampling(details.info, createInfo);
+		};
+
+		auto create = [&]()
+		{
+			auto details = std::make_shared<Details>();
+			details->context = context;
+			details->gl = static_cast<const GladGLContext*>(details->context.GetNativeHandle().gl);
+			details->info = createInfo;
+			details->info.context = HLContext{}; // Don't keep the context alive twice
+
+			const GladGLContext* gl = details->gl;
+			gl->CreateSamplers(1, &details->sampler);
+			Impl::CountResourceCreated(HLResourceType::Sampler);
+
+			gl->SamplerParameteri(details->sampler, GL_TEXTURE_MIN_FILTER, minFilter);
+			gl->SamplerParameteri(details->sampler, GL_TEXTURE_MAG_FILTER, (createInfo.magFilter == HLTextureFilter::Linear) ? GL_LINEAR : GL_NEAREST);
+			gl->SamplerParameteri(details->sampler, GL_TEXTURE_WRAP_S, wrapU);
+			gl->SamplerParameteri(details->sampler, GL_TEXTURE_WRAP_T, wrapV);
+
+			// Black and White are the border colors of the texture wrap modes
+			constexpr float white[4]{ 1.0f, 1.0f, 1.0f, 1.0f };
+			constexpr float black[4]{ 0.0f, 0.0f, 0.0f, 1.0f };
+			const float* borderColor = createInfo.borderColor;
+			if (createInfo.wrapU == HLTextureWrapMode::White || createInfo.wrapV == HLTextureWrapMode::White)
+				borderColor = white;
+			else if (createInfo.wrapU == HLTextureWrapMode::Black || createInfo.wrapV == HLTextureWrapMode::Black)
+				borderColor = black;
+			gl->SamplerParameterfv(details->sampler, GL_TEXTURE_BORDER_COLOR, borderColor);
+
+			gl->SamplerParameterf(details->sampler, GL_TEXTURE_LOD_BIAS, createInfo.lodBias);
+			gl->SamplerParameterf(details->sampler, GL_TEXTURE_MIN_LOD, createInfo.minLod);
+			gl->SamplerParameterf(details->sampler, GL_TEXTURE_MAX_LOD, createInfo.maxLod);
+
+			if (createInfo.compareEnable)
+			{
+				gl->SamplerParameteri(details->sampler, GL_TEXTURE_COMPARE_MODE, GL_COMPARE_REF_TO_TEXTURE);
+				gl->SamplerParameteri(details->sampler, GL_TEXTURE_COMPARE_FUNC, compareFunc);
+			}
+
+			if (createInfo.maxAnisotropy > 1.0f)
+			{
+				const float maxAnisotropy = static_cast<const GL4Extensions*>(details->context.GetNativeHandle().extensions)->maxAnisotropy;
+				if (maxAnisotropy > 1.0f)
+					gl->SamplerParameterf(details->sampler, Impl::GLTextureMaxAnisotropy, std::min(createInfo.maxAnisotropy, maxAnisotropy));
+			}
+
+			return details;
+		};
+
+		m_details = Details::cache.FindOrCreate(hash, isSame, create);
+
+		return Result::Success;
+	}
+
+	Result HLSampler::Destroy()
+	{
+		m_details = nullptr;
+		return Result::Success;
+	}
+
+	HLSampler::NativeHandle HLSampler::GetNativeHandle()
+	{
+		return m_details->sampler;
+	}
+
+	bool HLSampler::IsInitialized()
+	{
+		return m_details && m_details->gl;
+	}
+}
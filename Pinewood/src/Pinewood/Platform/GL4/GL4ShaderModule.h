@@ -1,6 +1,9 @@
 #pragma once
 #include "pch.h"
+#include "GL4Extensions.h"
+
 #include <Pinewood/Renderer/HL/HLShaderModule.h>
+#include "../../Renderer/HL/HLRenderStatsCounters.h"
 
 namespace Pinewood
 {
@@ -12,6 +15,8 @@ namespace Pinewood
 			return GL_VERTEX_SHADER;
 		case Pinewood::HLShaderModuleType::Pixel:
 			return GL_FRAGMENT_SHADER;
+		case Pinewood::HLShaderModuleType::Compute:
+			return GL_COMPUTE_SHADER;
 		default:
 			return 0;
 		}
@@ -37,7 +42,11 @@ namespace Pinewood
 
 	Result HLShaderModule::Details::Destroy()
 	{
+		if (!gl)
+			return Result::Success; // Already destroyed
+
 		gl->DeleteShader(shader);
+		Impl::CountResourceDestroyed(HLResourceType::ShaderModule);
 
 		gl = nullptr;
 		context = HLContext{};
@@ -47,12 +56,41 @@ namespace Pinewood
 
 	Result HLShaderModule::Create(const HLShaderModuleCreateInfo& createInfo)
 	{
+		HLContext context = createInfo.context;
+		const auto contextHandle = context.GetNativeHandle();
+		const GladGLContext* gl = static_cast<const GladGLContext*>(contextHandle.gl);
+
+		const auto SpecializeShader = static_cast<const GL4Extensions*>(contextHandle.extensions)->SpecializeShader;
+		if (!createInfo.spirv.empty() && !SpecializeShader)
+			return Result::Unsupported;
+
 		m_details = std::make_shared<Details>();
-		m_details->context = createInfo.context;
-		m_details->gl = static_cast<const GladGLContext*>(m_details->context.GetNativeHandle().gl);
+		m_details->context = context;
+		m_details->gl = gl;
 
 		m_details->shader = m_details->gl->CreateShader(GetGLShaderType(createInfo.type));
+		Impl::CountResourceCreated(HLResourceType::ShaderModule);
 
+		if (!createInfo.spirv.empty())
+		{
+			// The module is already parsed and validated, the driver only has to specialize it and generate the code
+			m_details->gl->ShaderBinary(1, &m_details->shader, Impl::GLShaderBinaryFormatSpirV, createInfo.spirv.data(),
+				static_cast<GLsizei>(createInfo.spirv.size_bytes()));
+
+			std::string entryPoint{ createInfo.entryPoint };
+			std::vector<GLuint> constantIds, constantValues;
+			constantIds.reserve(createInfo.specializationConstants.size());
+			constantValues.reserve(createInfo.specializationConstants.size());
+			for (auto& constant : createInfo.specializationConstants)
+			{
+				constantIds.push_back(constant.id);
+				constantValues.push_back(constant.value);
+			}
+
+			SpecializeShader(m_details->shader, entryPoint.c_str(), static_cast<GLuint>(constantIds.size()), constantIds.data(),
+				constantValues.data());
+		}
+		else
 		{
 			// Create some temporary variables so I can pass pointers to glShaderSource
 			std::string shaderSource{ createInfo.shaderSource };
@@ -60,11 +98,10 @@ namespace Pinewood
 			int shaderSourceLength = static_cast<int>(createInfo.shaderSource.size());
 
 			m_details->gl->ShaderSource(m_details->shader, 1, &shaderSourceCStr, &shaderSourceLength);
+			m_details->gl->CompileShader(m_details->shader);
 		}
 
-		m_details->gl->CompileShader(m_details->shader);
-
-		// Check for compile errors
+		// Check for compile errors (for SPIR-V, if it was specialized)
 		int compileStatus;
 		m_details->gl->GetShaderiv(m_details->shader, GL_COMPILE_STATUS, &compileStatus);
 		if (compileStatus == GL_FALSE)
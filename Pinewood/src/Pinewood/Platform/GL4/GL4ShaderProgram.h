@@ -1,6 +1,7 @@
 #pragma once
 #include "pch.h"
 #include <Pinewood/Renderer/HL/HLShaderProgram.h>
+#include "../../Renderer/HL/HLRenderStatsCounters.h"
 
 namespace Pinewood
 {
@@ -26,7 +27,11 @@ namespace Pinewood
 
 	Result HLShaderProgram::Details::Destroy()
 	{
+		if (!gl)
+			return Result::Success; // Already destroyed
+
 		gl->DeleteProgram(program);
+		Impl::CountResourceDestroyed(HLResourceType::ShaderProgram);
 
 		gl = nullptr;
 		context = HLContext{};
@@ -43,6 +48,7 @@ namespace Pinewood
 		std::copy(createInfo.shaderModules.begin(), createInfo.shaderModules.end(), std::back_inserter(m_details->modules));
 
 		m_details->program = m_details->gl->CreateProgram();
+		Impl::CountResourceCreated(HLResourceType::ShaderProgram);
 
 		for (auto& module : m_details->modules)
 			m_details->gl->AttachShader(m_details->program, module.GetNativeHandle());
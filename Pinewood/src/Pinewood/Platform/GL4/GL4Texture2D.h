@@ -1,6 +1,7 @@
 #pragma once
 #include "pch.h"
 #include "TextureCommon.h"
+#include "../../Renderer/HL/HLRenderStatsCounters.h"
 
 #include <Pinewood/Renderer/HL/HLTexture2D.h>
 
@@ -13,7 +14,10 @@ namespace Pinewood
 		const GladGLContext* gl; // So I don't need to get it from the context all the time
 		
 		HLImageFormat format;
+		uint32_t width, height;
+		uint32_t samples;
 		uint32_t texture;
+		uint64_t memorySize;
 
 		~Details();
 
@@ -27,7 +31,11 @@ namespace Pinewood
 	
 	Result HLTexture2D::Details::Destroy()
 	{
+		if (!gl)
+			return Result::Success; // Already destroyed
+
 		gl->DeleteTextures(1, &texture);
+		Impl::CountResourceDestroyed(HLResourceType::Texture2D, memorySize);
 
 		gl = nullptr;
 		context = HLContext{};
@@ -41,9 +49,36 @@ namespace Pinewood
 		m_details->context = createInfo.context;
 		m_details->gl = static_cast<const GladGLContext*>(m_details->context.GetNativeHandle().gl);
 		m_details->format = createInfo.format;
+		m_details->width = createInfo.width;
+		m_details->height = createInfo.height;
+		m_details->samples = std::max(createInfo.samples, 1u);
 		auto glFormat = Impl::GetGLFormat(createInfo.format);
 
+		if (m_details->samples > 1)
+		{
+			// Multisampled textures have no mips, sampler state or initial data
+			if (createInfo.data || createInfo.mipLevels > 1)
+			{
+				m_details->gl = nullptr; // Nothing was created yet
+				m_details = nullptr;
+				return Result::InvalidParameter;
+			}
+
+			m_details->gl->CreateTextures(GL_TEXTURE_2D_MULTISAMPLE, 1, &m_details->texture);
+			Impl::CountResourceCreated(HLResourceType::Texture2D);
+
+			// Fixed sample locations, so a resolve gives the same result as a single sampled target that is rendered the same way
+			m_details->gl->TextureStorage2DMultisample(m_details->texture, m_details->samples, glFormat.sizeFormat, createInfo.width, createInfo.height, GL_TRUE);
+
+			m_details->memorySize = Impl::GetTextureMemorySize(createInfo.format, createInfo.width, createInfo.height, 1, 1) * m_details->samples;
+			Impl::CountStat(Impl::renderStats.liveMemory[static_cast<size_t>(HLResourceType::Texture2D)], m_details->memorySize);
+
+			return Result::Success;
+		}
+
 		m_details->gl->CreateTextures(GL_TEXTURE_2D, 1, &m_details->texture);
+		m_details->memorySize = 0;
+		Impl::CountResourceCreated(HLResourceType::Texture2D);
 
 		// Set the wrap mode
 		switch (createInfo.wrapMode)
@@ -96,6 +131,9 @@ namespace Pinewood
 		
 		m_details->gl->TextureStorage2D(m_details->texture, mipLevels, glFormat.sizeFormat, createInfo.width, createInfo.height);
 
+		m_details->memorySize = Impl::GetTextureMemorySize(createInfo.format, createInfo.width, createInfo.height, 1, mipLevels);
+		Impl::CountStat(Impl::renderStats.liveMemory[static_cast<size_t>(HLResourceType::Texture2D)], m_details->memorySize);
+
 		if (createInfo.data)
 			SetImage(createInfo.data, 0, 0, 0, createInfo.width, createInfo.height);
 
@@ -111,27 +149,60 @@ namespace Pinewood
 
 	Result HLTexture2D::SetImage(const void* data, uint32_t mipLevel, uint32_t xOffset, uint32_t yOffset, uint32_t width, uint32_t height)
 	{
+		if (m_details->samples > 1)
+			return Result::InvalidParameter;
+
 		auto glFormat = Impl::GetGLFormat2(m_details->format);
 		m_details->gl->TextureSubImage2D(m_details->texture, mipLevel, xOffset, yOffset, width, height, glFormat.baseFormat, glFormat.sizeFormat, data);
+		Impl::CountStat(Impl::renderStats.textureUploadBytes, static_cast<uint64_t>(width) * height * GetImageFormatSize(m_details->format));
 
 		return Result::Success;
 	}
 
 	Result HLTexture2D::GetImage(void* data, size_t bufferSize, uint32_t mipLevel, uint32_t xOffset, uint32_t yOffset, uint32_t width, uint32_t height)
 	{
+		if (m_details->samples > 1)
+			return Result::InvalidParameter;
+
 		auto glFormat = Impl::GetGLFormat2(m_details->format);
-		m_details->gl->GetTextureSubImage(m_details->texture, mipLevel, xOffset, yOffset, 0, width, height, 0, glFormat.baseFormat, glFormat.sizeFormat, static_cast<GLsizei>(bufferSize), data);
+		m_details->gl->GetTextureSubImage(m_details->texture, mipLevel, xOffset, yOffset, 0, width, height, 1, glFormat.baseFormat, glFormat.sizeFormat, static_cast<GLsizei>(bufferSize), data);
 
 		return Result::Success;
 	}
 
 	Result HLTexture2D::GenerateMips()
 	{
+		if (m_details->samples > 1)
+			return Result::InvalidParameter;
+
 		m_details->gl->GenerateTextureMipmap(m_details->texture);
 
 		return Result::Success;
 	}
 
+	Result HLTexture2D::GetSize(uint32_t& widthOut, uint32_t& heightOut)
+	{
+		widthOut = m_details->width;
+		heightOut = m_details->height;
+
+		return Result::Success;
+	}
+
+	uint32_t HLTexture2D::GetSampleCount()
+	{
+		return m_details->samples;
+	}
+
+	HLImageFormat HLTexture2D::GetFormat()
+	{
+		return m_details->format;
+	}
+
+	uint64_t HLTexture2D::GetMemorySize()
+	{
+		return m_details->memorySize;
+	}
+
 	HLTexture2D::NativeHandle HLTexture2D::GetNativeHandle()
 	{
 		return m_details->texture;
@@ -1,6 +1,7 @@
 #pragma once
 #include "pch.h"
 #include "TextureCommon.h"
+#include "../../Renderer/HL/HLRenderStatsCounters.h"
 
 #include <Pinewood/Renderer/HL/HLTexture2DArray.h>
 
@@ -14,6 +15,7 @@ namespace Pinewood
 		
 		HLImageFormat format;
 		uint32_t texture;
+		uint64_t memorySize;
 
 		~Details();
 
@@ -27,7 +29,11 @@ namespace Pinewood
 	
 	Result HLTexture2DArray::Details::Destroy()
 	{
+		if (!gl)
+			return Result::Success; // Already destroyed
+
 		gl->DeleteTextures(1, &texture);
+		Impl::CountResourceDestroyed(HLResourceType::Texture2DArray, memorySize);
 
 		gl = nullptr;
 		context = HLContext{};
@@ -44,6 +50,8 @@ namespace Pinewood
 		auto glFormat = Impl::GetGLFormat(createInfo.format);
 
 		m_details->gl->CreateTextures(GL_TEXTURE_2D_ARRAY, 1, &m_details->texture);
+		m_details->memorySize = 0;
+		Impl::CountResourceCreated(HLResourceType::Texture2DArray);
 
 		// Set the wrap mode
 		switch (createInfo.wrapMode)
@@ -96,8 +104,11 @@ namespace Pinewood
 		
 		m_details->gl->TextureStorage3D(m_details->texture, mipLevels, glFormat.sizeFormat, createInfo.width, createInfo.height, createInfo.count);
 
+		m_details->memorySize = Impl::GetTextureMemorySize(createInfo.format, createInfo.width, createInfo.height, createInfo.count, mipLevels);
+		Impl::CountStat(Impl::renderStats.liveMemory[static_cast<size_t>(HLResourceType::Texture2DArray)], m_details->memorySize);
+
 		if (createInfo.data)
-			SetImage(createInfo.data, 0, 0, 0, createInfo.width, createInfo.height);
+			SetImage(createInfo.data, 0, 0, 0, createInfo.width, createInfo.height, 0, createInfo.count);
 
 		return Result::Success;
 	}
@@ -113,6 +124,7 @@ namespace Pinewood
 	{
 		auto glFormat = Impl::GetGLFormat2(m_details->format);
 		m_details->gl->TextureSubImage3D(m_details->texture, mipLevel, xOffset, yOffset, startIndex, width, height, numTextures, glFormat.baseFormat, glFormat.sizeFormat, data);
+		Impl::CountStat(Impl::renderStats.textureUploadBytes, static_cast<uint64_t>(width) * height * numTextures * GetImageFormatSize(m_details->format));
 
 		return Result::Success;
 	}
@@ -132,6 +144,11 @@ namespace Pinewood
 		return Result::Success;
 	}
 
+	uint64_t HLTexture2DArray::GetMemorySize()
+	{
+		return m_details->memorySize;
+	}
+
 	HLTexture2DArray::NativeHandle HLTexture2DArray::GetNativeHandle()
 	{
 		return m_details->texture;
@@ -0,0 +1,334 @@
+#pragma once
+#include "pch.h"
+#include "GL4Extensions.h"
+#include "TextureCommon.h"
+
+#include <Pinewood/Renderer/HL/HLTextureTable.h>
+#include <Pinewood/Renderer/HL/HLResidencyManager.h>
+
+#include <bit>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Pinewood
+{
+	class HLTextureTable::Details
+	{
+	public:
+		// A texture in the table, kept alive while the table samples it
+		struct Entry
+		{
+			HLTexture2D texture;
+			HLTexture2DArray textures;
+			GLuint view = 0;		// A one layer texture array view of the 2D texture, so every handle is a sampler2DArray
+			GLuint64 handle = 0;
+		};
+
+		// An entry of the bindless table, in the layout of the shader (std430)
+		struct GPUEntry
+		{
+			GLuint64 handle;
+			uint32_t layer;
+			uint32_t padding;
+		};
+
+		HLRenderInterface renderInterface;
+		const GladGLContext* gl; // So I don't need to get it from the context all the time
+		GL4Extensions extensions;
+
+		uint32_t capacity;
+		bool bindless;
+		HLSampler sampler;
+		uint32_t bufferIndex, textureLocation, textureSlot;
+
+		uint32_t width, height;
+		HLImageFormat format;
+		uint32_t mipLevels;
+
+		HLBuffer entryBuffer;			// Bindless
+		HLTexture2DArray textureArray;	// Fallback
+		std::vector<Entry> entries;
+		std::unordered_map<GLuint64, uint32_t> residentHandles; // Entries with the same texture share the handle, it's resident once
+
+		std::string shaderSource;
+
+		~Details();
+
+		Result Destroy();
+
+		void Release(Entry& entry);
+		Result SetBindless(uint32_t index, Entry&& entry, GLuint texture, uint32_t layer);
+		Result CopyToFallback(uint32_t index, GLuint texture, GLenum target, uint32_t layer);
+	};
+
+	HLTextureTable::Details::~Details()
+	{
+		Destroy();
+	}
+
+	Result HLTextureTable::Details::Destroy()
+	{
+		if (!gl)
+			return Result::Success; // Already destroyed
+
+		for (auto& entry : entries)
+			Release(entry);
+		entries.clear();
+
+		textureArray = HLTexture2DArray{};
+		entryBuffer = HLBuffer{};
+		sampler = HLSampler{};
+
+		gl = nullptr;
+		renderInterface = HLRenderInterface{};
+
+		return Result::Success;
+	}
+
+	void HLTextureTable::Details::Release(Entry& entry)
+	{
+		if (entry.handle != 0)
+		{
+			auto it = residentHandles.find(entry.handle);
+			if (--it->second == 0)
+			{
+				extensions.MakeTextureHandleNonResident(entry.handle);
+				residentHandles.erase(it);
+			}
+		}
+
+		if (entry.view != 0)
+			gl->DeleteTextures(1, &entry.view);
+
+		entry = Entry{};
+	}
+
+	Result HLTextureTable::Details::SetBindless(uint32_t index, Entry&& entry, GLuint texture, uint32_t layer)
+	{
+		HLSampler samp = sampler;
+
+		// The handle of a texture and sampler pair is always the same, and the texture can't change after it
+		entry.handle = extensions.GetTextureSamplerHandle(texture, samp.GetNativeHandle());
+		if (entry.handle == 0)
+		{
+			if (entry.view != 0)
+				gl->DeleteTextures(1, &entry.view);
+			return Result::UnknownError;
+		}
+
+		if (residentHandles[entry.handle]++ == 0)
+			extensions.MakeTextureHandleResident(entry.handle);
+
+		Release(entries[index]);
+		entries[index] = std::move(entry);
+
+		GPUEntry gpuEntry{ .handle = entries[index].handle, .layer = layer, .padding = 0 };
+		return entryBuffer.SetData(&gpuEntry, sizeof(GPUEntry) * index, sizeof(GPUEntry));
+	}
+
+	Result HLTextureTable::Details::CopyToFallback(uint32_t index, GLuint texture, GLenum target, uint32_t layer)
+	{
+		GLint textureWidth = 0, textureHeight = 0, textureFormat = 0, textureLevels = 0;
+		gl->GetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &textureWidth);
+		gl->GetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &textureHeight);
+		gl->GetTextureLevelParameteriv(texture, 0, GL_TEXTURE_INTERNAL_FORMAT, &textureFormat);
+		gl->GetTextureParameteriv(texture, GL_TEXTURE_IMMUTABLE_LEVELS, &textureLevels);
+
+		if (static_cast<uint32_t>(textureWidth) != width || static_cast<uint32_t>(textureHeight) != height ||
+			static_cast<GLenum>(textureFormat) != Impl::GetGLFormat(format).sizeFormat)
+			return Result::InvalidParameter;
+
+		// Copies the mips the texture has, the array makes the others
+		const uint32_t copiedLevels = std::min(static_cast<uint32_t>(std::max(textureLevels, 1)), mipLevels);
+		for (uint32_t level = 0; level < copiedLevels; level++)
+		{
+			gl->CopyImageSubData(texture, target, level, 0, 0, layer, textureArray.GetNativeHandle(), GL_TEXTURE_2D_ARRAY, level, 0, 0, index,
+				std::max(width >> level, 1u), std::max(height >> level, 1u), 1);
+		}
+
+		if (copiedLevels < mipLevels)
+			textureArray.GenerateMips();
+
+		Release(entries[index]);
+		return Result::Success;
+	}
+
+	Result HLTextureTable::Create(const HLTextureTableCreateInfo& createInfo)
+	{
+		HLRenderInterface renderInterface = createInfo.renderInterface;
+		if (!renderInterface.IsInitialized() || createInfo.capacity == 0)
+			return Result::InvalidParameter;
+
+		m_details = std::make_shared<Details>();
+		m_details->renderInterface = renderInterface;
+		m_details->capacity = createInfo.capacity;
+		m_details->bindless = renderInterface.IsBindlessTextureSupported() && !createInfo.forceFallback;
+		m_details->sampler = createInfo.sampler;
+		m_details->bufferIndex = createInfo.bufferIndex;
+		m_details->textureLocation = createInfo.textureLocation;
+		m_details->textureSlot = createInfo.textureSlot;
+		m_details->width = createInfo.width;
+		m_details->height = createInfo.height;
+		m_details->format = createInfo.format;
+		m_details->mipLevels = (createInfo.mipLevels == 0) ? std::bit_width(std::max(createInfo.width, createInfo.height)) : createInfo.mipLevels;
+		m_details->entries.resize(createInfo.capacity);
+
+		HLContext context = renderInterface.GetContext();
+		const auto contextHandle = context.GetNativeHandle();
+		m_details->gl = static_cast<const GladGLContext*>(contextHandle.gl);
+		m_details->extensions = *static_cast<const GL4Extensions*>(contextHandle.extensions);
+
+		Result result = Result::Success;
+		if (!m_details->sampler.IsInitialized())
+			result = m_details->sampler.Create({ .context = context });
+
+		if (!IsError(result) && m_details->bindless)
+		{
+			result = m_details->entryBuffer.Create({
+				.context = context,
+				.usage = HLBufferUsage::Mutable,
+				.size = sizeof(Details::GPUEntry) * createInfo.capacity,
+				.data = nullptr
+				});
+
+			m_details->shaderSource =
+				"#extension GL_ARB_bindless_texture : require\n"
+				"struct PWTextureTableEntry { uvec2 handle; uint layer; uint padding; };\n"
+				"layout(std430, binding = " + std::to_string(createInfo.bufferIndex) + ") readonly buffer PWTextureTable { PWTextureTableEntry pw_textureTable[]; };\n"
+				"vec4 SampleTextureTable(uint index, vec2 uv)\n"
+				"{\n"
+				"	PWTextureTableEntry entry = pw_textureTable[index];\n"
+				"	return texture(sampler2DArray(entry.handle), vec3(uv, float(entry.layer)));\n"
+				"}\n";
+		}
+		else if (!IsError(result))
+		{
+			if (createInfo.width == 0 || createInfo.height == 0)
+				result = Result::InvalidParameter;
+			else
+				result = m_details->textureArray.Create({
+					.context = context,
+					.width = createInfo.width,
+					.height = createInfo.height,
+					.count = createInfo.capacity,
+					.mipLevels = m_details->mipLevels,
+					.format = createInfo.format,
+					.data = nullptr
+					});
+
+			m_details->shaderSource =
+				"layout(location = " + std::to_string(createInfo.textureLocation) + ") uniform sampler2DArray pw_textureTable;\n"
+				"vec4 SampleTextureTable(uint index, vec2 uv)\n"
+				"{\n"
+				"	return texture(pw_textureTable, vec3(uv, float(index)));\n"
+				"}\n";
+		}
+
+		if (IsError(result))
+		{
+			m_details = nullptr;
+			return result;
+		}
+
+		return Result::Success;
+	}
+
+	Result HLTextureTable::Destroy()
+	{
+		auto result = m_details->Destroy();
+		m_details = nullptr;
+		return result;
+	}
+
+	Result HLTextureTable::SetTexture(uint32_t index, const HLTexture2D& texture)
+	{
+		HLTexture2D tex = texture;
+		if (index >= m_details->capacity || !tex.IsInitialized() || tex.GetSampleCount() > 1)
+			return Result::InvalidParameter;
+
+		if (!m_details->bindless)
+			return m_details->CopyToFallback(index, tex.GetNativeHandle(), GL_TEXTURE_2D, 0);
+
+		GLint levels = 0;
+		m_details->gl->GetTextureParameteriv(tex.GetNativeHandle(), GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+
+		GLuint view = 0;
+		m_details->gl->GenTextures(1, &view);
+		m_details->gl->TextureView(view, GL_TEXTURE_2D_ARRAY, tex.GetNativeHandle(), Impl::GetGLFormat(tex.GetFormat()).sizeFormat, 0,
+			std::max(levels, 1), 0, 1);
+
+		return m_details->SetBindless(index, Details::Entry{ .texture = tex, .view = view }, view, 0);
+	}
+
+	Result HLTextureTable::SetTexture(uint32_t index, const HLTexture2DArray& textures, uint32_t layer)
+	{
+		HLTexture2DArray tex = textures;
+		if (index >= m_details->capacity || !tex.IsInitialized())
+			return Result::InvalidParameter;
+
+		GLint layerCount = 0;
+		m_details->gl->GetTextureLevelParameteriv(tex.GetNativeHandle(), 0, GL_TEXTURE_DEPTH, &layerCount);
+		if (layer >= static_cast<uint32_t>(layerCount))
+			return Result::InvalidParameter;
+
+		if (!m_details->bindless)
+			return m_details->CopyToFallback(index, tex.GetNativeHandle(), GL_TEXTURE_2D_ARRAY, layer);
+
+		return m_details->SetBindless(index, Details::Entry{ .textures = tex }, tex.GetNativeHandle(), layer);
+	}
+
+	Result HLTextureTable::RemoveTexture(uint32_t index)
+	{
+		if (index >= m_details->capacity)
+			return Result::InvalidParameter;
+
+		// The handle stays in the buffer, but it isn't resident anymore (if no other entry uses it)
+		m_details->Release(m_details->entries[index]);
+		return Result::Success;
+	}
+
+	Result HLTextureTable::Bind()
+	{
+		if (m_details->bindless)
+		{
+			// The shaders sample the textures of the table through their handles, so binding the table uses them
+			HLResidencyManager residencyManager = m_details->renderInterface.GetResidencyManager();
+			if (residencyManager.IsInitialized())
+			{
+				for (auto& entry : m_details->entries)
+				{
+					if (entry.texture.IsInitialized())
+						residencyManager.Touch(entry.texture);
+					else if (entry.textures.IsInitialized())
+						residencyManager.Touch(entry.textures);
+				}
+			}
+
+			return m_details->renderInterface.SetStorageBuffer(m_details->bufferIndex, m_details->entryBuffer);
+		}
+
+		return m_details->renderInterface.SetTexture2DArray(m_details->textureLocation, m_details->textureSlot, m_details->textureArray,
+			m_details->sampler);
+	}
+
+	const std::string& HLTextureTable::GetShaderSource()
+	{
+		return m_details->shaderSource;
+	}
+
+	bool HLTextureTable::IsBindless()
+	{
+		return m_details->bindless;
+	}
+
+	uint32_t HLTextureTable::GetCapacity()
+	{
+		return m_details->capacity;
+	}
+
+	bool HLTextureTable::IsInitialized()
+	{
+		return m_details && m_details->gl;
+	}
+}
@@ -1,6 +1,10 @@
 #pragma once
 #include "pch.h"
 #include <Pinewood/Renderer/HL/HLVertexBinding.h>
+#include "../../Renderer/HL/HLRenderStatsCounters.h"
+#include "../../Renderer/HL/HLObjectCache.h"
+
+#include <algorithm>
 
 namespace Pinewood
 {
@@ -28,6 +32,9 @@ namespace Pinewood
 		case 0x6:
 			glType.type = GL_INT;
 			break;
+		case 0x7:
+			glType.type = GL_HALF_FLOAT;
+			break;
 		case 0x8:
 			glType.type = GL_FLOAT;
 			break;
@@ -62,18 +69,35 @@ namespace Pinewood
 	class HLVertexBinding::Details
 	{
 	public:
+		// GL_MAX_VERTEX_ATTRIB_BINDINGS is at least 16
+		static constexpr size_t MaxVertexBuffers = 16;
+
 		HLContext context;
 		const GladGLContext* gl; // So I don't need to get it from the context all the time
 
-		std::vector<HLBuffer> vertexBuffers;
-		HLBuffer indexBuffer;
+		std::vector<HLBuffer> vertexBuffers; // Empty for a layout-only binding
+		HLBuffer indexBuffer; // Of the create info, part of the cache key (none for a layout-only binding, see boundIndexBuffer)
 		HLLayout vertexLayout;
+		bool hasLayout; // An empty binding has no attributes, for vertex pulling
+		bool layoutOnly;
+
+		// The buffers set by SetBuffers, kept alive so a new buffer can't get the name of a set one
+		HLBuffer boundBuffers[MaxVertexBuffers];
+		GLintptr boundOffsets[MaxVertexBuffers]{};
+		HLBuffer boundIndexBuffer;
 
 		uint32_t vao;
 
+		Impl::ObjectCacheEntry<Details> cacheEntry;
+
+		static inline Impl::ObjectCache<Details> cache;
+
 		~Details();
 
 		Result Destroy();
+
+		// Whether the binding was created from the same layout and buffers, and none of them was destroyed since
+		bool IsSame(const void* renderContext, const HLLayout::NativeHandle& layoutData, std::span<const HLBuffer> buffers, HLBuffer& index);
 	};
 
 	HLVertexBinding::Details::~Details()
@@ -83,7 +107,11 @@ namespace Pinewood
 
 	Result HLVertexBinding::Details::Destroy()
 	{
-		gl->DeleteBuffers(1, &vao);
+		if (!gl)
+			return Result::Success; // Already destroyed
+
+		gl->DeleteVertexArrays(1, &vao);
+		Impl::CountResourceDestroyed(HLResourceType::VertexBinding);
 
 		gl = nullptr;
 		context = HLContext{};
@@ -91,60 +119,175 @@ namespace Pinewood
 		return Result::Success;
 	}
 
-	Result HLVertexBinding::Create(const HLVertexBindingCreateInfo& createInfo)
+	bool HLVertexBinding::Details::IsSame(const void* renderContext, const HLLayout::NativeHandle& layoutData, std::span<const HLBuffer> buffers,
+		HLBuffer& index)
 	{
+		if (!gl || context.GetNativeHandle().renderContext != renderContext || buffers.size() != vertexBuffers.size() ||
+			index.IsInitialized() != indexBuffer.IsInitialized())
+			return false;
 
-		m_details = std::make_shared<Details>();
-		m_details->context = createInfo.context;
-		m_details->gl = static_cast<const GladGLContext*>(m_details->context.GetNativeHandle().gl);
-
-		std::copy(createInfo.vertexBuffers.begin(), createInfo.vertexBuffers.end(), std::back_inserter(m_details->vertexBuffers));
-		m_details->indexBuffer = createInfo.indexBuffer;
-		m_details->vertexLayout = createInfo.vertexLayout;
-
-		const auto vertexLayoutData = m_details->vertexLayout.GetNativeHandle();
+		// The layout of a binding with one can't be destroyed, it doesn't match the empty binding then
+		if (hasLayout == layoutData.elements.empty() || (hasLayout && !vertexLayout.IsInitialized()))
+			return false;
 
-		m_details->gl->CreateVertexArrays(1, &m_details->vao);
+		if (index.IsInitialized() && (index.GetNativeHandle() != indexBuffer.GetNativeHandle()))
+			return false;
 
-		for (auto& element : vertexLayoutData.elements)
+		for (size_t i = 0; i < buffers.size(); i++)
 		{
-			// Enable the attribute index
-			m_details->gl->EnableVertexArrayAttrib(m_details->vao, element.index);
-
-			// Set the format of the attribute
-			auto glType = GetGLType(element.type);
-			if (glType.type == GL_DOUBLE)
-				m_details->gl->VertexArrayAttribLFormat(m_details->vao, element.index, glType.size,
-					glType.type, element.offset);
-			else
-				m_details->gl->VertexArrayAttribFormat(m_details->vao, element.index, glType.size,
-					glType.type, glType.normalized, element.offset);
-
-			// Bind the attribute to a vertex buffer binding (see the next loop where I loop over all the vertex buffers)
-			m_details->gl->VertexArrayAttribBinding(m_details->vao, element.index, element.binding);
+			HLBuffer buffer = buffers[i];
+			if (!vertexBuffers[i].IsInitialized() || buffer.GetNativeHandle() != vertexBuffers[i].GetNativeHandle())
+				return false;
 		}
 
+		if (!hasLayout)
+			return true;
+
+		const auto cachedLayoutData = vertexLayout.GetNativeHandle();
+		return std::ranges::equal(cachedLayoutData.elements, layoutData.elements) && std::ranges::equal(cachedLayoutData.bindings, layoutData.bindings);
+	}
+
+	static uint64_t HashVertexBinding(const void* renderContext, const HLLayout::NativeHandle& layoutData, std::span<const HLBuffer> buffers,
+		HLBuffer& index)
+	{
+		uint64_t hash = Impl::ObjectHashBasis;
+		Impl::HashValue(hash, reinterpret_cast<uintptr_t>(renderContext));
+		Impl::HashLayout(hash, layoutData);
+
+		for (auto& buffer : buffers)
+			Impl::HashValue(hash, HLBuffer{ buffer }.GetNativeHandle());
+		Impl::HashValue(hash, index.IsInitialized() ? index.GetNativeHandle() : 0);
+
+		return hash;
+	}
+
+	Result HLVertexBinding::Create(const HLVertexBindingCreateInfo& createInfo)
+	{
+		HLContext context = createInfo.context;
+		HLLayout layout = createInfo.vertexLayout;
+		HLBuffer indexBuffer = createInfo.indexBuffer;
+		const bool layoutOnly = createInfo.vertexBuffers.empty();
+		if (!context.IsInitialized() || (!layout.IsInitialized() && !layoutOnly) || (layoutOnly && indexBuffer.IsInitialized()))
+			return Result::InvalidParameter; // A layout-only binding is shared, its cache key can't have buffers
+
+		const auto vertexLayoutData = Impl::GetLayoutData(layout);
+
 		// Make sure the sizes match
-		if (createInfo.vertexBuffers.size() != vertexLayoutData.bindings.size())
+		if ((!layoutOnly && createInfo.vertexBuffers.size() != vertexLayoutData.bindings.size()) ||
+			vertexLayoutData.bindings.size() > Details::MaxVertexBuffers)
 			return Result::InvalidParameter;
 
-		// Bind the vertex buffers
-		for (uint32_t i = 0; i < createInfo.vertexBuffers.size(); i++)
-			m_details->gl->VertexArrayVertexBuffer(m_details->vao, i, m_details->vertexBuffers[i].GetNativeHandle(),
-				vertexLayoutData.bindings[i].offset, vertexLayoutData.bindings[i].stride);
+		const void* renderContext = context.GetNativeHandle().renderContext;
+		const uint64_t hash = HashVertexBinding(renderContext, vertexLayoutData, createInfo.vertexBuffers, indexBuffer);
+
+		auto isSame = [&](Details& details) { return details.IsSame(renderContext, vertexLayoutData, createInfo.vertexBuffers, indexBuffer); };
+
+		auto create = [&]()
+		{
+			auto details = std::make_shared<Details>();
+			details->context = context;
+			details->gl = static_cast<const GladGLContext*>(details->context.GetNativeHandle().gl);
+
+			details->vertexBuffers.assign(createInfo.vertexBuffers.begin(), createInfo.vertexBuffers.end());
+			details->indexBuffer = indexBuffer;
+			details->vertexLayout = layout;
+			details->hasLayout = layout.IsInitialized();
+			details->layoutOnly = layoutOnly;
 
-		// Optionally bind the index buffer
-		if (m_details->indexBuffer.IsInitialized())
-			m_details->gl->VertexArrayElementBuffer(m_details->vao, m_details->indexBuffer.GetNativeHandle());
+			details->gl->CreateVertexArrays(1, &details->vao);
+			Impl::CountResourceCreated(HLResourceType::VertexBinding);
+
+			for (auto& element : vertexLayoutData.elements)
+			{
+				// Enable the attribute index
+				details->gl->EnableVertexArrayAttrib(details->vao, element.index);
+
+				// Set the format of the attribute
+				auto glType = GetGLType(element.type);
+				if (glType.type == GL_DOUBLE)
+					details->gl->VertexArrayAttribLFormat(details->vao, element.index, glType.size,
+						glType.type, element.offset);
+				else
+					details->gl->VertexArrayAttribFormat(details->vao, element.index, glType.size,
+						glType.type, glType.normalized, element.offset);
+
+				// Bind the attribute to a vertex buffer binding (see the next loop where I loop over all the vertex buffers)
+				details->gl->VertexArrayAttribBinding(details->vao, element.index, element.binding);
+
+				// The divisor belongs to the binding, not the attribute
+				if (element.instanceDivisor != 0)
+					details->gl->VertexArrayBindingDivisor(details->vao, element.binding, element.instanceDivisor);
+			}
+
+			// Bind the vertex buffers
+			for (uint32_t i = 0; i < createInfo.vertexBuffers.size(); i++)
+				details->gl->VertexArrayVertexBuffer(details->vao, i, details->vertexBuffers[i].GetNativeHandle(),
+					vertexLayoutData.bindings[i].offset, vertexLayoutData.bindings[i].stride);
+
+			// Optionally bind the index buffer
+			if (details->indexBuffer.IsInitialized())
+				details->gl->VertexArrayElementBuffer(details->vao, details->indexBuffer.GetNativeHandle());
+
+			return details;
+		};
+
+		m_details = Details::cache.FindOrCreate(hash, isSame, create);
 
 		return Result::Success;
 	}
 
 	Result HLVertexBinding::Destroy()
 	{
-		return m_details->Destroy();
+		m_details = nullptr;
+		return Result::Success;
 	}
 
+	Result HLVertexBinding::SetBuffers(std::span<const HLBuffer> vertexBuffers, const HLBuffer& indexBuffer, std::span<const size_t> offsets)
+	{
+		const auto vertexLayoutData = Impl::GetLayoutData(m_details->vertexLayout);
+		if (!m_details->layoutOnly || vertexBuffers.size() != vertexLayoutData.bindings.size() ||
+			(!offsets.empty() && offsets.size() != vertexBuffers.size()))
+			return Result::InvalidParameter;
+
+		GLuint buffers[Details::MaxVertexBuffers];
+		GLintptr bufferOffsets[Details::MaxVertexBuffers];
+		GLsizei strides[Details::MaxVertexBuffers];
+		bool changed = false;
+		for (size_t i = 0; i < vertexBuffers.size(); i++)
+		{
+			buffers[i] = HLBuffer{ vertexBuffers[i] }.GetNativeHandle();
+			bufferOffsets[i] = vertexLayoutData.bindings[i].offset + (offsets.empty() ? 0 : offsets[i]);
+			strides[i] = vertexLayoutData.bindings[i].stride;
+
+			HLBuffer& bound = m_details->boundBuffers[i];
+			changed = changed || !bound.IsInitialized() || bound.GetNativeHandle() != buffers[i] || bufferOffsets[i] != m_details->boundOffsets[i];
+		}
+
+		if (changed)
+		{
+			m_details->gl->VertexArrayVertexBuffers(m_details->vao, 0, static_cast<GLsizei>(vertexBuffers.size()), buffers, bufferOffsets, strides);
+			std::copy_n(vertexBuffers.begin(), vertexBuffers.size(), m_details->boundBuffers);
+			std::copy_n(bufferOffsets, vertexBuffers.size(), m_details->boundOffsets);
+			Impl::CountStat(Impl::renderStats.vertexBufferBinds);
+		}
+
+		HLBuffer index = indexBuffer;
+		HLBuffer& boundIndex = m_details->boundIndexBuffer;
+		const bool indexChanged = index.IsInitialized() ?
+			(!boundIndex.IsInitialized() || boundIndex.GetNativeHandle() != index.GetNativeHandle()) : boundIndex.IsInitialized();
+		if (indexChanged)
+		{
+			m_details->gl->VertexArrayElementBuffer(m_details->vao, index.IsInitialized() ? index.GetNativeHandle() : 0);
+			boundIndex = index;
+		}
+
+		return Result::Success;
+	}
+
+	bool HLVertexBinding::IsLayoutOnly()
+	{
+		return m_details->layoutOnly;
+	}
 
 	HLVertexBinding::NativeHandle HLVertexBinding::GetNativeHandle()
 	{
@@ -0,0 +1,262 @@
+#pragma once
+#include "pch.h"
+#include "GL4Extensions.h"
+
+#include <Pinewood/Renderer/HL/HLVertexPuller.h>
+
+#include <algorithm>
+#include <string>
+
+namespace Pinewood
+{
+	class HLVertexPuller::Details
+	{
+	public:
+		HLRenderInterface renderInterface;
+		const GladGLContext* gl; // So I don't need to get it from the context all the time
+
+		HLVertexBinding vertexBinding; // The empty binding, the cache shares it with every puller of the context
+		uint32_t bindingCount;
+		uint32_t firstBufferIndex;
+		GLint offsetAlignment;
+
+		std::string shaderSource;
+
+		~Details();
+
+		Result Destroy();
+	};
+
+	HLVertexPuller::Details::~Details()
+	{
+		Destroy();
+	}
+
+	Result HLVertexPuller::Details::Destroy()
+	{
+		if (!gl)
+			return Result::Success; // Already destroyed
+
+		vertexBinding = HLVertexBinding{};
+
+		gl = nullptr;
+		renderInterface = HLRenderInterface{};
+
+		return Result::Success;
+	}
+
+	// The size of a component of an element type in bytes, 0 for an unknown type
+	static uint32_t GetComponentSize(HLLayoutElementType type)
+	{
+		switch (static_cast<uint32_t>(type) >> 4)
+		{
+		case 0x0: case 0x4: case 0xa: case 0xc:
+			return 1;
+		case 0x1: case 0x5: case 0x7: case 0xb: case 0xd:
+			return 2;
+		case 0x2: case 0x6: case 0x8:
+			return 4;
+		case 0x9:
+			return 8;
+		default:
+			return 0;
+		}
+	}
+
+	// The GLSL that reads a component of an element, at 'offset' bytes from the element's address 'o'
+	static std::string GetComponentSource(HLLayoutElementType type, uint32_t binding, uint32_t offset)
+	{
+		auto load = [&](const char* function, uint32_t extraOffset = 0)
+		{
+			return std::string(function) + "_" + std::to_string(binding) + "(o + " + std::to_string(offset + extraOffset) + "u)";
+		};
+
+		switch (static_cast<uint32_t>(type) >> 4)
+		{
+		case 0x0:
+			return "float(" + load("PWLoadU8") + ")";
+		case 0x1:
+			return "float(" + load("PWLoadU16") + ")";
+		case 0x2:
+			return "float(" + load("PWLoadU32") + ")";
+		case 0x4:
+			return "float(" + load("PWLoadI8") + ")";
+		case 0x5:
+			return "float(" + load("PWLoadI16") + ")";
+		case 0x6:
+			return "float(int(" + load("PWLoadU32") + "))";
+		case 0x7:
+			return "unpackHalf2x16(" + load("PWLoadU16") + ").x";
+		case 0x8:
+			return "uintBitsToFloat(" + load("PWLoadU32") + ")";
+		case 0x9:
+			return "packDouble2x32(uvec2(" + load("PWLoadU32") + ", " + load("PWLoadU32", 4) + "))";
+		case 0xa:
+			return "(float(" + load("PWLoadU8") + ") / 255.0)";
+		case 0xb:
+			return "(float(" + load("PWLoadU16") + ") / 65535.0)";
+		// Like OpenGL 4.2+, the most negative value is -1 too
+		case 0xc:
+			return "max(float(" + load("PWLoadI8") + ") / 127.0, -1.0)";
+		case 0xd:
+			return "max(float(" + load("PWLoadI16") + ") / 32767.0, -1.0)";
+		default:
+			return {};
+		}
+	}
+
+	Result HLVertexPuller::Create(const HLVertexPullerCreateInfo& createInfo)
+	{
+		HLRenderInterface renderInterface = createInfo.renderInterface;
+		HLLayout layout = createInfo.vertexLayout;
+		if (!renderInterface.IsInitialized() || !layout.IsInitialized())
+			return Result::InvalidParameter;
+
+		HLContext context = renderInterface.GetContext();
+		const auto contextHandle = context.GetNativeHandle();
+		const GladGLContext* gl = static_cast<const GladGLContext*>(contextHandle.gl);
+		const auto& extensions = *static_cast<const GL4Extensions*>(contextHandle.extensions);
+
+		const auto layoutData = layout.GetNativeHandle();
+		bool instanced = false;
+		for (size_t i = 0; i < layoutData.elements.size(); i++)
+		{
+			const HLLayoutElement& element = layoutData.elements[i];
+			if (element.binding >= layoutData.bindings.size())
+				return Result::InvalidParameter;
+
+			// The loads read whole 32 bit words of the buffer, a component can't straddle two of them
+			const uint32_t alignment = std::min(GetComponentSize(element.type), 4u);
+			const HLLayoutBinding& binding = layoutData.bindings[element.binding];
+			if (alignment == 0 || (binding.offset + element.offset) % alignment != 0 || binding.stride % alignment != 0)
+				return Result::InvalidParameter;
+
+			// Every index is a function
+			for (size_t j = 0; j < i; j++)
+			{
+				if (layoutData.elements[j].index == element.index)
+					return Result::InvalidParameter;
+			}
+
+			instanced = instanced || element.instanceDivisor != 0;
+		}
+
+		if (instanced && !extensions.shaderDrawParameters)
+			return Result::Unsupported;
+
+		m_details = std::make_shared<Details>();
+		m_details->renderInterface = renderInterface;
+		m_details->gl = gl;
+		m_details->bindingCount = static_cast<uint32_t>(layoutData.bindings.size());
+		m_details->firstBufferIndex = createInfo.firstBufferIndex;
+		gl->GetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &m_details->offsetAlignment);
+
+		Result result = m_details->vertexBinding.Create({ .context = context });
+		if (IsError(result))
+		{
+			m_details = nullptr;
+			return result;
+		}
+
+		std::string& source = m_details->shaderSource;
+		if (instanced)
+			source += "#extension GL_ARB_shader_draw_parameters : require\n";
+
+		// A buffer of words per binding, with the loads of 8 and 16 bit values (sign extended for the signed ones)
+		for (uint32_t i = 0; i < layoutData.bindings.size(); i++)
+		{
+			const std::string binding = std::to_string(i);
+			const std::string data = "pw_vertexData" + binding;
+			source +=
+				"layout(std430, binding = " + std::to_string(createInfo.firstBufferIndex + i) + ") readonly buffer PWVertexBuffer" + binding +
+				" { uint " + data + "[]; };\n"
+				"uint PWLoadU32_" + binding + "(uint o) { return " + data + "[o >> 2]; }\n"
+				"uint PWLoadU16_" + binding + "(uint o) { return bitfieldExtract(" + data + "[o >> 2], int(o & 2u) * 8, 16); }\n"
+				"uint PWLoadU8_" + binding + "(uint o) { return bitfieldExtract(" + data + "[o >> 2], int(o & 3u) * 8, 8); }\n"
+				"int PWLoadI16_" + binding + "(uint o) { return bitfieldExtract(int(" + data + "[o >> 2]), int(o & 2u) * 8, 16); }\n"
+				"int PWLoadI8_" + binding + "(uint o) { return bitfieldExtract(int(" + data + "[o >> 2]), int(o & 3u) * 8, 8); }\n";
+		}
+
+		for (auto& element : layoutData.elements)
+		{
+			const HLLayoutBinding& binding = layoutData.bindings[element.binding];
+			const bool isDouble = (static_cast<uint32_t>(element.type) >> 4) == 0x9;
+			const uint32_t componentCount = (static_cast<uint32_t>(element.type) & 0x3) + 1;
+			const uint32_t componentSize = GetComponentSize(element.type);
+
+			// Instanced elements advance every instanceDivisor instances, from the baseInstance of the draw
+			const std::string vertex = (element.instanceDivisor == 0) ? "uint(gl_VertexID)" :
+				"(uint(gl_InstanceID) / " + std::to_string(element.instanceDivisor) + "u + uint(gl_BaseInstanceARB))";
+
+			std::string components;
+			for (uint32_t i = 0; i < 4; i++)
+			{
+				if (i < componentCount)
+					components += GetComponentSource(element.type, element.binding, i * componentSize);
+				else
+					components += (i == 3) ? "1.0" : "0.0";
+				if (i < 3)
+					components += ", ";
+			}
+
+			source +=
+				std::string(isDouble ? "dvec4" : "vec4") + " PWPullAttribute" + std::to_string(element.index) + "()\n"
+				"{\n"
+				"	uint o = " + vertex + " * " + std::to_string(binding.stride) + "u + " + std::to_string(binding.offset + element.offset) + "u;\n"
+				"	return " + (isDouble ? "dvec4(" : "vec4(") + components + ");\n"
+				"}\n";
+		}
+
+		return Result::Success;
+	}
+
+	Result HLVertexPuller::Destroy()
+	{
+		auto result = m_details->Destroy();
+		m_details = nullptr;
+		return result;
+	}
+
+	Result HLVertexPuller::Bind(std::span<const HLBuffer> vertexBuffers, const HLBuffer& indexBuffer, std::span<const size_t> offsets)
+	{
+		if (vertexBuffers.size() != m_details->bindingCount || (!offsets.empty() && offsets.size() != vertexBuffers.size()))
+			return Result::InvalidParameter;
+
+		for (size_t i = 0; i < vertexBuffers.size(); i++)
+		{
+			HLBuffer buffer = vertexBuffers[i];
+			if (!buffer.IsInitialized())
+				return Result::InvalidParameter;
+			if (!offsets.empty() && (offsets[i] % m_details->offsetAlignment != 0 || offsets[i] >= buffer.GetSize()))
+				return Result::InvalidParameter;
+		}
+
+		// The empty binding is shared, only its index buffer changes (and only when it's another one)
+		Result result = m_details->vertexBinding.SetBuffers({}, indexBuffer);
+		if (!IsError(result))
+			result = m_details->renderInterface.BindVertexBinding(m_details->vertexBinding);
+		if (IsError(result))
+			return result;
+
+		for (uint32_t i = 0; i < vertexBuffers.size(); i++)
+		{
+			// A size of 0 binds the rest of the buffer after the offset
+			const size_t offset = offsets.empty() ? 0 : offsets[i];
+			result = m_details->renderInterface.SetStorageBuffer(m_details->firstBufferIndex + i, vertexBuffers[i], offset, 0);
+			if (IsError(result))
+				return result;
+		}
+
+		return Result::Success;
+	}
+
+	const std::string& HLVertexPuller::GetShaderSource()
+	{
+		return m_details->shaderSource;
+	}
+
+	bool HLVertexPuller::IsInitialized()
+	{
+		return m_details && m_details->gl;
+	}
+}
@@ -1,6 +1,9 @@
 #pragma once
 #include "pch.h"
 #include <Pinewood/Renderer/HL/HLContext.h>
+#include "../GL4/GL4DebugOutput.h"
+#include "../GL4/GL4FrameQueue.h"
+#include "../GL4/GL4Extensions.h"
 
 // Used for creating a dummy context
 #include <Pinewood/Window.h>
@@ -14,6 +17,16 @@ namespace Pinewood
 
 	thread_local static HLContext* g_currentContext;
 
+	static constexpr int g_contextAttribs[]{
+		WGL_CONTEXT_MAJOR_VERSION_ARB, 4,
+		WGL_CONTEXT_MINOR_VERSION_ARB, 5,
+		WGL_CONTEXT_PROFILE_MASK_ARB, WGL_CONTEXT_CORE_PROFILE_BIT_ARB,
+#if PW_DEBUG
+		WGL_CONTEXT_FLAGS_ARB, WGL_CONTEXT_DEBUG_BIT_ARB,
+#endif // ^^^ PW_DEBUG
+		0, // End
+	};
+
 	class HLContext::Details
 		:std::enable_shared_from_this<HLContext::Details>
 	{
@@ -21,11 +34,12 @@ namespace Pinewood
 		HDC deviceContext;
 		HGLRC renderContext;
 		GladGLContext gl;
+		GL4Extensions extensions;
+		GL4FrameQueue frames;
 
 		~Details();
 
 		static Result InitializeWGL();
-		static void __stdcall DebugMessageCallback(uint32_t source, uint32_t type, uint32_t id, uint32_t severity, int32_t length, const char* message, const void* userParam);
 		Result MakeObsolete();
 		Result Destroy();
 	};
@@ -52,6 +66,11 @@ namespace Pinewood
 		return reinterpret_cast<GLADapiproc>(GetProcAddress(glInstance, name));
 	}
 
+	GLADapiproc Impl::GL4GetProcAddress(const char* name)
+	{
+		return glLoadFunc(name);
+	}
+
 	Result HLContext::Details::InitializeWGL()
 	{
 		Result result;
@@ -123,93 +142,6 @@ namespace Pinewood
 		return Result::Success;
 	}
 
-	void __stdcall HLContext::Details::DebugMessageCallback(uint32_t source, uint32_t type, uint32_t id, uint32_t severity, int32_t length, const char* message, const void* userParam)
-	{
-		const char* messageSource;
-		const char* messageType;
-		const char* messageSeverity;
-		bool isSevere = false;
-
-		switch (source)
-		{
-		case GL_DEBUG_SOURCE_API:
-			messageSource = "OpenGL";
-			break;
-		case GL_DEBUG_SOURCE_WINDOW_SYSTEM:
-			messageSource = "Window System";
-			break;
-		case GL_DEBUG_SOURCE_SHADER_COMPILER:
-			messageSource = "Shader Compiler";
-			break;
-		case GL_DEBUG_SOURCE_THIRD_PARTY:
-			messageSource = "Third Party";
-			break;
-		case GL_DEBUG_SOURCE_APPLICATION:
-			messageSource = "Application";
-			break;
-		case GL_DEBUG_SOURCE_OTHER:
-			messageSource = "Other";
-			break;
-		default:
-			messageSource = "Unknown";
-		}
-
-		switch (type)
-		{
-		case GL_DEBUG_TYPE_ERROR:
-			messageType = "Error";
-			break;
-		case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR:
-			messageType = "Deprecated Behavior";
-			break;
-		case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR:
-			messageType = "Undefined Behavior";
-			break;
-		case GL_DEBUG_TYPE_PORTABILITY:
-			messageType = "Portability";
-			break;
-		case GL_DEBUG_TYPE_PERFORMANCE:
-			messageType = "Performance";
-			break;
-		case GL_DEBUG_TYPE_MARKER:
-			messageType = "Marker";
-			break;
-		case GL_DEBUG_TYPE_PUSH_GROUP:
-			messageType = "Push Group";
-			break;
-		case GL_DEBUG_TYPE_POP_GROUP:
-			messageType = "Pop Group";
-			break;
-		case GL_DEBUG_TYPE_OTHER:
-			messageType = "Other";
-			break;
-		default:
-			messageType = "Unknown";
-		}
-
-		switch (severity)
-		{
-		case GL_DEBUG_SEVERITY_HIGH:
-			messageSeverity = "High";
-			isSevere = true;
-			break;
-		case GL_DEBUG_SEVERITY_MEDIUM:
-			messageSeverity = "Medium";
-			isSevere = true;
-			break;
-		case GL_DEBUG_SEVERITY_LOW:
-			messageSeverity = "Low";
-			break;
-		case GL_DEBUG_SEVERITY_NOTIFICATION:
-			messageSeverity = "Notification";
-			break;
-		default:
-			messageSeverity = "Unknown";
-		}
-
-		std::printf("OpenGL Error (source = %s, type = %s, id = %u, severity = %s):\n%s\n\n", messageSource, messageType, id, messageSeverity, message);
-	}
-
 	Result HLContext::Details::MakeObsolete()
 	{
 		// The context is already current, don't need to do anything
@@ -256,6 +188,7 @@ namespace Pinewood
 			return Result::NotInitialized;
 
 		MakeObsolete();
+		frames.Reset();
 		wglDeleteContext(renderContext);
 
 		// Prevent double free
@@ -310,17 +243,7 @@ namespace Pinewood
 		if (!SetPixelFormat(deviceContext, pixelFormat, &pixelFormatDesc))
 			return Result::SystemError;
 
-		constexpr int contextAttribs[]{
-			WGL_CONTEXT_MAJOR_VERSION_ARB, 4,
-			WGL_CONTEXT_MINOR_VERSION_ARB, 5,
-			WGL_CONTEXT_PROFILE_MASK_ARB, WGL_CONTEXT_CORE_PROFILE_BIT_ARB,
-#if PW_DEBUG
-			WGL_CONTEXT_FLAGS_ARB, WGL_CONTEXT_DEBUG_BIT_ARB,
-#endif // ^^^ PW_DEBUG
-			0, // End
-		};
-
-		HGLRC renderContext = wglCreateContextAttribsARB(deviceContext, nullptr, contextAttribs);
+		HGLRC renderContext = wglCreateContextAttribsARB(deviceContext, nullptr, g_contextAttribs);
 		if (!renderContext)
 			return Result::SystemError;
 
@@ -344,12 +267,10 @@ namespace Pinewood
 			return Result::UnknownError;
 		}
 
-		m_details->gl.Enable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-		m_details->gl.DebugMessageCallback(Details::DebugMessageCallback, this);
-#if !PW_DEBUG
-		m_details->gl.DebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_LOW, 0, nullptr, GL_FALSE);
-		m_details->gl.DebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, nullptr, GL_FALSE);
-#endif // ^^^ !PW_DEBUG
+		GL4EnableDebugOutput(m_details->gl);
+		m_details->extensions = GL4LoadExtensions(m_details->gl);
+
+		m_details->frames.Create(createInfo.framesInFlight, createInfo.targetFrameTime);
 
 		result = SetSwapInterval(createInfo.swapInterval);
 		if (IsError(result))
@@ -358,6 +279,28 @@ namespace Pinewood
 		return Result::Success;
 	}
 	
+	Result HLContext::CreateShared(const HLContext& shareContext)
+	{
+		if (!shareContext.m_details || !shareContext.m_details->renderContext)
+			return Result::InvalidParameter;
+
+		// The device context of the window has the right pixel format, the shared context is made current with it as well
+		HDC deviceContext = shareContext.m_details->deviceContext;
+		HGLRC renderContext = wglCreateContextAttribsARB(deviceContext, shareContext.m_details->renderContext, g_contextAttribs);
+		if (!renderContext)
+			return Result::SystemError;
+
+		m_details = std::make_shared<Details>();
+		m_details->renderContext = renderContext;
+		m_details->deviceContext = deviceContext;
+
+		// Contexts with the same pixel format use the same functions and extensions, and loading them needs the context to be current
+		m_details->gl = shareContext.m_details->gl;
+		m_details->extensions = shareContext.m_details->extensions;
+
+		return Result::Success;
+	}
+
 	Result HLContext::SwapBuffers()
 	{
 		if (!::SwapBuffers(m_details->deviceContext))
@@ -386,7 +329,7 @@ namespace Pinewood
 
 	HLContext::NativeHandle HLContext::GetNativeHandle()
 	{
-		return NativeHandle{ m_details->renderContext, &m_details->gl };
+		return NativeHandle{ m_details->renderContext, &m_details->gl, &m_details->extensions };
 	}
 	
 	bool HLContext::IsInitialized()
@@ -1,7 +1,9 @@
 #pragma once
 #include <Pinewood/Window.h>
+#include "../../Window/WindowEvents.h"
 #include <thread>
 #include <mutex>
+#include <condition_variable>
 #include <cwchar>
 
 #include <windowsx.h>
@@ -13,41 +15,32 @@ namespace Pinewood
 	static ATOM g_wndClassAtom;
 	static HINSTANCE g_win32Instance;
 
-	// Used for creating windows in the async window thread
-	static std::mutex g_windowCreateMutex;
-	static const WindowCreateInfo* volatile g_windowCreateInfo;
-	static Window* volatile g_windowCreatePtr; // I would've used Window::Detail, but it's private
-	static volatile Result g_windowCreateResult;
-	static std::atomic_bool g_windowCreateFinished;
-
-	static std::atomic_bool g_windowThreadInitialized;
-	static std::thread g_windowThread;
+	// Tasks for the async window thread (guarded by g_windowTaskMutex)
+	static std::mutex g_windowTaskMutex;
+	static std::condition_variable g_windowTaskFinished;
+	static std::vector<std::function<void()>> g_windowTasks;
+	static uint64_t g_windowTasksQueued, g_windowTasksFinished;
+	static bool g_windowThreadRunning;
+	static std::thread::id g_windowThreadID;
+	static HANDLE g_windowTaskEvent; // Auto-reset, wakes up the window thread when tasks are queued
 
 	static std::atomic_uint64_t g_numWindows;
 
-	// Without the event code
-	struct WindowEventHandler2
-	{
-		WindowEventHandler::Function function;
-		void* userPointer;
-
-		bool operator==(const WindowEventHandler2& rhs)
-		{
-			return (function == rhs.function) && (userPointer == rhs.userPointer);
-		}
-	};
-
 	class Window::Details
 		:public std::enable_shared_from_this<Window::Details>
 	{
 	public:
 		HWND window;
-		bool isRunning;
+		std::atomic_bool isRunning;
+		bool headless;				// WindowCreateFlags::Headless, there is no HWND
+		uint16_t width, height;		// Only for headless windows
+
+		Impl::WindowEvents events;
 
-		std::array<std::vector<WindowEventHandler2>, 12> eventHandlers;
+		void SendEvent(const WindowEventData& event);
 
 		Result CreateWindowImpl(const WindowCreateInfo& createInfo);
-		Result CreateWindowAsync(const WindowCreateInfo& createInfo, Window* ptr);
+		Result CreateWindowAsync(const WindowCreateInfo& createInfo);
 		static void AsyncWindowThread();
 		static intptr_t CALLBACK WindowProc(HWND window, UINT message, WPARAM wparam, LPARAM lparam);
 	};
@@ -362,6 +355,12 @@ namespace Pinewood
 		return (translationTable[keyCode] != KeyCode::Null) ? translationTable[keyCode] : static_cast<KeyCode>(keyCode | 0x100);
 	}
 
+	void Window::Details::SendEvent(const WindowEventData& event)
+	{
+		if (!events.Queue(event) && events.HasHandlers(event.code))
+			events.Dispatch(Window{ shared_from_this() }, event);
+	}
+
 	Result Window::Details::CreateWindowImpl(const WindowCreateInfo& createInfo)
 	{
 		// Could've use std::codecvt, but that's deprecated
@@ -410,34 +409,47 @@ namespace Pinewood
 		return Result::Success;
 	}
 
-	Result Window::Details::CreateWindowAsync(const WindowCreateInfo& createInfo, Window* ptr)
+	Result Window::Details::CreateWindowAsync(const WindowCreateInfo& createInfo)
 	{
-		std::lock_guard lock{ g_windowCreateMutex };
+		Result result = Result::UnknownError;
+		const std::function<void()> task = [&]() { result = CreateWindowImpl(createInfo); };
 
-		// Setup parameters
-		g_windowCreateInfo = &createInfo;
-		g_windowCreatePtr = ptr;
-		g_windowCreateFinished = false;
-
-		// Create the thread if it wasn't already created
-		if (!g_windowThreadInitialized)
+		Result taskResult = Window::RunOnWindowThread({ &task, 1 }, true);
+		if (IsError(taskResult))
 		{
-			g_windowThread = std::move(std::thread{ AsyncWindowThread });
-			g_windowThread.detach();
-			g_windowThreadInitialized = true;
+			g_numWindows--;
+			return taskResult;
 		}
 
-		// Wait until the window creation was finished
-		while (!g_windowCreateFinished)	Sleep(0);
-
-		return g_windowCreateResult;
+		return result;
 	}
 
 	void Window::Details::AsyncWindowThread()
 	{
+		std::vector<std::function<void()>> tasks;
 		MSG msg;
-		while (g_numWindows > 0)
+
+		while (true)
 		{
+			// Run the tasks in a batch, outside of the lock so they can queue more tasks
+			{
+				std::lock_guard lock{ g_windowTaskMutex };
+				tasks.swap(g_windowTasks);
+			}
+
+			for (auto& task : tasks)
+				task();
+
+			if (!tasks.empty())
+			{
+				{
+					std::lock_guard lock{ g_windowTaskMutex };
+					g_windowTasksFinished += tasks.size();
+				}
+				g_windowTaskFinished.notify_all();
+				tasks.clear();
+			}
+
 			while (PeekMessageW(&msg, nullptr, 0, 0, PM_REMOVE))
 			{
 				// Handle the messages
@@ -445,16 +457,20 @@ namespace Pinewood
 				DispatchMessageW(&msg);
 			}
 
-			if (g_windowCreateFinished == false) // Create a new window if needed
 			{
-				g_windowCreateResult = g_windowCreatePtr->m_details->CreateWindowImpl(*g_windowCreateInfo);
-				g_windowCreateFinished = true;
+				// Checked under the lock, so a task can't get queued while the thread exits
+				std::lock_guard lock{ g_windowTaskMutex };
+				if (g_numWindows == 0 && g_windowTasks.empty())
+				{
+					g_windowThreadRunning = false;
+					g_windowThreadID = {};
+					return;
+				}
 			}
 
-			WaitMessage();
+			// Sleep until there is a message or a task
+			MsgWaitForMultipleObjectsEx(1, &g_windowTaskEvent, INFINITE, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
 		}
-
-		g_windowThreadInitialized = false;
 	}
 
 	intptr_t CALLBACK Window::Details::WindowProc(HWND window, UINT message, WPARAM wparam, LPARAM lparam)
@@ -483,38 +499,35 @@ namespace Pinewood
 			case WM_KEYDOWN:
 			case WM_SYSKEYDOWN:
 			{
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowKeyEvent event{
-					.key = TranslateKey(static_cast<uint32_t>(wparam), static_cast<uint32_t>(lparam))
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::KeyDown) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::KeyDown,
+					.key = {
+						.key = TranslateKey(static_cast<uint32_t>(wparam), static_cast<uint32_t>(lparam))
+					}
+				});
 
 				break;
 			}
 			case WM_KEYUP:
 			case WM_SYSKEYUP:
 			{
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowKeyEvent event{
-					.key = TranslateKey(static_cast<uint32_t>(wparam), static_cast<uint32_t>(lparam))
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::KeyUp) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::KeyUp,
+					.key = {
+						.key = TranslateKey(static_cast<uint32_t>(wparam), static_cast<uint32_t>(lparam))
+					}
+				});
 
 				break;
 			}
 			case WM_CHAR:
 			{
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowKeyCharEvent event{
-					.character = static_cast<char>(wparam)
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::KeyChar) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::KeyChar,
+					.keyChar = {
+						.character = static_cast<char>(wparam)
+					}
+				});
 
 				break;
 			}
@@ -533,15 +546,14 @@ namespace Pinewood
 				case WM_XBUTTONDOWN: button = (HIWORD(wparam) == XBUTTON1) ? MouseButton::XButton1 : MouseButton::XButton2; break;
 				}
 
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowMouseEvent event{
-					.x = static_cast<uint16_t>(GET_X_LPARAM(lparam)),
-					.y = static_cast<uint16_t>(GET_Y_LPARAM(lparam)),
-					.buttons = Win32MouseToMouseButtons(LOWORD(wparam), button)
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::MouseButtonDown) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::MouseButtonDown,
+					.mouse = {
+						.x = static_cast<uint16_t>(GET_X_LPARAM(lparam)),
+						.y = static_cast<uint16_t>(GET_Y_LPARAM(lparam)),
+						.buttons = Win32MouseToMouseButtons(LOWORD(wparam), button)
+					}
+				});
 
 				break;
 			}
@@ -560,106 +572,97 @@ namespace Pinewood
 				case WM_XBUTTONUP: button = (HIWORD(wparam) == XBUTTON1) ? MouseButton::XButton1 : MouseButton::XButton2; break;
 				}
 
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowMouseEvent event{
-					.x = static_cast<uint32_t>(GET_X_LPARAM(lparam)),
-					.y = static_cast<uint32_t>(GET_Y_LPARAM(lparam)),
-					.buttons = Win32MouseToMouseButtons(LOWORD(wparam), button)
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::MouseButtonUp) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::MouseButtonUp,
+					.mouse = {
+						.x = static_cast<uint16_t>(GET_X_LPARAM(lparam)),
+						.y = static_cast<uint16_t>(GET_Y_LPARAM(lparam)),
+						.buttons = Win32MouseToMouseButtons(LOWORD(wparam), button)
+					}
+				});
 
 				break;
 			}
 			case WM_MOUSEWHEEL:
 			{
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowMouseScrollEvent event{
-					.x = static_cast<uint32_t>(GET_X_LPARAM(lparam)),
-					.y = static_cast<uint32_t>(GET_Y_LPARAM(lparam)),
-					.buttons = Win32MouseToMouseButtons(GET_KEYSTATE_WPARAM(wparam), MouseButton::Null),
-					.scroll = static_cast<float>(GET_WHEEL_DELTA_WPARAM(wparam)) / 120.0f
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::MouseScroll) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::MouseScroll,
+					.mouseScroll = {
+						.x = static_cast<uint16_t>(GET_X_LPARAM(lparam)),
+						.y = static_cast<uint16_t>(GET_Y_LPARAM(lparam)),
+						.buttons = Win32MouseToMouseButtons(GET_KEYSTATE_WPARAM(wparam), MouseButton::Null),
+						.scroll = static_cast<float>(GET_WHEEL_DELTA_WPARAM(wparam)) / 120.0f
+					}
+				});
 
 				break;
 			}
 			case WM_MOUSEMOVE:
 			{
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowMouseEvent event{
-					.x = static_cast<uint32_t>(GET_X_LPARAM(lparam)),
-					.y = static_cast<uint32_t>(GET_Y_LPARAM(lparam)),
-					.buttons = Win32MouseToMouseButtons(static_cast<uint32_t>(wparam), MouseButton::Null)
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::MouseMove) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::MouseMove,
+					.mouse = {
+						.x = static_cast<uint16_t>(GET_X_LPARAM(lparam)),
+						.y = static_cast<uint16_t>(GET_Y_LPARAM(lparam)),
+						.buttons = Win32MouseToMouseButtons(static_cast<uint32_t>(wparam), MouseButton::Null)
+					}
+				});
 
 				break;
 			}
 			case WM_SIZE:
 			{
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowResizeEvent event{
-					.width = LOWORD(lparam),
-					.height = HIWORD(lparam),
-					.showMode = SizingTypeToShowMode(static_cast<uint32_t>(wparam)),
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::WindowResize) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::WindowResize,
+					.resize = {
+						.width = LOWORD(lparam),
+						.height = HIWORD(lparam),
+						.showMode = SizingTypeToShowMode(static_cast<uint32_t>(wparam)),
+					}
+				});
 
 				break;
 			}
 			case WM_SIZING:
 			{
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowResizeEvent event{
-					.width = LOWORD(lparam),
-					.height = HIWORD(lparam),
-					.showMode = SizingTypeToShowMode(static_cast<uint32_t>(wparam)),
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::WindowResizing) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::WindowResizing,
+					.resize = {
+						.width = LOWORD(lparam),
+						.height = HIWORD(lparam),
+						.showMode = SizingTypeToShowMode(static_cast<uint32_t>(wparam)),
+					}
+				});
 
 				break;
 			}
 			case WM_MOVE:
 			{
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowMoveEvent event{
-					.x = GET_X_LPARAM(lparam),
-					.y = GET_Y_LPARAM(lparam),
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::WindowMove) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::WindowMove,
+					.move = {
+						.x = static_cast<int16_t>(GET_X_LPARAM(lparam)),
+						.y = static_cast<int16_t>(GET_Y_LPARAM(lparam)),
+					}
+				});
 
 				break;
 			}
 			case WM_MOVING:
 			{
-				Window windowObj{ windowDetails->shared_from_this() };
-				WindowMoveEvent event{
-					.x = GET_X_LPARAM(lparam),
-					.y = GET_Y_LPARAM(lparam),
-				};
-
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::WindowMoving) - 1])
-					eventHandler.function(windowObj, event, eventHandler.userPointer);
+				windowDetails->SendEvent({
+					.code = WindowEventCode::WindowMoving,
+					.move = {
+						.x = static_cast<int16_t>(GET_X_LPARAM(lparam)),
+						.y = static_cast<int16_t>(GET_Y_LPARAM(lparam)),
+					}
+				});
 
 				break;
 			}
 			case WM_DESTROY:
 			{
-				Window windowObj{ windowDetails->shared_from_this() };
-				for (auto& eventHandler : windowDetails->eventHandlers[static_cast<uint32_t>(WindowEventCode::WindowDestroy) - 1])
-					eventHandler.function(windowObj, WindowEvent{}, eventHandler.userPointer);
+				windowDetails->SendEvent({ .code = WindowEventCode::WindowDestroy });
 
 				PostQuitMessage(0);
 				windowDetails->isRunning = false;
@@ -675,6 +678,17 @@ namespace Pinewood
 
 	Result Window::Create(const WindowCreateInfo& createInfo)
 	{
+		if (static_cast<uint32_t>(createInfo.flags & WindowCreateFlags::Headless))
+		{
+			m_details = std::make_shared<Details>();
+			m_details->events.Create(createInfo);
+			m_details->headless = true;
+			m_details->width = createInfo.width;
+			m_details->height = createInfo.height;
+			m_details->isRunning = true;
+			return Result::Success;
+		}
+
 		// Register a window class if one wasn't already
 		{
 			std::lock_guard<std::mutex> lock{ g_win32InfoMutex };
@@ -703,16 +717,26 @@ namespace Pinewood
 		}
 
 		m_details = std::make_shared<Details>();
+		m_details->events.Create(createInfo);
+
 		g_numWindows++;
-		// Create the thread only if WindowCreateFlags::Async was specified and we are not the window thread (if we were then a dead lock would occur)
-		if (static_cast<uint32_t>(createInfo.flags & WindowCreateFlags::Async) && (g_windowThread.get_id() != std::this_thread::get_id()))
-			return m_details->CreateWindowAsync(createInfo, this);
+		// Create the window on the window thread only if WindowCreateFlags::Async was specified and we are not already on it
+		if (static_cast<uint32_t>(createInfo.flags & WindowCreateFlags::Async) && !IsWindowThread())
+			return m_details->CreateWindowAsync(createInfo);
 		else
 			return m_details->CreateWindowImpl(createInfo);
 	}
 
 	Result Window::Destroy()
 	{
+		if (m_details->headless)
+		{
+			m_details->headless = false;
+			m_details->isRunning = false;
+			m_details->SendEvent({ .code = WindowEventCode::WindowDestroy });
+			return Result::Success;
+		}
+
 		if (!DestroyWindow(m_details->window))
 			return Result::SystemError;
 
@@ -721,8 +745,58 @@ namespace Pinewood
 		return Result::Success;
 	}
 
+	Result Window::RunOnWindowThread(std::span<const std::function<void()>> tasks, bool wait)
+	{
+		if (tasks.empty())
+			return Result::Success;
+
+		// Waiting on ourselves would never finish
+		if (IsWindowThread())
+		{
+			for (auto& task : tasks)
+				task();
+
+			return Result::Success;
+		}
+
+		std::unique_lock lock{ g_windowTaskMutex };
+
+		if (!g_windowTaskEvent && !(g_windowTaskEvent = CreateEventW(nullptr, false, false, nullptr)))
+			return Result::SystemError;
+
+		g_windowTasks.insert(g_windowTasks.end(), tasks.begin(), tasks.end());
+		g_windowTasksQueued += tasks.size();
+		const uint64_t ticket = g_windowTasksQueued;
+
+		// Start the thread if it isn't running (it exits once there are no windows left)
+		if (!g_windowThreadRunning)
+		{
+			std::thread thread{ Details::AsyncWindowThread };
+			g_windowThreadID = thread.get_id();
+			thread.detach();
+			g_windowThreadRunning = true;
+		}
+
+		SetEvent(g_windowTaskEvent);
+
+		// Tasks finish in order, so every task up to the ticket is done
+		if (wait)
+			g_windowTaskFinished.wait(lock, [ticket]() { return g_windowTasksFinished >= ticket; });
+
+		return Result::Success;
+	}
+
+	bool Window::IsWindowThread()
+	{
+		std::lock_guard lock{ g_windowTaskMutex };
+		return g_windowThreadRunning && g_windowThreadID == std::this_thread::get_id();
+	}
+
 	Result Window::Update()
 	{
+		if (m_details->headless)
+			return Result::Success;
+
 		MSG msg;
 		while (PeekMessageW(&msg, m_details->window, 0, 0, PM_REMOVE))
 		{
@@ -740,6 +814,9 @@ namespace Pinewood
 
 	Result Window::SetShowMode(WindowShowMode showMode)
 	{
+		if (m_details->headless)
+			return Result::Success;
+
 		ShowWindow(m_details->window,
 			(showMode == WindowShowMode::Hide) ? SW_HIDE :
 			((showMode == WindowShowMode::Show) ? SW_SHOW :
@@ -753,42 +830,31 @@ namespace Pinewood
 		return m_details->window;
 	}
 
-	bool Window::IsInitialized()
+	Window::NativeHandle Window::GetNativeDisplay()
 	{
-		return m_details && m_details->window;
+		return nullptr;
 	}
 
-	Result Window::AddEventHandler(const WindowEventHandler& eventHandler)
+	Result Window::GetSize(uint16_t& widthOut, uint16_t& heightOut)
 	{
-		// We search with the smaller structure
-		WindowEventHandler2 smallHandler{
-			.function = eventHandler.function,
-			.userPointer = eventHandler.userPointer
-		};
+		if (m_details->headless)
+		{
+			widthOut = m_details->width;
+			heightOut = m_details->height;
+			return Result::Success;
+		}
 
-		// Make sure the event handler isn't already present
-		auto& eventHandlers = m_details->eventHandlers[static_cast<uint32_t>(eventHandler.event) - 1];
-		if (std::find(eventHandlers.begin(), eventHandlers.end(), smallHandler) != eventHandlers.end())
-			return Result::InvalidParameter;
+		RECT rect;
+		if (!GetClientRect(m_details->window, &rect))
+			return Result::SystemError;
 
-		eventHandlers.push_back(smallHandler);
+		widthOut = static_cast<uint16_t>(rect.right - rect.left);
+		heightOut = static_cast<uint16_t>(rect.bottom - rect.top);
 		return Result::Success;
-
 	}
 
-	Result Window::RemoveEventHandler(const WindowEventHandler& eventHandler)
+	bool Window::IsInitialized()
 	{
-		// We search with the smaller structure
-		WindowEventHandler2 smallHandler{
-			.function = eventHandler.function,
-			.userPointer = eventHandler.userPointer
-		};
-
-		// Make sure the event handler isn't already present
-		auto& eventHandlers = m_details->eventHandlers[static_cast<uint32_t>(eventHandler.event) - 1];
-		if (std::erase(eventHandlers, smallHandler) == 0)
-			return Result::InvalidParameter;
-		
-		return Result::Success;
+		return m_details && (m_details->window || m_details->headless);
 	}
 }
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/XKBlib.h>
+#include <X11/keysym.h>
+#include <X11/XF86keysym.h>
+
+// Xlib defines these as macros, they clash with Pinewood names (ex: Result::Success)
+#undef Success
+#undef None
+#undef Bool
+#undef Status
+#undef Always
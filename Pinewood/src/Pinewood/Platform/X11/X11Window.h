@@ -0,0 +1,660 @@
+#pragma once
+#include <Pinewood/Window.h>
+#include "../../Window/WindowEvents.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "X11Include.h"
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace Pinewood
+{
+	// Tasks for the async window thread (guarded by g_windowTaskMutex)
+	static std::mutex g_windowTaskMutex;
+	static std::condition_variable g_windowTaskFinished;
+	static std::vector<std::function<void()>> g_windowTasks;
+	static uint64_t g_windowTasksQueued, g_windowTasksFinished;
+	static bool g_windowThreadRunning;
+	static std::thread::id g_windowThreadID;
+	static int g_windowTaskEvent = -1; // eventfd, wakes up the window thread when tasks are queued
+
+	static std::atomic_uint64_t g_numWindows;
+	static std::once_flag g_xlibInitialized;
+
+	class Window::Details
+		:public std::enable_shared_from_this<Window::Details>
+	{
+	public:
+		::Display* display;			// Every window has its own connection, so windows never see each other's events
+		::Window window;
+		Atom deleteWindowAtom;
+		std::atomic_bool isRunning;
+		bool headless;				// WindowCreateFlags::Headless, there is no display or window
+		bool async;					// Created on the window thread, which processes its events
+		std::atomic_uint16_t width, height;	// Written by the thread that processes the events, read by GetSize
+		int16_t x, y;
+
+		Impl::WindowEvents events;
+
+		// Windows updated by the window thread (guarded by g_windowTaskMutex)
+		static inline std::vector<std::weak_ptr<Details>> asyncWindows;
+
+		~Details();
+
+		void SendEvent(const WindowEventData& event);
+		void HandleEvent(XEvent& event);
+		void ProcessEvents();
+		Result SetShowMode(WindowShowMode showMode);
+
+		Result CreateWindowImpl(const WindowCreateInfo& createInfo, bool async);
+		Result CreateWindowAsync(const WindowCreateInfo& createInfo);
+		static void AsyncWindowThread();
+	};
+
+	static MouseButton X11StateToMouseButtons(uint32_t state, MouseButton overrideButton /* Used to give mouse buttons presidence (ex: ButtonPress) */)
+	{
+		MouseButton out = MouseButton::Null;
+		if (state & ControlMask) out |= MouseButton::Control;
+		if (state & ShiftMask) out |= MouseButton::Shift;
+
+		// If there is a presidence, return it with that
+		if (overrideButton != MouseButton::Null)
+			return out | overrideButton;
+
+		if (state & Button1Mask) out |= MouseButton::LeftButton;
+		if (state & Button2Mask) out |= MouseButton::MiddleButton;
+		if (state & Button3Mask) out |= MouseButton::RightButton;
+
+		return out;
+	}
+
+	static MouseButton X11ButtonToMouseButton(uint32_t button)
+	{
+		switch (button)
+		{
+		case Button1: return MouseButton::LeftButton;
+		case Button2: return MouseButton::MiddleButton;
+		case Button3: return MouseButton::RightButton;
+		case 8: return MouseButton::XButton1;
+		case 9: return MouseButton::XButton2;
+		default: return MouseButton::Null;
+		}
+	}
+
+	static KeyCode TranslateKey(KeySym keySym)
+	{
+		// Letters and numbers line up with ASCII
+		if (keySym >= XK_a && keySym <= XK_z)
+			return static_cast<KeyCode>(keySym - XK_a + 'A');
+		if (keySym >= XK_A && keySym <= XK_Z)
+			return static_cast<KeyCode>(keySym);
+		if (keySym >= XK_0 && keySym <= XK_9)
+			return static_cast<KeyCode>(keySym);
+		if (keySym >= XK_F1 && keySym <= XK_F24)
+			return static_cast<KeyCode>(static_cast<uint32_t>(KeyCode::F1) + (keySym - XK_F1));
+		if (keySym >= XK_KP_0 && keySym <= XK_KP_9)
+			return static_cast<KeyCode>(static_cast<uint32_t>(KeyCode::Numpad0) + (keySym - XK_KP_0));
+
+		switch (keySym)
+		{
+		case XK_Escape: return KeyCode::Escape;
+		case XK_Shift_L: return KeyCode::LeftShift;
+		case XK_Shift_R: return KeyCode::RightShift;
+		case XK_Alt_L: return KeyCode::LeftAlt;
+		case XK_Alt_R: return KeyCode::RightAlt;
+		case XK_Control_L: return KeyCode::LeftControl;
+		case XK_Control_R: return KeyCode::RightControl;
+		case XK_Super_L: return KeyCode::LeftOS;
+		case XK_Super_R: return KeyCode::RightOS;
+		case XK_Insert: return KeyCode::Insert;
+		case XK_Num_Lock: return KeyCode::NumLock;
+		case XK_Scroll_Lock: return KeyCode::ScrollLock;
+		case XK_Menu: return KeyCode::AppsKey;
+		case XK_Delete: return KeyCode::Delete;
+		case XK_Clear: return KeyCode::Clear;
+		case XK_KP_Add: return KeyCode::Add;
+		case XK_KP_Subtract: return KeyCode::Substract;
+		case XK_KP_Multiply: return KeyCode::Multiply;
+		case XK_KP_Divide: return KeyCode::Divide;
+		case XK_KP_Decimal: return KeyCode::Decimal;
+		case XK_KP_Separator: return KeyCode::Separator;
+		case XK_KP_Enter: return KeyCode::Enter;
+		case XK_space: return KeyCode::Space;
+		case XK_bracketleft: return KeyCode::OpenBracket;
+		case XK_bracketright: return KeyCode::CloseBracket;
+		case XK_backslash: return KeyCode::Backslash;
+		case XK_semicolon: return KeyCode::Semicolon;
+		case XK_apostrophe: return KeyCode::SingleQuote;
+		case XK_comma: return KeyCode::Comma;
+		case XK_period: return KeyCode::Period;
+		case XK_slash: return KeyCode::ForwardSlash;
+		case XK_minus: return KeyCode::Minus;
+		case XK_equal: return KeyCode::Equals;
+		case XK_grave: return KeyCode::Backtick;
+		case XK_Page_Up: return KeyCode::PageUp;
+		case XK_Page_Down: return KeyCode::PageDown;
+		case XK_Up: return KeyCode::Up;
+		case XK_Down: return KeyCode::Down;
+		case XK_Left: return KeyCode::Left;
+		case XK_Right: return KeyCode::Right;
+		case XF86XK_Back: return KeyCode::BrowserBack;
+		case XF86XK_Forward: return KeyCode::BrowserForward;
+		case XF86XK_Refresh: return KeyCode::BrowserRefresh;
+		case XF86XK_Stop: return KeyCode::BrowserStop;
+		case XF86XK_Search: return KeyCode::BrowserSearch;
+		case XF86XK_Favorites: return KeyCode::BrowserFavorites;
+		case XF86XK_HomePage: return KeyCode::BrowserHome;
+		case XF86XK_AudioRaiseVolume: return KeyCode::VolumeUp;
+		case XF86XK_AudioLowerVolume: return KeyCode::VolumeDown;
+		case XF86XK_AudioMute: return KeyCode::VolumeMute;
+		case XF86XK_AudioNext: return KeyCode::MediaNext;
+		case XF86XK_AudioPrev: return KeyCode::MediaPrevious;
+		case XF86XK_AudioStop: return KeyCode::MediaStop;
+		case XF86XK_AudioPlay: return KeyCode::MediaPlayPause;
+		case XK_BackSpace: return KeyCode::Backspace;
+		case XK_Tab: return KeyCode::Tab;
+		case XK_Caps_Lock: return KeyCode::CapsLock;
+		case XK_Home: return KeyCode::Home;
+		case XK_End: return KeyCode::End;
+		case XK_Help: return KeyCode::Help;
+		case XK_Return: return KeyCode::Enter;
+		case XK_Pause: return KeyCode::Pause;
+		default: return static_cast<KeyCode>((keySym & 0xff) | 0x100); // System specific
+		}
+	}
+
+	Window::Details::~Details()
+	{
+		if (!display)
+			return;
+
+		// Closing the display destroys a window that wasn't destroyed, there won't be a DestroyNotify to stop counting it
+		if (window)
+		{
+			g_numWindows--;
+
+			// Wake up the window thread, so it exits if this was the last window
+			std::lock_guard lock{ g_windowTaskMutex };
+			if (g_windowTaskEvent != -1)
+			{
+				const uint64_t value = 1;
+				write(g_windowTaskEvent, &value, sizeof(value));
+			}
+		}
+
+		XCloseDisplay(display);
+	}
+
+	void Window::Details::SendEvent(const WindowEventData& event)
+	{
+		if (!events.Queue(event) && events.HasHandlers(event.code))
+			events.Dispatch(Window{ shared_from_this() }, event);
+	}
+
+	void Window::Details::HandleEvent(XEvent& event)
+	{
+		switch (event.type)
+		{
+		case KeyPress:
+		case KeyRelease:
+		{
+			// Shift and caps lock are ignored, so letters always give the same key
+			const KeySym keySym = XLookupKeysym(&event.xkey, 0);
+			SendEvent({
+				.code = (event.type == KeyPress) ? WindowEventCode::KeyDown : WindowEventCode::KeyUp,
+				.key = {
+					.key = TranslateKey(keySym)
+				}
+			});
+
+			char character;
+			if (event.type == KeyPress && XLookupString(&event.xkey, &character, 1, nullptr, nullptr) == 1)
+			{
+				SendEvent({
+					.code = WindowEventCode::KeyChar,
+					.keyChar = {
+						.character = character
+					}
+				});
+			}
+			break;
+		}
+		case ButtonPress:
+		case ButtonRelease:
+		{
+			// Buttons 4 to 7 are the scroll wheels, only the vertical one is reported
+			if (event.xbutton.button == Button4 || event.xbutton.button == Button5)
+			{
+				if (event.type == ButtonPress)
+				{
+					SendEvent({
+						.code = WindowEventCode::MouseScroll,
+						.mouseScroll = {
+							.x = static_cast<uint16_t>(event.xbutton.x),
+							.y = static_cast<uint16_t>(event.xbutton.y),
+							.buttons = X11StateToMouseButtons(event.xbutton.state, MouseButton::Null),
+							.scroll = (event.xbutton.button == Button4) ? 1.0f : -1.0f
+						}
+					});
+				}
+				break;
+			}
+
+			const MouseButton button = X11ButtonToMouseButton(event.xbutton.button);
+			if (button == MouseButton::Null)
+				break;
+
+			SendEvent({
+				.code = (event.type == ButtonPress) ? WindowEventCode::MouseButtonDown : WindowEventCode::MouseButtonUp,
+				.mouse = {
+					.x = static_cast<uint16_t>(event.xbutton.x),
+					.y = static_cast<uint16_t>(event.xbutton.y),
+					.buttons = X11StateToMouseButtons(event.xbutton.state, button)
+				}
+			});
+			break;
+		}
+		case MotionNotify:
+		{
+			SendEvent({
+				.code = WindowEventCode::MouseMove,
+				.mouse = {
+					.x = static_cast<uint16_t>(event.xmotion.x),
+					.y = static_cast<uint16_t>(event.xmotion.y),
+					.buttons = X11StateToMouseButtons(event.xmotion.state, MouseButton::Null)
+				}
+			});
+			break;
+		}
+		case ConfigureNotify:
+		{
+			// X11 doesn't tell when the user stops resizing or moving, so both events are sent every time
+			if (event.xconfigure.width != width || event.xconfigure.height != height)
+			{
+				width = static_cast<uint16_t>(event.xconfigure.width);
+				height = static_cast<uint16_t>(event.xconfigure.height);
+
+				for (WindowEventCode code : { WindowEventCode::WindowResizing, WindowEventCode::WindowResize })
+				{
+					SendEvent({
+						.code = code,
+						.resize = {
+							.width = width,
+							.height = height,
+							.showMode = WindowShowMode::Show
+						}
+					});
+				}
+			}
+
+			if (event.xconfigure.x != x || event.xconfigure.y != y)
+			{
+				x = static_cast<int16_t>(event.xconfigure.x);
+				y = static_cast<int16_t>(event.xconfigure.y);
+
+				for (WindowEventCode code : { WindowEventCode::WindowMoving, WindowEventCode::WindowMove })
+				{
+					SendEvent({
+						.code = code,
+						.move = {
+							.x = x,
+							.y = y
+						}
+					});
+				}
+			}
+			break;
+		}
+		case ClientMessage:
+		{
+			// The close button
+			if (static_cast<Atom>(event.xclient.data.l[0]) == deleteWindowAtom)
+				XDestroyWindow(display, window);
+			break;
+		}
+		case DestroyNotify:
+		{
+			if (event.xdestroywindow.window != window)
+				break;
+
+			SendEvent({ .code = WindowEventCode::WindowDestroy });
+
+			window = 0;
+			isRunning = false;
+			g_numWindows--;
+			break;
+		}
+		}
+	}
+
+	void Window::Details::ProcessEvents()
+	{
+		XEvent event;
+		while (isRunning && XPending(display))
+		{
+			XNextEvent(display, &event);
+			HandleEvent(event);
+		}
+	}
+
+	Result Window::Details::SetShowMode(WindowShowMode showMode)
+	{
+		switch (showMode)
+		{
+		case WindowShowMode::Hide:
+			XUnmapWindow(display, window);
+			break;
+		case WindowShowMode::Show:
+			XMapWindow(display, window);
+			break;
+		case WindowShowMode::Minimized:
+			XMapWindow(display, window);
+			XIconifyWindow(display, window, DefaultScreen(display));
+			break;
+		case WindowShowMode::Maximized:
+		{
+			XMapWindow(display, window);
+
+			// Ask the window manager (EWMH)
+			XEvent event{};
+			event.xclient.type = ClientMessage;
+			event.xclient.window = window;
+			event.xclient.message_type = XInternAtom(display, "_NET_WM_STATE", false);
+			event.xclient.format = 32;
+			event.xclient.data.l[0] = 1; // _NET_WM_STATE_ADD
+			event.xclient.data.l[1] = static_cast<long>(XInternAtom(display, "_NET_WM_STATE_MAXIMIZED_HORZ", false));
+			event.xclient.data.l[2] = static_cast<long>(XInternAtom(display, "_NET_WM_STATE_MAXIMIZED_VERT", false));
+			XSendEvent(display, DefaultRootWindow(display), false, SubstructureRedirectMask | SubstructureNotifyMask, &event);
+			break;
+		}
+		}
+
+		XFlush(display);
+		return Result::Success;
+	}
+
+	Result Window::Details::CreateWindowImpl(const WindowCreateInfo& createInfo, bool async)
+	{
+		display = XOpenDisplay(nullptr);
+		if (!display)
+		{
+			g_numWindows--; // Nevermind, a window wasn't created
+			return Result::SystemError;
+		}
+
+		// Only send KeyPress for key repeats, instead of KeyRelease and KeyPress
+		XkbSetDetectableAutoRepeat(display, true, nullptr);
+
+		XSetWindowAttributes attributes{};
+		attributes.event_mask = KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask | PointerMotionMask | StructureNotifyMask;
+
+		window = XCreateWindow(display, DefaultRootWindow(display), createInfo.x, createInfo.y, createInfo.width, createInfo.height, 0,
+			CopyFromParent, InputOutput, CopyFromParent, CWEventMask, &attributes);
+		if (!window)
+		{
+			XCloseDisplay(display);
+			display = nullptr;
+			g_numWindows--;
+			return Result::SystemError;
+		}
+
+		width = createInfo.width;
+		height = createInfo.height;
+		x = createInfo.x;
+		y = createInfo.y;
+		isRunning = true;
+		this->async = async;
+
+		// The title is UTF-8, same as on Windows
+		const std::string title{ createInfo.title };
+		Xutf8SetWMProperties(display, window, title.c_str(), title.c_str(), nullptr, 0, nullptr, nullptr, nullptr);
+
+		// Get a ClientMessage instead of the window being destroyed by the window manager
+		deleteWindowAtom = XInternAtom(display, "WM_DELETE_WINDOW", false);
+		XSetWMProtocols(display, window, &deleteWindowAtom, 1);
+
+		// X11 has no minimize/maximize button styles, only whether the window can be resized
+		if (!static_cast<uint32_t>(createInfo.flags & WindowCreateFlags::Resizeable))
+		{
+			XSizeHints* sizeHints = XAllocSizeHints();
+			sizeHints->flags = PMinSize | PMaxSize;
+			sizeHints->min_width = sizeHints->max_width = createInfo.width;
+			sizeHints->min_height = sizeHints->max_height = createInfo.height;
+			XSetWMNormalHints(display, window, sizeHints);
+			XFree(sizeHints);
+		}
+
+		WindowCreateFlags show = (createInfo.flags & WindowCreateFlags::ShowBitMask);
+		if (static_cast<uint32_t>(show))
+			SetShowMode(
+				(show == WindowCreateFlags::Show) ? WindowShowMode::Show :
+				((show == WindowCreateFlags::Minimized) ? WindowShowMode::Minimized : WindowShowMode::Maximized));
+
+		XFlush(display);
+
+		if (async)
+		{
+			std::lock_guard lock{ g_windowTaskMutex };
+			asyncWindows.push_back(weak_from_this());
+		}
+
+		return Result::Success;
+	}
+
+	Result Window::Details::CreateWindowAsync(const WindowCreateInfo& createInfo)
+	{
+		Result result = Result::UnknownError;
+		const std::function<void()> task = [&]() { result = CreateWindowImpl(createInfo, true); };
+
+		Result taskResult = Window::RunOnWindowThread({ &task, 1 }, true);
+		if (IsError(taskResult))
+		{
+			g_numWindows--;
+			return taskResult;
+		}
+
+		return result;
+	}
+
+	void Window::Details::AsyncWindowThread()
+	{
+		std::vector<std::function<void()>> tasks;
+		std::vector<std::shared_ptr<Details>> windows;
+		std::vector<pollfd> pollFDs;
+
+		while (true)
+		{
+			// Run the tasks in a batch, outside of the lock so they can queue more tasks
+			{
+				std::lock_guard lock{ g_windowTaskMutex };
+				tasks.swap(g_windowTasks);
+			}
+
+			for (auto& task : tasks)
+				task();
+
+			if (!tasks.empty())
+			{
+				{
+					std::lock_guard lock{ g_windowTaskMutex };
+					g_windowTasksFinished += tasks.size();
+				}
+				g_windowTaskFinished.notify_all();
+				tasks.clear();
+			}
+
+			{
+				// Checked under the lock, so a task can't get queued while the thread exits
+				std::lock_guard lock{ g_windowTaskMutex };
+				if (g_numWindows == 0 && g_windowTasks.empty())
+				{
+					g_windowThreadRunning = false;
+					g_windowThreadID = {};
+					asyncWindows.clear();
+					return;
+				}
+
+				// Holding a reference keeps the display open while its events are processed
+				std::erase_if(asyncWindows, [](const std::weak_ptr<Details>& window) { auto details = window.lock(); return !details || !details->isRunning; });
+				for (auto& window : asyncWindows)
+					windows.push_back(window.lock());
+			}
+
+			pollFDs.assign(1, { .fd = g_windowTaskEvent, .events = POLLIN });
+			for (auto& window : windows)
+			{
+				window->ProcessEvents();
+				pollFDs.push_back({ .fd = ConnectionNumber(window->display), .events = POLLIN });
+			}
+			windows.clear();
+
+			// Sleep until there is an event or a task
+			poll(pollFDs.data(), pollFDs.size(), -1);
+
+			uint64_t value;
+			if (pollFDs[0].revents & POLLIN)
+				read(g_windowTaskEvent, &value, sizeof(value));
+		}
+	}
+
+	Result Window::Create(const WindowCreateInfo& createInfo)
+	{
+		m_details = std::make_shared<Details>();
+		m_details->events.Create(createInfo);
+
+		if (static_cast<uint32_t>(createInfo.flags & WindowCreateFlags::Headless))
+		{
+			m_details->headless = true;
+			m_details->width = createInfo.width;
+			m_details->height = createInfo.height;
+			m_details->isRunning = true;
+			return Result::Success;
+		}
+
+		// The display of an async window is also used by the thread that calls the window functions (and the rendering context)
+		std::call_once(g_xlibInitialized, []() { XInitThreads(); });
+
+		g_numWindows++;
+		// Create the window on the window thread only if WindowCreateFlags::Async was specified and we are not already on it
+		if (static_cast<uint32_t>(createInfo.flags & WindowCreateFlags::Async) && !IsWindowThread())
+			return m_details->CreateWindowAsync(createInfo);
+		else
+			return m_details->CreateWindowImpl(createInfo, IsWindowThread());
+	}
+
+	Result Window::Destroy()
+	{
+		if (m_details->headless)
+		{
+			m_details->headless = false;
+			m_details->isRunning = false;
+			m_details->SendEvent({ .code = WindowEventCode::WindowDestroy });
+			return Result::Success;
+		}
+
+		if (!m_details->window)
+			return Result::NotInitialized;
+
+		// The DestroyNotify event sends WindowDestroy, like on Windows
+		XDestroyWindow(m_details->display, m_details->window);
+		XFlush(m_details->display);
+
+		return Result::Success;
+	}
+
+	Result Window::RunOnWindowThread(std::span<const std::function<void()>> tasks, bool wait)
+	{
+		if (tasks.empty())
+			return Result::Success;
+
+		// Waiting on ourselves would never finish
+		if (IsWindowThread())
+		{
+			for (auto& task : tasks)
+				task();
+
+			return Result::Success;
+		}
+
+		std::unique_lock lock{ g_windowTaskMutex };
+
+		if (g_windowTaskEvent == -1 && (g_windowTaskEvent = eventfd(0, EFD_CLOEXEC)) == -1)
+			return Result::SystemError;
+
+		g_windowTasks.insert(g_windowTasks.end(), tasks.begin(), tasks.end());
+		g_windowTasksQueued += tasks.size();
+		const uint64_t ticket = g_windowTasksQueued;
+
+		// Start the thread if it isn't running (it exits once there are no windows left)
+		if (!g_windowThreadRunning)
+		{
+			std::thread thread{ Details::AsyncWindowThread };
+			g_windowThreadID = thread.get_id();
+			thread.detach();
+			g_windowThreadRunning = true;
+		}
+
+		const uint64_t value = 1;
+		write(g_windowTaskEvent, &value, sizeof(value));
+
+		// Tasks finish in order, so every task up to the ticket is done
+		if (wait)
+			g_windowTaskFinished.wait(lock, [ticket]() { return g_windowTasksFinished >= ticket; });
+
+		return Result::Success;
+	}
+
+	bool Window::IsWindowThread()
+	{
+		std::lock_guard lock{ g_windowTaskMutex };
+		return g_windowThreadRunning && g_windowThreadID == std::this_thread::get_id();
+	}
+
+	Result Window::Update()
+	{
+		// The window thread processes the events of async windows, the event queue only has one producer
+		if (m_details->headless || m_details->async || !m_details->display)
+			return Result::Success;
+
+		m_details->ProcessEvents();
+		return Result::Success;
+	}
+
+	bool Window::IsRunning()
+	{
+		return m_details->isRunning;
+	}
+
+	Result Window::SetShowMode(WindowShowMode showMode)
+	{
+		if (m_details->headless)
+			return Result::Success;
+
+		return m_details->SetShowMode(showMode);
+	}
+
+	Window::NativeHandle Window::GetNativeHandle()
+	{
+		return reinterpret_cast<NativeHandle>(m_details->window);
+	}
+
+	Window::NativeHandle Window::GetNativeDisplay()
+	{
+		return m_details->display;
+	}
+
+	Result Window::GetSize(uint16_t& widthOut, uint16_t& heightOut)
+	{
+		widthOut = m_details->width;
+		heightOut = m_details->height;
+		return Result::Success;
+	}
+
+	bool Window::IsInitialized()
+	{
+		return m_details && (m_details->window || m_details->headless);
+	}
+}
@@ -0,0 +1,362 @@
+#include "pch.h"
+#include <Pinewood/Profiler.h>
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+namespace Pinewood
+{
+	std::atomic_bool Profiler::s_enabled = true;
+	thread_local uint32_t ProfilerScope::s_depth = 0;
+
+	namespace
+	{
+		struct ZoneEvent
+		{
+			const char* name;
+			uint64_t begin, end;
+			uint32_t depth;
+			bool gpu;
+		};
+
+		// Ring buffer with a single producer (the thread that owns it) and a single consumer (EndFrame)
+		class ThreadBuffer
+		{
+		public:
+			static constexpr size_t Capacity = 8192; // Must be a power of 2
+
+			ThreadBuffer(uint32_t threadID) :threadID(threadID), m_events(Capacity) {}
+
+			bool Push(const ZoneEvent& event)
+			{
+				const size_t head = m_head.load(std::memory_order_relaxed);
+				if (head - m_tail.load(std::memory_order_acquire) >= Capacity)
+					return false;
+
+				m_events[head & (Capacity - 1)] = event;
+				m_head.store(head + 1, std::memory_order_release);
+				return true;
+			}
+
+			template<typename TFunc>
+			void Drain(TFunc&& function)
+			{
+				size_t tail = m_tail.load(std::memory_order_relaxed);
+				const size_t head = m_head.load(std::memory_order_acquire);
+				for (; tail != head; tail++)
+					function(m_events[tail & (Capacity - 1)]);
+
+				m_tail.store(tail, std::memory_order_release);
+			}
+
+			const uint32_t threadID;
+
+		private:
+			std::vector<ZoneEvent> m_events;
+
+			// Separate cache lines, so the producer and consumer don't fight over them
+			alignas(64) std::atomic_size_t m_head = 0;
+			alignas(64) std::atomic_size_t m_tail = 0;
+		};
+
+		struct ZoneHistory
+		{
+			bool gpu = false;
+			std::vector<double> totalMs;	// Ring buffer of per frame totals
+			std::vector<uint32_t> calls;
+			size_t next = 0, count = 0;
+		};
+
+		struct CapturedZone
+		{
+			uint32_t threadID;
+			ZoneEvent event;
+		};
+
+		struct ProfilerState
+		{
+			const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+			std::mutex threadsMutex;
+			std::vector<std::shared_ptr<ThreadBuffer>> threads; // A buffer only referenced here belongs to a thread that exited
+			std::map<uint32_t, std::string> threadNames;
+			uint32_t nextThreadID = 0;
+			std::atomic_uint64_t droppedZones = 0;
+
+			std::mutex statsMutex;
+			std::map<std::string, ZoneHistory, std::less<>> zones;
+			uint32_t historySize = 300;
+			uint64_t lastFrameEnd = 0;
+
+			bool capturing = false;
+			std::vector<CapturedZone> capturedZones;
+		};
+
+		ProfilerState& GetState()
+		{
+			static ProfilerState state;
+			return state;
+		}
+
+		// Keeps the thread's buffer alive for as long as the thread runs
+		struct ThreadBufferHolder
+		{
+			std::shared_ptr<ThreadBuffer> buffer;
+		};
+
+		thread_local ThreadBufferHolder threadBufferHolder;
+
+		ThreadBuffer& GetThreadBuffer()
+		{
+			if (!threadBufferHolder.buffer)
+			{
+				auto& state = GetState();
+				std::lock_guard lock{ state.threadsMutex };
+				threadBufferHolder.buffer = std::make_shared<ThreadBuffer>(state.nextThreadID++);
+				state.threads.push_back(threadBufferHolder.buffer);
+			}
+
+			return *threadBufferHolder.buffer;
+		}
+
+		void AddFrameSample(ZoneHistory& history, uint32_t historySize, bool gpu, double totalMs, uint32_t calls)
+		{
+			if (history.totalMs.size() != historySize)
+			{
+				history.totalMs.assign(historySize, 0.0);
+				history.calls.assign(historySize, 0);
+				history.next = history.count = 0;
+			}
+
+			history.gpu = gpu;
+			history.totalMs[history.next] = totalMs;
+			history.calls[history.next] = calls;
+			history.next = (history.next + 1) % historySize;
+			history.count = std::min<size_t>(history.count + 1, historySize);
+		}
+
+		ProfilerZoneStats CalculateStats(std::string_view name, const ZoneHistory& history)
+		{
+			ProfilerZoneStats stats{
+				.name = std::string{ name },
+				.gpu = history.gpu,
+				.frameCount = static_cast<uint32_t>(history.count),
+				.callsPerFrame = 0.0f,
+				.minMs = 0.0, .avgMs = 0.0, .p99Ms = 0.0, .maxMs = 0.0
+			};
+
+			if (history.count == 0)
+				return stats;
+
+			std::vector<double> samples{ history.totalMs.begin(), history.totalMs.begin() + history.count };
+			std::sort(samples.begin(), samples.end());
+
+			double sum = 0.0;
+			uint64_t calls = 0;
+			for (size_t i = 0; i < history.count; i++)
+			{
+				sum += history.totalMs[i];
+				calls += history.calls[i];
+			}
+
+			stats.callsPerFrame = static_cast<float>(calls) / history.count;
+			stats.minMs = samples.front();
+			stats.maxMs = samples.back();
+			stats.avgMs = sum / history.count;
+			stats.p99Ms = samples[static_cast<size_t>(std::ceil(0.99 * samples.size())) - 1];
+			return stats;
+		}
+
+		void WriteJSONString(std::ostream& stream, std::string_view string)
+		{
+			stream << '"';
+			for (char c : string)
+			{
+				if (c == '"' || c == '\\')
+					stream << '\\' << c;
+				else if (static_cast<unsigned char>(c) < 0x20)
+					stream << ' ';
+				else
+					stream << c;
+			}
+			stream << '"';
+		}
+	}
+
+	void Profiler::SetEnabled(bool enabled)
+	{
+		s_enabled.store(enabled, std::memory_order_relaxed);
+	}
+
+	void Profiler::SetThreadName(std::string_view name)
+	{
+		const uint32_t threadID = GetThreadBuffer().threadID;
+
+		auto& state = GetState();
+		std::lock_guard lock{ state.threadsMutex };
+		state.threadNames[threadID] = name;
+	}
+
+	void Profiler::EndFrame()
+	{
+		auto& state = GetState();
+		const uint64_t now = GetTime();
+
+		struct FrameTotal
+		{
+			uint64_t time = 0;
+			uint32_t calls = 0;
+			bool gpu = false;
+		};
+
+		// Zone names are string literals, so they can be keyed by view until they go into the history
+		std::map<std::string_view, FrameTotal> frameTotals;
+
+		{
+			std::lock_guard lock{ state.threadsMutex };
+			std::lock_guard statsLock{ state.statsMutex };
+
+			for (auto& buffer : state.threads)
+			{
+				buffer->Drain([&](const ZoneEvent& event)
+				{
+					auto& total = frameTotals[event.name];
+					total.time += event.end - event.begin;
+					total.calls++;
+					total.gpu = event.gpu;
+
+					if (state.capturing)
+						state.capturedZones.push_back({ buffer->threadID, event });
+				});
+			}
+
+			// Drop the buffers of threads that exited, they were just drained
+			std::erase_if(state.threads, [](const std::shared_ptr<ThreadBuffer>& buffer) { return buffer.use_count() == 1; });
+		}
+
+		std::lock_guard lock{ state.statsMutex };
+
+		if (state.lastFrameEnd != 0 && IsEnabled())
+			frameTotals["Frame"] = { now - state.lastFrameEnd, 1, false };
+		state.lastFrameEnd = now;
+
+		for (auto& [name, total] : frameTotals)
+		{
+			auto it = state.zones.find(name);
+			if (it == state.zones.end())
+				it = state.zones.emplace(std::string{ name }, ZoneHistory{}).first;
+
+			AddFrameSample(it->second, state.historySize, total.gpu, total.time / 1'000'000.0, total.calls);
+		}
+	}
+
+	void Profiler::SetHistorySize(uint32_t frameCount)
+	{
+		auto& state = GetState();
+		std::lock_guard lock{ state.statsMutex };
+		state.historySize = std::max(frameCount, 1u);
+		state.zones.clear();
+	}
+
+	std::vector<ProfilerZoneStats> Profiler::GetZoneStats()
+	{
+		auto& state = GetState();
+		std::lock_guard lock{ state.statsMutex };
+
+		std::vector<ProfilerZoneStats> stats;
+		stats.reserve(state.zones.size());
+		for (auto& [name, history] : state.zones)
+			stats.push_back(CalculateStats(name, history));
+
+		return stats;
+	}
+
+	Result Profiler::GetZoneStats(std::string_view name, ProfilerZoneStats& statsOut)
+	{
+		auto& state = GetState();
+		std::lock_guard lock{ state.statsMutex };
+
+		auto it = state.zones.find(name);
+		if (it == state.zones.end())
+			return Result::InvalidParameter;
+
+		statsOut = CalculateStats(name, it->second);
+		return Result::Success;
+	}
+
+	uint64_t Profiler::GetDroppedZoneCount()
+	{
+		return GetState().droppedZones.load(std::memory_order_relaxed);
+	}
+
+	void Profiler::BeginCapture()
+	{
+		auto& state = GetState();
+		std::lock_guard lock{ state.statsMutex };
+		state.capturing = true;
+		state.capturedZones.clear();
+	}
+
+	Result Profiler::EndCapture(const std::filesystem::path& path)
+	{
+		auto& state = GetState();
+
+		std::vector<CapturedZone> zones;
+		{
+			std::lock_guard lock{ state.statsMutex };
+			if (!state.capturing)
+				return Result::NotInitialized;
+
+			state.capturing = false;
+			zones = std::move(state.capturedZones);
+		}
+
+		std::map<uint32_t, std::string> threadNames;
+		{
+			std::lock_guard lock{ state.threadsMutex };
+			threadNames = state.threadNames;
+		}
+
+		std::ofstream file{ path };
+		if (!file)
+			return Result::SystemError;
+
+		// CPU zones go in process 0 (one track per thread), GPU zones in process 1
+		file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+		file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}";
+		for (auto& [threadID, name] : threadNames)
+		{
+			file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << threadID << ",\"args\":{\"name\":";
+			WriteJSONString(file, name);
+			file << "}}";
+		}
+
+		file.setf(std::ios::fixed);
+		file.precision(3);
+		for (auto& zone : zones)
+		{
+			file << ",\n{\"name\":";
+			WriteJSONString(file, zone.event.name);
+			file << ",\"ph\":\"X\",\"ts\":" << zone.event.begin / 1000.0 << ",\"dur\":" << (zone.event.end - zone.event.begin) / 1000.0
+				<< ",\"pid\":" << (zone.event.gpu ? 1 : 0) << ",\"tid\":" << zone.threadID << "}";
+		}
+		file << "\n]}\n";
+
+		return file ? Result::Success : Result::SystemError;
+	}
+
+	uint64_t Profiler::GetTime()
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - GetState().epoch).count();
+	}
+
+	void Profiler::SubmitZone(const char* name, uint64_t begin, uint64_t end, uint32_t depth, bool gpu)
+	{
+		if (!GetThreadBuffer().Push({ name, begin, std::max(begin, end), depth, gpu }))
+			GetState().droppedZones.fetch_add(1, std::memory_order_relaxed);
+	}
+}
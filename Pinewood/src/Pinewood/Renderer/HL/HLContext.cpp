@@ -1,7 +1,12 @@
 #include "pch.h"
 
 #ifdef PW_RENDERER_OPENGL4
+#if PW_PLATFORM_WINDOWS
 #include "../../Platform/WGL/WGLContext.h"
+#elif PW_PLATFORM_LINUX // ^^^ PW_PLATFORM_WINDOWS // PW_PLATFORM_LINUX vvv
+#include "../../Platform/EGL/EGLContext.h"
+#endif // ^^^ PW_PLATFORM_LINUX
+#include "../../Platform/GL4/GL4Context.h"
 #else // ^^^ PW_RENDERER_OPENGL4 // Unsupported API vvv
 #error "No valid/supported rendering API was selected"
 #endif // ^^^ Unsupported API
@@ -0,0 +1,353 @@
+#include "pch.h"
+#include "RangeAllocator.h"
+#include <Pinewood/Renderer/HL/HLGeometryHeap.h>
+
+#include <algorithm>
+#include <vector>
+
+// The heap only uses the HL objects, so it's the same for every rendering API
+
+namespace Pinewood
+{
+	class HLGeometryHeap::Details
+	{
+	public:
+		struct Mesh
+		{
+			uint32_t vertexOffset, vertexCount;	// In vertices
+			uint32_t indexOffset, indexCount;	// In indices
+			uint32_t generation;				// Incremented when the mesh is freed
+			bool live;
+		};
+
+		HLContext context;
+		uint32_t vertexStride;
+
+		HLBuffer vertexBuffer, indexBuffer;
+		HLVertexBinding vertexBinding;
+		HLBuffer scratchBuffer; // For the moves of Defragment that overlap, grows to the largest one
+		size_t scratchSize = 0;
+
+		Impl::RangeAllocator vertexAllocator, indexAllocator;
+		std::vector<Mesh> meshes;
+		std::vector<uint32_t> freeMeshes;
+		uint32_t meshCount = 0;
+
+		~Details();
+
+		Result Destroy();
+
+		Mesh* GetMesh(HLGeometryMesh mesh);
+		Result Move(HLBuffer& buffer, size_t sourceOffset, size_t offset, size_t size);
+	};
+
+	HLGeometryHeap::Details::~Details()
+	{
+		Destroy();
+	}
+
+	Result HLGeometryHeap::Details::Destroy()
+	{
+		if (!context.IsInitialized())
+			return Result::Success; // Already destroyed
+
+		vertexBinding = HLVertexBinding{};
+		scratchBuffer = HLBuffer{};
+		scratchSize = 0;
+		indexBuffer = HLBuffer{};
+		vertexBuffer = HLBuffer{};
+		meshes.clear();
+		freeMeshes.clear();
+		meshCount = 0;
+
+		context = HLContext{};
+
+		return Result::Success;
+	}
+
+	HLGeometryHeap::Details::Mesh* HLGeometryHeap::Details::GetMesh(HLGeometryMesh mesh)
+	{
+		if (!mesh.IsValid() || mesh.index >= meshes.size() || !meshes[mesh.index].live || meshes[mesh.index].generation != mesh.generation)
+			return nullptr;
+
+		return &meshes[mesh.index];
+	}
+
+	Result HLGeometryHeap::Details::Move(HLBuffer& buffer, size_t sourceOffset, size_t offset, size_t size)
+	{
+		if (sourceOffset == offset || size == 0)
+			return Result::Success;
+
+		// Meshes only move towards the start, they overlap their old range if they move less than their size
+		if (sourceOffset - offset >= size)
+			return buffer.CopyData(buffer, sourceOffset, offset, size);
+
+		if (!scratchBuffer.IsInitialized() || scratchSize < size)
+		{
+			scratchBuffer = HLBuffer{};
+			Result result = scratchBuffer.Create({
+				.context = context,
+				.usage = HLBufferUsage::Immutable, // Only copied to and from
+				.size = size,
+				.data = nullptr
+				});
+			if (IsError(result))
+				return result;
+
+			scratchSize = size;
+		}
+
+		scratchBuffer.CopyData(buffer, sourceOffset, 0, size);
+		return buffer.CopyData(scratchBuffer, 0, offset, size);
+	}
+
+	Result HLGeometryHeap::Create(const HLGeometryHeapCreateInfo& createInfo)
+	{
+		HLContext context = createInfo.context;
+		HLLayout layout = createInfo.vertexLayout;
+		if (!context.IsInitialized() || !layout.IsInitialized() || createInfo.vertexCapacity == 0 || createInfo.indexCapacity == 0)
+			return Result::InvalidParameter;
+
+		auto layoutData = layout.GetNativeHandle();
+		if (layoutData.bindings.size() != createInfo.otherBuffers.size() + 1 || layoutData.bindings[0].stride == 0)
+			return Result::InvalidParameter;
+
+		m_details = std::make_shared<Details>();
+		m_details->context = context;
+		m_details->vertexStride = layoutData.bindings[0].stride;
+		m_details->vertexAllocator.Reset(createInfo.vertexCapacity);
+		m_details->indexAllocator.Reset(createInfo.indexCapacity);
+
+		Result result = m_details->vertexBuffer.Create({
+			.context = context,
+			.usage = HLBufferUsage::Mutable,
+			.size = static_cast<size_t>(createInfo.vertexCapacity) * m_details->vertexStride,
+			.data = nullptr
+			});
+		if (!IsError(result))
+			result = m_details->indexBuffer.Create({
+				.context = context,
+				.usage = HLBufferUsage::Mutable,
+				.size = static_cast<size_t>(createInfo.indexCapacity) * sizeof(uint32_t),
+				.data = nullptr
+				});
+
+		if (!IsError(result))
+		{
+			std::vector<HLBuffer> vertexBuffers{ m_details->vertexBuffer };
+			vertexBuffers.insert(vertexBuffers.end(), createInfo.otherBuffers.begin(), createInfo.otherBuffers.end());
+
+			result = m_details->vertexBinding.Create({
+				.context = context,
+				.vertexBuffers = vertexBuffers,
+				.indexBuffer = m_details->indexBuffer,
+				.vertexLayout = layout
+				});
+		}
+
+		if (IsError(result))
+		{
+			m_details = nullptr;
+			return result;
+		}
+
+		return Result::Success;
+	}
+
+	Result HLGeometryHeap::Destroy()
+	{
+		auto result = m_details->Destroy();
+		m_details = nullptr;
+		return result;
+	}
+
+	Result HLGeometryHeap::Allocate(std::span<const std::byte> vertices, std::span<const uint32_t> indices, HLGeometryMesh& meshOut)
+	{
+		if (vertices.empty() || vertices.size() % m_details->vertexStride != 0)
+			return Result::InvalidParameter;
+
+		Details::Mesh mesh{
+			.vertexOffset = 0,
+			.vertexCount = static_cast<uint32_t>(vertices.size() / m_details->vertexStride),
+			.indexOffset = 0,
+			.indexCount = static_cast<uint32_t>(indices.size()),
+			.generation = 0,
+			.live = true
+		};
+
+		if (!m_details->vertexAllocator.Allocate(mesh.vertexCount, mesh.vertexOffset))
+			return Result::OutOfMemory;
+
+		if (!m_details->indexAllocator.Allocate(mesh.indexCount, mesh.indexOffset))
+		{
+			m_details->vertexAllocator.Free(mesh.vertexOffset, mesh.vertexCount);
+			return Result::OutOfMemory;
+		}
+
+		m_details->vertexBuffer.SetData(const_cast<std::byte*>(vertices.data()), static_cast<size_t>(mesh.vertexOffset) * m_details->vertexStride,
+			vertices.size_bytes());
+		if (!indices.empty())
+			m_details->indexBuffer.SetData(const_cast<uint32_t*>(indices.data()), static_cast<size_t>(mesh.indexOffset) * sizeof(uint32_t),
+				indices.size_bytes());
+
+		if (m_details->freeMeshes.empty())
+		{
+			meshOut.index = static_cast<uint32_t>(m_details->meshes.size());
+			m_details->meshes.push_back(mesh);
+		}
+		else
+		{
+			meshOut.index = m_details->freeMeshes.back();
+			m_details->freeMeshes.pop_back();
+			mesh.generation = m_details->meshes[meshOut.index].generation;
+			m_details->meshes[meshOut.index] = mesh;
+		}
+		meshOut.generation = mesh.generation;
+		m_details->meshCount++;
+
+		return Result::Success;
+	}
+
+	Result HLGeometryHeap::Free(HLGeometryMesh mesh)
+	{
+		Details::Mesh* data = m_details->GetMesh(mesh);
+		if (!data)
+			return Result::InvalidParameter;
+
+		m_details->vertexAllocator.Free(data->vertexOffset, data->vertexCount);
+		m_details->indexAllocator.Free(data->indexOffset, data->indexCount);
+		data->live = false;
+		data->generation++;
+
+		m_details->freeMeshes.push_back(mesh.index);
+		m_details->meshCount--;
+
+		return Result::Success;
+	}
+
+	Result HLGeometryHeap::SetVertices(HLGeometryMesh mesh, uint32_t firstVertex, std::span<const std::byte> vertices)
+	{
+		Details::Mesh* data = m_details->GetMesh(mesh);
+		if (!data || vertices.size() % m_details->vertexStride != 0 ||
+			firstVertex + vertices.size() / m_details->vertexStride > data->vertexCount)
+			return Result::InvalidParameter;
+
+		if (vertices.empty())
+			return Result::Success;
+
+		return m_details->vertexBuffer.SetData(const_cast<std::byte*>(vertices.data()),
+			(static_cast<size_t>(data->vertexOffset) + firstVertex) * m_details->vertexStride, vertices.size_bytes());
+	}
+
+	Result HLGeometryHeap::Defragment(uint32_t* movedCountOut)
+	{
+		std::vector<uint32_t> order;
+		order.reserve(m_details->meshCount);
+		for (uint32_t i = 0; i < m_details->meshes.size(); i++)
+		{
+			if (m_details->meshes[i].live)
+				order.push_back(i);
+		}
+
+		std::vector<bool> moved(m_details->meshes.size(), false);
+		const size_t vertexStride = m_details->vertexStride;
+
+		// Packs the ranges in the order of their offsets, so a range only moves to memory that no range uses anymore
+		auto compact = [&](HLBuffer& buffer, size_t elementSize, uint32_t Details::Mesh::* offsetMember, uint32_t Details::Mesh::* countMember)
+		{
+			auto& meshes = m_details->meshes;
+			std::ranges::sort(order, [&](uint32_t lhs, uint32_t rhs) { return meshes[lhs].*offsetMember < meshes[rhs].*offsetMember; });
+
+			uint32_t cursor = 0;
+			for (uint32_t index : order)
+			{
+				Details::Mesh& mesh = meshes[index];
+				if (mesh.*countMember == 0)
+					continue;
+
+				if (mesh.*offsetMember != cursor)
+				{
+					Result result = m_details->Move(buffer, mesh.*offsetMember * elementSize, cursor * elementSize, mesh.*countMember * elementSize);
+					if (IsError(result))
+						return result;
+
+					mesh.*offsetMember = cursor;
+					moved[index] = true;
+				}
+				cursor += mesh.*countMember;
+			}
+
+			return Result::Success;
+		};
+
+		Result result = compact(m_details->vertexBuffer, vertexStride, &Details::Mesh::vertexOffset, &Details::Mesh::vertexCount);
+		if (!IsError(result))
+			result = compact(m_details->indexBuffer, sizeof(uint32_t), &Details::Mesh::indexOffset, &Details::Mesh::indexCount);
+		if (IsError(result))
+			return result;
+
+		// Everything is packed at the start now
+		m_details->vertexAllocator.ResetCompacted(m_details->vertexAllocator.GetSize() - m_details->vertexAllocator.GetFreeSize());
+		m_details->indexAllocator.ResetCompacted(m_details->indexAllocator.GetSize() - m_details->indexAllocator.GetFreeSize());
+
+		// Empty index ranges don't use memory, they're at 0 like a new one
+		for (uint32_t index : order)
+		{
+			if (m_details->meshes[index].indexCount == 0)
+				m_details->meshes[index].indexOffset = 0;
+		}
+
+		if (movedCountOut)
+			*movedCountOut = static_cast<uint32_t>(std::ranges::count(moved, true));
+
+		return Result::Success;
+	}
+
+	HLGeometryRange HLGeometryHeap::GetRange(HLGeometryMesh mesh)
+	{
+		Details::Mesh* data = m_details->GetMesh(mesh);
+		if (!data)
+			return HLGeometryRange{ 0, 0, 0, 0 };
+
+		return HLGeometryRange{
+			.baseVertex = static_cast<int32_t>(data->vertexOffset),
+			.vertexCount = data->vertexCount,
+			.firstIndex = data->indexOffset,
+			.indexCount = data->indexCount
+		};
+	}
+
+	HLVertexBinding HLGeometryHeap::GetVertexBinding()
+	{
+		return m_details->vertexBinding;
+	}
+
+	HLBuffer HLGeometryHeap::GetVertexBuffer()
+	{
+		return m_details->vertexBuffer;
+	}
+
+	HLBuffer HLGeometryHeap::GetIndexBuffer()
+	{
+		return m_details->indexBuffer;
+	}
+
+	HLGeometryHeapStats HLGeometryHeap::GetStats()
+	{
+		auto& vertices = m_details->vertexAllocator;
+		auto& indices = m_details->indexAllocator;
+		return HLGeometryHeapStats{
+			.meshCount = m_details->meshCount,
+			.usedVertices = vertices.GetSize() - vertices.GetFreeSize(),
+			.largestFreeVertexRange = vertices.GetLargestFreeRange(),
+			.usedIndices = indices.GetSize() - indices.GetFreeSize(),
+			.largestFreeIndexRange = indices.GetLargestFreeRange(),
+			.freeRangeCount = vertices.GetFreeRangeCount() + indices.GetFreeRangeCount()
+		};
+	}
+
+	bool HLGeometryHeap::IsInitialized()
+	{
+		return m_details && m_details->context.IsInitialized();
+	}
+}
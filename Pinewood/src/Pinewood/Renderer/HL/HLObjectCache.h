@@ -0,0 +1,124 @@
+#pragma once
+#include <Pinewood/Renderer/HL/HLLayout.h>
+
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// The cache of the HL objects that are shared (pipeline states, samplers and vertex bindings), creating an object that is the
+// same as a live one gives the live one. The cache doesn't keep the objects alive, an object removes itself when it's destroyed.
+
+namespace Pinewood::Impl
+{
+	constexpr uint64_t ObjectHashBasis = 0xcbf29ce484222325ull;
+
+	// FNV-1a over whole values
+	inline void HashValue(uint64_t& hash, uint64_t value)
+	{
+		hash = (hash ^ value) * 0x100000001b3ull;
+	}
+
+	inline void HashLayout(uint64_t& hash, const HLLayout::NativeHandle& layoutData)
+	{
+		for (auto& element : layoutData.elements)
+		{
+			HashValue(hash, element.offset);
+			HashValue(hash, static_cast<uint32_t>(element.type));
+			HashValue(hash, element.index);
+			HashValue(hash, element.binding);
+			HashValue(hash, element.instanceDivisor);
+		}
+		for (auto& binding : layoutData.bindings)
+		{
+			HashValue(hash, binding.offset);
+			HashValue(hash, binding.stride);
+		}
+	}
+
+	// The elements and bindings of a layout, none for an uninitialized layout
+	inline HLLayout::NativeHandle GetLayoutData(HLLayout& layout)
+	{
+		return layout.IsInitialized() ? layout.GetNativeHandle() : HLLayout::NativeHandle{};
+	}
+
+	template<typename TDetails>
+	struct ObjectCacheState
+	{
+		std::mutex mutex;
+		std::unordered_multimap<uint64_t, std::pair<const TDetails*, std::weak_ptr<TDetails>>> objects;
+	};
+
+	// A member of the cached Details (named cacheEntry), removes the object from the cache when it's destroyed
+	template<typename TDetails>
+	class ObjectCacheEntry
+	{
+	public:
+		ObjectCacheEntry() = default;
+		ObjectCacheEntry(const ObjectCacheEntry&) = delete;
+		ObjectCacheEntry& operator=(const ObjectCacheEntry&) = delete;
+
+		~ObjectCacheEntry()
+		{
+			if (!m_state)
+				return;
+
+			std::lock_guard lock{ m_state->mutex };
+			auto [begin, end] = m_state->objects.equal_range(m_hash);
+			for (auto it = begin; it != end; it++)
+			{
+				if (it->second.first == m_object)
+				{
+					m_state->objects.erase(it);
+					return;
+				}
+			}
+		}
+
+	private:
+		template<typename> friend class ObjectCache;
+
+		std::shared_ptr<ObjectCacheState<TDetails>> m_state; // Objects can outlive the cache (ex: globals)
+		const TDetails* m_object = nullptr;
+		uint64_t m_hash = 0;
+	};
+
+	template<typename TDetails>
+	class ObjectCache
+	{
+	public:
+		// Gets the live object with the hash that isSame(TDetails&) accepts, or the new object that create() returns
+		// create runs under the lock, so two threads can't both create the same object
+		template<typename TIsSame, typename TCreate>
+		std::shared_ptr<TDetails> FindOrCreate(uint64_t hash, TIsSame&& isSame, TCreate&& create)
+		{
+			// Released after the lock, if one is the last reference its entry takes the lock to remove it
+			std::vector<std::shared_ptr<TDetails>> others;
+			std::lock_guard lock{ m_state->mutex };
+
+			auto [begin, end] = m_state->objects.equal_range(hash);
+			for (auto it = begin; it != end; it++)
+			{
+				auto details = it->second.second.lock();
+				if (!details)
+					continue; // Being destroyed, its entry removes it once we unlock
+
+				if (isSame(*details))
+					return details;
+				others.push_back(std::move(details));
+			}
+
+			std::shared_ptr<TDetails> details = create();
+			details->cacheEntry.m_state = m_state;
+			details->cacheEntry.m_object = details.get();
+			details->cacheEntry.m_hash = hash;
+			m_state->objects.emplace(hash, std::pair<const TDetails*, std::weak_ptr<TDetails>>{ details.get(), details });
+
+			return details;
+		}
+
+	private:
+		std::shared_ptr<ObjectCacheState<TDetails>> m_state = std::make_shared<ObjectCacheState<TDetails>>();
+	};
+}
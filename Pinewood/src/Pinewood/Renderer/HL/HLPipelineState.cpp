@@ -0,0 +1,143 @@
+#include "pch.h"
+#include <Pinewood/Renderer/HL/HLPipelineState.h>
+#include "HLObjectCache.h"
+
+#include <bit>
+
+// Pipeline states only hold HL objects, so they are the same for every rendering API (HLRenderInterface applies them)
+
+namespace Pinewood
+{
+	class HLPipelineState::Details
+	{
+	public:
+		HLContext context;
+		HLShaderProgram program;
+		HLLayout layout;
+		HLRenderState renderState;
+
+		uint32_t id; // Never reused, even after the state is destroyed
+
+		Impl::ObjectCacheEntry<Details> cacheEntry;
+
+		static inline Impl::ObjectCache<Details> cache;
+		static inline uint32_t nextID = 1; // Guarded by the cache, only changed by create
+	};
+
+	using Impl::HashValue;
+
+	static uint64_t HashPipelineState(const void* renderContext, HLShaderProgram::NativeHandle program, HLLayout::NativeHandle layout,
+		const HLRenderState& state)
+	{
+		uint64_t hash = Impl::ObjectHashBasis;
+		HashValue(hash, reinterpret_cast<uintptr_t>(renderContext));
+		HashValue(hash, program);
+		Impl::HashLayout(hash, layout);
+
+		const HLBlendState& blend = state.blend;
+		HashValue(hash, blend.enable);
+		HashValue(hash, static_cast<uint32_t>(blend.sourceColor));
+		HashValue(hash, static_cast<uint32_t>(blend.destinationColor));
+		HashValue(hash, static_cast<uint32_t>(blend.colorOp));
+		HashValue(hash, static_cast<uint32_t>(blend.sourceAlpha));
+		HashValue(hash, static_cast<uint32_t>(blend.destinationAlpha));
+		HashValue(hash, static_cast<uint32_t>(blend.alphaOp));
+		HashValue(hash, static_cast<uint32_t>(blend.writeMask));
+
+		HashValue(hash, state.depth.testEnable);
+		HashValue(hash, state.depth.writeEnable);
+		HashValue(hash, static_cast<uint32_t>(state.depth.compareOp));
+
+		const HLStencilState& stencil = state.stencil;
+		HashValue(hash, stencil.testEnable);
+		for (const HLStencilFaceState* face : { &stencil.front, &stencil.back })
+		{
+			HashValue(hash, static_cast<uint32_t>(face->failOp));
+			HashValue(hash, static_cast<uint32_t>(face->depthFailOp));
+			HashValue(hash, static_cast<uint32_t>(face->passOp));
+			HashValue(hash, static_cast<uint32_t>(face->compareOp));
+		}
+		HashValue(hash, stencil.readMask | (stencil.writeMask << 8) | (stencil.reference << 16));
+
+		const HLRasterState& raster = state.raster;
+		HashValue(hash, static_cast<uint32_t>(raster.cullMode));
+		HashValue(hash, static_cast<uint32_t>(raster.frontFace));
+		HashValue(hash, raster.scissorEnable);
+		HashValue(hash, raster.wireframe);
+		HashValue(hash, std::bit_cast<uint32_t>(raster.depthBiasConstant));
+		HashValue(hash, std::bit_cast<uint32_t>(raster.depthBiasSlope));
+
+		return hash;
+	}
+
+	Result HLPipelineState::Create(const HLPipelineStateCreateInfo& createInfo)
+	{
+		HLContext context = createInfo.context;
+		HLShaderProgram program = createInfo.program;
+		HLLayout layout = createInfo.layout;
+		if (!context.IsInitialized() || !program.IsInitialized())
+			return Result::InvalidParameter;
+
+		const void* renderContext = context.GetNativeHandle().renderContext;
+		const auto programHandle = program.GetNativeHandle();
+		const auto layoutData = Impl::GetLayoutData(layout);
+		const uint64_t hash = HashPipelineState(renderContext, programHandle, layoutData, createInfo.renderState);
+
+		auto isSame = [&](Details& details)
+		{
+			if (!details.program.IsInitialized() || !details.context.IsInitialized())
+				return false; // Its program was destroyed, and the name may have been reused
+
+			const auto cachedLayoutData = Impl::GetLayoutData(details.layout);
+			return details.context.GetNativeHandle().renderContext == renderContext && details.program.GetNativeHandle() == programHandle &&
+				details.renderState == createInfo.renderState &&
+				std::ranges::equal(cachedLayoutData.elements, layoutData.elements) && std::ranges::equal(cachedLayoutData.bindings, layoutData.bindings);
+		};
+
+		auto create = [&]()
+		{
+			auto details = std::make_shared<Details>();
+			details->context = context;
+			details->program = program;
+			details->layout = layout;
+			details->renderState = createInfo.renderState;
+			details->id = Details::nextID++;
+			return details;
+		};
+
+		m_details = Details::cache.FindOrCreate(hash, isSame, create);
+
+		return Result::Success;
+	}
+
+	Result HLPipelineState::Destroy()
+	{
+		m_details = nullptr;
+		return Result::Success;
+	}
+
+	HLShaderProgram HLPipelineState::GetProgram()
+	{
+		return m_details->program;
+	}
+
+	HLLayout HLPipelineState::GetLayout()
+	{
+		return m_details->layout;
+	}
+
+	const HLRenderState& HLPipelineState::GetRenderState()
+	{
+		return m_details->renderState;
+	}
+
+	uint64_t HLPipelineState::GetSortKey()
+	{
+		return (static_cast<uint64_t>(m_details->program.GetNativeHandle()) << 32) | m_details->id;
+	}
+
+	bool HLPipelineState::IsInitialized()
+	{
+		return m_details != nullptr;
+	}
+}
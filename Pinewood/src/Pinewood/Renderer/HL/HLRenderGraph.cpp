@@ -0,0 +1,353 @@
+#include "pch.h"
+#include <Pinewood/Renderer/HL/HLRenderGraph.h>
+#include <Pinewood/Profiler.h>
+
+// The graph only uses the HL objects, so it's the same for every rendering API
+
+namespace Pinewood
+{
+	class HLRenderGraph::Details
+	{
+	public:
+		enum class ResourceType
+		{
+			TransientTexture,
+			ImportedTexture,
+			ImportedBuffer,
+			Backbuffer
+		};
+
+		struct Resource
+		{
+			const char* name;
+			ResourceType type;
+			HLRenderTargetDesc desc;	// Transient textures only
+			HLTexture2D texture;		// Set while a transient texture is acquired
+			HLBuffer buffer;
+			bool needed;				// A pass that isn't culled reads it after the pass being looked at
+			uint32_t firstPass, lastPass;
+		};
+
+		struct Write
+		{
+			uint32_t resource;
+			HLFramebufferAttachment attachment;
+		};
+
+		struct Pass
+		{
+			const char* name;
+			ExecuteFunction execute;
+			std::vector<uint32_t> reads;
+			std::vector<Write> writes;
+			bool keepAlive;
+			bool culled;
+		};
+
+		HLRenderInterface renderInterface;
+		HLRenderTargetPool renderTargetPool;
+
+		std::vector<Resource> resources;
+		std::vector<Pass> passes;
+		uint32_t currentPass = UINT32_MAX;
+		HLFramebuffer currentFramebuffer;
+
+		HLRenderGraphStats stats{};
+
+		HLRenderGraphResource AddResource(const char* name, ResourceType type);
+		bool IsAccessedBy(uint32_t resource, uint32_t pass) const;
+		void Cull();
+		void ComputeLifetimes();
+		Result ExecutePass(HLRenderGraph& graph, uint32_t pass);
+		void Clear();
+	};
+
+	HLRenderGraphResource HLRenderGraph::Details::AddResource(const char* name, ResourceType type)
+	{
+		resources.push_back({ .name = name, .type = type, .desc = {}, .needed = false, .firstPass = UINT32_MAX, .lastPass = 0 });
+		return HLRenderGraphResource{ static_cast<uint32_t>(resources.size() - 1) };
+	}
+
+	bool HLRenderGraph::Details::IsAccessedBy(uint32_t resource, uint32_t pass) const
+	{
+		const Pass& p = passes[pass];
+		return std::find(p.reads.begin(), p.reads.end(), resource) != p.reads.end() ||
+			std::any_of(p.writes.begin(), p.writes.end(), [resource](const Write& write) { return write.resource == resource; });
+	}
+
+	void HLRenderGraph::Details::Cull()
+	{
+		// Walk back from the outputs: a pass is needed if it writes something the graph outputs or a later needed pass reads.
+		// Every earlier write of a read resource counts (a pass may only draw over a part of a target)
+		for (uint32_t i = static_cast<uint32_t>(passes.size()); i-- > 0;)
+		{
+			Pass& pass = passes[i];
+
+			bool needed = pass.keepAlive;
+			for (const Write& write : pass.writes)
+			{
+				const Resource& resource = resources[write.resource];
+				needed |= resource.type != ResourceType::TransientTexture || resource.needed;
+			}
+
+			pass.culled = !needed;
+			if (pass.culled)
+				continue;
+
+			for (uint32_t read : pass.reads)
+				resources[read].needed = true;
+		}
+	}
+
+	void HLRenderGraph::Details::ComputeLifetimes()
+	{
+		for (uint32_t i = 0; i < passes.size(); i++)
+		{
+			if (passes[i].culled)
+				continue;
+
+			auto extend = [this, i](uint32_t resource)
+			{
+				resources[resource].firstPass = std::min(resources[resource].firstPass, i);
+				resources[resource].lastPass = std::max(resources[resource].lastPass, i);
+			};
+
+			for (uint32_t read : passes[i].reads)
+				extend(read);
+			for (const Write& write : passes[i].writes)
+				extend(write.resource);
+		}
+	}
+
+	Result HLRenderGraph::Details::ExecutePass(HLRenderGraph& graph, uint32_t passIndex)
+	{
+		Pass& pass = passes[passIndex];
+
+		// Transient textures are acquired right before the first pass that uses them
+		for (uint32_t i = 0; i < resources.size(); i++)
+		{
+			Resource& resource = resources[i];
+			if (resource.type == ResourceType::TransientTexture && resource.firstPass == passIndex)
+			{
+				Result result = renderTargetPool.Acquire(resource.desc, resource.texture);
+				if (IsError(result))
+					return result;
+			}
+		}
+
+		// The framebuffer of the pass, the backbuffer can't be combined with other attachments
+		std::vector<HLTexture2D> textures;
+		std::vector<HLFramebufferAttachment> attachments;
+		bool writesBackbuffer = false;
+		for (const Write& write : pass.writes)
+		{
+			if (write.attachment == HLFramebufferAttachment::Null)
+				continue;
+
+			Resource& resource = resources[write.resource];
+			if (resource.type == ResourceType::Backbuffer)
+				writesBackbuffer = true;
+			else if (resource.type != ResourceType::ImportedBuffer)
+			{
+				textures.push_back(resource.texture);
+				attachments.push_back(write.attachment);
+			}
+		}
+
+		if (writesBackbuffer && !textures.empty())
+			return Result::InvalidParameter;
+
+		currentFramebuffer = HLFramebuffer{};
+		if (writesBackbuffer)
+			renderInterface.ResetFramebuffer();
+		else if (!textures.empty())
+		{
+			Result result = renderTargetPool.GetFramebuffer(textures, attachments, currentFramebuffer);
+			if (IsError(result))
+				return result;
+
+			renderInterface.SetFramebuffer(currentFramebuffer);
+		}
+
+		{
+			PW_PROFILE_SCOPE(pass.name);
+			PW_PROFILE_GPU_SCOPE(renderInterface, pass.name);
+
+			currentPass = passIndex;
+			HLRenderGraphPassContext context{ graph };
+			pass.execute(context);
+			currentPass = UINT32_MAX;
+			currentFramebuffer = HLFramebuffer{};
+		}
+
+		// And released after the last one, a later pass can get the same texture
+		for (auto& resource : resources)
+		{
+			if (resource.type == ResourceType::TransientTexture && resource.lastPass == passIndex)
+			{
+				renderTargetPool.Release(resource.texture);
+				resource.texture = HLTexture2D{};
+			}
+		}
+
+		return Result::Success;
+	}
+
+	void HLRenderGraph::Details::Clear()
+	{
+		// Textures of passes that didn't run because of an error
+		for (auto& resource : resources)
+		{
+			if (resource.type == ResourceType::TransientTexture && resource.texture.IsInitialized())
+				renderTargetPool.Release(resource.texture);
+		}
+
+		resources.clear();
+		passes.clear();
+	}
+
+	Result HLRenderGraph::Create(const HLRenderGraphCreateInfo& createInfo)
+	{
+		if (!HLRenderInterface{ createInfo.renderInterface }.IsInitialized() || !HLRenderTargetPool{ createInfo.renderTargetPool }.IsInitialized())
+			return Result::InvalidParameter;
+
+		m_details = std::make_shared<Details>();
+		m_details->renderInterface = createInfo.renderInterface;
+		m_details->renderTargetPool = createInfo.renderTargetPool;
+
+		return Result::Success;
+	}
+
+	Result HLRenderGraph::Destroy()
+	{
+		m_details->Clear();
+		m_details = nullptr;
+		return Result::Success;
+	}
+
+	HLRenderGraphResource HLRenderGraph::CreateTexture(const char* name, const HLRenderTargetDesc& desc)
+	{
+		auto handle = m_details->AddResource(name, Details::ResourceType::TransientTexture);
+		m_details->resources[handle.index].desc = desc;
+		return handle;
+	}
+
+	HLRenderGraphResource HLRenderGraph::ImportTexture(const char* name, const HLTexture2D& texture)
+	{
+		auto handle = m_details->AddResource(name, Details::ResourceType::ImportedTexture);
+		m_details->resources[handle.index].texture = texture;
+		return handle;
+	}
+
+	HLRenderGraphResource HLRenderGraph::ImportBuffer(const char* name, const HLBuffer& buffer)
+	{
+		auto handle = m_details->AddResource(name, Details::ResourceType::ImportedBuffer);
+		m_details->resources[handle.index].buffer = buffer;
+		return handle;
+	}
+
+	HLRenderGraphResource HLRenderGraph::ImportBackbuffer(const char* name)
+	{
+		return m_details->AddResource(name, Details::ResourceType::Backbuffer);
+	}
+
+	HLRenderGraphPassBuilder HLRenderGraph::AddPass(const char* name, ExecuteFunction execute)
+	{
+		m_details->passes.push_back({ .name = name, .execute = std::move(execute), .keepAlive = false, .culled = false });
+		return HLRenderGraphPassBuilder{ *this, static_cast<uint32_t>(m_details->passes.size() - 1) };
+	}
+
+	Result HLRenderGraph::Execute()
+	{
+		PW_PROFILE_SCOPE("Render Graph");
+
+		m_details->Cull();
+		m_details->ComputeLifetimes();
+
+		m_details->stats = HLRenderGraphStats{ .passCount = static_cast<uint32_t>(m_details->passes.size()) };
+		for (auto& pass : m_details->passes)
+			m_details->stats.culledPassCount += pass.culled ? 1 : 0;
+		for (auto& resource : m_details->resources)
+			m_details->stats.transientTextureCount += (resource.type == Details::ResourceType::TransientTexture && resource.firstPass != UINT32_MAX) ? 1 : 0;
+
+		Result result = Result::Success;
+		for (uint32_t i = 0; i < m_details->passes.size() && !IsError(result); i++)
+		{
+			if (!m_details->passes[i].culled)
+				result = m_details->ExecutePass(*this, i);
+		}
+
+		m_details->Clear();
+		return result;
+	}
+
+	HLRenderGraphStats HLRenderGraph::GetStats()
+	{
+		return m_details->stats;
+	}
+
+	bool HLRenderGraph::IsInitialized()
+	{
+		return m_details != nullptr;
+	}
+
+	HLRenderGraphPassBuilder& HLRenderGraphPassBuilder::Read(HLRenderGraphResource resource)
+	{
+		if (resource.IsValid())
+			m_graph.m_details->passes[m_pass].reads.push_back(resource.index);
+		return *this;
+	}
+
+	HLRenderGraphPassBuilder& HLRenderGraphPassBuilder::Write(HLRenderGraphResource resource, HLFramebufferAttachment attachment)
+	{
+		if (resource.IsValid())
+			m_graph.m_details->passes[m_pass].writes.push_back({ resource.index, attachment });
+		return *this;
+	}
+
+	HLRenderGraphPassBuilder& HLRenderGraphPassBuilder::KeepAlive()
+	{
+		m_graph.m_details->passes[m_pass].keepAlive = true;
+		return *this;
+	}
+
+	HLRenderInterface& HLRenderGraphPassContext::GetRenderInterface()
+	{
+		return m_graph.m_details->renderInterface;
+	}
+
+	HLTexture2D HLRenderGraphPassContext::GetTexture(HLRenderGraphResource resource)
+	{
+		auto& details = *m_graph.m_details;
+		if (!resource.IsValid() || !details.IsAccessedBy(resource.index, details.currentPass))
+			return HLTexture2D{}; // Not declared by the pass
+
+		return details.resources[resource.index].texture;
+	}
+
+	HLBuffer HLRenderGraphPassContext::GetBuffer(HLRenderGraphResource resource)
+	{
+		auto& details = *m_graph.m_details;
+		if (!resource.IsValid() || !details.IsAccessedBy(resource.index, details.currentPass))
+			return HLBuffer{}; // Not declared by the pass
+
+		return details.resources[resource.index].buffer;
+	}
+
+	HLFramebuffer HLRenderGraphPassContext::GetFramebuffer()
+	{
+		return m_graph.m_details->currentFramebuffer;
+	}
+
+	HLFramebuffer HLRenderGraphPassContext::GetReadFramebuffer(HLRenderGraphResource resource)
+	{
+		HLTexture2D textures[]{ GetTexture(resource) };
+		if (!textures[0].IsInitialized())
+			return HLFramebuffer{};
+
+		HLFramebufferAttachment attachments[]{ HLFramebufferAttachment::Color0 };
+		HLFramebuffer framebuffer;
+		m_graph.m_details->renderTargetPool.GetFramebuffer(textures, attachments, framebuffer);
+		return framebuffer;
+	}
+}
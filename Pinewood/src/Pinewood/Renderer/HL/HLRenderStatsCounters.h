@@ -0,0 +1,74 @@
+#pragma once
+#include <Pinewood/Renderer/HL/HLRenderStats.h>
+#include <Pinewood/Renderer/HL/HLImageFormat.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace Pinewood::Impl
+{
+	// The counters behind HLRenderStats, relaxed atomics since any thread with a current context can render
+	struct HLRenderStatsCounters
+	{
+		std::atomic_uint64_t drawCalls;
+		std::atomic_uint64_t triangles;
+		std::atomic_uint64_t dispatches;
+		std::atomic_uint64_t programBinds;
+		std::atomic_uint64_t pipelineStateBinds;
+		std::atomic_uint64_t renderStateChanges;
+		std::atomic_uint64_t vertexBindingBinds;
+		std::atomic_uint64_t vertexBufferBinds;
+		std::atomic_uint64_t textureBinds;
+		std::atomic_uint64_t samplerBinds;
+		std::atomic_uint64_t constantBufferBinds;
+		std::atomic_uint64_t storageBufferBinds;
+		std::atomic_uint64_t framebufferBinds;
+		std::atomic_uint64_t framebufferBlits;
+		std::atomic_uint64_t bufferUploadBytes;
+		std::atomic_uint64_t textureUploadBytes;
+		std::atomic_uint64_t mappedBytes;
+		std::atomic_uint64_t resourcesCreated;
+		std::atomic_uint64_t resourcesDestroyed;
+
+		std::array<std::atomic_uint64_t, static_cast<size_t>(HLResourceType::Count)> liveResources;
+		std::array<std::atomic_uint64_t, static_cast<size_t>(HLResourceType::Count)> liveMemory;
+	};
+
+	// One for the process, not per context or render interface
+	inline HLRenderStatsCounters renderStats{};
+
+#ifndef PW_DISABLE_RENDER_STATS
+	inline void CountStat(std::atomic_uint64_t& counter, uint64_t value = 1)
+	{
+		counter.fetch_add(value, std::memory_order_relaxed);
+	}
+
+	inline void CountResourceCreated(HLResourceType type, uint64_t memory = 0)
+	{
+		renderStats.resourcesCreated.fetch_add(1, std::memory_order_relaxed);
+		renderStats.liveResources[static_cast<size_t>(type)].fetch_add(1, std::memory_order_relaxed);
+		renderStats.liveMemory[static_cast<size_t>(type)].fetch_add(memory, std::memory_order_relaxed);
+	}
+
+	inline void CountResourceDestroyed(HLResourceType type, uint64_t memory = 0)
+	{
+		renderStats.resourcesDestroyed.fetch_add(1, std::memory_order_relaxed);
+		renderStats.liveResources[static_cast<size_t>(type)].fetch_sub(1, std::memory_order_relaxed);
+		renderStats.liveMemory[static_cast<size_t>(type)].fetch_sub(memory, std::memory_order_relaxed);
+	}
+#else // ^^^ !PW_DISABLE_RENDER_STATS // PW_DISABLE_RENDER_STATS vvv
+	inline void CountStat(std::atomic_uint64_t&, uint64_t = 1) {}
+	inline void CountResourceCreated(HLResourceType, uint64_t = 0) {}
+	inline void CountResourceDestroyed(HLResourceType, uint64_t = 0) {}
+#endif // ^^^ PW_DISABLE_RENDER_STATS
+
+	// Size of a texture with its whole mip chain
+	inline uint64_t GetTextureMemorySize(HLImageFormat format, uint32_t width, uint32_t height, uint32_t layers, uint32_t mipLevels)
+	{
+		uint64_t size = 0;
+		for (uint32_t i = 0; i < mipLevels; i++)
+			size += static_cast<uint64_t>(std::max(width >> i, 1u)) * std::max(height >> i, 1u);
+
+		return size * layers * GetImageFormatSize(format);
+	}
+}
@@ -0,0 +1,276 @@
+#include "pch.h"
+#include <Pinewood/Renderer/HL/HLRenderTargetPool.h>
+
+// The pool only uses the HL objects, so it's the same for every rendering API
+
+namespace Pinewood
+{
+	class HLRenderTargetPool::Details
+	{
+	public:
+		struct Target
+		{
+			HLRenderTargetDesc desc;
+			HLTexture2D texture;
+			uint64_t memorySize;
+			uint64_t lastUsedFrame;
+			bool acquired;
+		};
+
+		struct CachedFramebuffer
+		{
+			std::vector<HLTexture2D> textures; // To check that none of them got destroyed since
+			std::vector<HLFramebufferAttachment> attachments;
+			HLFramebuffer framebuffer;
+			uint64_t lastUsedFrame;
+		};
+
+		HLContext context;
+		uint32_t maxUnusedFrames;
+
+		// A pool has a handful of targets and framebuffers, searching them is faster than hashing
+		std::vector<Target> targets;
+		std::vector<CachedFramebuffer> framebuffers;
+		uint64_t frameIndex = 0;
+
+		uint32_t acquiredCount = 0, peakAcquiredCount = 0, lastPeakAcquiredCount = 0;
+		uint64_t targetsCreated = 0, framebuffersCreated = 0;
+
+		~Details();
+
+		void DestroyFramebuffersUsing(HLTexture2D::NativeHandle texture);
+		Result Destroy();
+	};
+
+	static bool operator==(const HLRenderTargetDesc& lhs, const HLRenderTargetDesc& rhs)
+	{
+		return lhs.width == rhs.width && lhs.height == rhs.height && lhs.format == rhs.format &&
+			lhs.samples == rhs.samples && lhs.sampleFilter == rhs.sampleFilter;
+	}
+
+	HLRenderTargetPool::Details::~Details()
+	{
+		Destroy();
+	}
+
+	void HLRenderTargetPool::Details::DestroyFramebuffersUsing(HLTexture2D::NativeHandle texture)
+	{
+		std::erase_if(framebuffers, [texture](CachedFramebuffer& cached)
+		{
+			for (auto& attachedTexture : cached.textures)
+			{
+				if (attachedTexture.IsInitialized() && attachedTexture.GetNativeHandle() == texture)
+				{
+					cached.framebuffer.Destroy();
+					return true;
+				}
+			}
+			return false;
+		});
+	}
+
+	Result HLRenderTargetPool::Details::Destroy()
+	{
+		if (!context.IsInitialized())
+			return Result::Success; // Already destroyed
+
+		// Framebuffers first, they hold on to the targets
+		for (auto& cached : framebuffers)
+			cached.framebuffer.Destroy();
+		framebuffers.clear();
+
+		for (auto& target : targets)
+			target.texture.Destroy();
+		targets.clear();
+
+		acquiredCount = 0;
+		context = HLContext{};
+
+		return Result::Success;
+	}
+
+	Result HLRenderTargetPool::Create(const HLRenderTargetPoolCreateInfo& createInfo)
+	{
+		HLContext context = createInfo.context;
+		if (!context.IsInitialized())
+			return Result::InvalidParameter;
+
+		m_details = std::make_shared<Details>();
+		m_details->context = createInfo.context;
+		m_details->maxUnusedFrames = createInfo.maxUnusedFrames;
+
+		return Result::Success;
+	}
+
+	Result HLRenderTargetPool::Destroy()
+	{
+		auto result = m_details->Destroy();
+		m_details = nullptr;
+		return result;
+	}
+
+	Result HLRenderTargetPool::Acquire(const HLRenderTargetDesc& desc, HLTexture2D& textureOut)
+	{
+		if (desc.width == 0 || desc.height == 0 || desc.format == HLImageFormat::Unknown || desc.samples == 0)
+			return Result::InvalidParameter;
+
+		auto it = std::find_if(m_details->targets.begin(), m_details->targets.end(), [&desc](const Details::Target& target)
+		{
+			return !target.acquired && target.desc == desc;
+		});
+
+		if (it == m_details->targets.end())
+		{
+			HLTexture2D texture;
+			Result result = texture.Create({
+				.context = m_details->context,
+				.width = desc.width,
+				.height = desc.height,
+				.mipLevels = 1,
+				.sampleFilter = desc.sampleFilter,
+				.wrapMode = HLTextureWrapMode::ClampToEdge,
+				.format = desc.format,
+				.data = nullptr,
+				.samples = desc.samples
+				});
+			if (IsError(result))
+				return result;
+
+			const uint64_t memorySize = static_cast<uint64_t>(desc.width) * desc.height * desc.samples * GetImageFormatSize(desc.format);
+			m_details->targets.push_back({ desc, std::move(texture), memorySize, 0, false });
+			m_details->targetsCreated++;
+			it = std::prev(m_details->targets.end());
+		}
+
+		it->acquired = true;
+		it->lastUsedFrame = m_details->frameIndex;
+		textureOut = it->texture;
+
+		m_details->acquiredCount++;
+		m_details->peakAcquiredCount = std::max(m_details->peakAcquiredCount, m_details->acquiredCount);
+
+		return Result::Success;
+	}
+
+	Result HLRenderTargetPool::Release(const HLTexture2D& texture)
+	{
+		HLTexture2D textureCopy = texture; // GetNativeHandle isn't const
+		if (!textureCopy.IsInitialized())
+			return Result::InvalidParameter;
+
+		const auto handle = textureCopy.GetNativeHandle();
+		for (auto& target : m_details->targets)
+		{
+			if (target.acquired && target.texture.GetNativeHandle() == handle)
+			{
+				target.acquired = false;
+				m_details->acquiredCount--;
+				return Result::Success;
+			}
+		}
+
+		return Result::InvalidParameter; // Not acquired from this pool
+	}
+
+	Result HLRenderTargetPool::GetFramebuffer(std::span<HLTexture2D> textures, std::span<HLFramebufferAttachment> attachments, HLFramebuffer& framebufferOut)
+	{
+		if (textures.empty() || textures.size() != attachments.size())
+			return Result::InvalidParameter;
+
+		for (auto& cached : m_details->framebuffers)
+		{
+			if (cached.textures.size() != textures.size() || !std::equal(attachments.begin(), attachments.end(), cached.attachments.begin()))
+				continue;
+
+			bool match = true;
+			for (size_t i = 0; i < textures.size() && match; i++)
+				match = cached.textures[i].IsInitialized() && cached.textures[i].GetNativeHandle() == textures[i].GetNativeHandle();
+
+			if (match)
+			{
+				cached.lastUsedFrame = m_details->frameIndex;
+				framebufferOut = cached.framebuffer;
+				return Result::Success;
+			}
+		}
+
+		HLFramebuffer framebuffer;
+		Result result = framebuffer.Create({
+			.context = m_details->context,
+			.textures = textures,
+			.attachments = attachments
+			});
+		if (IsError(result))
+			return result;
+
+		m_details->framebuffers.push_back({
+			.textures = std::vector<HLTexture2D>(textures.begin(), textures.end()),
+			.attachments = std::vector<HLFramebufferAttachment>(attachments.begin(), attachments.end()),
+			.framebuffer = framebuffer,
+			.lastUsedFrame = m_details->frameIndex
+			});
+		m_details->framebuffersCreated++;
+
+		framebufferOut = framebuffer;
+		return Result::Success;
+	}
+
+	void HLRenderTargetPool::EndFrame()
+	{
+		const uint64_t frameIndex = m_details->frameIndex;
+		const uint32_t maxUnusedFrames = m_details->maxUnusedFrames;
+		auto isUnused = [frameIndex, maxUnusedFrames](uint64_t lastUsedFrame) { return frameIndex - lastUsedFrame >= maxUnusedFrames; };
+
+		// Framebuffers of destroyed textures can never match again
+		std::erase_if(m_details->framebuffers, [&isUnused](Details::CachedFramebuffer& cached)
+		{
+			bool destroyed = std::any_of(cached.textures.begin(), cached.textures.end(), [](HLTexture2D& texture) { return !texture.IsInitialized(); });
+			if (!destroyed && !isUnused(cached.lastUsedFrame))
+				return false;
+
+			cached.framebuffer.Destroy();
+			return true;
+		});
+
+		// Acquired targets count as used, a pass can hold on to a target over multiple frames
+		std::erase_if(m_details->targets, [this, &isUnused](Details::Target& target)
+		{
+			if (target.acquired)
+				target.lastUsedFrame = m_details->frameIndex;
+
+			if (!isUnused(target.lastUsedFrame))
+				return false;
+
+			m_details->DestroyFramebuffersUsing(target.texture.GetNativeHandle());
+			target.texture.Destroy();
+			return true;
+		});
+
+		m_details->lastPeakAcquiredCount = m_details->peakAcquiredCount;
+		m_details->peakAcquiredCount = m_details->acquiredCount;
+		m_details->frameIndex++;
+	}
+
+	HLRenderTargetPoolStats HLRenderTargetPool::GetStats()
+	{
+		HLRenderTargetPoolStats stats{
+			.targetCount = static_cast<uint32_t>(m_details->targets.size()),
+			.acquiredCount = m_details->acquiredCount,
+			.peakAcquiredCount = m_details->lastPeakAcquiredCount,
+			.framebufferCount = static_cast<uint32_t>(m_details->framebuffers.size()),
+			.memorySize = 0,
+			.targetsCreated = m_details->targetsCreated,
+			.framebuffersCreated = m_details->framebuffersCreated
+		};
+
+		for (auto& target : m_details->targets)
+			stats.memorySize += target.memorySize;
+
+		return stats;
+	}
+
+	bool HLRenderTargetPool::IsInitialized()
+	{
+		return m_details && m_details->context.IsInitialized();
+	}
+}
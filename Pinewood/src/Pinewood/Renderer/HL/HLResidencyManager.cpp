@@ -0,0 +1,410 @@
+#include "pch.h"
+#include "HLRenderStatsCounters.h"
+#include <Pinewood/Renderer/HL/HLResidencyManager.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+// The manager only uses the HL objects (and the memory counters), so it's the same for every rendering API
+
+namespace Pinewood
+{
+	class HLResidencyManager::Details
+	{
+	public:
+		enum class State
+		{
+			Resident,
+			Evicted,
+			Reloading
+		};
+
+		struct Entry
+		{
+			HLResourceType type;
+			uint32_t handle;		// The native handle of the resource, while it's resident
+			uint64_t size;
+			uint64_t lastUsedFrame;
+			HLResidencyStreamInfo streamInfo;
+			State state;
+			uint32_t generation;	// Incremented when the resource is unregistered
+			bool live;
+		};
+
+		HLContext context;
+
+		uint64_t budget;
+		uint64_t driverBudget;	// UINT64_MAX if the driver doesn't report its memory
+		uint32_t keepFrames;
+		uint64_t frame = 0;
+
+		std::vector<Entry> entries;
+		std::vector<uint32_t> freeEntries;
+		std::unordered_map<uint64_t, uint32_t> residentEntries; // By GetKey, so the binds find them
+
+		uint64_t registeredMemory = 0;
+		uint32_t residentCount = 0, evictedCount = 0;
+		uint64_t evictions = 0, reloads = 0;
+
+		~Details();
+
+		Result Destroy();
+
+		static uint64_t GetKey(HLResourceType type, uint32_t handle) { return (static_cast<uint64_t>(type) << 32) | handle; }
+
+		Entry* GetEntry(HLResidentResource resource);
+
+		Result Add(HLResourceType type, uint32_t handle, uint64_t size, HLResidencyStreamInfo&& streamInfo, HLResidentResource& resourceOut);
+		Result SetResident(HLResidentResource resource, HLResourceType type, uint32_t handle, uint64_t size);
+		void Touch(HLResourceType type, uint32_t handle);
+		void Evict(uint32_t index);
+
+		// The memory of every live HL resource, or of the registered ones if the render stats are compiled out
+		uint64_t GetUsedMemory() const;
+	};
+
+	HLResidencyManager::Details::~Details()
+	{
+		Destroy();
+	}
+
+	Result HLResidencyManager::Details::Destroy()
+	{
+		if (!context.IsInitialized())
+			return Result::Success; // Already destroyed
+
+		// The resources belong to their users, they stay as they are
+		entries.clear();
+		freeEntries.clear();
+		residentEntries.clear();
+
+		context = HLContext{};
+
+		return Result::Success;
+	}
+
+	HLResidencyManager::Details::Entry* HLResidencyManager::Details::GetEntry(HLResidentResource resource)
+	{
+		if (!resource.IsValid() || resource.index >= entries.size() || !entries[resource.index].live ||
+			entries[resource.index].generation != resource.generation)
+			return nullptr;
+
+		return &entries[resource.index];
+	}
+
+	Result HLResidencyManager::Details::Add(HLResourceType type, uint32_t handle, uint64_t size, HLResidencyStreamInfo&& streamInfo,
+		HLResidentResource& resourceOut)
+	{
+		if (residentEntries.contains(GetKey(type, handle)))
+			return Result::InvalidParameter; // Already registered
+
+		Entry entry{
+			.type = type,
+			.handle = handle,
+			.size = size,
+			.lastUsedFrame = frame,
+			.streamInfo = std::move(streamInfo),
+			.state = State::Resident,
+			.generation = 0,
+			.live = true
+		};
+
+		if (freeEntries.empty())
+		{
+			resourceOut.index = static_cast<uint32_t>(entries.size());
+			entries.push_back(std::move(entry));
+		}
+		else
+		{
+			resourceOut.index = freeEntries.back();
+			freeEntries.pop_back();
+			entry.generation = entries[resourceOut.index].generation;
+			entries[resourceOut.index] = std::move(entry);
+		}
+		resourceOut.generation = entries[resourceOut.index].generation;
+
+		residentEntries.emplace(GetKey(type, handle), resourceOut.index);
+		registeredMemory += size;
+		residentCount++;
+
+		return Result::Success;
+	}
+
+	Result HLResidencyManager::Details::SetResident(HLResidentResource resource, HLResourceType type, uint32_t handle, uint64_t size)
+	{
+		Entry* entry = GetEntry(resource);
+		if (!entry || entry->type != type || entry->state == State::Resident || residentEntries.contains(GetKey(type, handle)))
+			return Result::InvalidParameter;
+
+		entry->handle = handle;
+		entry->size = size;
+		entry->lastUsedFrame = frame;
+		entry->state = State::Resident;
+
+		residentEntries.emplace(GetKey(type, handle), resource.index);
+		registeredMemory += size;
+		residentCount++;
+		evictedCount--;
+
+		return Result::Success;
+	}
+
+	void HLResidencyManager::Details::Touch(HLResourceType type, uint32_t handle)
+	{
+		auto it = residentEntries.find(GetKey(type, handle));
+		if (it != residentEntries.end())
+			entries[it->second].lastUsedFrame = frame;
+	}
+
+	void HLResidencyManager::Details::Evict(uint32_t index)
+	{
+		Entry& entry = entries[index];
+
+		// The handle is free once the resource is destroyed, a new resource can get it
+		residentEntries.erase(GetKey(entry.type, entry.handle));
+		entry.state = State::Evicted;
+		registeredMemory -= entry.size;
+		residentCount--;
+		evictedCount++;
+		evictions++;
+
+		// A copy, the function may register resources (entries can move)
+		auto evict = entry.streamInfo.evict;
+		evict();
+	}
+
+	uint64_t HLResidencyManager::Details::GetUsedMemory() const
+	{
+		uint64_t used = 0;
+		for (auto& memory : Impl::renderStats.liveMemory)
+			used += memory.load(std::memory_order_relaxed);
+
+		return std::max(used, registeredMemory);
+	}
+
+	Result HLResidencyManager::Create(const HLResidencyManagerCreateInfo& createInfo)
+	{
+		HLRenderInterface renderInterface = createInfo.renderInterface;
+		if (!renderInterface.IsInitialized() || createInfo.budgetFraction <= 0.0f)
+			return Result::InvalidParameter;
+
+		m_details = std::make_shared<Details>();
+		m_details->context = renderInterface.GetContext();
+		m_details->keepFrames = createInfo.keepFrames;
+
+		// Without the total memory, the HL resources that exist now are part of the available memory
+		HLMemoryInfo memoryInfo;
+		if (IsError(renderInterface.GetMemoryInfo(memoryInfo)))
+			m_details->driverBudget = UINT64_MAX;
+		else if (memoryInfo.totalMemory != 0)
+			m_details->driverBudget = static_cast<uint64_t>(memoryInfo.totalMemory * static_cast<double>(createInfo.budgetFraction));
+		else
+			m_details->driverBudget = static_cast<uint64_t>((memoryInfo.availableMemory + m_details->GetUsedMemory()) *
+				static_cast<double>(createInfo.budgetFraction));
+
+		m_details->budget = (createInfo.budget != 0) ? createInfo.budget : m_details->driverBudget;
+
+		return Result::Success;
+	}
+
+	Result HLResidencyManager::Destroy()
+	{
+		auto result = m_details->Destroy();
+		m_details = nullptr;
+		return result;
+	}
+
+	Result HLResidencyManager::Register(const HLTexture2D& texture, HLResidentResource& resourceOut, HLResidencyStreamInfo streamInfo)
+	{
+		HLTexture2D tex = texture;
+		if (!tex.IsInitialized())
+			return Result::InvalidParameter;
+
+		return m_details->Add(HLResourceType::Texture2D, tex.GetNativeHandle(), tex.GetMemorySize(), std::move(streamInfo), resourceOut);
+	}
+
+	Result HLResidencyManager::Register(const HLTexture2DArray& textures, HLResidentResource& resourceOut, HLResidencyStreamInfo streamInfo)
+	{
+		HLTexture2DArray tex = textures;
+		if (!tex.IsInitialized())
+			return Result::InvalidParameter;
+
+		return m_details->Add(HLResourceType::Texture2DArray, tex.GetNativeHandle(), tex.GetMemorySize(), std::move(streamInfo), resourceOut);
+	}
+
+	Result HLResidencyManager::Register(const HLBuffer& buffer, HLResidentResource& resourceOut, HLResidencyStreamInfo streamInfo)
+	{
+		HLBuffer buf = buffer;
+		if (!buf.IsInitialized())
+			return Result::InvalidParameter;
+
+		return m_details->Add(HLResourceType::Buffer, buf.GetNativeHandle(), buf.GetSize(), std::move(streamInfo), resourceOut);
+	}
+
+	Result HLResidencyManager::Unregister(HLResidentResource resource)
+	{
+		Details::Entry* entry = m_details->GetEntry(resource);
+		if (!entry)
+			return Result::InvalidParameter;
+
+		if (entry->state == Details::State::Resident)
+		{
+			m_details->residentEntries.erase(Details::GetKey(entry->type, entry->handle));
+			m_details->registeredMemory -= entry->size;
+			m_details->residentCount--;
+		}
+		else
+			m_details->evictedCount--;
+
+		const uint32_t generation = entry->generation + 1;
+		*entry = Details::Entry{};
+		entry->generation = generation;
+		m_details->freeEntries.push_back(resource.index);
+
+		return Result::Success;
+	}
+
+	Result HLResidencyManager::SetReloaded(HLResidentResource resource, const HLTexture2D& texture)
+	{
+		HLTexture2D tex = texture;
+		if (!tex.IsInitialized())
+			return Result::InvalidParameter;
+
+		return m_details->SetResident(resource, HLResourceType::Texture2D, tex.GetNativeHandle(), tex.GetMemorySize());
+	}
+
+	Result HLResidencyManager::SetReloaded(HLResidentResource resource, const HLTexture2DArray& textures)
+	{
+		HLTexture2DArray tex = textures;
+		if (!tex.IsInitialized())
+			return Result::InvalidParameter;
+
+		return m_details->SetResident(resource, HLResourceType::Texture2DArray, tex.GetNativeHandle(), tex.GetMemorySize());
+	}
+
+	Result HLResidencyManager::SetReloaded(HLResidentResource resource, const HLBuffer& buffer)
+	{
+		HLBuffer buf = buffer;
+		if (!buf.IsInitialized())
+			return Result::InvalidParameter;
+
+		return m_details->SetResident(resource, HLResourceType::Buffer, buf.GetNativeHandle(), buf.GetSize());
+	}
+
+	Result HLResidencyManager::Touch(HLResidentResource resource)
+	{
+		Details::Entry* entry = m_details->GetEntry(resource);
+		if (!entry)
+			return Result::InvalidParameter;
+
+		entry->lastUsedFrame = m_details->frame;
+
+		// The reload function may set the resource reloaded right away
+		if (entry->state == Details::State::Evicted && entry->streamInfo.reload)
+		{
+			entry->state = Details::State::Reloading;
+			m_details->reloads++;
+
+			auto reload = entry->streamInfo.reload;
+			reload();
+		}
+
+		return Result::Success;
+	}
+
+	void HLResidencyManager::Touch(const HLTexture2D& texture)
+	{
+		HLTexture2D tex = texture;
+		if (tex.IsInitialized())
+			m_details->Touch(HLResourceType::Texture2D, tex.GetNativeHandle());
+	}
+
+	void HLResidencyManager::Touch(const HLTexture2DArray& textures)
+	{
+		HLTexture2DArray tex = textures;
+		if (tex.IsInitialized())
+			m_details->Touch(HLResourceType::Texture2DArray, tex.GetNativeHandle());
+	}
+
+	void HLResidencyManager::Touch(const HLBuffer& buffer)
+	{
+		HLBuffer buf = buffer;
+		if (buf.IsInitialized())
+			m_details->Touch(HLResourceType::Buffer, buf.GetNativeHandle());
+	}
+
+	uint32_t HLResidencyManager::Update()
+	{
+		uint32_t evictedCount = 0;
+
+		uint64_t usedMemory = m_details->GetUsedMemory();
+		if (usedMemory > m_details->budget)
+		{
+			// The streamable resources that weren't used in the last keepFrames frames, least recently used first (then largest
+			// first, so fewer resources are evicted)
+			std::vector<uint32_t> candidates;
+			for (uint32_t i = 0; i < m_details->entries.size(); i++)
+			{
+				const Details::Entry& entry = m_details->entries[i];
+				if (entry.live && entry.state == Details::State::Resident && entry.streamInfo.evict &&
+					m_details->frame - entry.lastUsedFrame >= m_details->keepFrames)
+					candidates.push_back(i);
+			}
+
+			auto& entries = m_details->entries;
+			std::ranges::sort(candidates, [&](uint32_t lhs, uint32_t rhs)
+			{
+				if (entries[lhs].lastUsedFrame != entries[rhs].lastUsedFrame)
+					return entries[lhs].lastUsedFrame < entries[rhs].lastUsedFrame;
+				return entries[lhs].size > entries[rhs].size;
+			});
+
+			for (uint32_t index : candidates)
+			{
+				if (usedMemory <= m_details->budget)
+					break;
+
+				// Count the registered size as freed even if the live memory didn't drop (something else still holds the resource),
+				// so one resource that can't be freed doesn't evict every other candidate
+				const uint64_t size = entries[index].size;
+				m_details->Evict(index);
+				usedMemory = std::min(m_details->GetUsedMemory(), usedMemory - std::min(usedMemory, size));
+				evictedCount++;
+			}
+		}
+
+		m_details->frame++;
+		return evictedCount;
+	}
+
+	bool HLResidencyManager::IsResident(HLResidentResource resource)
+	{
+		Details::Entry* entry = m_details->GetEntry(resource);
+		return entry && entry->state == Details::State::Resident;
+	}
+
+	Result HLResidencyManager::SetBudget(uint64_t budget)
+	{
+		m_details->budget = (budget != 0) ? budget : m_details->driverBudget;
+		return Result::Success;
+	}
+
+	HLResidencyStats HLResidencyManager::GetStats()
+	{
+		return HLResidencyStats{
+			.budget = m_details->budget,
+			.usedMemory = m_details->GetUsedMemory(),
+			.registeredMemory = m_details->registeredMemory,
+			.residentCount = m_details->residentCount,
+			.evictedCount = m_details->evictedCount,
+			.evictions = m_details->evictions,
+			.reloads = m_details->reloads
+		};
+	}
+
+	bool HLResidencyManager::IsInitialized()
+	{
+		return m_details && m_details->context.IsInitialized();
+	}
+}
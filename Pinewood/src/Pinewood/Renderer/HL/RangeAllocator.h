@@ -0,0 +1,121 @@
+#pragma once
+#include "pch.h"
+
+#include <map>
+
+namespace Pinewood::Impl
+{
+	// Allocates ranges of [0, size), best fit from a free list. Freed ranges merge with their free neighbours, so the free list
+	// only grows with fragmentation
+	class RangeAllocator
+	{
+	public:
+		// Frees everything, the whole size is one free range
+		void Reset(uint32_t size)
+		{
+			m_size = size;
+			m_freeSize = size;
+			m_freeByOffset.clear();
+			m_freeBySize.clear();
+			if (size > 0)
+				AddFreeRange(0, size);
+		}
+
+		// Marks [0, usedSize) allocated and the rest free (ex: after compacting the allocations)
+		void ResetCompacted(uint32_t usedSize)
+		{
+			m_freeSize = m_size - usedSize;
+			m_freeByOffset.clear();
+			m_freeBySize.clear();
+			if (usedSize < m_size)
+				AddFreeRange(usedSize, m_size - usedSize);
+		}
+
+		// Returns false if no free range is large enough
+		bool Allocate(uint32_t size, uint32_t& offsetOut)
+		{
+			if (size == 0)
+			{
+				offsetOut = 0;
+				return true;
+			}
+
+			// The smallest free range that fits
+			auto it = m_freeBySize.lower_bound(size);
+			if (it == m_freeBySize.end())
+				return false;
+
+			const uint32_t rangeSize = it->first;
+			const uint32_t offset = it->second;
+			RemoveFreeRange(offset, rangeSize);
+			if (rangeSize > size)
+				AddFreeRange(offset + size, rangeSize - size);
+
+			m_freeSize -= size;
+			offsetOut = offset;
+			return true;
+		}
+
+		void Free(uint32_t offset, uint32_t size)
+		{
+			if (size == 0)
+				return;
+
+			m_freeSize += size;
+
+			// Merge with the free ranges around it
+			auto next = m_freeByOffset.lower_bound(offset);
+			if (next != m_freeByOffset.end() && next->first == offset + size)
+			{
+				size += next->second;
+				RemoveFreeRange(next->first, next->second);
+			}
+
+			auto previous = m_freeByOffset.lower_bound(offset);
+			if (previous != m_freeByOffset.begin())
+			{
+				previous--;
+				if (previous->first + previous->second == offset)
+				{
+					offset = previous->first;
+					size += previous->second;
+					RemoveFreeRange(previous->first, previous->second);
+				}
+			}
+
+			AddFreeRange(offset, size);
+		}
+
+		uint32_t GetSize() const { return m_size; }
+		uint32_t GetFreeSize() const { return m_freeSize; }
+		uint32_t GetLargestFreeRange() const { return m_freeBySize.empty() ? 0 : m_freeBySize.rbegin()->first; }
+		uint32_t GetFreeRangeCount() const { return static_cast<uint32_t>(m_freeByOffset.size()); }
+
+	private:
+		void AddFreeRange(uint32_t offset, uint32_t size)
+		{
+			m_freeByOffset.emplace(offset, size);
+			m_freeBySize.emplace(size, offset);
+		}
+
+		void RemoveFreeRange(uint32_t offset, uint32_t size)
+		{
+			m_freeByOffset.erase(offset);
+
+			auto [begin, end] = m_freeBySize.equal_range(size);
+			for (auto it = begin; it != end; it++)
+			{
+				if (it->second == offset)
+				{
+					m_freeBySize.erase(it);
+					break;
+				}
+			}
+		}
+
+		uint32_t m_size = 0;
+		uint32_t m_freeSize = 0;
+		std::map<uint32_t, uint32_t> m_freeByOffset;		// Offset -> size
+		std::multimap<uint32_t, uint32_t> m_freeBySize;	// Size -> offset
+	};
+}
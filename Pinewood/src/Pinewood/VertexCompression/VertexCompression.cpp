@@ -0,0 +1,416 @@
+#include "pch.h"
+#include <Pinewood/VertexCompression.h>
+
+#include <cmath>
+#include <cstring>
+
+namespace Pinewood
+{
+	namespace
+	{
+		enum class Encoding
+		{
+			UNorm,		// offset + stored * scale
+			Octahedral,	// SNorm storage
+			Half,
+			Float
+		};
+
+		struct Candidate
+		{
+			HLLayoutElementType baseType; // The 1 component type
+			Encoding encoding;
+		};
+
+		uint32_t GetComponentCount(HLLayoutElementType type)
+		{
+			return (static_cast<uint32_t>(type) & 0x3) + 1;
+		}
+
+		uint32_t GetComponentSize(HLLayoutElementType type)
+		{
+			switch (static_cast<uint32_t>(type) >> 4)
+			{
+			case 0x0: case 0x4: case 0xa: case 0xc: return 1;
+			case 0x1: case 0x5: case 0x7: case 0xb: case 0xd: return 2;
+			case 0x2: case 0x6: case 0x8: return 4;
+			case 0x9: return 8;
+			default: return 0;
+			}
+		}
+
+		HLLayoutElementType MakeType(HLLayoutElementType baseType, uint32_t componentCount)
+		{
+			return static_cast<HLLayoutElementType>(static_cast<uint32_t>(baseType) | (componentCount - 1));
+		}
+
+		bool IsFloat32(HLLayoutElementType type)
+		{
+			return (static_cast<uint32_t>(type) >> 4) == 0x8;
+		}
+
+		// IEEE 754 binary16, rounds to nearest even
+		uint16_t FloatToHalf(float value)
+		{
+			uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+
+			const uint32_t sign = (bits >> 16) & 0x8000;
+			const int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+			uint32_t mantissa = bits & 0x7fffff;
+
+			if (((bits >> 23) & 0xff) == 0xff) // Inf or NaN
+				return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+			if (exponent >= 31) // Overflow
+				return static_cast<uint16_t>(sign | 0x7c00);
+
+			if (exponent <= 0)
+			{
+				// Denormal (or zero)
+				if (exponent < -10)
+					return static_cast<uint16_t>(sign);
+
+				mantissa |= 0x800000;
+				const uint32_t shift = 14 - exponent;
+				uint32_t half = mantissa >> shift;
+				const uint32_t remainder = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+				if (remainder > halfway || (remainder == halfway && (half & 1)))
+					half++;
+				return static_cast<uint16_t>(sign | half);
+			}
+
+			uint32_t half = (static_cast<uint32_t>(exponent) << 10) | (mantissa >> 13);
+			const uint32_t remainder = mantissa & 0x1fff;
+			if (remainder > 0x1000 || (remainder == 0x1000 && (half & 1)))
+				half++; // May carry into the exponent, which is still correct (up to infinity)
+			return static_cast<uint16_t>(sign | half);
+		}
+
+		float HalfToFloat(uint16_t half)
+		{
+			const uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+			uint32_t exponent = (half >> 10) & 0x1f;
+			uint32_t mantissa = half & 0x3ff;
+			uint32_t bits;
+
+			if (exponent == 0x1f)
+				bits = sign | 0x7f800000 | (mantissa << 13);
+			else if (exponent != 0)
+				bits = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+			else if (mantissa == 0)
+				bits = sign;
+			else
+			{
+				// Denormal, normalize it
+				exponent = 127 - 15 + 1;
+				while (!(mantissa & 0x400))
+				{
+					mantissa <<= 1;
+					exponent--;
+				}
+				bits = sign | (exponent << 23) | ((mantissa & 0x3ff) << 13);
+			}
+
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+
+		// Octahedral mapping of a unit vector onto [-1, 1]^2
+		void OctahedralEncode(const float (&normal)[3], float (&encodedOut)[2])
+		{
+			const float sum = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+			float x = normal[0] / sum, y = normal[1] / sum;
+			if (normal[2] < 0.0f)
+			{
+				const float foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+				const float foldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+				x = foldedX;
+				y = foldedY;
+			}
+
+			encodedOut[0] = x;
+			encodedOut[1] = y;
+		}
+
+		// Same as OctahedralDecodeGLSL
+		void OctahedralDecode(float x, float y, float (&normalOut)[3])
+		{
+			float z = 1.0f - std::abs(x) - std::abs(y);
+			if (z < 0.0f)
+			{
+				const float unfoldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+				const float unfoldedY = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+				x = unfoldedX;
+				y = unfoldedY;
+			}
+
+			const float length = std::sqrt(x * x + y * y + z * z);
+			normalOut[0] = x / length;
+			normalOut[1] = y / length;
+			normalOut[2] = z / length;
+		}
+
+		// Quantizes one attribute with one candidate, and measures the error
+		class AttributeEncoder
+		{
+		public:
+			AttributeEncoder(std::span<const float> values, uint32_t componentCount) :m_values(values), m_componentCount(componentCount) {}
+
+			// Returns the maximum error, encoded data is tightly packed
+			float Encode(const Candidate& candidate, const float (&offset)[4], const float (&scale)[4], std::vector<uint8_t>& dataOut) const
+			{
+				const uint32_t storedComponents = (candidate.encoding == Encoding::Octahedral) ? 2 : m_componentCount;
+				const uint32_t componentSize = GetComponentSize(candidate.baseType);
+				const size_t vertexCount = m_values.size() / m_componentCount;
+
+				dataOut.resize(vertexCount * storedComponents * componentSize);
+				float maxError = 0.0f;
+
+				for (size_t i = 0; i < vertexCount; i++)
+				{
+					const float* in = &m_values[i * m_componentCount];
+					uint8_t* out = &dataOut[i * storedComponents * componentSize];
+
+					if (candidate.encoding == Encoding::Octahedral)
+					{
+						maxError = std::max(maxError, EncodeOctahedral(in, componentSize, out));
+						continue;
+					}
+
+					for (uint32_t c = 0; c < m_componentCount; c++)
+					{
+						float decoded;
+						switch (candidate.encoding)
+						{
+						case Encoding::UNorm:
+						{
+							const float maxValue = (componentSize == 1) ? 255.0f : 65535.0f;
+							const float normalized = (scale[c] != 0.0f) ? std::clamp((in[c] - offset[c]) / scale[c], 0.0f, 1.0f) : 0.0f;
+							const uint32_t stored = static_cast<uint32_t>(std::round(normalized * maxValue));
+							std::memcpy(out + c * componentSize, &stored, componentSize); // Little endian
+							decoded = offset[c] + (stored / maxValue) * scale[c];
+							break;
+						}
+						case Encoding::Half:
+						{
+							const uint16_t stored = FloatToHalf(in[c]);
+							std::memcpy(out + c * componentSize, &stored, sizeof(stored));
+							decoded = HalfToFloat(stored);
+							break;
+						}
+						default:
+							std::memcpy(out + c * componentSize, &in[c], sizeof(float));
+							decoded = in[c];
+							break;
+						}
+
+						maxError = std::max(maxError, std::abs(decoded - in[c]));
+					}
+				}
+
+				return maxError;
+			}
+
+		private:
+			// Tries the 4 nearest quantized points, since rounding each component on its own isn't always the closest direction
+			static float EncodeOctahedral(const float* in, uint32_t componentSize, uint8_t* out)
+			{
+				const float length = std::sqrt(in[0] * in[0] + in[1] * in[1] + in[2] * in[2]);
+				if (length <= 0.0f)
+				{
+					std::memset(out, 0, componentSize * 2);
+					return 0.0f;
+				}
+
+				const float normal[3] = { in[0] / length, in[1] / length, in[2] / length };
+				float encoded[2];
+				OctahedralEncode(normal, encoded);
+
+				const float maxValue = (componentSize == 1) ? 127.0f : 32767.0f;
+				const float baseX = std::floor(encoded[0] * maxValue), baseY = std::floor(encoded[1] * maxValue);
+
+				float bestError = std::numeric_limits<float>::max();
+				int32_t bestX = 0, bestY = 0;
+				for (uint32_t j = 0; j < 4; j++)
+				{
+					const int32_t x = static_cast<int32_t>(std::clamp(baseX + (j & 1), -maxValue, maxValue));
+					const int32_t y = static_cast<int32_t>(std::clamp(baseY + (j >> 1), -maxValue, maxValue));
+
+					float decoded[3];
+					OctahedralDecode(x / maxValue, y / maxValue, decoded);
+
+					float error = 0.0f;
+					for (uint32_t c = 0; c < 3; c++)
+						error = std::max(error, std::abs(decoded[c] - normal[c]));
+
+					if (error < bestError)
+					{
+						bestError = error;
+						bestX = x;
+						bestY = y;
+					}
+				}
+
+				std::memcpy(out, &bestX, componentSize);
+				std::memcpy(out + componentSize, &bestY, componentSize);
+				return bestError;
+			}
+
+			std::span<const float> m_values;
+			uint32_t m_componentCount;
+		};
+	}
+
+	uint32_t GetLayoutElementSize(HLLayoutElementType type)
+	{
+		return GetComponentCount(type) * GetComponentSize(type);
+	}
+
+	Result CompressVertices(std::span<const uint8_t> vertexData, uint32_t vertexStride, std::span<const HLLayoutElement> elements,
+		std::span<const VertexCompressionAttribute> attributes, CompressedVertexData& compressedOut)
+	{
+		if (vertexStride == 0 || vertexData.size() % vertexStride || elements.size() != attributes.size())
+			return Result::InvalidParameter;
+
+		for (auto& element : elements)
+			if (element.binding != 0 || GetComponentSize(element.type) == 0 || element.offset + GetLayoutElementSize(element.type) > vertexStride)
+				return Result::InvalidParameter;
+
+		const size_t vertexCount = vertexData.size() / vertexStride;
+
+		compressedOut.elements.clear();
+		compressedOut.attributes.clear();
+
+		std::vector<std::vector<uint8_t>> encodedElements(elements.size());
+		uint32_t stride = 0;
+
+		for (size_t i = 0; i < elements.size(); i++)
+		{
+			const HLLayoutElement& element = elements[i];
+			const uint32_t componentCount = GetComponentCount(element.type);
+
+			CompressedVertexAttribute attribute{
+				.element = element,
+				.octahedral = false,
+				.offset = { 0.0f, 0.0f, 0.0f, 0.0f },
+				.scale = { 1.0f, 1.0f, 1.0f, 1.0f },
+				.maxError = 0.0f
+			};
+
+			VertexAttributeHint hint = attributes[i].hint;
+			if (!IsFloat32(element.type))
+				hint = VertexAttributeHint::Keep;
+			if (hint == VertexAttributeHint::Normal && componentCount != 3)
+				return Result::InvalidParameter;
+
+			if (hint == VertexAttributeHint::Keep)
+			{
+				// Copy it as is
+				const uint32_t size = GetLayoutElementSize(element.type);
+				auto& encoded = encodedElements[i];
+				encoded.resize(vertexCount * size);
+				for (size_t j = 0; j < vertexCount; j++)
+					std::memcpy(&encoded[j * size], &vertexData[j * vertexStride + element.offset], size);
+			}
+			else
+			{
+				// Gather the values and their bounds
+				std::vector<float> values(vertexCount * componentCount);
+				for (size_t j = 0; j < vertexCount; j++)
+					std::memcpy(&values[j * componentCount], &vertexData[j * vertexStride + element.offset], componentCount * sizeof(float));
+
+				float boundsMin[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, boundsMax[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+				for (uint32_t c = 0; c < componentCount; c++)
+				{
+					boundsMin[c] = std::numeric_limits<float>::max();
+					boundsMax[c] = std::numeric_limits<float>::lowest();
+					for (size_t j = 0; j < vertexCount; j++)
+					{
+						boundsMin[c] = std::min(boundsMin[c], values[j * componentCount + c]);
+						boundsMax[c] = std::max(boundsMax[c], values[j * componentCount + c]);
+					}
+				}
+
+				bool inUnitRange = true;
+				for (uint32_t c = 0; c < componentCount; c++)
+					inUnitRange = inUnitRange && (boundsMin[c] >= 0.0f) && (boundsMax[c] <= 1.0f);
+
+				// Candidates from smallest to largest, Float32 always fits
+				std::vector<Candidate> candidates;
+				bool useBounds = false;
+				switch (hint)
+				{
+				case VertexAttributeHint::Position:
+					useBounds = true;
+					candidates = { { HLLayoutElementType::UNorm8, Encoding::UNorm }, { HLLayoutElementType::UNorm16, Encoding::UNorm }, { HLLayoutElementType::Float16, Encoding::Half } };
+					break;
+				case VertexAttributeHint::Normal:
+					candidates = { { HLLayoutElementType::Norm8, Encoding::Octahedral }, { HLLayoutElementType::Norm16, Encoding::Octahedral }, { HLLayoutElementType::Float16, Encoding::Half } };
+					break;
+				case VertexAttributeHint::TexCoord:
+					useBounds = !inUnitRange;
+					candidates = { { HLLayoutElementType::UNorm8, Encoding::UNorm }, { HLLayoutElementType::UNorm16, Encoding::UNorm }, { HLLayoutElementType::Float16, Encoding::Half } };
+					break;
+				case VertexAttributeHint::Color:
+					if (inUnitRange)
+						candidates = { { HLLayoutElementType::UNorm8, Encoding::UNorm }, { HLLayoutElementType::UNorm16, Encoding::UNorm } };
+					candidates.push_back({ HLLayoutElementType::Float16, Encoding::Half });
+					break;
+				default:
+					candidates = { { HLLayoutElementType::Float16, Encoding::Half } };
+					break;
+				}
+				candidates.push_back({ HLLayoutElementType::Float32, Encoding::Float });
+
+				float offset[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, scale[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+				if (useBounds)
+				{
+					for (uint32_t c = 0; c < componentCount; c++)
+					{
+						offset[c] = boundsMin[c];
+						scale[c] = boundsMax[c] - boundsMin[c];
+					}
+				}
+
+				AttributeEncoder encoder{ values, componentCount };
+				for (auto& candidate : candidates)
+				{
+					const float error = encoder.Encode(candidate, offset, scale, encodedElements[i]);
+					if (error > attributes[i].maxError && candidate.encoding != Encoding::Float)
+						continue;
+
+					const bool octahedral = (candidate.encoding == Encoding::Octahedral);
+					attribute.element.type = MakeType(candidate.baseType, octahedral ? 2 : componentCount);
+					attribute.octahedral = octahedral;
+					attribute.maxError = error;
+					if (candidate.encoding == Encoding::UNorm)
+					{
+						std::copy_n(offset, 4, attribute.offset);
+						std::copy_n(scale, 4, attribute.scale);
+					}
+					break;
+				}
+			}
+
+			// Keep every attribute 4 byte aligned
+			attribute.element.offset = stride;
+			stride += (GetLayoutElementSize(attribute.element.type) + 3) & ~3u;
+
+			compressedOut.elements.push_back(attribute.element);
+			compressedOut.attributes.push_back(attribute);
+		}
+
+		// Interleave the encoded attributes
+		compressedOut.binding = { 0, stride };
+		compressedOut.vertexData.assign(vertexCount * stride, 0);
+		for (size_t i = 0; i < elements.size(); i++)
+		{
+			const uint32_t size = GetLayoutElementSize(compressedOut.elements[i].type);
+			for (size_t j = 0; j < vertexCount; j++)
+				std::memcpy(&compressedOut.vertexData[j * stride + compressedOut.elements[i].offset], &encodedElements[i][j * size], size);
+		}
+
+		return Result::Success;
+	}
+}
@@ -2,6 +2,71 @@
 
 #if PW_PLATFORM_WINDOWS
 #include "../Platform/Win32/Win32Window.h"
-#else // ^^^ PW_PLATFORM_WINDOWS // Unsupported platform vvv
+#elif PW_PLATFORM_LINUX // ^^^ PW_PLATFORM_WINDOWS // PW_PLATFORM_LINUX vvv
+#include "../Platform/X11/X11Window.h"
+#else // ^^^ PW_PLATFORM_LINUX // Unsupported platform vvv
 #error "No valid/supported plaform was selected"
 #endif // ^^^ Unsupported platform
+
+// Shared by every platform, Window::Details has the events and SendEvent everywhere
+namespace Pinewood
+{
+	Result Window::AddEventHandler(const WindowEventHandler& eventHandler)
+	{
+		return m_details->events.AddHandler(eventHandler);
+	}
+
+	Result Window::RemoveEventHandler(const WindowEventHandler& eventHandler)
+	{
+		return m_details->events.RemoveHandler(eventHandler);
+	}
+
+	Result Window::PollEvents(std::span<WindowEventData> eventsOut, size_t& countOut)
+	{
+		countOut = 0;
+		if (!m_details->events.HasQueue())
+			return Result::NotInitialized;
+
+		countOut = m_details->events.Pop(eventsOut);
+		for (size_t i = 0; i < countOut; i++)
+			m_details->events.Dispatch(*this, eventsOut[i]);
+
+		return Result::Success;
+	}
+
+	Result Window::PollEvents()
+	{
+		std::array<WindowEventData, 64> events;
+		size_t count;
+
+		do
+		{
+			Result result = PollEvents(events, count);
+			if (IsError(result))
+				return result;
+		} while (count == events.size());
+
+		return Result::Success;
+	}
+
+	uint64_t Window::GetDroppedEventCount()
+	{
+		return m_details->events.GetDroppedCount();
+	}
+
+	Result Window::InjectEvent(const WindowEventData& event)
+	{
+		// The platform sends the events of other windows, the event queue only has one producer
+		if (!m_details->headless || event.code == WindowEventCode::Null)
+			return Result::InvalidParameter;
+
+		if (event.code == WindowEventCode::WindowResize)
+		{
+			m_details->width = event.resize.width;
+			m_details->height = event.resize.height;
+		}
+
+		m_details->SendEvent(event);
+		return Result::Success;
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <Pinewood/Window.h>
+#include <Pinewood/SPSCQueue.h>
+
+#include <atomic>
+
+namespace Pinewood::Impl
+{
+	// Without the event code
+	struct WindowEventHandler2
+	{
+		WindowEventHandler::Function function;
+		void* userPointer;
+
+		bool operator==(const WindowEventHandler2& rhs)
+		{
+			return (function == rhs.function) && (userPointer == rhs.userPointer);
+		}
+	};
+
+	// The event handlers and event queue of a window, the same on every platform
+	class WindowEvents
+	{
+	public:
+		// Creates the event queue if WindowCreateFlags::EventQueue was specified
+		void Create(const WindowCreateInfo& createInfo)
+		{
+			if (static_cast<uint32_t>(createInfo.flags & WindowCreateFlags::EventQueue))
+				m_eventQueue = std::make_unique<SPSCQueue<WindowEventData>>(createInfo.eventQueueSize);
+		}
+
+		// If the eventHandler is already present, it will not be added and Result::InvalidParameter will be returned
+		Result AddHandler(const WindowEventHandler& eventHandler)
+		{
+			// We search with the smaller structure
+			WindowEventHandler2 smallHandler{
+				.function = eventHandler.function,
+				.userPointer = eventHandler.userPointer
+			};
+
+			// Make sure the event handler isn't already present
+			auto& eventHandlers = m_eventHandlers[static_cast<uint32_t>(eventHandler.event) - 1];
+			if (std::find(eventHandlers.begin(), eventHandlers.end(), smallHandler) != eventHandlers.end())
+				return Result::InvalidParameter;
+
+			eventHandlers.push_back(smallHandler);
+			return Result::Success;
+		}
+
+		// If the eventHandler is not present, Result::InvalidParameter will be returned
+		Result RemoveHandler(const WindowEventHandler& eventHandler)
+		{
+			// We search with the smaller structure
+			WindowEventHandler2 smallHandler{
+				.function = eventHandler.function,
+				.userPointer = eventHandler.userPointer
+			};
+
+			auto& eventHandlers = m_eventHandlers[static_cast<uint32_t>(eventHandler.event) - 1];
+			if (std::erase(eventHandlers, smallHandler) == 0)
+				return Result::InvalidParameter;
+
+			return Result::Success;
+		}
+
+		bool HasHandlers(WindowEventCode code) const
+		{
+			return code != WindowEventCode::Null && !m_eventHandlers[static_cast<uint32_t>(code) - 1].empty();
+		}
+
+		// Calls the event handlers for the event
+		void Dispatch(const Window& window, const WindowEventData& event) const
+		{
+			if (!HasHandlers(event.code))
+				return;
+
+			for (auto& eventHandler : m_eventHandlers[static_cast<uint32_t>(event.code) - 1])
+				eventHandler.function(window, event.GetEvent(), eventHandler.userPointer);
+		}
+
+		bool HasQueue() const { return m_eventQueue != nullptr; }
+
+		// Queues the event (producer side), returns false if the window has no event queue and the event must be dispatched right away
+		bool Queue(const WindowEventData& event)
+		{
+			if (!m_eventQueue)
+				return false;
+
+			if (!m_eventQueue->Push(event))
+				m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+
+			return true;
+		}
+
+		// Pops queued events (consumer side)
+		size_t Pop(std::span<WindowEventData> eventsOut)
+		{
+			return m_eventQueue ? m_eventQueue->Pop(eventsOut) : 0;
+		}
+
+		uint64_t GetDroppedCount() const { return m_droppedEvents.load(std::memory_order_relaxed); }
+
+	private:
+		std::array<std::vector<WindowEventHandler2>, 12> m_eventHandlers;
+
+		// Only with WindowCreateFlags::EventQueue, the window thread produces and PollEvents consumes
+		std::unique_ptr<SPSCQueue<WindowEventData>> m_eventQueue;
+		std::atomic_uint64_t m_droppedEvents = 0;
+	};
+}